@@ -30,6 +30,8 @@ class Tile(object):
         "overlay",  # bool: Tile is rendered above player
         "solid",    # bool: Tile cannot be moved through
         "water",    # bool: Tile is water
+        "zone",     # int: Encounter zone, 0 for the location default
+        "frames",   # list: Animation frames as (tile ID, duration ms)
     ]
 
     def __init__(self):
@@ -39,6 +41,8 @@ class Tile(object):
         self.overlay = False
         self.solid = False
         self.water = False
+        self.zone = 0
+        self.frames = []
 
 ###############################################################
 ## Tileset
@@ -50,6 +54,15 @@ class Tileset(object):
         1.  overlay (bool): The tile is rendered above the player.
         2.  solid (bool):   The tile cannot be moved through.
         3.  water (bool):   The tile is water, and cannot be moved through.
+
+        Tiles may also define an encounter zone.
+
+        4.  zone (int):     Encounter zone of the tile (tall grass, cave
+                            floor, deep water...), indexing the location's
+                            Zones. 0 uses the location's own encounters.
+
+        Tiles animated in Tiled (water, waterfalls, lava) keep their frame
+        sequence, and are drawn by the game's animated tile layer.
     """
 
     __slots__ = [
@@ -78,6 +91,12 @@ class Tileset(object):
                     built.solid = prop.get("value") == "true"
                 elif prop.get("name") == "water":
                     built.water = prop.get("value") == "true"
+                elif prop.get("name") == "zone":
+                    built.zone = int(prop.get("value"))
+            animation = tile.find("animation")
+            if animation is not None:
+                for frame in animation.iter("frame"):
+                    built.frames.append((int(frame.get("tileid")), int(frame.get("duration"))))
             self._tiles.append(built)
 
         # Assemble images
@@ -221,13 +240,25 @@ class Map(object):
             self._events.set(x, y, id)
         return
     
+    def _zone(self, x, y):
+        """ Gets the encounter zone of the tile at x,y. The topmost
+            layer with a zone decides the tile's zone.
+        """
+        zone = 0
+        for layer in self._layers:
+            tile = layer.get(x, y)
+            if tile and tile.zone:
+                zone = tile.zone
+        return zone
+
     def _pack(self, x, y):
-        """ Packs the tile properties at x,y into a struct of 2 bytes.
-            The first byte is the struct flags, and the second is the
-            event ID.
+        """ Packs the tile properties at x,y into a struct of 3 bytes.
+            The first byte is the struct flags, the second is the
+            event ID, and the third is the encounter zone.
         """
         # Get tile properties
         flags = 0x0
+        zone = self._zone(x, y)
         for layer in self._layers:
             tile = layer.get(x, y)
             if tile and tile.water:
@@ -243,7 +274,7 @@ class Map(object):
             event = 0
         
         # Yield packed data
-        return struct.pack("BB", flags, event)
+        return struct.pack("BBB", flags, event, zone)
 
     def compile(self, filename, overlay=None):
         """ Render the map as a pair of images.
@@ -272,6 +303,9 @@ class Map(object):
             overlay = base + "-overlay" + ext
             fg.save(overlay)
         
+        # Save the animated tiles
+        self._compile_animations(filename)
+
         # Save the events
         sensor = bytearray()
         for y in range(self.height):
@@ -283,6 +317,81 @@ class Map(object):
             file.write(sensor)
         return
 
+    def stamp_zones(self, path):
+        """ Writes the encounter zones into the alpha channel of the
+            map's sensor image, which is what the game reads them from.
+            A tile in zone n is left 255-n opaque, so tiles without a
+            zone stay fully opaque. The sensor's colors are kept.
+
+            path - string: Sensor image to update.
+        """
+        sensor = Image.open(path).convert("RGBA")
+        width = min(sensor.width, self.width)
+        height = min(sensor.height, self.height)
+        pixels = sensor.load()
+        for y in range(height):
+            for x in range(width):
+                r, g, b, _ = pixels[x, y]
+                pixels[x, y] = (r, g, b, 255-self._zone(x, y))
+        sensor.save(path)
+        return
+
+    def _compile_animations(self, filename):
+        """ Writes the animated tiles of the map, if there are any.
+            The frames of every animation used go into an atlas image
+            (-atlas.png), and the animations and tile positions go into
+            a little-endian data file (-animated.dat):
+
+            H animation count, H tile count
+            Per animation: H frame count, then per frame: H atlas
+                index, H duration in milliseconds
+            Per tile, sorted by row then column: H x, H y, H animation
+        """
+        tile_width = self._tileset.width
+        tile_height = self._tileset.height
+
+        # Find the animated tiles; the topmost layer wins.
+        animations = []
+        animation_index = {}
+        cells = {}
+        for layer in self._layers:
+            for y, row in enumerate(layer.tiles):
+                for x, tile in enumerate(row):
+                    if tile is not None and tile.frames:
+                        if id(tile) not in animation_index:
+                            animation_index[id(tile)] = len(animations)
+                            animations.append(tile)
+                        cells[(y, x)] = animation_index[id(tile)]
+        if not cells:
+            return
+
+        # Pack every frame image into the atlas.
+        frame_index = {}
+        for tile in animations:
+            for tile_id, _ in tile.frames:
+                if tile_id not in frame_index:
+                    frame_index[tile_id] = len(frame_index)
+        columns = min(len(frame_index), 16)
+        rows = (len(frame_index)+columns-1) // columns
+        atlas = Image.new("RGBA", (columns*tile_width, rows*tile_height))
+        for tile_id, index in frame_index.items():
+            position = ((index % columns)*tile_width, (index // columns)*tile_height)
+            atlas.alpha_composite(self._tileset.tile(tile_id).image, position)
+        base, ext = os.path.splitext(filename)
+        atlas.save(base + "-atlas" + ext)
+
+        # Write the animations and tiles
+        data = bytearray(struct.pack("<HH", len(animations), len(cells)))
+        for tile in animations:
+            data.extend(struct.pack("<H", len(tile.frames)))
+            for tile_id, duration in tile.frames:
+                data.extend(struct.pack("<HH", frame_index[tile_id], duration))
+        for (y, x) in sorted(cells):
+            data.extend(struct.pack("<HHH", x, y, cells[(y, x)]))
+        with open(base + "-animated.dat", "wb") as file:
+            file.write(data)
+        return
+
 ###############################################################
 ## Main
 ###############################################################
@@ -290,10 +399,11 @@ if __name__ == "__main__":
     tileset_path = sys.argv[1] if len(sys.argv) > 1 else None
     tilemap_path = sys.argv[2] if len(sys.argv) > 2 else None
     output_path = sys.argv[3] if len(sys.argv) > 3 else None
+    sensor_path = sys.argv[4] if len(sys.argv) > 4 else None
 
     # Deal with arguments
     if tileset_path is None or tilemap_path is None:
-        print("Usage: %s <tileset> <map> [output?]" % (sys.argv[0],))
+        print("Usage: %s <tileset> <map> [output?] [sensor?]" % (sys.argv[0],))
         exit(0)
     if output_path is None:
         output_path = os.path.splitext(tilemap_path)[0] + ".png"
@@ -305,6 +415,8 @@ if __name__ == "__main__":
         if not os.path.isdir(os.path.dirname(output_path)):
             os.mkdir(os.path.dirname(output_path))
         tilemap.compile(output_path)
+        if sensor_path is not None:
+            tilemap.stamp_zones(sensor_path)
     except:
         traceback.print_exc()
         exit(1)
@@ -0,0 +1,54 @@
+/**********************************************************//**
+ * @file animation.h
+ * @brief Draws the animated tiles of a map from an atlas.
+ * @author Rena Shinomiya
+ * @date June 2, 2018
+ **************************************************************/
+
+#ifndef _ANIMATION_H_
+#define _ANIMATION_H_
+
+#include <stdbool.h>            // bool
+#include <allegro5/allegro.h>   // ALLEGRO_BITMAP
+
+/**************************************************************/
+/// @brief Width and height of one animated tile in pixels.
+#define ANIMATION_TILE 16
+
+/**********************************************************//**
+ * @struct ANIMATED_TILE
+ * @brief One tile on the map that plays an animation.
+ **************************************************************/
+typedef struct {
+    int X;                      ///< Tile X-position.
+    int Y;                      ///< Tile Y-position.
+    int Animation;              ///< Index of the animation played.
+} ANIMATED_TILE;
+
+/**********************************************************//**
+ * @struct ANIMATION_LAYER
+ * @brief All the animated tiles on a map. The tiles are
+ * sorted by row, so only the rows on screen are visited.
+ **************************************************************/
+typedef struct {
+    ALLEGRO_BITMAP *Atlas;      ///< Every frame used on the map, or NULL.
+    int AtlasColumns;           ///< Number of frames across the atlas.
+    int nAnimations;            ///< Number of different animations.
+    int *FirstFrame;            ///< First frame of each animation; nAnimations+1 entries.
+    int *FrameIndex;            ///< Atlas index of each frame.
+    int *FrameEnd;              ///< Time in milliseconds each frame ends at.
+    int *Current;               ///< Atlas index shown for each animation.
+    int nTiles;                 ///< Number of animated tiles.
+    ANIMATED_TILE *Tiles;       ///< Animated tiles by row, then column.
+    int Rows;                   ///< Number of rows with RowStart entries.
+    int *RowStart;              ///< First tile in each row; Rows+1 entries.
+} ANIMATION_LAYER;
+
+/**************************************************************/
+extern bool InitializeAnimationLayer(ANIMATION_LAYER *layer, ALLEGRO_BITMAP *atlas, const unsigned char *data, int size);
+extern void DestroyAnimationLayer(ANIMATION_LAYER *layer);
+extern void DrawAnimationLayer(ANIMATION_LAYER *layer, int left, int top);
+extern void UpdateAnimationClock(void);
+
+/**************************************************************/
+#endif // _ANIMATION_H_
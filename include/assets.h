@@ -48,6 +48,9 @@ extern ALLEGRO_BITMAP *WindowImage(WINDOW_ID id);
 extern ALLEGRO_BITMAP *AilmentImage(AILMENT_ID id);
 extern ALLEGRO_BITMAP *TypeImage(TYPE_ID id);
 extern ALLEGRO_BITMAP *MapImage(MAP_ID id);
+extern ALLEGRO_BITMAP *MapOverlayImage(MAP_ID id);
+extern ALLEGRO_BITMAP *MapAtlasImage(MAP_ID id);
+extern const unsigned char *MapAnimationData(MAP_ID id, int *size);
 extern ALLEGRO_BITMAP *SensorImage(MAP_ID id);
 extern ALLEGRO_BITMAP *PersonImage(PERSON_ID id);
 extern ALLEGRO_BITMAP *MiscImage(MISC_ID id);
@@ -14,11 +14,23 @@
 #include "battler.h"            // BATTLER
 
 /**************************************************************/
-/// @brief Number of battlers on one TEAM.
+/// @brief Number of battlers on one TEAM in the game, unless
+/// the encounter asks for another size.
 #define TEAM_SIZE 3
 
-/// @brief Number of battlers in the whole battle.
-#define BATTLE_SIZE (TEAM_SIZE+TEAM_SIZE)
+/// @brief Most battlers one team can have in the game. This
+/// many HUDs a side still fit on the screen.
+#define TEAM_LIMIT 6
+
+/// @brief Most battlers in a battle in the game.
+#define BATTLE_LIMIT (TEAM_LIMIT+TEAM_LIMIT)
+
+/// @brief Most battlers one team can have in the battle
+/// engine, for raids and simulations.
+#define TEAM_MAX 32
+
+/// @brief Most battlers in any battle.
+#define BATTLE_MAX (TEAM_MAX+TEAM_MAX)
 
 /**********************************************************//**
  * @enum ENCOUNTER_TYPE
@@ -29,7 +41,8 @@ typedef enum {
     ENCOUNTER_FISHING           = 2,
     ENCOUNTER_BOSS              = 3,
 } ENCOUNTER_TYPE;
-/**********************************************************//**
+
+/**********************************************************//**
  * @struct ENEMY
  * @brief Defines enemy data that should be used to generate
  * a random encounter or boss battle.
@@ -39,12 +52,25 @@ typedef struct {
     int Level;
 } ENEMY;
 
+/**********************************************************//**
+ * @enum ENEMY_AI
+ * @brief How the enemy team chooses its turns.
+ **************************************************************/
+typedef enum {
+    AI_RANDOM,                  ///< Random techniques and targets, like wild spectra.
+    AI_SEARCH,                  ///< Play out each choice and pick the best.
+} ENEMY_AI;
+
 /**********************************************************//**
  * @struct BOSS
  * @brief Data about a structured BOSS encounter.
  **************************************************************/
 typedef struct {
-    ENEMY Boss[TEAM_SIZE];
+    ENEMY Boss[TEAM_LIMIT];
+    ENEMY_AI Ai;                ///< How the bosses choose turns.
+    int Budget;                 ///< Milliseconds AI_SEARCH may think each round.
+    int Allies;                 ///< Size of the player's team, or 0 for TEAM_SIZE.
+    int Enemies;                ///< Size of the boss's team, or 0 for TEAM_SIZE.
 } BOSS;
 
 /**********************************************************//**
@@ -52,7 +78,7 @@ typedef struct {
  * @brief Contains the battlers on a given team, user or enemy.
  **************************************************************/
 typedef struct {
-    BATTLER Member[TEAM_SIZE];
+    BATTLER Member[TEAM_LIMIT];
 } TEAM;
 
 /**********************************************************//**
@@ -84,12 +110,16 @@ typedef struct {
 extern void InitializeRandomEncounter(int count, ENCOUNTER_TYPE type);
 extern void InitializeBossEncounter(const BOSS *bosses);
 extern void DrawBattle(void);
+extern void DestroyBattleScene(void);
 extern void UpdateBattle(void);
 extern bool EscapeBattle(void);
+extern bool ReplayLastBattle(void);
 
 /**************************************************************/
 extern BATTLER *BattlerByID(int id);
 extern TURN *TurnByID(int id);
+extern int AllyCount(void);
+extern int BattlerCount(void);
 extern int GetTargets(int *targets, int user, TARGET_TYPE type);
 
 /**********************************************************//**
@@ -0,0 +1,196 @@
+/**********************************************************//**
+ * @file battle_engine.h
+ * @brief The battle engine. A BATTLE_CONTEXT holds the whole
+ * state of one battle by value, so any number of battles can
+ * run at once and a battle can be copied with memcpy to look
+ * ahead without disturbing the original.
+ * @author Rena Shinomiya
+ * @date June 5, 2018
+ **************************************************************/
+
+#ifndef _BATTLE_ENGINE_H_
+#define _BATTLE_ENGINE_H_
+
+#include <stdbool.h>            // bool
+#include <stdint.h>             // uint64_t
+#include <stddef.h>             // offsetof
+#include <string.h>             // memcpy
+
+#include "species.h"            // SPECTRA
+#include "item.h"               // ITEM_ID
+#include "technique.h"          // TARGET_TYPE
+#include "battler.h"            // BATTLER
+#include "battle.h"             // TURN, BATTLE_MAX
+#include "battle_log.h"         // BATTLE_LOG
+
+/**********************************************************//**
+ * @enum BATTLE_STATE
+ * @brief Controls how the battle is finished.
+ **************************************************************/
+typedef enum {
+    BATTLE_STATE_INTRO,         ///< The battle is being introduced.
+    BATTLE_STATE_ACTIVE,        ///< Battle is ongoing.
+    BATTLE_STATE_WIN,           ///< The user won.
+    BATTLE_STATE_LOSE,          ///< The user lost.
+    BATTLE_STATE_ESCAPE,        ///< The user escaped.
+    BATTLE_STATE_NO_ESCAPE,     ///< The user failed to escape.
+    BATTLE_STATE_EXIT,          ///< The battle is just ending.
+} BATTLE_STATE;
+
+/**********************************************************//**
+ * @enum NOTICE_TYPE
+ * @brief Kinds of things the engine reports as they happen.
+ **************************************************************/
+typedef enum {
+    NOTICE_BLOCKED,             ///< An ailment stopped the user's turn.
+    NOTICE_MISS,                ///< The target avoided the technique.
+    NOTICE_HIT,                 ///< The technique hit the target.
+} NOTICE_TYPE;
+
+/**********************************************************//**
+ * @struct BATTLE_NOTICE
+ * @brief Something that happened during a turn.
+ **************************************************************/
+typedef struct {
+    NOTICE_TYPE Type;           ///< What happened.
+    int User;                   ///< ID of the battler taking its turn.
+    int Target;                 ///< ID of the target, or -1.
+    int Damage;                 ///< Damage dealt by a hit.
+    bool Critical;              ///< Set if the hit was critical.
+} BATTLE_NOTICE;
+
+/**********************************************************//**
+ * @struct BATTLE_CONTEXT
+ * @brief Everything about one battle. Battlers 0 up to
+ * nAllies are the player's team and the rest, up to
+ * nBattlers, are the enemy team. Only that many entries of
+ * each array are used. The context owns copies of every
+ * spectra, so the player's party is untouched until the
+ * battle is over.
+ *
+ * Turns are taken in order of priority, which is worked out
+ * once at the start of each round's execution and sorted, so
+ * a round costs O(n log n) however many battlers there are.
+ *
+ * The context has its own random number state, so a battle
+ * plays out the same way every time from the same seed and
+ * the same choices, no matter what else uses random numbers.
+ * Only choosing turns at random uses the thread's generator.
+ *
+ * The hooks let the game react to things outside the battle;
+ * any of them may be NULL. Copies of a context share the same
+ * hooks and log, so clear them on copies used for looking
+ * ahead, and reseed the copies so they don't all play out the
+ * same way.
+ **************************************************************/
+typedef struct {
+    int nAllies;                    ///< Number of battlers on the player's team.
+    int nBattlers;                  ///< Number of battlers on both teams.
+    int CurrentTurn;                ///< ID of the turn being executed, or -1.
+    int nOrder;                     ///< Turns in Order, or -1 until it's worked out.
+    int NextOrder;                  ///< Position of the next turn in Order.
+    int Survivor[2];                ///< IDs last seen alive on each team.
+    int Captured;                   ///< ID of a battler captured this turn, or -1.
+    int CaptureRoom;                ///< Number of spectra the player can still capture.
+    BATTLE_STATE State;             ///< How the battle is going.
+    bool Quiet;                     ///< Set to suppress battle messages.
+    uint64_t Random;                ///< Random number state for the battle.
+    BATTLE_LOG *Log;                ///< Where events are recorded, or NULL.
+
+    /// @brief Called with each spectra that's captured.
+    void (*Capture)(const SPECTRA *spectra);
+
+    /// @brief Called when an item is used up.
+    void (*UseItem)(ITEM_ID item);
+
+    /// @brief Called as hits, misses and blocked turns happen.
+    void (*Notify)(void *data, const BATTLE_NOTICE *notice);
+
+    /// @brief Passed to Notify.
+    void *NotifyData;
+
+    int Order[BATTLE_MAX];          ///< IDs of this round's turns, highest priority first.
+    BATTLER Battler[BATTLE_MAX];    ///< Every battler.
+    TURN Turns[BATTLE_MAX];         ///< Actions chosen this round.
+} BATTLE_CONTEXT;
+
+/**********************************************************//**
+ * @enum REPLAY_STEP
+ * @brief What to do next when replaying a log.
+ **************************************************************/
+typedef enum {
+    REPLAY_ROUND,               ///< Turns were loaded; execute them.
+    REPLAY_ESCAPE,              ///< The player tried to escape; call TryEscape.
+    REPLAY_END,                 ///< There's nothing more in the log.
+} REPLAY_STEP;
+
+/**********************************************************//**
+ * @struct BATTLE_REPLAY
+ * @brief Position in a log being replayed.
+ **************************************************************/
+typedef struct {
+    const BATTLE_LOG *Log;      ///< The log.
+    int Cursor;                 ///< Next event to read.
+} BATTLE_REPLAY;
+
+/**************************************************************/
+extern void InitializeBattleContext(BATTLE_CONTEXT *context, const SPECTRA *allies, int nAllies, const SPECTRA *enemies, int nEnemies);
+extern void SeedBattleContext(BATTLE_CONTEXT *context, uint64_t seed);
+extern void StartBattleLog(BATTLE_CONTEXT *context, BATTLE_LOG *log);
+extern int ContextTargets(const BATTLE_CONTEXT *context, int *targets, int user, TARGET_TYPE type);
+extern float EscapeChance(const BATTLE_CONTEXT *context);
+extern bool TryEscape(BATTLE_CONTEXT *context);
+
+/**************************************************************/
+extern void BeginRound(BATTLE_CONTEXT *context);
+extern void ChooseRandomTurn(BATTLE_CONTEXT *context, int id);
+extern void CommitTurns(BATTLE_CONTEXT *context);
+extern TURN *NextTurn(BATTLE_CONTEXT *context);
+extern void ExecuteTurn(BATTLE_CONTEXT *context, const TURN *turn);
+extern void FinishTurn(BATTLE_CONTEXT *context, TURN *turn);
+extern bool RoundDone(const BATTLE_CONTEXT *context);
+extern void ApplyEndOfRoundEffects(BATTLE_CONTEXT *context);
+extern bool UpdateBattleState(BATTLE_CONTEXT *context);
+extern void RunRound(BATTLE_CONTEXT *context);
+
+/**************************************************************/
+extern void StartReplay(BATTLE_REPLAY *replay, const BATTLE_LOG *log, BATTLE_CONTEXT *context);
+extern REPLAY_STEP ReplayNext(BATTLE_REPLAY *replay, BATTLE_CONTEXT *context);
+extern void FastForwardReplay(BATTLE_REPLAY *replay, BATTLE_CONTEXT *context);
+
+/**********************************************************//**
+ * @brief Checks if a battler is on the player's team.
+ * @param context: The battle.
+ * @param id: Battler's unique ID.
+ * @return True if the battler is an ally.
+ **************************************************************/
+static inline bool BattlerIsAlly(const BATTLE_CONTEXT *context, int id) {
+    return (id<context->nAllies);
+}
+
+/**********************************************************//**
+ * @brief Gets a battler in a context.
+ * @param context: The battle.
+ * @param id: Unique ID of the battler.
+ * @return Pointer to the battler.
+ **************************************************************/
+static inline BATTLER *ContextBattler(BATTLE_CONTEXT *context, int id) {
+    return &context->Battler[id];
+}
+
+/**********************************************************//**
+ * @brief Copies a battle so it can be played out separately.
+ * Only the battlers in use are copied.
+ * @param copy: Context to overwrite.
+ * @param context: Context to copy.
+ **************************************************************/
+static inline void CopyBattleContext(BATTLE_CONTEXT *copy, const BATTLE_CONTEXT *context) {
+    int n = context->nBattlers;
+    memcpy(copy, context, offsetof(BATTLE_CONTEXT, Order));
+    memcpy(copy->Order, context->Order, n*sizeof(int));
+    memcpy(copy->Battler, context->Battler, n*sizeof(BATTLER));
+    memcpy(copy->Turns, context->Turns, n*sizeof(TURN));
+}
+
+/**************************************************************/
+#endif // _BATTLE_ENGINE_H_
@@ -0,0 +1,95 @@
+/**********************************************************//**
+ * @file battle_log.h
+ * @brief Compact binary record of everything that happens in
+ * a battle. Together with the seed and starting teams in the
+ * header, a log is enough to replay a battle exactly.
+ * @author Rena Shinomiya
+ * @date June 7, 2018
+ **************************************************************/
+
+#ifndef _BATTLE_LOG_H_
+#define _BATTLE_LOG_H_
+
+#include <stdio.h>              // FILE
+#include <stdint.h>             // uint8_t, uint16_t, int32_t, uint64_t
+#include <stdbool.h>            // bool
+
+#include "species.h"            // SPECTRA
+#include "battle.h"             // BATTLE_MAX
+
+/**************************************************************/
+/// @brief Bumped whenever the log layout changes.
+#define BATTLE_LOG_VERSION 2
+
+/// @brief Stored in place of a missing battler ID.
+#define LOG_NOBODY 0xFF
+
+/**********************************************************//**
+ * @enum BATTLE_EVENT_TYPE
+ * @brief Kinds of battle events. The meaning of each field
+ * of BATTLE_EVENT depends on the type.
+ **************************************************************/
+typedef enum {
+    LOG_ROUND = 1,              ///< A round's turns were chosen.
+    LOG_CHOICE,                 ///< A=user, B=technique, C=target, Value=item.
+    LOG_TURN,                   ///< A=user started its turn.
+    LOG_BLOCKED,                ///< A=user, B=ailment, or 0 if out of power.
+    LOG_MISS,                   ///< A=user, C=target.
+    LOG_HIT,                    ///< A=user, B=critical, C=target, Value=damage.
+    LOG_AILMENT,                ///< C=target, B=new ailment, or 0 if cured.
+    LOG_ROUND_DAMAGE,           ///< C=target, B=ailment, Value=damage.
+    LOG_CAPTURE,                ///< A=user, B=success, C=target.
+    LOG_ESCAPE,                 ///< B=success.
+    LOG_END,                    ///< B=final BATTLE_STATE.
+} BATTLE_EVENT_TYPE;
+
+/**********************************************************//**
+ * @struct BATTLE_EVENT
+ * @brief One entry in the log; six bytes.
+ **************************************************************/
+typedef struct {
+    uint8_t Type;               ///< BATTLE_EVENT_TYPE.
+    uint8_t A;                  ///< Usually the user.
+    uint8_t B;                  ///< Technique, ailment or flag.
+    uint8_t C;                  ///< Usually the target.
+    uint16_t Value;             ///< Damage or item.
+} BATTLE_EVENT;
+
+/**********************************************************//**
+ * @struct BATTLE_LOG_HEADER
+ * @brief How the logged battle started. Only nBattlers
+ * spectra are saved.
+ **************************************************************/
+typedef struct {
+    char Magic[4];                  ///< Always "SPBL".
+    uint32_t Version;               ///< BATTLE_LOG_VERSION.
+    uint64_t Seed;                  ///< Random number state at the start.
+    int32_t CaptureRoom;            ///< Spectra the player could capture.
+    int32_t nAllies;                ///< Battlers on the player's team.
+    int32_t nBattlers;              ///< Battlers on both teams.
+    SPECTRA Spectra[BATTLE_MAX];    ///< Every battler at the start.
+} BATTLE_LOG_HEADER;
+
+/**********************************************************//**
+ * @struct BATTLE_LOG
+ * @brief A log being recorded or replayed.
+ **************************************************************/
+typedef struct {
+    BATTLE_LOG_HEADER Header;   ///< How the battle started.
+    BATTLE_EVENT *Events;       ///< Events in order.
+    int nEvents;                ///< Number of events.
+    int Capacity;               ///< Space allocated for events.
+} BATTLE_LOG;
+
+/**************************************************************/
+extern void InitializeBattleLog(BATTLE_LOG *log, uint64_t seed, int room, const SPECTRA *spectra, int nAllies, int nBattlers);
+extern void DestroyBattleLog(BATTLE_LOG *log);
+extern void LogEvent(BATTLE_LOG *log, BATTLE_EVENT_TYPE type, int a, int b, int c, int value);
+
+/**************************************************************/
+extern bool SaveBattleLog(const BATTLE_LOG *log, const char *filename);
+extern bool LoadBattleLog(BATTLE_LOG *log, const char *filename);
+extern void ExportBattleLog(const BATTLE_LOG *log, FILE *file);
+
+/**************************************************************/
+#endif // _BATTLE_LOG_H_
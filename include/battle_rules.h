@@ -0,0 +1,45 @@
+/**********************************************************//**
+ * @file battle_rules.h
+ * @brief The rules of battle: hit and critical hit rates,
+ * damage, turn order and status ailments. These don't draw
+ * or print anything, so tools can share them with the game.
+ * @author Rena Shinomiya
+ * @date June 4, 2018
+ **************************************************************/
+
+#ifndef _BATTLE_RULES_H_
+#define _BATTLE_RULES_H_
+
+#include <stdbool.h>            // bool
+
+#include "species.h"            // AILMENT_ID
+#include "technique.h"          // TECHNIQUE
+#include "battler.h"            // BATTLER
+
+/**********************************************************//**
+ * @enum ROUND_EFFECT
+ * @brief What a status ailment did to a battler at the end
+ * of a round.
+ **************************************************************/
+typedef enum {
+    ROUND_NO_EFFECT,            ///< Nothing happened.
+    ROUND_WOKE_UP,              ///< The battler woke up.
+    ROUND_POISON,               ///< The battler took poison damage.
+    ROUND_FIRE,                 ///< The battler took fire damage.
+} ROUND_EFFECT;
+
+/**************************************************************/
+extern float HitRate(const BATTLER *user, const BATTLER *target, bool allied, const TECHNIQUE *technique);
+extern float CriticalHitRate(const BATTLER *user, const BATTLER *target);
+extern int TechniqueDamage(const BATTLER *user, const BATTLER *target, const TECHNIQUE *technique);
+extern int InflictDamage(BATTLER *battler, int damage);
+extern int Priority(const BATTLER *battler);
+extern int UsableTechniques(const BATTLER *battler, TECHNIQUE_ID *techniques);
+extern TECHNIQUE_ID RandomTechnique(const BATTLER *battler);
+
+/**************************************************************/
+extern AILMENT_ID BlockingAilment(BATTLER *user);
+extern ROUND_EFFECT ApplyRoundAilment(BATTLER *battler, int *damage);
+
+/**************************************************************/
+#endif // _BATTLE_RULES_H_
@@ -10,6 +10,7 @@
 
 #include <stddef.h>             // NULL
 #include <stdbool.h>            // bool
+#include <string.h>             // memset
 
 #include "species.h"            // SPECIES, SPECTRA
 
@@ -29,10 +30,11 @@ typedef enum {
 /**********************************************************//**
  * @struct BATTLER
  * @brief Defines battle-level information for a spectra
- * participating in the battle.
+ * participating in the battle. The battler holds its own copy
+ * of the spectra, so battlers can be copied freely.
  **************************************************************/
 typedef struct {
-    SPECTRA *Spectra;           ///< Pointer to the spectra, or NULL.
+    SPECTRA Spectra;            ///< The spectra, or Species 0 if none.
     BATTLER_FLAGS Flags;        ///< Battler information.
     int AttackBoost;            ///< Change to apply to attack stat.
     int DefendBoost;            ///< Change to apply to defend stat.
@@ -47,7 +49,7 @@ typedef struct {
  * @return True if the BATTLER is a valid battler.
  **************************************************************/
 static inline bool BattlerIsActive(const BATTLER *battler) {
-    return battler->Spectra != NULL;
+    return battler->Spectra.Species != 0;
 }
 /**********************************************************//**
  * @brief Determines if the battler is active and alive.
@@ -55,7 +57,7 @@ static inline bool BattlerIsActive(const BATTLER *battler) {
  * @return True if the battler is alive.
  **************************************************************/
 static inline bool BattlerIsAlive(const BATTLER *battler) {
-    return battler->Spectra && battler->Spectra->Health > 0;
+    return battler->Spectra.Species && battler->Spectra.Health > 0;
 }
 
 /**********************************************************//**
@@ -64,7 +66,7 @@ static inline bool BattlerIsAlive(const BATTLER *battler) {
  * @return The BATTLER's species.
  **************************************************************/
 static inline const SPECIES *BattlerSpecies(const BATTLER *battler) {
-    return SpeciesByID(battler->Spectra->Species);
+    return SpeciesByID(battler->Spectra.Species);
 }
 
 /**********************************************************//**
@@ -79,10 +81,15 @@ static inline const char *BattlerName(const BATTLER *battler) {
 /**********************************************************//**
  * @brief Set up a BATTLER for a SPECTRA.
  * @param battler: BATTLER to set up.
- * @param spectra: SPECTRA that's joining the battle.
+ * @param spectra: SPECTRA that's joining the battle, which
+ * is copied into the battler, or NULL.
  **************************************************************/
-static inline void InitializeBattler(BATTLER *battler, SPECTRA *spectra) {
-    battler->Spectra = spectra;
+static inline void InitializeBattler(BATTLER *battler, const SPECTRA *spectra) {
+    if (spectra) {
+        battler->Spectra = *spectra;
+    } else {
+        memset(&battler->Spectra, 0, sizeof(SPECTRA));
+    }
     battler->Flags = 0;
     battler->AttackBoost = 0;
     battler->DefendBoost = 0;
@@ -105,7 +112,7 @@ static inline void InitializeBattlerAsInactive(BATTLER *battler) {
  * @return The battler's current health.
  **************************************************************/
 static inline int BattlerHealth(const BATTLER *battler) {
-    return battler->Spectra->Health;
+    return battler->Spectra.Health;
 }
 
 /**********************************************************//**
@@ -114,7 +121,7 @@ static inline int BattlerHealth(const BATTLER *battler) {
  * @return The battler's current power.
  **************************************************************/
 static inline int BattlerPower(const BATTLER *battler) {
-    return battler->Spectra->Power;
+    return battler->Spectra.Power;
 }
 
 /**********************************************************//**
@@ -123,7 +130,7 @@ static inline int BattlerPower(const BATTLER *battler) {
  * @return The battler's maximum health.
  **************************************************************/
 static inline int BattlerMaxHealth(const BATTLER *battler) {
-    return battler->Spectra->MaxHealth;
+    return battler->Spectra.MaxHealth;
 }
 
 /**********************************************************//**
@@ -132,7 +139,7 @@ static inline int BattlerMaxHealth(const BATTLER *battler) {
  * @return The battler's maximum power.
  **************************************************************/
 static inline int BattlerMaxPower(const BATTLER *battler) {
-    return battler->Spectra->MaxPower;
+    return battler->Spectra.MaxPower;
 }
 
 /**************************************************************/
@@ -0,0 +1,92 @@
+/**********************************************************//**
+ * @file damage.h
+ * @brief Lookup tables and a batched kernel for the damage
+ * formula. The tables hold exactly the values the formulas
+ * would compute, so damage comes out the same either way.
+ * @author Rena Shinomiya
+ * @date June 9, 2018
+ **************************************************************/
+
+#ifndef _DAMAGE_H_
+#define _DAMAGE_H_
+
+#include <stdbool.h>            // bool
+
+#include "type.h"               // TYPE_ID, N_TYPE
+#include "species.h"            // SPECIES_ID, N_SPECIES, LEVEL_MAX
+#include "technique.h"          // TECHNIQUE
+#include "battler.h"            // BATTLER, BOOST_MAX
+
+/**************************************************************/
+/// @brief Most damage calculations one batch can hold.
+#define DAMAGE_BATCH_SIZE 128
+
+/**********************************************************//**
+ * @struct DAMAGE_BATCH
+ * @brief Many damage calculations laid out one array per
+ * input, so ComputeDamageBatch runs the same arithmetic down
+ * each column and the compiler can vectorize it.
+ **************************************************************/
+typedef struct {
+    int Count;                          ///< Number of calculations.
+    int Attack[DAMAGE_BATCH_SIZE];      ///< Boosted attack of each user.
+    int Defend[DAMAGE_BATCH_SIZE];      ///< Boosted defend of each target.
+    int Level[DAMAGE_BATCH_SIZE];       ///< Level of each user.
+    int Power[DAMAGE_BATCH_SIZE];       ///< Power of each technique.
+    float Matchup[DAMAGE_BATCH_SIZE];   ///< Type matchup against each target.
+    int Damage[DAMAGE_BATCH_SIZE];      ///< Filled in by ComputeDamageBatch.
+} DAMAGE_BATCH;
+
+/**************************************************************/
+/// @brief Stat multiplier for each boost, offset by BOOST_MAX.
+extern float BoostScaleTable[2*BOOST_MAX+1];
+
+/// @brief Combined matchup of each technique type against
+/// both of each species' types.
+extern float SpeciesMatchupTable[N_TYPE][N_SPECIES];
+
+/**************************************************************/
+extern void InitializeDamageTables(void);
+extern bool AddDamageBatch(DAMAGE_BATCH *batch, const BATTLER *user, const BATTLER *target, const TECHNIQUE *technique);
+extern void ComputeDamageBatch(DAMAGE_BATCH *batch);
+
+/**********************************************************//**
+ * @brief Gets the multiplication factor for a base stat,
+ * given a certain boost level.
+ * @param boost: Levels of boosting to apply.
+ * @return Factor to multiply a stat by.
+ **************************************************************/
+static inline float BoostScale(int boost) {
+    return BoostScaleTable[boost+BOOST_MAX];
+}
+
+/**********************************************************//**
+ * @brief Gets how effective a type is against a species.
+ * @param type: The attacking type.
+ * @param species: The defending species.
+ * @return Multiplication factor of the matchup.
+ **************************************************************/
+static inline float SpeciesMatchup(TYPE_ID type, SPECIES_ID species) {
+    return SpeciesMatchupTable[type][species];
+}
+
+/**********************************************************//**
+ * @brief The damage formula, before any critical hit. Both
+ * TechniqueDamage and ComputeDamageBatch go through here so
+ * they always agree.
+ * @param attack: User's boosted attack.
+ * @param defend: Target's boosted defend.
+ * @param level: User's level.
+ * @param power: Technique's power.
+ * @param matchup: Type matchup against the target.
+ * @return Damage dealt.
+ **************************************************************/
+static inline int DamageFormula(int attack, int defend, int level, int power, float matchup) {
+    float ratio = (float)attack/defend;
+    float scale = (float)level/LEVEL_MAX;
+    float base = (power>10)? (power-10)*scale+10: 10;
+    return 1 + base*ratio*matchup;
+}
+
+/**************************************************************/
+#endif // _DAMAGE_H_
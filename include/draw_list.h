@@ -0,0 +1,29 @@
+/**********************************************************//**
+ * @file draw_list.h
+ * @brief Records the windows, text and bars of the interface
+ * as they're drawn, then draws them together, grouped by
+ * texture, so a busy screen is only a few batches.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#ifndef _DRAW_LIST_H_
+#define _DRAW_LIST_H_
+
+#include <allegro5/allegro.h>   // ALLEGRO_BITMAP, ALLEGRO_COLOR
+#include <allegro5/allegro_font.h>
+
+/**************************************************************/
+/// @brief Number of commands the list starts with. It grows
+/// if a frame needs more.
+#define DRAW_LIST_SIZE 256
+
+/**************************************************************/
+extern void ListBitmap(ALLEGRO_BITMAP *bitmap, float x, float y, int flags);
+extern void ListRectangle(float x0, float y0, float x1, float y1, ALLEGRO_COLOR color);
+extern void ListText(const ALLEGRO_FONT *font, ALLEGRO_COLOR color, float x, float y, int flags, const char *text, int length);
+extern void FlushDrawList(void);
+extern void DestroyDrawList(void);
+
+/**************************************************************/
+#endif // _DRAW_LIST_H_
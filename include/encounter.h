@@ -0,0 +1,27 @@
+/**********************************************************//**
+ * @file encounter.h
+ * @brief Precomputed tables for rolling random encounters.
+ * @author Rena Shinomiya
+ * @date May 31, 2018
+ **************************************************************/
+
+#ifndef _ENCOUNTER_H_
+#define _ENCOUNTER_H_
+
+#include <stdbool.h>            // bool
+
+#include "location.h"           // LOCATION_ID, ENCOUNTER
+
+/**************************************************************/
+extern bool InitializeEncounters(void);
+extern void DestroyEncounters(void);
+
+/**************************************************************/
+extern float EncounterChance(ENCOUNTER_RATE rate);
+extern float ZoneEncounterChance(LOCATION_ID id, int zone);
+extern const ENCOUNTER *ZoneEncounter(LOCATION_ID id, int zone);
+extern const ENCOUNTER *OverworldEncounter(LOCATION_ID id);
+extern const ENCOUNTER *FishingEncounter(LOCATION_ID id);
+
+/**************************************************************/
+#endif // _ENCOUNTER_H_
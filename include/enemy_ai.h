@@ -0,0 +1,25 @@
+/**********************************************************//**
+ * @file enemy_ai.h
+ * @brief Search-based AI for boss battles. While the player
+ * picks their turns, a worker thread plays out each choice
+ * the enemies could make many times over and keeps score.
+ * @author Rena Shinomiya
+ * @date June 6, 2018
+ **************************************************************/
+
+#ifndef _ENEMY_AI_H_
+#define _ENEMY_AI_H_
+
+#include "battle_engine.h"      // BATTLE_CONTEXT
+
+/**************************************************************/
+/// @brief Thinking time used when a boss doesn't give one.
+#define AI_DEFAULT_BUDGET 100
+
+/**************************************************************/
+extern void StartEnemyAI(const BATTLE_CONTEXT *context, int budget);
+extern void StopEnemyAI(void);
+extern void FinishEnemyAI(BATTLE_CONTEXT *context);
+
+/**************************************************************/
+#endif // _ENEMY_AI_H_
@@ -18,6 +18,7 @@
 #define TEXT(text) {EVENT_TEXT, {.Text=text}}
 #define SHOP(person, direction, speech, shop) {EVENT_PERSON, {.Person={person, direction, PERSON_SHOP, speech, shop}}}
 #define BOSS(spectra, level) {EVENT_BOSS, {.Boss={{{spectra, level}}}}}
+#define SMART_BOSS(spectra, level, budget) {EVENT_BOSS, {.Boss={{{spectra, level}}, AI_SEARCH, budget}}}
 #define REDIRECT(event) {EVENT_REDIRECT, {.Redirect=event}}
 #define UNDEFINED {0}
 #define HOUSE TEXT("You can't go in other people's houses!")
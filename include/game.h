@@ -36,6 +36,10 @@ typedef enum {
     KEY_DENY        = ALLEGRO_KEY_V,
 #ifdef DEBUG
     KEY_DEBUG       = ALLEGRO_KEY_D,
+    KEY_REPLAY      = ALLEGRO_KEY_R,
+    KEY_QUICKSAVE   = ALLEGRO_KEY_F5,
+    KEY_QUICKLOAD   = ALLEGRO_KEY_F9,
+    KEY_REWIND      = ALLEGRO_KEY_BACKSPACE,
 #endif
 } KEY;
 
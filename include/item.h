@@ -8,6 +8,8 @@
 #ifndef _ITEM_H_
 #define _ITEM_H_
 
+#include <stdbool.h>            // bool
+
 #include "effect.h"             // EFFECT_ID
 
 /**********************************************************//**
@@ -85,6 +87,7 @@ typedef struct {
 
 /**************************************************************/
 extern const ITEM *ItemByID(ITEM_ID id);
+extern bool IsItem(ITEM_ID id);
 
 /**************************************************************/
 #endif // _ITEM_H_
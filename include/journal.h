@@ -0,0 +1,75 @@
+/**********************************************************//**
+ * @file journal.h
+ * @brief Keeps a journal of changes to the player's progress
+ * since the last save, so it can be recovered after a crash.
+ * The journal is written a little at a time on its own
+ * thread, and is folded into the save file by saving the game
+ * every so often.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#ifndef _JOURNAL_H_
+#define _JOURNAL_H_
+
+#include <stdbool.h>            // bool
+
+#include "species.h"            // SPECTRA
+
+/**************************************************************/
+/// @brief Path of the journal, next to the save file.
+#define JOURNAL_FILE "spectrum.journal"
+
+/// @brief Seconds between writes to the journal.
+#define JOURNAL_FLUSH 2.0
+
+/// @brief Bytes of journal since the last save that start an
+/// autosave.
+#define JOURNAL_COMPACT_SIZE (16<<10)
+
+/// @brief Seconds since the last save that start an autosave,
+/// if anything has been journaled.
+#define JOURNAL_COMPACT_TIME 300.0
+
+/**********************************************************//**
+ * @enum JOURNAL_KIND
+ * @brief Kinds of changes kept in the journal.
+ **************************************************************/
+typedef enum {
+    JOURNAL_BASE,               ///< Slot and checksum of the save that follows.
+    JOURNAL_GET_ITEM,           ///< An item was obtained.
+    JOURNAL_DROP_ITEM,          ///< An item was used up or dropped.
+    JOURNAL_GET_SPECTRA,        ///< A spectra joined the party or storage.
+    JOURNAL_RELEASE_SPECTRA,    ///< A spectra in the party was released.
+    JOURNAL_DEPOSIT_SPECTRA,    ///< A spectra in the party was stored.
+    JOURNAL_WITHDRAW_SPECTRA,   ///< A stored spectra joined the party.
+    JOURNAL_SWITCH,             ///< A switch was set.
+    JOURNAL_WARP,               ///< The player warped.
+    JOURNAL_PARTY,              ///< The party changed after a battle or swap.
+    JOURNAL_MONEY,              ///< The player's money changed.
+    JOURNAL_PLAYER,             ///< All of the player's data, after a snapshot or hospital.
+} JOURNAL_KIND;
+
+/// The number of unique JOURNAL_KIND members.
+#define N_JOURNAL_KIND (JOURNAL_PLAYER+1)
+
+/**************************************************************/
+extern void Journal(JOURNAL_KIND kind, int value);
+extern void JournalSpectra(JOURNAL_KIND kind, const SPECTRA *spectra);
+extern void JournalSwitch(int id, int value);
+extern void JournalWarp(void);
+extern void JournalParty(void);
+extern void JournalPlayer(void);
+
+/**************************************************************/
+extern int JournalSlot(void);
+extern void RecoverJournal(unsigned long checksum, int slot);
+extern void ResetJournal(unsigned long checksum, int slot);
+extern void BeginJournal(unsigned long checksum, int slot);
+extern void CompactJournal(unsigned long checksum);
+extern void StopJournal(void);
+extern void UpdateJournal(void);
+extern void DestroyJournal(void);
+
+/**************************************************************/
+#endif // _JOURNAL_H_
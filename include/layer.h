@@ -0,0 +1,37 @@
+/**********************************************************//**
+ * @file layer.h
+ * @brief Draws large map images in culled chunks.
+ * @author Rena Shinomiya
+ * @date June 1, 2018
+ **************************************************************/
+
+#ifndef _LAYER_H_
+#define _LAYER_H_
+
+#include <stdbool.h>            // bool
+#include <allegro5/allegro.h>   // ALLEGRO_BITMAP
+
+/**************************************************************/
+/// @brief Width and height of one chunk in pixels.
+#define LAYER_CHUNK 128
+
+/**********************************************************//**
+ * @struct LAYER
+ * @brief A map image split into square chunks. Only chunks
+ * that are on screen and have something drawn in them are
+ * ever blitted.
+ **************************************************************/
+typedef struct {
+    ALLEGRO_BITMAP *Image;      ///< The whole layer image, or NULL.
+    int Columns;                ///< Number of chunks across.
+    int Rows;                   ///< Number of chunks down.
+    bool *Filled;               ///< Set for chunks with any visible pixel.
+} LAYER;
+
+/**************************************************************/
+extern bool InitializeLayer(LAYER *layer, ALLEGRO_BITMAP *image, bool sparse);
+extern void DestroyLayer(LAYER *layer);
+extern void DrawLayer(const LAYER *layer, int left, int top);
+
+/**************************************************************/
+#endif // _LAYER_H_
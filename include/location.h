@@ -225,6 +225,16 @@ typedef enum {
     COMMON,
 } ENCOUNTER_RATE;
 
+/**********************************************************//**
+ * @struct ENCOUNTER_ZONE
+ * @brief Encounter settings for one zone painted into a
+ * map's sensor, such as tall grass or deep water.
+ **************************************************************/
+typedef struct {
+    ENCOUNTER_RATE Rate;            ///< Likelihood of finding enemies.
+    const ENCOUNTER *Encounters;    ///< SPECIES encounters, ending with a 0 Chance.
+} ENCOUNTER_ZONE;
+
 /**********************************************************//**
  * @struct LOCATION
  * @brief Stores all information for a LOCATION.
@@ -234,11 +244,17 @@ typedef struct {
     MAP_ID Map;                     ///< Map to display for the location.
     COORDINATE Bounds[2];           ///< Bounding box for the location.
     BACKGROUND_ID Background;       ///< Battle background used.
-    ENCOUNTER *Encounters;          ///< Overworld SPECIES encounters.
-    ENCOUNTER *Fishing;             ///< Fishing SPECIES encounters.
+    ENCOUNTER *Encounters;          ///< Overworld SPECIES encounters, ending with a 0 Chance.
+    ENCOUNTER *Fishing;             ///< Fishing SPECIES encounters, ending with a 0 Chance.
     ENCOUNTER_RATE EncounterRate;   ///< Likelihood of finding enemies.
+    const ENCOUNTER_ZONE *Zones;    ///< Zones 1, 2, ... ending with a NULL Encounters.
+    int TeamSize;                   ///< Most enemies met at once, or 0 for TEAM_SIZE.
 } LOCATION;
 
+/// @brief Number of events that can be buffered in the
+/// RuntimeMapTiles cache.
+#define N_RUNTIME_EVENT 256
+
 /**************************************************************/
 extern const LOCATION *Location(LOCATION_ID id);
 extern void InitializeLocation(void);
@@ -246,6 +262,9 @@ extern void InitializeLocation(void);
 /**************************************************************/
 extern void Warp(LOCATION_ID id, int x, int y, DIRECTION direction);
 extern void WarpToLastHospital(void);
+extern bool StartAutoWalk(LOCATION_ID destination);
+extern void StopAutoWalk(void);
+extern int EncounterZone(void);
 
 /**************************************************************/
 extern bool UseMapItem(ITEM_ID id);
@@ -29,11 +29,13 @@ const LOCATION LOCATION_DATA[] = {
             {19, SSSNAKE,       { 3,  6}},
             { 5, HOCUS,         { 5,  5}},
             { 1, JAYRAPTOR,     {12, 12}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {90, CATFISH,       { 4,  8}},
             { 9, CATFISH,       { 8, 15}},
-            { 1, NESSIE,        {10, 10}}
+            { 1, NESSIE,        {10, 10}},
+            {0},
         },
         .EncounterRate  = COMMON,
     },
@@ -47,11 +49,13 @@ const LOCATION LOCATION_DATA[] = {
             {50, JAYRAPTOR,     { 4,  6}},
             {25, SSSNAKE,       { 2,  5}},
             {25, FLOPJELLY,     { 2,  5}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {90, CATFISH,       { 4,  8}},
             { 9, CATFISH,       { 8, 15}},
             { 1, NESSIE,        {10, 10}},
+            {0},
         },
         .EncounterRate  = RARE,
     },
@@ -88,9 +92,19 @@ const LOCATION LOCATION_DATA[] = {
         .Encounters     = (ENCOUNTER[]){
             {99, SSSNAKE,       { 4,  6}},
             { 1, SPACESNAKE,    { 8,  8}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = RARE,
+        .Zones          = (ENCOUNTER_ZONE[]){
+            // 1: The overgrown beds in the west
+            {UNCOMMON, (ENCOUNTER[]){
+                {90, SSSNAKE,       { 5,  7}},
+                {10, SPACESNAKE,    { 8,  9}},
+                {0},
+            }},
+            {0},
+        },
     },
 
     [SAPLING_LABORATORY] = {
@@ -109,6 +123,7 @@ const LOCATION LOCATION_DATA[] = {
             {25, FLOPJELLY,     { 5,  6}},
             {20, SSSNAKE,       { 5,  6}},
             { 5, HOCUS,         { 6,  6}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -125,12 +140,14 @@ const LOCATION LOCATION_DATA[] = {
             {50, JAYRAPTOR,     { 7,  9}},
             {49, FLOPJELLY,     { 5,  8}},
             { 1, GASMOG,        { 5,  8}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {60, CATFISH,       { 5,  8}},
             {30, GARPIKE,       { 7,  9}},
             { 9, GARPIKE,       {10, 16}},
             { 1, MINESPHERE,    {11, 11}},
+            {0},
         },
         .EncounterRate  = RARE,
     },
@@ -164,12 +181,14 @@ const LOCATION LOCATION_DATA[] = {
             {40, JAYRAPTOR,     { 9, 12}},
             {30, FLOPJELLY,     { 8, 12}},
             {30, NITROBOMB,     { 8, 12}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {50, CATFISH,       { 8, 12}},
             {40, GARPIKE,       { 9, 15}},
             { 9, COALSHARK,     {12, 16}},
             { 1, MINESPHERE,    {17, 17}},
+            {0},
         },
         .EncounterRate  = UNCOMMON,
     },
@@ -185,9 +204,11 @@ const LOCATION LOCATION_DATA[] = {
             {20, NITROBOMB,     { 8, 12}},
             { 9, BUTCHERBIRD,   {15, 15}},
             { 1, PUZZLE,        {12, 12}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = UNCOMMON,
+        .TeamSize       = 5,
     },
 
     [OXIDE_CAVE] = {
@@ -201,6 +222,7 @@ const LOCATION LOCATION_DATA[] = {
             {20, BUTCHERBIRD,   {11, 16}},
             { 9, MEGATAR,       {16, 18}},
             { 1, PUZZLE,        {16, 16}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -218,11 +240,13 @@ const LOCATION LOCATION_DATA[] = {
             {40, GASMOG,        { 8, 13}},
             {19, LEKTRON,       { 5, 12}},
             { 1, CUMULUS,       {12, 12}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {50, CATFISH,       { 8, 12}},
             {49, GARPIKE,       { 9, 15}},
             { 1, MINESPHERE,    {17, 17}},
+            {0},
         },
         .EncounterRate  = RARE,
     },
@@ -263,11 +287,13 @@ const LOCATION LOCATION_DATA[] = {
             { 5, CUMULUS,       {10, 18}},
             { 4, VOLTDRAGON,    {15, 21}},
             { 1, LAUNCHPAD,     {21, 22}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {50, CATFISH,       {10, 18}},
             {30, GARPIKE,       {12, 18}},
             {20, TOOLFISH,      {14, 16}},
+            {0},
         },
         .EncounterRate  = COMMON,
     },
@@ -284,6 +310,7 @@ const LOCATION LOCATION_DATA[] = {
             { 5, CUMULUS,       {10, 18}},
             { 4, VOLTDRAGON,    {15, 21}},
             { 1, LAUNCHPAD,     {21, 22}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {30, CATFISH,       {10, 18}},
@@ -293,6 +320,7 @@ const LOCATION LOCATION_DATA[] = {
             { 5, MINESPHERE,    {20, 20}},
             { 4, COALSHARK,     {18, 18}},
             { 1, CATFISH,       {30, 30}},
+            {0},
         },
         .EncounterRate  = RARE,
     },
@@ -307,6 +335,7 @@ const LOCATION LOCATION_DATA[] = {
         .Encounters     = (ENCOUNTER[]){
             {90, LEKTRON,       {12, 20}},
             {10, VOLTDRAGON,    {16, 20}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = RARE,
@@ -320,6 +349,7 @@ const LOCATION LOCATION_DATA[] = {
         .Encounters     = (ENCOUNTER[]){
             {70, LEKTRON,       {16, 20}},
             {30, VOLTDRAGON,    {16, 20}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = RARE,
@@ -333,6 +363,7 @@ const LOCATION LOCATION_DATA[] = {
         .Encounters     = (ENCOUNTER[]){
             {50, LEKTRON,       {18, 22}},
             {50, VOLTDRAGON,    {18, 22}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = RARE,
@@ -346,6 +377,7 @@ const LOCATION LOCATION_DATA[] = {
         .Encounters     = (ENCOUNTER[]){
             {95, LEKTRON,       {26, 34}},
             { 5, PRGMERROR,     {20, 20}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -362,11 +394,13 @@ const LOCATION LOCATION_DATA[] = {
             {50, JAYRAPTOR,     {10, 18}},
             {30, LEKTRON,       { 8, 16}},
             {20, CUMULUS,       {10, 18}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {50, CATFISH,       {10, 18}},
             {30, GARPIKE,       {12, 18}},
             {20, TOOLFISH,      {14, 16}},
+            {0},
         },
         .EncounterRate  = COMMON,
     },
@@ -383,6 +417,7 @@ const LOCATION LOCATION_DATA[] = {
             { 5, PUZZLE,        {16, 19}},
             { 4, ICEBOULDER,    {18, 20}},
             { 1, BUTCHERBIRD,   {28, 28}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -402,12 +437,14 @@ const LOCATION LOCATION_DATA[] = {
             { 9, CUMULUS,       {18, 24}},
             { 1, TOTEM_POLE,    {27, 27}},
             { 1, JAYRAPTOR,     {30, 30}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {50, CATFISH,       {18, 24}},
             {30, BASSMONSTER,   {20, 25}},
             {19, ACISTAR,       {22, 26}},
             { 1, ACISTAR,       {27, 32}},
+            {0},
         },
         .EncounterRate  = COMMON,
     },
@@ -429,8 +466,10 @@ const LOCATION LOCATION_DATA[] = {
             {30, BASSMONSTER,   {18, 22}},
             { 9, ACISTAR,       {20, 24}},
             { 1, ICEBOULDER,    {22, 22}},
+            {0},
         },
-        .Fishing        = NULL,        .EncounterRate  = COMMON,
+        .Fishing        = NULL,
+        .EncounterRate  = COMMON,
     },
 
     [FALLS_CAVE_B1F] = {
@@ -447,6 +486,7 @@ const LOCATION LOCATION_DATA[] = {
             { 5, ICEBOULDER,    {23, 26}},
             { 4, MOATMONSTER,   {30, 34}},
             { 1, GIGACLAM,      {36, 36}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -463,6 +503,7 @@ const LOCATION LOCATION_DATA[] = {
             {40, JAYRAPTOR,     {19, 27}},
             {40, WATERWING,     {20, 24}},
             {20, CUMULUS,       {18, 24}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {30, CATFISH,       {18, 24}},
@@ -470,6 +511,7 @@ const LOCATION LOCATION_DATA[] = {
             {20, BASSMONSTER,   {20, 25}},
             {19, ACISTAR,       {22, 26}},
             { 1, NESSIE,        {32, 32}},
+            {0},
         },
         .EncounterRate  = RARE,
     },
@@ -499,6 +541,7 @@ const LOCATION LOCATION_DATA[] = {
             {20, DACTYLUS,      {24, 28}},
             { 5, TARHEAP,       {26, 32}},
             { 5, MEGATAR,       {28, 32}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -518,6 +561,7 @@ const LOCATION LOCATION_DATA[] = {
             { 5, PUZZLE,        {28, 32}},
             { 4, BUTCHERBIRD,   {30, 36}},
             { 1, GOLDDRAGON,    {40, 40}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -534,12 +578,14 @@ const LOCATION LOCATION_DATA[] = {
             {50, JAYRAPTOR,     {24, 29}},
             {30, FLOPJELLY,     {22, 28}},
             {20, TELEVIRUS,     {22, 28}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {50, CATFISH,       {22, 28}},
             {30, BASSMONSTER,   {22, 30}},
             {19, ACISTAR,       {27, 32}},
             { 1, CATFISH,       {29, 38}},
+            {0},
         },
         .EncounterRate  = UNCOMMON,
     },
@@ -554,6 +600,7 @@ const LOCATION LOCATION_DATA[] = {
             {30, GASMOG,        {22, 28}},
             {20, VACUUM,        {24, 28}},
             {10, FOGFANG,       {26, 32}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = RARE,
@@ -570,6 +617,7 @@ const LOCATION LOCATION_DATA[] = {
             {20, NITROBOMB,     {26, 32}},
             { 9, VACUUM,        {30, 36}},
             { 1, SPACESNAKE,    {28, 36}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = RARE,
@@ -678,6 +726,7 @@ const LOCATION LOCATION_DATA[] = {
             {70, NITROBOMB,     {65, 70}},
             {20, LEKTRON,       {48, 54}},
             {10, GASMOG,        {48, 54}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -692,6 +741,7 @@ const LOCATION LOCATION_DATA[] = {
             {70, NITROBOMB,     {45, 50}},
             {20, LEKTRON,       {48, 54}},
             {10, ASTEROID,      {58, 64}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -705,6 +755,7 @@ const LOCATION LOCATION_DATA[] = {
         .Encounters     = (ENCOUNTER[]){
             {70, NITROBOMB,     {50, 55}},
             {30, ASTEROID,      {58, 64}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -719,6 +770,7 @@ const LOCATION LOCATION_DATA[] = {
             {50, NITROBOMB,     {55, 60}},
             {30, ASTEROID,      {58, 64}},
             {20, SPACESNAKE,    {58, 64}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -732,6 +784,7 @@ const LOCATION LOCATION_DATA[] = {
         .Encounters     = (ENCOUNTER[]){
             {50, ASTEROID,      {60, 65}},
             {50, SPACESNAKE,    {58, 64}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -748,6 +801,7 @@ const LOCATION LOCATION_DATA[] = {
             {20, TARHEAP,       {48, 54}},
             { 9, MOATMONSTER,   {48, 54}},
             { 1, PRGMERROR,     {70, 70}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -766,6 +820,7 @@ const LOCATION LOCATION_DATA[] = {
             {20, SPACESNAKE,    {30, 34}},
             {10, PUZZLE,        {30, 36}},
             {10, PHOENIX,       {32, 36}},
+            {0},
         },
         .Fishing        = NULL,
         .EncounterRate  = COMMON,
@@ -785,6 +840,7 @@ const LOCATION LOCATION_DATA[] = {
             { 1, GLACIALITH,    {54, 64}},
             { 1, BRONTO,        {54, 64}},
             { 1, MOATMONSTER,   {54, 64}},
+            {0},
         },
         .Fishing        = (ENCOUNTER[]){
             {30, GARPIKE,       {44, 54}},
@@ -794,6 +850,7 @@ const LOCATION LOCATION_DATA[] = {
             { 9, MOATMONSTER,   {44, 54}},
             { 1, CATFISH,       {70, 80}},
             { 1, COALSHARK,     {54, 64}},
+            {0},
         },
         .EncounterRate  = COMMON,
     },
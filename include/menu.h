@@ -12,6 +12,7 @@
 #include "game.h"               // KEY
 #include "species.h"            // SPECTRA
 #include "item.h"               // ITEM_ID
+#include "storage.h"            // STORAGE_VIEW
 
 /**********************************************************//**
  * @enum WINDOW_ID
@@ -126,6 +127,9 @@ extern void UpdateControl(CONTROL *control);
 /// @brief The most options a menu can have.
 #define MENU_MAX_OPTION 32
 
+/// @brief Rows of the storage box shown at once.
+#define STORAGE_ROWS 8
+
 /**********************************************************//**
  * @struct MENU
  * @brief Contains text for displaying choices on a menu.
@@ -202,10 +206,14 @@ extern void DrawItemDisplay(ITEM_ID id);
 extern void DrawOutput(void);
 extern void DrawPlayerDisplay(void);
 extern void DrawPopupBar(const char *text);
+extern void DestroyPanels(void);
 
 /**************************************************************/
 extern void DrawParty(void);
 extern void DrawItems(void);
+extern void DrawStorage(const STORAGE_VIEW *view, const CONTROL *control);
+extern void DrawSaveSlots(const CONTROL *control);
+extern void DrawSaveSlot(int slot);
 extern CONTROL *PartyControl(void);
 extern CONTROL *ItemsControl(void);
 
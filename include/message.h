@@ -0,0 +1,78 @@
+/**********************************************************//**
+ * @file message.h
+ * @brief Lists the game's message templates. Messages are
+ * queued as a template and its arguments, and only formatted
+ * once they're shown, so code that runs without a screen
+ * never formats text. Every piece of text lives in message.i,
+ * ready to be translated.
+ * @author Rena Shinomiya
+ * @date June 10, 2018
+ **************************************************************/
+
+#ifndef _MESSAGE_H_
+#define _MESSAGE_H_
+
+/**********************************************************//**
+ * @enum MESSAGE_ID
+ * @brief Defines a constant for each message template (0 is
+ * invalid). Templates take printf-style %s, %d and %f
+ * arguments.
+ **************************************************************/
+typedef enum {
+    MESSAGE_ESCAPE             = 1,
+    MESSAGE_ESCAPE_SUCCESS     = 2,
+    MESSAGE_ESCAPE_FAILURE     = 3,
+    MESSAGE_CAPTURE_SUCCESS    = 4,
+    MESSAGE_CAPTURE_NO_ROOM    = 5,
+    MESSAGE_CAPTURE_GOT_AWAY   = 6,
+    MESSAGE_CAPTURE_BROKE_FREE = 7,
+    MESSAGE_CAPTURE_FAILURE    = 8,
+    MESSAGE_BLOCKED_SHOCKED    = 9,
+    MESSAGE_BLOCKED_BURIED     = 10,
+    MESSAGE_BLOCKED_ASLEEP     = 11,
+    MESSAGE_NO_POWER           = 12,
+    MESSAGE_AVOIDED            = 13,
+    MESSAGE_CRITICAL_HIT       = 14,
+    MESSAGE_DAMAGE             = 15,
+    MESSAGE_PASSED_OUT         = 16,
+    MESSAGE_NO_DAMAGE          = 17,
+    MESSAGE_NO_EFFECT          = 18,
+    MESSAGE_NOT_USEFUL         = 19,
+    MESSAGE_NO_TARGET          = 20,
+    MESSAGE_WOKE_UP            = 21,
+    MESSAGE_POISON_DAMAGE      = 22,
+    MESSAGE_FIRE_DAMAGE        = 23,
+    MESSAGE_LOSE               = 24,
+    MESSAGE_WIN                = 25,
+    MESSAGE_POISONED           = 26,
+    MESSAGE_SHOCKED            = 27,
+    MESSAGE_BURIED             = 28,
+    MESSAGE_FELL_ASLEEP        = 29,
+    MESSAGE_SET_ON_FIRE        = 30,
+    MESSAGE_CURED_POISON       = 31,
+    MESSAGE_CURED_SHOCK        = 32,
+    MESSAGE_UNBURIED           = 33,
+    MESSAGE_EXTINGUISHED       = 34,
+    MESSAGE_HEALED             = 35,
+    MESSAGE_ATTACK_BOOST       = 36,
+    MESSAGE_DEFEND_BOOST       = 37,
+    MESSAGE_EVADE_BOOST        = 38,
+    MESSAGE_LUCK_BOOST         = 39,
+    MESSAGE_STATS_RESET        = 40,
+    MESSAGE_DIED               = 41,
+    MESSAGE_DEFENDING          = 42,
+    MESSAGE_USED               = 43,
+    MESSAGE_EXPERIENCE         = 44,
+    MESSAGE_LEVEL_UP           = 45,
+    MESSAGE_LEVELS_UP          = 46,
+    MESSAGE_MONEY              = 47,
+} MESSAGE_ID;
+
+/// A size large enough to contain every MESSAGE_ID in an array.
+#define N_MESSAGE 48
+
+/**************************************************************/
+extern const char *MessageTemplate(MESSAGE_ID id);
+
+/**************************************************************/
+#endif // _MESSAGE_H_
@@ -0,0 +1,68 @@
+/**********************************************************//**
+ * @file message.i
+ * @brief Defines the text of every message template.
+ * @author Rena Shinomiya
+ * @date June 10, 2018
+ **************************************************************/
+
+#ifndef _MESSAGE_I_
+#define _MESSAGE_I_
+
+#include "message.h"            // MESSAGE_ID
+
+/**********************************************************//**
+ * @var MESSAGE_DATA
+ * @brief Holds the template for each MESSAGE_ID.
+ **************************************************************/
+static const char *const MESSAGE_DATA[N_MESSAGE] = {
+    [MESSAGE_ESCAPE]             = "The party tries to escape...",
+    [MESSAGE_ESCAPE_SUCCESS]     = "And succeeds!",
+    [MESSAGE_ESCAPE_FAILURE]     = "And fails...",
+    [MESSAGE_CAPTURE_SUCCESS]    = "The capture succeeded!",
+    [MESSAGE_CAPTURE_NO_ROOM]    = "You can't capture any more!",
+    [MESSAGE_CAPTURE_GOT_AWAY]   = "It just got away...",
+    [MESSAGE_CAPTURE_BROKE_FREE] = "It managed to break free!",
+    [MESSAGE_CAPTURE_FAILURE]    = "The capture failed!",
+    [MESSAGE_BLOCKED_SHOCKED]    = "%s can't move...",
+    [MESSAGE_BLOCKED_BURIED]     = "%s is buried in the ground...",
+    [MESSAGE_BLOCKED_ASLEEP]     = "%s is fast asleep...",
+    [MESSAGE_NO_POWER]           = "%s is out of power!",
+    [MESSAGE_AVOIDED]            = "%s avoided the attack!",
+    [MESSAGE_CRITICAL_HIT]       = "A critical hit on %s!",
+    [MESSAGE_DAMAGE]             = "%s took %d damage!",
+    [MESSAGE_PASSED_OUT]         = "%s passed out!",
+    [MESSAGE_NO_DAMAGE]          = "%s didn't take any damage!",
+    [MESSAGE_NO_EFFECT]          = "There was no effect...",
+    [MESSAGE_NOT_USEFUL]         = "That's not useful right now!",
+    [MESSAGE_NO_TARGET]          = "There was no target...",
+    [MESSAGE_WOKE_UP]            = "%s woke up!",
+    [MESSAGE_POISON_DAMAGE]      = "%s took %d damage from poison!",
+    [MESSAGE_FIRE_DAMAGE]        = "%s took %d damage from fire!",
+    [MESSAGE_LOSE]               = "You lost!",
+    [MESSAGE_WIN]                = "You won!",
+    [MESSAGE_POISONED]           = "%s was poisoned!",
+    [MESSAGE_SHOCKED]            = "%s was shocked!",
+    [MESSAGE_BURIED]             = "%s was buried in the ground!",
+    [MESSAGE_FELL_ASLEEP]        = "%s fell asleep!",
+    [MESSAGE_SET_ON_FIRE]        = "%s was set on fire!",
+    [MESSAGE_CURED_POISON]       = "%s is no longer poisoned!",
+    [MESSAGE_CURED_SHOCK]        = "%s is no longer shocked!",
+    [MESSAGE_UNBURIED]           = "%s was unburied!",
+    [MESSAGE_EXTINGUISHED]       = "%s was extinguished!",
+    [MESSAGE_HEALED]             = "%s healed by %d!",
+    [MESSAGE_ATTACK_BOOST]       = "%s's attack %s %s!",
+    [MESSAGE_DEFEND_BOOST]       = "%s's defend %s %s!",
+    [MESSAGE_EVADE_BOOST]        = "%s's evade %s %s!",
+    [MESSAGE_LUCK_BOOST]         = "%s's luck %s %s!",
+    [MESSAGE_STATS_RESET]        = "%s's stats went back to normal.",
+    [MESSAGE_DIED]               = "%s died!",
+    [MESSAGE_DEFENDING]          = "%s is defending.",
+    [MESSAGE_USED]               = "%s used %s!",
+    [MESSAGE_EXPERIENCE]         = "%s gained %d experience!",
+    [MESSAGE_LEVEL_UP]           = "%s's level went up!\n",
+    [MESSAGE_LEVELS_UP]          = "%s's level went up by %d!\n",
+    [MESSAGE_MONEY]              = "Gained $%.2f",
+};
+
+/**************************************************************/
+#endif // _MESSAGE_I_
@@ -11,13 +11,20 @@
 #include <stdio.h>              // snprintf
 #include <stdbool.h>            // bool
 
+#include "message.h"            // MESSAGE_ID
+
 /**************************************************************/
-/// @brief The size of an output message in characters.
+/// @brief Longest formatted message in characters. Plain
+/// text can be any length.
 #define MESSAGE_SIZE 255
 
-/// @brief The number of output messages that can be queued.
+/// @brief The number of output messages queued before the
+/// queue has to grow.
 #define LOG_SIZE 32
 
+/// @brief Most arguments one message template can take.
+#define MESSAGE_ARGUMENTS 4
+
 /**********************************************************//**
  * @brief Enqueues a new output message, with formatting.
  * @param format: printf-style format string for the output.
@@ -30,10 +37,13 @@
 }
 
 /**************************************************************/
+extern void MuteOutput(bool mute);
 extern void Output(const char *text);
+extern void OutputMessage(MESSAGE_ID message, ...);
 extern void OutputSplitByCR(const char *text);
 extern void UpdateOutput(void);
-extern const char *GetOutput(void);
+extern const char *GetOutput(int *length, int *typed);
+extern int OutputSerial(void);
 extern bool OutputDone(void);
 extern bool OutputWaiting(void);
 
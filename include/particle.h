@@ -0,0 +1,31 @@
+/**********************************************************//**
+ * @file particle.h
+ * @brief Particle effects shown when techniques are used in
+ * battle. Every particle lives in one fixed pool and they all
+ * draw together in a single call.
+ * @author Rena Shinomiya
+ * @date June 10, 2018
+ **************************************************************/
+
+#ifndef _PARTICLE_H_
+#define _PARTICLE_H_
+
+#include <stdbool.h>            // bool
+
+#include "type.h"               // TYPE_ID
+
+/**************************************************************/
+/// @brief Most particles on screen at once. Effects started
+/// while the pool is full just get fewer particles.
+#define PARTICLE_MAX 4096
+
+/**************************************************************/
+extern bool InitializeParticles(void);
+extern void DestroyParticles(void);
+extern void StartParticleEffect(TYPE_ID type, float x, float y);
+extern void ClearParticles(void);
+extern void UpdateParticles(float time);
+extern void DrawParticles(void);
+
+/**************************************************************/
+#endif // _PARTICLE_H_
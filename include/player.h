@@ -85,15 +85,23 @@ extern void DropItem(ITEM_ID id);
 extern bool InventoryFull(void);
 
 /**************************************************************/
+extern bool PartyFull(void);
 extern bool GetSpectra(const SPECTRA *spectra);
 extern void ReleaseSpectra(int index);
+extern bool DepositSpectra(int index);
+extern bool WithdrawSpectra(int entry);
 extern void RecoverParty(void);
 extern void RecoverPartyPower(void);
 
 /**************************************************************/
 extern void NewGame(void);
-extern bool LoadGame(void);
-extern bool SaveGame(void);
+extern bool LoadGame(int slot, bool recover);
+extern bool SaveGame(int slot);
+extern void StartSaveGame(int slot);
+extern bool SaveGameDone(bool *success);
+extern bool FinishSaveGame(void);
+extern void DestroySaveGame(void);
+extern int CurrentSaveSlot(void);
 
 /**************************************************************/
 extern void StartPlayTime(void);
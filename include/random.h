@@ -1,16 +1,41 @@
 /**********************************************************//**
  * @file random.h
- * @brief Basic pseudorandom number generator functions to
- * go on top of the stdlib rand() and RAND_MAX.
+ * @brief Basic pseudorandom number generator functions. Each
+ * thread has its own xorshift generator, so simulations can
+ * run in parallel without sharing the stdlib rand() state.
  * @author Rena Shinomiya
- * @version 1.0
+ * @version 1.1
  * @date January 2017
  **************************************************************/
 
 #ifndef _RANDOM_H_
 #define _RANDOM_H_
 
-#include <stdlib.h>             // rand, RAND_MAX
+#include <stdint.h>             // uint64_t
+
+/**************************************************************/
+/// @brief Generator state for the current thread. Zero means
+/// the thread hasn't been seeded yet.
+extern __thread uint64_t RandomState;
+
+/**************************************************************/
+extern void SeedRandom(uint64_t seed);
+extern void SeedRandomLazily(void);
+
+/**********************************************************//**
+ * @brief Generates the next raw 64-bit random number on the
+ * current thread (xorshift64*).
+ * @return A random number.
+ **************************************************************/
+static inline uint64_t RandomNext(void) {
+    if (!RandomState) {
+        SeedRandomLazily();
+    }
+    RandomState ^= RandomState >> 12;
+    RandomState ^= RandomState << 25;
+    RandomState ^= RandomState >> 27;
+    return RandomState*UINT64_C(2685821657736338717);
+}
 
 /**********************************************************//**
  * @brief Generate a random integer from a to b, inclusive.
@@ -19,7 +44,7 @@
  * @return A random integer.
  **************************************************************/
 static inline int randint(int a, int b) {
-    return a + (rand() % (b-a+1));
+    return a + (int)((RandomNext() >> 32) % (uint64_t)(b-a+1));
 }
 
 /**********************************************************//**
@@ -29,7 +54,7 @@ static inline int randint(int a, int b) {
  * @return A random double.
  **************************************************************/
 static inline double uniform(double a, double b) {
-    return a + (b-a)*((double)rand()/RAND_MAX);
+    return a + (b-a)*((double)(RandomNext() >> 11)/(double)((UINT64_C(1) << 53)-1));
 }
 
 /**************************************************************/
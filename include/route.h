@@ -0,0 +1,54 @@
+/**********************************************************//**
+ * @file route.h
+ * @brief Plans walking routes between locations across the
+ * warps connecting each map.
+ * @author Rena Shinomiya
+ * @date May 30, 2018
+ **************************************************************/
+
+#ifndef _ROUTE_H_
+#define _ROUTE_H_
+
+#include <stdbool.h>            // bool
+
+#include "coordinate.h"         // COORDINATE
+#include "location.h"           // LOCATION_ID, MAP_ID
+
+/**************************************************************/
+/// @brief Maximum number of legs (maps walked through) on a
+/// single route.
+#define ROUTE_MAX 32
+
+/**********************************************************//**
+ * @struct ROUTE_LEG
+ * @brief One stretch of a route walked on a single map.
+ **************************************************************/
+typedef struct {
+    MAP_ID Map;                 ///< Map the leg is walked on.
+    COORDINATE Target;          ///< Tile to walk to.
+    bool Warp;                  ///< Set if the target is a warp tile.
+} ROUTE_LEG;
+
+/**********************************************************//**
+ * @struct ROUTE
+ * @brief A planned route to a LOCATION, starting from some
+ * tile on some map.
+ **************************************************************/
+typedef struct {
+    LOCATION_ID Destination;    ///< Where the route leads.
+    int Cost;                   ///< Number of steps along the route.
+    int Length;                 ///< Number of legs on the route.
+    int Current;                ///< Leg currently being walked.
+    ROUTE_LEG Leg[ROUTE_MAX];   ///< Every leg in walking order.
+} ROUTE;
+
+/**************************************************************/
+extern bool InitializeRoutes(void);
+extern void DestroyRoutes(void);
+
+/**************************************************************/
+extern bool FindRoute(ROUTE *route, MAP_ID map, COORDINATE start, LOCATION_ID destination);
+extern bool RouteStep(ROUTE *route, MAP_ID map, COORDINATE tile, COORDINATE *next);
+
+/**************************************************************/
+#endif // _ROUTE_H_
@@ -0,0 +1,81 @@
+/**********************************************************//**
+ * @file save_file.h
+ * @brief Reads and writes save files. Every field is written
+ * one at a time in little-endian order, so save files work
+ * the same on any machine, and each file has a version and
+ * a checksum so damage can be noticed. A short summary of
+ * the save comes right after the header, so save slots can
+ * be listed without reading whole files.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#ifndef _SAVE_FILE_H_
+#define _SAVE_FILE_H_
+
+#include <stdbool.h>            // bool
+
+#include "game.h"               // DISPLAY_WIDTH
+#include "player.h"             // PLAYER
+#include "species.h"            // SPECTRA
+
+/**************************************************************/
+/// @brief First bytes of every save file.
+#define SAVE_MAGIC "SPEC"
+
+/// @brief Version of the save files written now. Files from
+/// newer versions aren't read.
+#define SAVE_VERSION 2
+
+/// @brief Width of the picture in a save's summary.
+#define THUMBNAIL_WIDTH (DISPLAY_WIDTH/5)
+
+/// @brief Height of the picture in a save's summary.
+#define THUMBNAIL_HEIGHT (DISPLAY_HEIGHT/5)
+
+/**********************************************************//**
+ * @struct SAVE_THUMBNAIL
+ * @brief A small picture of the game when it was saved.
+ **************************************************************/
+typedef struct {
+    unsigned char Pixels[THUMBNAIL_HEIGHT][THUMBNAIL_WIDTH][3]; ///< Red, green and blue.
+} SAVE_THUMBNAIL;
+
+/**********************************************************//**
+ * @struct SAVE_SUMMARY
+ * @brief What a save slot shows about its save. This is read
+ * without reading the rest of the file.
+ **************************************************************/
+typedef struct {
+    COSTUME_ID Costume;                 ///< The player's costume.
+    LOCATION_ID Location;               ///< Where the player is.
+    int PlayTime;                       ///< Seconds played.
+    int Money;                          ///< The player's money.
+    int nItems;                         ///< Number of items held.
+    unsigned long SavedAt;              ///< When the save was made.
+    SPECIES_ID Party[PARTY_SIZE];       ///< Species of each party member.
+    int Level[PARTY_SIZE];              ///< Level of each party member.
+    bool HasThumbnail;                  ///< Set if there is a picture.
+    SAVE_THUMBNAIL Thumbnail;           ///< Picture of the game.
+} SAVE_SUMMARY;
+
+/**********************************************************//**
+ * @struct SAVE_DATA
+ * @brief Everything in a save file.
+ **************************************************************/
+typedef struct {
+    PLAYER Player;              ///< The player's data.
+    SPECTRA *Storage;           ///< Stored spectra, oldest first.
+    int nStorage;               ///< Number of stored spectra.
+} SAVE_DATA;
+
+/**************************************************************/
+extern bool MoveOverFile(const char *from, const char *to);
+extern unsigned long SaveDataChecksum(const SAVE_DATA *data);
+extern bool IsSaveFile(const char *path);
+extern bool WriteSaveFile(const char *path, const SAVE_DATA *data, const SAVE_THUMBNAIL *thumbnail, bool compress);
+extern bool ReadSaveFile(const char *path, SAVE_DATA *data);
+extern bool ReadSaveSummary(const char *path, SAVE_SUMMARY *summary);
+
+/**************************************************************/
+#endif // _SAVE_FILE_H_
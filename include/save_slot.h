@@ -0,0 +1,49 @@
+/**********************************************************//**
+ * @file save_slot.h
+ * @brief Lists the save slots. Only the summary at the start
+ * of each save file is read, on its own thread, and only once
+ * the slot is asked about, so the list opens right away no
+ * matter how big the saves are.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#ifndef _SAVE_SLOT_H_
+#define _SAVE_SLOT_H_
+
+#include <allegro5/allegro.h>   // ALLEGRO_BITMAP
+
+#include "save_file.h"          // SAVE_SUMMARY, SAVE_THUMBNAIL
+
+/**************************************************************/
+/// @brief Number of save slots.
+#define SAVE_SLOTS 8
+
+/**********************************************************//**
+ * @enum SLOT_STATE
+ * @brief What's known about a save slot.
+ **************************************************************/
+typedef enum {
+    SLOT_UNREAD,                ///< The slot hasn't been looked at.
+    SLOT_READING,               ///< The summary is being read.
+    SLOT_EMPTY,                 ///< Nothing is saved in the slot.
+    SLOT_READY,                 ///< The summary was read.
+    SLOT_OLD,                   ///< The save is from before summaries.
+    SLOT_DAMAGED,               ///< The save can't be read.
+} SLOT_STATE;
+
+/**************************************************************/
+extern const char *SaveSlotPath(int slot);
+extern SLOT_STATE SaveSlotState(int slot);
+extern const SAVE_SUMMARY *SaveSlotSummary(int slot);
+extern ALLEGRO_BITMAP *SaveSlotThumbnail(int slot);
+extern void ForgetSaveSlot(int slot);
+extern int LatestSaveSlot(void);
+extern void DestroySaveSlots(void);
+
+/**************************************************************/
+extern void CaptureThumbnail(void);
+extern const SAVE_THUMBNAIL *Thumbnail(void);
+
+/**************************************************************/
+#endif // _SAVE_SLOT_H_
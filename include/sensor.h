@@ -0,0 +1,77 @@
+/**********************************************************//**
+ * @file sensor.h
+ * @brief Defines the tile information decoded from each
+ * map's sensor image.
+ * @author Rena Shinomiya
+ * @date April 15, 2018
+ **************************************************************/
+
+#ifndef _SENSOR_H_
+#define _SENSOR_H_
+
+#include <stdbool.h>            // bool
+
+#include "location.h"           // MAP_ID
+
+/**********************************************************//**
+ * @enum TILE_FLAGS
+ * @brief Flags that describe a tile (16*16 cell) on a map.
+ * These can be combined with a bitwise-OR.
+ **************************************************************/
+typedef enum {
+    TILE_SOLID      = 0x0001,   ///< Tile can't be walked through.
+    TILE_WATER      = 0x0002,   ///< Tile can be fished in.
+    TILE_EVENT      = 0x0004,   ///< Tile contains an event.
+} TILE_FLAGS;
+
+/**********************************************************//**
+ * @struct TILE
+ * @brief Contains information about one 16*16 region on a
+ * map. This is used by a SENSOR to control motion.
+ **************************************************************/
+typedef struct {
+    TILE_FLAGS Flags;           ///< Describes the tile properties.
+    int EventID;                ///< Indexed TILE_EVENT ID.
+    int RuntimeID;              ///< Indexed runtime event ID.
+    int Zone;                   ///< Encounter zone, or 0 for the location default.
+} TILE;
+
+/**********************************************************//**
+ * @struct SENSOR
+ * @brief Contains all the tile information for a map.
+ **************************************************************/
+typedef struct {
+    int Height;                 ///< Height in tiles of the map.
+    int Width;                  ///< Width in tiles of the map.
+    TILE *Sensor;               ///< All tile information.
+} SENSOR;
+
+/**********************************************************//**
+ * @brief Gets a tile from a sensor. No bounds checking is
+ * done.
+ * @param sensor: The sensor to read.
+ * @param x: Tile X-position.
+ * @param y: Tile Y-position.
+ * @return Pointer to the tile at (x, y).
+ **************************************************************/
+static inline TILE *SensorTile(const SENSOR *sensor, int x, int y) {
+    return &sensor->Sensor[y*sensor->Width+x];
+}
+
+/**********************************************************//**
+ * @brief Checks if a tile coordinate is inside the sensor.
+ * @param sensor: The sensor to check.
+ * @param x: Tile X-position.
+ * @param y: Tile Y-position.
+ * @return True if (x, y) is in bounds.
+ **************************************************************/
+static inline bool SensorInBounds(const SENSOR *sensor, int x, int y) {
+    return 0 <= x && x < sensor->Width && 0 <= y && y < sensor->Height;
+}
+
+/**************************************************************/
+extern bool LoadSensor(SENSOR *sensor, MAP_ID id);
+extern void DestroySensor(SENSOR *sensor);
+
+/**************************************************************/
+#endif // _SENSOR_H_
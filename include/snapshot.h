@@ -0,0 +1,92 @@
+/**********************************************************//**
+ * @file snapshot.h
+ * @brief Keeps a history of the game in memory, for instant
+ * quicksaves and rewinding without touching the disk.
+ * Snapshots are only taken and restored while the game is
+ * waiting on the player, either walking around the map or
+ * choosing turns in battle.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include <stdbool.h>            // bool
+
+#include "game.h"               // MODE_ID
+#include "player.h"             // PLAYER
+#include "location.h"           // N_RUNTIME_EVENT
+#include "battle_engine.h"      // BATTLE_CONTEXT
+
+/**************************************************************/
+/// @brief Seconds between snapshots.
+#define SNAPSHOT_INTERVAL 5.0
+
+/// @brief Every this many snapshots, one is stored whole
+/// instead of as changes to the one before.
+#define SNAPSHOT_KEYFRAME 12
+
+/// @brief Most snapshots kept; over an hour at the interval.
+#define SNAPSHOT_MAX 1024
+
+/// @brief Bytes of memory shared by every snapshot kept. The
+/// oldest ones are dropped to make room.
+#define SNAPSHOT_MEMORY (4<<20)
+
+/**********************************************************//**
+ * @struct MAP_SNAPSHOT
+ * @brief State of the map that isn't in the PLAYER.
+ **************************************************************/
+typedef struct {
+    unsigned char Direction[N_RUNTIME_EVENT];   ///< Direction each person faces.
+    int WalkFrame;                              ///< The player's walking animation.
+} MAP_SNAPSHOT;
+
+/**********************************************************//**
+ * @struct BATTLE_SNAPSHOT
+ * @brief State of the battle being played.
+ **************************************************************/
+typedef struct {
+    BATTLE_CONTEXT Context;     ///< The battle.
+    ENEMY_AI EnemyAI;           ///< How the enemy team chooses its turns.
+    int EnemyBudget;            ///< Milliseconds the enemy AI may think.
+} BATTLE_SNAPSHOT;
+
+/**********************************************************//**
+ * @struct GAME_SNAPSHOT
+ * @brief Everything needed to put the game back the way it
+ * was. The battle is only used in MODE_BATTLE. The storage
+ * box isn't kept, so a snapshot can't be restored once the
+ * box has changed.
+ **************************************************************/
+typedef struct {
+    MODE_ID Mode;               ///< The game mode.
+    PLAYER Player;              ///< The player's data.
+    MAP_SNAPSHOT Map;           ///< State of the map.
+    BATTLE_SNAPSHOT Battle;     ///< State of the battle.
+    int Storage;                ///< StorageChanges when it was taken.
+} GAME_SNAPSHOT;
+
+/**************************************************************/
+extern bool MapSnapshotReady(void);
+extern void SnapshotMap(MAP_SNAPSHOT *snapshot);
+extern void RestoreMapSnapshot(const MAP_SNAPSHOT *snapshot);
+
+/**************************************************************/
+extern bool BattleSnapshotReady(void);
+extern void SnapshotBattle(BATTLE_SNAPSHOT *snapshot);
+extern void RestoreBattleSnapshot(const BATTLE_SNAPSHOT *snapshot);
+extern void AbandonBattle(void);
+
+/**************************************************************/
+extern bool SnapshotReady(void);
+extern bool TakeSnapshot(void);
+extern bool QuickSave(void);
+extern bool QuickLoad(void);
+extern bool Rewind(void);
+extern void UpdateSnapshots(void);
+extern void DestroySnapshots(void);
+
+/**************************************************************/
+#endif // _SNAPSHOT_H_
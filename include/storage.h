@@ -0,0 +1,76 @@
+/**********************************************************//**
+ * @file storage.h
+ * @brief Keeps the spectra that don't fit in the party. The
+ * box has no size limit, and it's kept sorted several ways
+ * at once so it can be browsed quickly however it's sorted
+ * or filtered.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#ifndef _STORAGE_H_
+#define _STORAGE_H_
+
+#include <stdio.h>              // FILE
+#include <stdbool.h>            // bool
+
+#include "species.h"            // SPECTRA
+#include "type.h"               // TYPE_ID
+
+/**************************************************************/
+/// @brief Number of spectra the box starts with room for. It
+/// grows as more are stored.
+#define STORAGE_SIZE 64
+
+/**********************************************************//**
+ * @enum STORAGE_ORDER
+ * @brief Orders the box is kept sorted in.
+ **************************************************************/
+typedef enum {
+    STORAGE_BY_CAPTURE,         ///< Oldest capture first.
+    STORAGE_BY_SPECIES,         ///< By species ID.
+    STORAGE_BY_LEVEL,           ///< Highest level first.
+    STORAGE_BY_TYPE,            ///< By first type, then second type.
+} STORAGE_ORDER;
+
+/// The number of unique STORAGE_ORDER members.
+#define N_STORAGE_ORDER 4
+
+/**********************************************************//**
+ * @struct STORAGE_VIEW
+ * @brief Part of the box in one order. A view is a run of
+ * one index, so its entries are found without searching.
+ * Views have to be refreshed when the box changes.
+ **************************************************************/
+typedef struct {
+    STORAGE_ORDER Order;        ///< Order the view is sorted in.
+    int Low;                    ///< Smallest key shown.
+    int High;                   ///< Largest key shown.
+    int First;                  ///< Position of the first entry in the index.
+    int Count;                  ///< Number of entries shown.
+} STORAGE_VIEW;
+
+/**************************************************************/
+extern bool StoreSpectra(const SPECTRA *spectra);
+extern bool TakeStoredSpectra(int entry, SPECTRA *spectra);
+extern const SPECTRA *StoredSpectra(int entry);
+extern int StorageSize(void);
+extern int StorageChanges(void);
+extern void ClearStorage(void);
+extern void DestroyStorage(void);
+
+/**************************************************************/
+extern void ViewStorage(STORAGE_VIEW *view, STORAGE_ORDER order);
+extern void ViewStorageSpecies(STORAGE_VIEW *view, SPECIES_ID species);
+extern void ViewStorageType(STORAGE_VIEW *view, TYPE_ID type);
+extern void ViewStorageLevels(STORAGE_VIEW *view, int low, int high);
+extern void RefreshStorageView(STORAGE_VIEW *view);
+extern int StorageViewEntry(const STORAGE_VIEW *view, int index);
+
+/**************************************************************/
+extern SPECTRA *CopyStorage(int *count);
+extern bool RestoreStorage(const SPECTRA *spectra, int count);
+extern bool LoadStorage(FILE *file);
+
+/**************************************************************/
+#endif // _STORAGE_H_
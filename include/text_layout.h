@@ -0,0 +1,51 @@
+/**********************************************************//**
+ * @file text_layout.h
+ * @brief Wraps text into lines once, so text boxes can be
+ * drawn every frame without measuring the text again.
+ * @author Rena Shinomiya
+ * @date June 11, 2018
+ **************************************************************/
+
+#ifndef _TEXT_LAYOUT_H_
+#define _TEXT_LAYOUT_H_
+
+#include <stdint.h>             // uint32_t
+
+#include <allegro5/allegro.h>   // ALLEGRO_COLOR
+#include <allegro5/allegro_font.h>
+
+/**************************************************************/
+/// @brief Most lines kept for one text box. Anything past
+/// this isn't drawn.
+#define TEXT_LINES_MAX 32
+
+/**********************************************************//**
+ * @struct TEXT_LINE
+ * @brief One wrapped line, as a span of the original text.
+ **************************************************************/
+typedef struct {
+    int Start;                  ///< Offset of the first character.
+    int Length;                 ///< Number of characters.
+} TEXT_LINE;
+
+/**********************************************************//**
+ * @struct TEXT_LAYOUT
+ * @brief How a string wraps at a certain width. The lines
+ * are offsets, so the text can move without wrapping again.
+ **************************************************************/
+typedef struct {
+    const ALLEGRO_FONT *Font;   ///< Font the text was measured in.
+    int Width;                  ///< Width the text was wrapped to.
+    int Length;                 ///< Length of the text.
+    uint32_t Hash;              ///< Hash of the text.
+    int nLines;                 ///< Number of lines.
+    TEXT_LINE Lines[TEXT_LINES_MAX]; ///< The lines, top to bottom.
+} TEXT_LAYOUT;
+
+/**************************************************************/
+extern void LayoutText(TEXT_LAYOUT *layout, const ALLEGRO_FONT *font, const char *text, int length, int width);
+extern const TEXT_LAYOUT *CachedTextLayout(const ALLEGRO_FONT *font, const char *text, int width);
+extern void DrawTextLayout(const TEXT_LAYOUT *layout, const char *text, int reveal, ALLEGRO_COLOR color, int x, int y, int lineHeight);
+
+/**************************************************************/
+#endif // _TEXT_LAYOUT_H_
@@ -0,0 +1,26 @@
+/**********************************************************//**
+ * @file world_map.h
+ * @brief Zoomable overview of the whole overworld.
+ * @author Rena Shinomiya
+ * @date June 3, 2018
+ **************************************************************/
+
+#ifndef _WORLD_MAP_H_
+#define _WORLD_MAP_H_
+
+#include <stdbool.h>            // bool
+
+/**************************************************************/
+/// @brief Maximum number of levels in the world map pyramid.
+#define WORLD_MAP_LEVELS 8
+
+/**************************************************************/
+extern bool InitializeWorldMap(void);
+extern void DestroyWorldMap(void);
+extern void OpenWorldMap(void);
+extern void UpdateWorldMap(void);
+extern void DrawWorldMap(void);
+extern bool WorldMapClosed(void);
+
+/**************************************************************/
+#endif // _WORLD_MAP_H_
@@ -0,0 +1,240 @@
+/**********************************************************//**
+ * @file animation.c
+ * @brief Draws the animated tiles of a map from an atlas.
+ * @author Rena Shinomiya
+ * @date June 2, 2018
+ **************************************************************/
+
+#include <allegro5/allegro.h>
+
+#include <stdlib.h>             // malloc, free
+#include <stdbool.h>            // bool
+#include <math.h>               // fmod
+
+#include "animation.h"          // ANIMATION_LAYER
+#include "game.h"               // DISPLAY_WIDTH, LastFrameTime
+#include "debug.h"              // eprintf
+
+/**************************************************************/
+/// @brief Seconds of animation played so far. Every animated
+/// tile reads the same clock so they all stay in step.
+static double AnimationClock = 0.0;
+
+/**********************************************************//**
+ * @brief Reads a little-endian 16-bit number, as written by
+ * buildmap.py.
+ * @param data: Pointer to the number.
+ * @return The number.
+ **************************************************************/
+static inline int Read16(const unsigned char *data) {
+    return data[0] | (data[1] << 8);
+}
+
+/**********************************************************//**
+ * @brief Reads the animations and tiles from the data file.
+ * @param layer: The layer, with its arrays allocated.
+ * @param data: The data after the header.
+ * @param end: The end of the data.
+ * @return True if the data is well formed.
+ **************************************************************/
+static bool ReadAnimationLayer(ANIMATION_LAYER *layer, const unsigned char *data, const unsigned char *end) {
+    // Frame sequence of each animation
+    int frame = 0;
+    for (int i = 0; i < layer->nAnimations; i++) {
+        if (data+2 > end) {
+            return false;
+        }
+        int nFrames = Read16(data);
+        data += 2;
+        if (!nFrames || data+4*nFrames > end) {
+            return false;
+        }
+        layer->FirstFrame[i] = frame;
+        int time = 0;
+        for (int j = 0; j < nFrames; j++, frame++) {
+            time += Read16(data+2);
+            layer->FrameIndex[frame] = Read16(data);
+            layer->FrameEnd[frame] = time;
+            data += 4;
+        }
+        if (!time) {
+            return false;
+        }
+    }
+    layer->FirstFrame[layer->nAnimations] = frame;
+
+    // Tile positions
+    if (data+6*layer->nTiles != end) {
+        return false;
+    }
+    for (int i = 0; i < layer->nTiles; i++, data += 6) {
+        ANIMATED_TILE *tile = &layer->Tiles[i];
+        tile->X = Read16(data);
+        tile->Y = Read16(data+2);
+        tile->Animation = Read16(data+4);
+        if (tile->Animation >= layer->nAnimations) {
+            return false;
+        }
+        if (i && tile->Y < layer->Tiles[i-1].Y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Sets up the animated tiles for a map.
+ * @param layer: The ANIMATION_LAYER to set up. Any previous
+ * layer data is released.
+ * @param atlas: Image holding every frame, or NULL if the map
+ * has no animated tiles.
+ * @param data: Animations and tiles written by buildmap.py.
+ * @param size: Size of the data in bytes.
+ * @return True on success.
+ **************************************************************/
+bool InitializeAnimationLayer(ANIMATION_LAYER *layer, ALLEGRO_BITMAP *atlas, const unsigned char *data, int size) {
+    DestroyAnimationLayer(layer);
+    if (!atlas || !data || size < 4) {
+        return true;
+    }
+
+    // The frame count isn't stored, but can't exceed the data.
+    const unsigned char *end = data+size;
+    int nAnimations = Read16(data);
+    int nTiles = Read16(data+2);
+    int maxFrames = size/4;
+    int rows = nTiles? Read16(end-4)+1: 0;
+    layer->FirstFrame = (int *)malloc(sizeof(int)*(nAnimations+1));
+    layer->FrameIndex = (int *)malloc(sizeof(int)*maxFrames);
+    layer->FrameEnd = (int *)malloc(sizeof(int)*maxFrames);
+    layer->Current = (int *)malloc(sizeof(int)*(nAnimations+1));
+    layer->Tiles = (ANIMATED_TILE *)malloc(sizeof(ANIMATED_TILE)*(nTiles+1));
+    layer->RowStart = (int *)malloc(sizeof(int)*(rows+1));
+    if (!layer->FirstFrame || !layer->FrameIndex || !layer->FrameEnd
+    || !layer->Current || !layer->Tiles || !layer->RowStart) {
+        eprintf("Out of memory for animated tiles.\n");
+        DestroyAnimationLayer(layer);
+        return false;
+    }
+    layer->nAnimations = nAnimations;
+    layer->nTiles = nTiles;
+    if (!ReadAnimationLayer(layer, data+4, end)) {
+        eprintf("Animated tile data is corrupt.\n");
+        DestroyAnimationLayer(layer);
+        return false;
+    }
+
+    // Index the first tile of each row.
+    layer->Rows = rows;
+    int tile = 0;
+    for (int row = 0; row <= rows; row++) {
+        while (tile < nTiles && layer->Tiles[tile].Y < row) {
+            tile++;
+        }
+        layer->RowStart[row] = tile;
+    }
+    layer->Atlas = atlas;
+    layer->AtlasColumns = al_get_bitmap_width(atlas)/ANIMATION_TILE;
+    if (layer->AtlasColumns < 1) {
+        layer->AtlasColumns = 1;
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Releases the animated tiles of a layer. The atlas
+ * belongs to the assets.
+ * @param layer: The ANIMATION_LAYER to clear.
+ **************************************************************/
+void DestroyAnimationLayer(ANIMATION_LAYER *layer) {
+    free(layer->FirstFrame);
+    free(layer->FrameIndex);
+    free(layer->FrameEnd);
+    free(layer->Current);
+    free(layer->Tiles);
+    free(layer->RowStart);
+    layer->Atlas = NULL;
+    layer->AtlasColumns = 0;
+    layer->nAnimations = 0;
+    layer->FirstFrame = NULL;
+    layer->FrameIndex = NULL;
+    layer->FrameEnd = NULL;
+    layer->Current = NULL;
+    layer->nTiles = 0;
+    layer->Tiles = NULL;
+    layer->Rows = 0;
+    layer->RowStart = NULL;
+}
+
+/**********************************************************//**
+ * @brief Finds the frame each animation is showing now.
+ * @param layer: The layer to update.
+ **************************************************************/
+static void UpdateAnimationFrames(ANIMATION_LAYER *layer) {
+    double now = AnimationClock*1000.0;
+    for (int i = 0; i < layer->nAnimations; i++) {
+        int first = layer->FirstFrame[i];
+        int last = layer->FirstFrame[i+1]-1;
+        double time = fmod(now, layer->FrameEnd[last]);
+        int frame = first;
+        while (frame < last && time >= layer->FrameEnd[frame]) {
+            frame++;
+        }
+        layer->Current[i] = layer->FrameIndex[frame];
+    }
+}
+
+/**********************************************************//**
+ * @brief Draws the animated tiles that are on screen. The
+ * current transform should align to the map's upper left
+ * corner.
+ * @param layer: The layer to draw.
+ * @param left: Map X-coordinate at the left of the screen.
+ * @param top: Map Y-coordinate at the top of the screen.
+ **************************************************************/
+void DrawAnimationLayer(ANIMATION_LAYER *layer, int left, int top) {
+    if (!layer->Atlas || !layer->nTiles) {
+        return;
+    }
+    int column0 = (left < 0)? 0: left/ANIMATION_TILE;
+    int row0 = (top < 0)? 0: top/ANIMATION_TILE;
+    int column1 = (left+DISPLAY_WIDTH-1)/ANIMATION_TILE;
+    int row1 = (top+DISPLAY_HEIGHT-1)/ANIMATION_TILE;
+    if (row1 >= layer->Rows) {
+        row1 = layer->Rows-1;
+    }
+    if (row0 > row1) {
+        return;
+    }
+    UpdateAnimationFrames(layer);
+
+    // Every frame comes from the atlas, so they batch together.
+    al_hold_bitmap_drawing(true);
+    for (int i = layer->RowStart[row0]; i < layer->RowStart[row1+1]; i++) {
+        const ANIMATED_TILE *tile = &layer->Tiles[i];
+        if (tile->X < column0 || tile->X > column1) {
+            continue;
+        }
+        int index = layer->Current[tile->Animation];
+        al_draw_bitmap_region(
+            layer->Atlas,
+            (index%layer->AtlasColumns)*ANIMATION_TILE,
+            (index/layer->AtlasColumns)*ANIMATION_TILE,
+            ANIMATION_TILE,
+            ANIMATION_TILE,
+            tile->X*ANIMATION_TILE,
+            tile->Y*ANIMATION_TILE,
+            0
+        );
+    }
+    al_hold_bitmap_drawing(false);
+}
+
+/**********************************************************//**
+ * @brief Advances the animation clock by one frame.
+ **************************************************************/
+void UpdateAnimationClock(void) {
+    AnimationClock += LastFrameTime();
+}
+
+/**************************************************************/
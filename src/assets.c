@@ -6,6 +6,7 @@
  **************************************************************/
 
 #include <stddef.h>             // NULL
+#include <stdlib.h>             // malloc, free
 #include <stdbool.h>            // bool
 
 #include <allegro5/allegro.h>
@@ -30,6 +31,8 @@
 typedef struct {
     const char *Filename;
     ALLEGRO_BITMAP *Image;
+    int Flags;
+    bool Optional;
 } IMAGE_ASSET;
 
 /**********************************************************//**
@@ -43,13 +46,40 @@ typedef struct {
     ALLEGRO_FONT *Font;
 } FONT_ASSET;
 
+/**********************************************************//**
+ * @struct ANIMATION_ASSET
+ * @brief Stores the frame atlas and tile data for a map's
+ * animated tiles, if the map has any.
+ **************************************************************/
+typedef struct {
+    const char *Filename;
+    const char *DataFilename;
+    ALLEGRO_BITMAP *Atlas;
+    unsigned char *Data;
+    int Size;
+} ANIMATION_ASSET;
+
 /**************************************************************/
 /// @brief The path to the game's assets directory relative to
 /// the executable.
 #define DATA "data/"
 
 /// @brief Initializes an IMAGE_ASSET with a standard path.
-#define IMAGE(filename) {DATA "image/" filename, NULL}
+#define IMAGE(filename) {DATA "image/" filename, NULL, 0, false}
+
+/// @brief Initializes an IMAGE_ASSET for a sensor. Sensors
+/// keep their alpha channel exactly as stored, since it holds
+/// the encounter zones.
+#define SENSOR_IMAGE(filename) {DATA "image/" filename, NULL, ALLEGRO_NO_PREMULTIPLIED_ALPHA, false}
+
+/// @brief Initializes an IMAGE_ASSET that may not exist, such
+/// as the overlay for a map with nothing drawn above the player.
+#define OPTIONAL_IMAGE(filename) {DATA "image/" filename, NULL, 0, true}
+
+/// @brief Initializes an ANIMATION_ASSET from the map image
+/// path without its extension. Maps with no animated tiles
+/// have no files.
+#define ANIMATION(name) {DATA "image/" name "-atlas.png", DATA "image/" name "-animated.dat", NULL, NULL, 0}
 
 /// @brief Initializes a FONT_ASSET with a standard path.
 #define FONT(filename, size) {DATA "font/" filename, size, NULL}
@@ -231,60 +261,173 @@ static IMAGE_ASSET MapAssets[] = {
     [MAP_LAVATORY]              = IMAGE("map/granite_city/tower_bathroom.png"),
 };
 
+/**********************************************************//**
+ * @brief Indexes MAP_ID members to IMAGE_ASSET data for the
+ * overlay drawn above the player on each map. Maps without
+ * anything above the player have no overlay file.
+ **************************************************************/
+static IMAGE_ASSET MapOverlayAssets[] = {
+    [MAP_OVERWORLD]             = OPTIONAL_IMAGE("map/kaido-overlay.png"),
+    [MAP_BOULDER_CAVE]          = OPTIONAL_IMAGE("map/boulder_cave-overlay.png"),
+    [MAP_FALLS_CAVE_1F]         = OPTIONAL_IMAGE("map/falls_cave_1st_floor-overlay.png"),
+    [MAP_FALLS_CAVE_B1F]        = OPTIONAL_IMAGE("map/falls_cave_basement-overlay.png"),
+    [MAP_GRANITE_CAVE_1F]       = OPTIONAL_IMAGE("map/granite_cave_1st_floor-overlay.png"),
+    [MAP_GRANITE_CAVE_B1F]      = OPTIONAL_IMAGE("map/granite_cave_basement-overlay.png"),
+    [MAP_NEW_LAND_CAVE]         = OPTIONAL_IMAGE("map/new_land_cave-overlay.png"),
+    [MAP_OXIDE_CRATER]          = OPTIONAL_IMAGE("map/oxide_crater-overlay.png"),
+    [MAP_SAPLING_YOUR_HOUSE]    = OPTIONAL_IMAGE("map/sapling_town/amy_house-overlay.png"),
+    [MAP_SAPLING_AIRPORT]       = OPTIONAL_IMAGE("map/sapling_town/airport-overlay.png"),
+    [MAP_SAPLING_HOSPITAL]      = OPTIONAL_IMAGE("map/sapling_town/hospital-overlay.png"),
+    [MAP_SAPLING_CITY_HALL]     = OPTIONAL_IMAGE("map/sapling_town/city_hall-overlay.png"),
+    [MAP_SAPLING_GREENHOUSE]    = OPTIONAL_IMAGE("map/sapling_town/greenhouse-overlay.png"),
+    [MAP_SAPLING_LABORATORY]    = OPTIONAL_IMAGE("map/sapling_town/laboratory-overlay.png"),
+    [MAP_ROYAL_HOSPITAL]        = OPTIONAL_IMAGE("map/port_royal/hospital-overlay.png"),
+    [MAP_ROYAL_WAREHOUSE]       = OPTIONAL_IMAGE("map/port_royal/warehouse-overlay.png"),
+    [MAP_ROYAL_PORT]            = OPTIONAL_IMAGE("map/port_royal/port-overlay.png"),
+    [MAP_SOLAR_AIRPORT]         = OPTIONAL_IMAGE("map/solar_city/airport-overlay.png"),
+    [MAP_SOLAR_HOSPITAL]        = OPTIONAL_IMAGE("map/solar_city/hospital-overlay.png"),
+    [MAP_SOLAR_EAST_CORP]       = OPTIONAL_IMAGE("map/solar_city/corporation_east-overlay.png"),
+    [MAP_SOLAR_WEST_CORP]       = OPTIONAL_IMAGE("map/solar_city/corporation_west-overlay.png"),
+    [MAP_SOLAR_INSTITUTE_1F]    = OPTIONAL_IMAGE("map/solar_city/institute_1st_floor-overlay.png"),
+    [MAP_SOLAR_INSTITUTE_2F]    = OPTIONAL_IMAGE("map/solar_city/institute_2nd_floor-overlay.png"),
+    [MAP_SOLAR_INSTITUTE_3F]    = OPTIONAL_IMAGE("map/solar_city/institute_3rd_floor-overlay.png"),
+    [MAP_GENERATOR_ROOM]        = OPTIONAL_IMAGE("map/solar_city/institute_generator_room-overlay.png"),
+    [MAP_REST_STOP]             = OPTIONAL_IMAGE("map/andora_falls/rest_stop-overlay.png"),
+    [MAP_ANDORA_HOSPITAL]       = OPTIONAL_IMAGE("map/andora_falls/hospital-overlay.png"),
+    [MAP_ANDORA_PORT]           = OPTIONAL_IMAGE("map/andora_falls/port-overlay.png"),
+    [MAP_GRANITE_AIRPORT]       = OPTIONAL_IMAGE("map/granite_city/airport-overlay.png"),
+    [MAP_GRANITE_AIR_EAST]      = OPTIONAL_IMAGE("map/granite_city/air_tower_east-overlay.png"),
+    [MAP_GRANITE_AIR_WEST]      = OPTIONAL_IMAGE("map/granite_city/air_tower_west-overlay.png"),
+    [MAP_GRANITE_CORP]          = OPTIONAL_IMAGE("map/granite_city/corporation-overlay.png"),
+    [MAP_GRANITE_DEPARTMENT]    = OPTIONAL_IMAGE("map/granite_city/department_store-overlay.png"),
+    [MAP_GAME_DESIGNER_ROOM]    = OPTIONAL_IMAGE("map/granite_city/game_designer_room-overlay.png"),
+    [MAP_GRANITE_HOSPITAL]      = OPTIONAL_IMAGE("map/granite_city/hospital-overlay.png"),
+    [MAP_GRANITE_LIBRARY]       = OPTIONAL_IMAGE("map/granite_city/library-overlay.png"),
+    [MAP_GRANITE_STORE_1]       = OPTIONAL_IMAGE("map/granite_city/store_1-overlay.png"),
+    [MAP_GRANITE_STORE_2]       = OPTIONAL_IMAGE("map/granite_city/store_2-overlay.png"),
+    [MAP_GRANITE_STORE_3]       = OPTIONAL_IMAGE("map/granite_city/store_3-overlay.png"),
+    [MAP_GRANITE_STORE_4]       = OPTIONAL_IMAGE("map/granite_city/store_4-overlay.png"),
+    [MAP_GRANITE_STORE_5]       = OPTIONAL_IMAGE("map/granite_city/store_5-overlay.png"),
+    [MAP_GRANITE_STORE_6]       = OPTIONAL_IMAGE("map/granite_city/store_6-overlay.png"),
+    [MAP_GRANITE_WAREHOUSE]     = OPTIONAL_IMAGE("map/granite_city/warehouse-overlay.png"),
+    [MAP_GRANITE_TOWER_1F]      = OPTIONAL_IMAGE("map/granite_city/tower_1st_floor-overlay.png"),
+    [MAP_GRANITE_TOWER_2F]      = OPTIONAL_IMAGE("map/granite_city/tower_2nd_floor-overlay.png"),
+    [MAP_GRANITE_TOWER_3F]      = OPTIONAL_IMAGE("map/granite_city/tower_3rd_floor-overlay.png"),
+    [MAP_GRANITE_TOWER_4F]      = OPTIONAL_IMAGE("map/granite_city/tower_4th_floor-overlay.png"),
+    [MAP_GRANITE_TOWER_5F]      = OPTIONAL_IMAGE("map/granite_city/tower_5th_floor-overlay.png"),
+    [MAP_LAVATORY]              = OPTIONAL_IMAGE("map/granite_city/tower_bathroom-overlay.png"),
+};
+
+/**********************************************************//**
+ * @brief Indexes MAP_ID members to ANIMATION_ASSET data for
+ * the animated tiles (water, lava...) on each map.
+ **************************************************************/
+static ANIMATION_ASSET MapAnimationAssets[] = {
+    [MAP_OVERWORLD]             = ANIMATION("map/kaido"),
+    [MAP_BOULDER_CAVE]          = ANIMATION("map/boulder_cave"),
+    [MAP_FALLS_CAVE_1F]         = ANIMATION("map/falls_cave_1st_floor"),
+    [MAP_FALLS_CAVE_B1F]        = ANIMATION("map/falls_cave_basement"),
+    [MAP_GRANITE_CAVE_1F]       = ANIMATION("map/granite_cave_1st_floor"),
+    [MAP_GRANITE_CAVE_B1F]      = ANIMATION("map/granite_cave_basement"),
+    [MAP_NEW_LAND_CAVE]         = ANIMATION("map/new_land_cave"),
+    [MAP_OXIDE_CRATER]          = ANIMATION("map/oxide_crater"),
+    [MAP_SAPLING_YOUR_HOUSE]    = ANIMATION("map/sapling_town/amy_house"),
+    [MAP_SAPLING_AIRPORT]       = ANIMATION("map/sapling_town/airport"),
+    [MAP_SAPLING_HOSPITAL]      = ANIMATION("map/sapling_town/hospital"),
+    [MAP_SAPLING_CITY_HALL]     = ANIMATION("map/sapling_town/city_hall"),
+    [MAP_SAPLING_GREENHOUSE]    = ANIMATION("map/sapling_town/greenhouse"),
+    [MAP_SAPLING_LABORATORY]    = ANIMATION("map/sapling_town/laboratory"),
+    [MAP_ROYAL_HOSPITAL]        = ANIMATION("map/port_royal/hospital"),
+    [MAP_ROYAL_WAREHOUSE]       = ANIMATION("map/port_royal/warehouse"),
+    [MAP_ROYAL_PORT]            = ANIMATION("map/port_royal/port"),
+    [MAP_SOLAR_AIRPORT]         = ANIMATION("map/solar_city/airport"),
+    [MAP_SOLAR_HOSPITAL]        = ANIMATION("map/solar_city/hospital"),
+    [MAP_SOLAR_EAST_CORP]       = ANIMATION("map/solar_city/corporation_east"),
+    [MAP_SOLAR_WEST_CORP]       = ANIMATION("map/solar_city/corporation_west"),
+    [MAP_SOLAR_INSTITUTE_1F]    = ANIMATION("map/solar_city/institute_1st_floor"),
+    [MAP_SOLAR_INSTITUTE_2F]    = ANIMATION("map/solar_city/institute_2nd_floor"),
+    [MAP_SOLAR_INSTITUTE_3F]    = ANIMATION("map/solar_city/institute_3rd_floor"),
+    [MAP_GENERATOR_ROOM]        = ANIMATION("map/solar_city/institute_generator_room"),
+    [MAP_REST_STOP]             = ANIMATION("map/andora_falls/rest_stop"),
+    [MAP_ANDORA_HOSPITAL]       = ANIMATION("map/andora_falls/hospital"),
+    [MAP_ANDORA_PORT]           = ANIMATION("map/andora_falls/port"),
+    [MAP_GRANITE_AIRPORT]       = ANIMATION("map/granite_city/airport"),
+    [MAP_GRANITE_AIR_EAST]      = ANIMATION("map/granite_city/air_tower_east"),
+    [MAP_GRANITE_AIR_WEST]      = ANIMATION("map/granite_city/air_tower_west"),
+    [MAP_GRANITE_CORP]          = ANIMATION("map/granite_city/corporation"),
+    [MAP_GRANITE_DEPARTMENT]    = ANIMATION("map/granite_city/department_store"),
+    [MAP_GAME_DESIGNER_ROOM]    = ANIMATION("map/granite_city/game_designer_room"),
+    [MAP_GRANITE_HOSPITAL]      = ANIMATION("map/granite_city/hospital"),
+    [MAP_GRANITE_LIBRARY]       = ANIMATION("map/granite_city/library"),
+    [MAP_GRANITE_STORE_1]       = ANIMATION("map/granite_city/store_1"),
+    [MAP_GRANITE_STORE_2]       = ANIMATION("map/granite_city/store_2"),
+    [MAP_GRANITE_STORE_3]       = ANIMATION("map/granite_city/store_3"),
+    [MAP_GRANITE_STORE_4]       = ANIMATION("map/granite_city/store_4"),
+    [MAP_GRANITE_STORE_5]       = ANIMATION("map/granite_city/store_5"),
+    [MAP_GRANITE_STORE_6]       = ANIMATION("map/granite_city/store_6"),
+    [MAP_GRANITE_WAREHOUSE]     = ANIMATION("map/granite_city/warehouse"),
+    [MAP_GRANITE_TOWER_1F]      = ANIMATION("map/granite_city/tower_1st_floor"),
+    [MAP_GRANITE_TOWER_2F]      = ANIMATION("map/granite_city/tower_2nd_floor"),
+    [MAP_GRANITE_TOWER_3F]      = ANIMATION("map/granite_city/tower_3rd_floor"),
+    [MAP_GRANITE_TOWER_4F]      = ANIMATION("map/granite_city/tower_4th_floor"),
+    [MAP_GRANITE_TOWER_5F]      = ANIMATION("map/granite_city/tower_5th_floor"),
+    [MAP_LAVATORY]              = ANIMATION("map/granite_city/tower_bathroom"),
+};
+
 /**********************************************************//**
  * @brief Indexes MAP_ID members to IMAGE_ASSET data for the
  * overworld map sensor data.
  **************************************************************/
 static IMAGE_ASSET SensorAssets[] = {
-    [MAP_OVERWORLD]             = IMAGE("sensor/kaido.png"),
-    [MAP_BOULDER_CAVE]          = IMAGE("sensor/boulder_cave.png"),
-    [MAP_FALLS_CAVE_1F]         = IMAGE("sensor/falls_cave_1st_floor.png"),
-    [MAP_FALLS_CAVE_B1F]        = IMAGE("sensor/falls_cave_basement.png"),
-    [MAP_GRANITE_CAVE_1F]       = IMAGE("sensor/granite_cave_1st_floor.png"),
-    [MAP_GRANITE_CAVE_B1F]      = IMAGE("sensor/granite_cave_basement.png"),
-    [MAP_NEW_LAND_CAVE]         = IMAGE("sensor/new_land_cave.png"),
-    [MAP_OXIDE_CRATER]          = IMAGE("sensor/oxide_crater.png"),
-    [MAP_SAPLING_YOUR_HOUSE]    = IMAGE("sensor/sapling_town/amy_house.png"),
-    [MAP_SAPLING_AIRPORT]       = IMAGE("sensor/sapling_town/airport.png"),
-    [MAP_SAPLING_HOSPITAL]      = IMAGE("sensor/sapling_town/hospital.png"),
-    [MAP_SAPLING_CITY_HALL]     = IMAGE("sensor/sapling_town/city_hall.png"),
-    [MAP_SAPLING_GREENHOUSE]    = IMAGE("sensor/sapling_town/greenhouse.png"),
-    [MAP_SAPLING_LABORATORY]    = IMAGE("sensor/sapling_town/laboratory.png"),
-    [MAP_ROYAL_HOSPITAL]        = IMAGE("sensor/port_royal/hospital.png"),
-    [MAP_ROYAL_WAREHOUSE]       = IMAGE("sensor/port_royal/warehouse.png"),
-    [MAP_ROYAL_PORT]            = IMAGE("sensor/port_royal/port.png"),
-    [MAP_SOLAR_AIRPORT]         = IMAGE("sensor/solar_city/airport.png"),
-    [MAP_SOLAR_HOSPITAL]        = IMAGE("sensor/solar_city/hospital.png"),
-    [MAP_SOLAR_EAST_CORP]       = IMAGE("sensor/solar_city/corporation_east.png"),
-    [MAP_SOLAR_WEST_CORP]       = IMAGE("sensor/solar_city/corporation_west.png"),
-    [MAP_SOLAR_INSTITUTE_1F]    = IMAGE("sensor/solar_city/institute_1st_floor.png"),
-    [MAP_SOLAR_INSTITUTE_2F]    = IMAGE("sensor/solar_city/institute_2nd_floor.png"),
-    [MAP_SOLAR_INSTITUTE_3F]    = IMAGE("sensor/solar_city/institute_3rd_floor.png"),
-    [MAP_GENERATOR_ROOM]        = IMAGE("sensor/solar_city/institute_generator_room.png"),
-    [MAP_REST_STOP]             = IMAGE("sensor/andora_falls/rest_stop.png"),
-    [MAP_ANDORA_HOSPITAL]       = IMAGE("sensor/andora_falls/hospital.png"),
-    [MAP_ANDORA_PORT]           = IMAGE("sensor/andora_falls/port.png"),
-    [MAP_GRANITE_AIRPORT]       = IMAGE("sensor/granite_city/airport.png"),
-    [MAP_GRANITE_AIR_EAST]      = IMAGE("sensor/granite_city/air_tower_east.png"),
-    [MAP_GRANITE_AIR_WEST]      = IMAGE("sensor/granite_city/air_tower_west.png"),
-    [MAP_GRANITE_CORP]          = IMAGE("sensor/granite_city/corporation.png"),
-    [MAP_GRANITE_DEPARTMENT]    = IMAGE("sensor/granite_city/department_store.png"),
-    [MAP_GAME_DESIGNER_ROOM]    = IMAGE("sensor/granite_city/game_designer_room.png"),
-    [MAP_GRANITE_HOSPITAL]      = IMAGE("sensor/granite_city/hospital.png"),
-    [MAP_GRANITE_LIBRARY]       = IMAGE("sensor/granite_city/library.png"),
-    [MAP_GRANITE_STORE_1]       = IMAGE("sensor/granite_city/store_1_through_5.png"),
-    [MAP_GRANITE_STORE_2]       = IMAGE("sensor/granite_city/store_1_through_5.png"),
-    [MAP_GRANITE_STORE_3]       = IMAGE("sensor/granite_city/store_1_through_5.png"),
-    [MAP_GRANITE_STORE_4]       = IMAGE("sensor/granite_city/store_1_through_5.png"),
-    [MAP_GRANITE_STORE_5]       = IMAGE("sensor/granite_city/store_1_through_5.png"),
-    [MAP_GRANITE_STORE_6]       = IMAGE("sensor/granite_city/store_6.png"),
-    [MAP_GRANITE_WAREHOUSE]     = IMAGE("sensor/granite_city/warehouse.png"),
-    [MAP_GRANITE_TOWER_1F]      = IMAGE("sensor/granite_city/tower_1st_floor.png"),
-    [MAP_GRANITE_TOWER_2F]      = IMAGE("sensor/granite_city/tower_2nd_floor.png"),
-    [MAP_GRANITE_TOWER_3F]      = IMAGE("sensor/granite_city/tower_3rd_floor.png"),
-    [MAP_GRANITE_TOWER_4F]      = IMAGE("sensor/granite_city/tower_4th_floor.png"),
-    [MAP_GRANITE_TOWER_5F]      = IMAGE("sensor/granite_city/tower_5th_floor.png"),
-    [MAP_LAVATORY]              = IMAGE("sensor/granite_city/tower_bathroom.png"),
+    [MAP_OVERWORLD]             = SENSOR_IMAGE("sensor/kaido.png"),
+    [MAP_BOULDER_CAVE]          = SENSOR_IMAGE("sensor/boulder_cave.png"),
+    [MAP_FALLS_CAVE_1F]         = SENSOR_IMAGE("sensor/falls_cave_1st_floor.png"),
+    [MAP_FALLS_CAVE_B1F]        = SENSOR_IMAGE("sensor/falls_cave_basement.png"),
+    [MAP_GRANITE_CAVE_1F]       = SENSOR_IMAGE("sensor/granite_cave_1st_floor.png"),
+    [MAP_GRANITE_CAVE_B1F]      = SENSOR_IMAGE("sensor/granite_cave_basement.png"),
+    [MAP_NEW_LAND_CAVE]         = SENSOR_IMAGE("sensor/new_land_cave.png"),
+    [MAP_OXIDE_CRATER]          = SENSOR_IMAGE("sensor/oxide_crater.png"),
+    [MAP_SAPLING_YOUR_HOUSE]    = SENSOR_IMAGE("sensor/sapling_town/amy_house.png"),
+    [MAP_SAPLING_AIRPORT]       = SENSOR_IMAGE("sensor/sapling_town/airport.png"),
+    [MAP_SAPLING_HOSPITAL]      = SENSOR_IMAGE("sensor/sapling_town/hospital.png"),
+    [MAP_SAPLING_CITY_HALL]     = SENSOR_IMAGE("sensor/sapling_town/city_hall.png"),
+    [MAP_SAPLING_GREENHOUSE]    = SENSOR_IMAGE("sensor/sapling_town/greenhouse.png"),
+    [MAP_SAPLING_LABORATORY]    = SENSOR_IMAGE("sensor/sapling_town/laboratory.png"),
+    [MAP_ROYAL_HOSPITAL]        = SENSOR_IMAGE("sensor/port_royal/hospital.png"),
+    [MAP_ROYAL_WAREHOUSE]       = SENSOR_IMAGE("sensor/port_royal/warehouse.png"),
+    [MAP_ROYAL_PORT]            = SENSOR_IMAGE("sensor/port_royal/port.png"),
+    [MAP_SOLAR_AIRPORT]         = SENSOR_IMAGE("sensor/solar_city/airport.png"),
+    [MAP_SOLAR_HOSPITAL]        = SENSOR_IMAGE("sensor/solar_city/hospital.png"),
+    [MAP_SOLAR_EAST_CORP]       = SENSOR_IMAGE("sensor/solar_city/corporation_east.png"),
+    [MAP_SOLAR_WEST_CORP]       = SENSOR_IMAGE("sensor/solar_city/corporation_west.png"),
+    [MAP_SOLAR_INSTITUTE_1F]    = SENSOR_IMAGE("sensor/solar_city/institute_1st_floor.png"),
+    [MAP_SOLAR_INSTITUTE_2F]    = SENSOR_IMAGE("sensor/solar_city/institute_2nd_floor.png"),
+    [MAP_SOLAR_INSTITUTE_3F]    = SENSOR_IMAGE("sensor/solar_city/institute_3rd_floor.png"),
+    [MAP_GENERATOR_ROOM]        = SENSOR_IMAGE("sensor/solar_city/institute_generator_room.png"),
+    [MAP_REST_STOP]             = SENSOR_IMAGE("sensor/andora_falls/rest_stop.png"),
+    [MAP_ANDORA_HOSPITAL]       = SENSOR_IMAGE("sensor/andora_falls/hospital.png"),
+    [MAP_ANDORA_PORT]           = SENSOR_IMAGE("sensor/andora_falls/port.png"),
+    [MAP_GRANITE_AIRPORT]       = SENSOR_IMAGE("sensor/granite_city/airport.png"),
+    [MAP_GRANITE_AIR_EAST]      = SENSOR_IMAGE("sensor/granite_city/air_tower_east.png"),
+    [MAP_GRANITE_AIR_WEST]      = SENSOR_IMAGE("sensor/granite_city/air_tower_west.png"),
+    [MAP_GRANITE_CORP]          = SENSOR_IMAGE("sensor/granite_city/corporation.png"),
+    [MAP_GRANITE_DEPARTMENT]    = SENSOR_IMAGE("sensor/granite_city/department_store.png"),
+    [MAP_GAME_DESIGNER_ROOM]    = SENSOR_IMAGE("sensor/granite_city/game_designer_room.png"),
+    [MAP_GRANITE_HOSPITAL]      = SENSOR_IMAGE("sensor/granite_city/hospital.png"),
+    [MAP_GRANITE_LIBRARY]       = SENSOR_IMAGE("sensor/granite_city/library.png"),
+    [MAP_GRANITE_STORE_1]       = SENSOR_IMAGE("sensor/granite_city/store_1_through_5.png"),
+    [MAP_GRANITE_STORE_2]       = SENSOR_IMAGE("sensor/granite_city/store_1_through_5.png"),
+    [MAP_GRANITE_STORE_3]       = SENSOR_IMAGE("sensor/granite_city/store_1_through_5.png"),
+    [MAP_GRANITE_STORE_4]       = SENSOR_IMAGE("sensor/granite_city/store_1_through_5.png"),
+    [MAP_GRANITE_STORE_5]       = SENSOR_IMAGE("sensor/granite_city/store_1_through_5.png"),
+    [MAP_GRANITE_STORE_6]       = SENSOR_IMAGE("sensor/granite_city/store_6.png"),
+    [MAP_GRANITE_WAREHOUSE]     = SENSOR_IMAGE("sensor/granite_city/warehouse.png"),
+    [MAP_GRANITE_TOWER_1F]      = SENSOR_IMAGE("sensor/granite_city/tower_1st_floor.png"),
+    [MAP_GRANITE_TOWER_2F]      = SENSOR_IMAGE("sensor/granite_city/tower_2nd_floor.png"),
+    [MAP_GRANITE_TOWER_3F]      = SENSOR_IMAGE("sensor/granite_city/tower_3rd_floor.png"),
+    [MAP_GRANITE_TOWER_4F]      = SENSOR_IMAGE("sensor/granite_city/tower_4th_floor.png"),
+    [MAP_GRANITE_TOWER_5F]      = SENSOR_IMAGE("sensor/granite_city/tower_5th_floor.png"),
+    [MAP_LAVATORY]              = SENSOR_IMAGE("sensor/granite_city/tower_bathroom.png"),
 };
 
 /**********************************************************//**
@@ -343,7 +486,10 @@ static void LoadImageAssets(IMAGE_ASSET *assets, int nAssets) {
         // Only load if filename defined and image not loaded
         // already (pointer initialized to NULL).
         if (assets[i].Filename && assets[i].Filename[0] && !assets[i].Image) {
-            assets[i].Image = al_load_bitmap(assets[i].Filename);
+            if (assets[i].Optional && !al_filename_exists(assets[i].Filename)) {
+                continue;
+            }
+            assets[i].Image = al_load_bitmap_flags(assets[i].Filename, assets[i].Flags);
             if (!assets[i].Image) {
                 eprintf("Failed to load image \"%s\"!\n", assets[i].Filename);
                 LoadSuccess = false;
@@ -364,6 +510,59 @@ static void DestroyImageAssets(IMAGE_ASSET *assets, int nAssets) {
     }
 }
 
+/**********************************************************//**
+ * @brief Loads an array of animation assets. The atlas goes
+ * onto the GPU and the tile data is read into memory.
+ * @param assets: The array of asset data to load.
+ * @param nAssets: Size of the array.
+ **************************************************************/
+static void LoadAnimationAssets(ANIMATION_ASSET *assets, int nAssets) {
+    for (int i = 0; i < nAssets; i++) {
+        // Both files are optional, but one needs the other.
+        if (!assets[i].Filename || assets[i].Atlas || !al_filename_exists(assets[i].Filename)) {
+            continue;
+        }
+        assets[i].Atlas = al_load_bitmap(assets[i].Filename);
+        if (!assets[i].Atlas) {
+            eprintf("Failed to load image \"%s\"!\n", assets[i].Filename);
+            LoadSuccess = false;
+            continue;
+        }
+        ALLEGRO_FILE *file = al_fopen(assets[i].DataFilename, "rb");
+        if (!file) {
+            eprintf("Failed to open \"%s\"!\n", assets[i].DataFilename);
+            LoadSuccess = false;
+            continue;
+        }
+        int size = (int)al_fsize(file);
+        assets[i].Data = (size > 0)? (unsigned char *)malloc(size): NULL;
+        if (!assets[i].Data || al_fread(file, assets[i].Data, size) != (size_t)size) {
+            eprintf("Failed to read \"%s\"!\n", assets[i].DataFilename);
+            free(assets[i].Data);
+            assets[i].Data = NULL;
+            LoadSuccess = false;
+        } else {
+            assets[i].Size = size;
+        }
+        al_fclose(file);
+    }
+}
+
+/**********************************************************//**
+ * @brief Removes an array of animation assets from memory.
+ * @param assets: The assets to get rid of.
+ * @param nAssets: The number of assets.
+ **************************************************************/
+static void DestroyAnimationAssets(ANIMATION_ASSET *assets, int nAssets) {
+    for (int i = 0; i < nAssets; i++) {
+        al_destroy_bitmap(assets[i].Atlas);
+        free(assets[i].Data);
+        assets[i].Atlas = NULL;
+        assets[i].Data = NULL;
+        assets[i].Size = 0;
+    }
+}
+
 /**********************************************************//**
  * @brief Loads an array of font assets onto the GPU.
  * @param assets: Array of font assets.
@@ -408,6 +607,8 @@ bool LoadAssets(void) {
     LoadImageAssets(AilmentAssets, N_AILMENT);
     LoadImageAssets(TypeAssets, N_TYPE);
     LoadImageAssets(MapAssets, N_MAP);
+    LoadImageAssets(MapOverlayAssets, N_MAP);
+    LoadAnimationAssets(MapAnimationAssets, N_MAP);
     LoadImageAssets(SensorAssets, N_MAP);
     LoadImageAssets(PersonAssets, N_PERSON);
     LoadImageAssets(MiscAssets, N_MISC);
@@ -426,6 +627,8 @@ void DestroyAssets(void) {
     DestroyImageAssets(AilmentAssets, N_AILMENT);
     DestroyImageAssets(TypeAssets, N_TYPE);
     DestroyImageAssets(MapAssets, N_MAP);
+    DestroyImageAssets(MapOverlayAssets, N_MAP);
+    DestroyAnimationAssets(MapAnimationAssets, N_MAP);
     DestroyImageAssets(SensorAssets, N_MAP);
     DestroyImageAssets(PersonAssets, N_PERSON);
     DestroyImageAssets(MiscAssets, N_MISC);
@@ -495,6 +698,39 @@ ALLEGRO_BITMAP *MapImage(MAP_ID id) {
     return MapAssets[id].Image;
 }
 
+/**********************************************************//**
+ * @brief Gets a map overlay image asset.
+ * @param id: The identity of the map.
+ * @return Pointer to the ALLEGRO_BITMAP data, or NULL if the
+ * map has no overlay.
+ **************************************************************/
+ALLEGRO_BITMAP *MapOverlayImage(MAP_ID id) {
+    return MapOverlayAssets[id].Image;
+}
+
+/**********************************************************//**
+ * @brief Gets the frame atlas for a map's animated tiles.
+ * @param id: The identity of the map.
+ * @return Pointer to the ALLEGRO_BITMAP data, or NULL if the
+ * map has no animated tiles.
+ **************************************************************/
+ALLEGRO_BITMAP *MapAtlasImage(MAP_ID id) {
+    return MapAnimationAssets[id].Atlas;
+}
+
+/**********************************************************//**
+ * @brief Gets the animated tile data written by buildmap.py
+ * for a map.
+ * @param id: The identity of the map.
+ * @param size: Set to the size of the data in bytes.
+ * @return Pointer to the data, or NULL if the map has no
+ * animated tiles.
+ **************************************************************/
+const unsigned char *MapAnimationData(MAP_ID id, int *size) {
+    *size = MapAnimationAssets[id].Size;
+    return MapAnimationAssets[id].Data;
+}
+
 /**********************************************************//**
  * @brief Gets a sensor image asset.
  * @param id: The identity of the sensor image.
@@ -21,50 +21,92 @@
 #include "battle.h"             // TEAM
 #include "battle_menu.h"        // BattleMenu
 #include "type.h"               // TYPE
-#include "output.h"             // Output
+#include "output.h"             // Output, OutputMessage
+#include "debug.h"              // eprintf
+#include "encounter.h"          // ZoneEncounter, OverworldEncounter
+#include "battle_engine.h"      // BATTLE_CONTEXT
+#include "enemy_ai.h"           // StartEnemyAI
+#include "battle_log.h"         // BATTLE_LOG, SaveBattleLog
+#include "particle.h"           // StartParticleEffect
+#include "draw_list.h"          // ListBitmap, FlushDrawList
+#include "snapshot.h"           // BATTLE_SNAPSHOT
+#include "journal.h"            // JournalParty
+
+/**************************************************************/
+/// @brief Where the log of the last battle is saved.
+#define BATTLE_LOG_FILE "battle.log"
+
+/**********************************************************//**
+ * @struct HUD_STATE
+ * @brief Everything a battler's HUD shows. The HUD is only
+ * drawn again when one of these changes.
+ **************************************************************/
+typedef struct {
+    SPECIES_ID Species;         ///< Species shown, or 0 if not drawn yet.
+    int Level;                  ///< Level shown.
+    int Health;                 ///< Health shown.
+    int MaxHealth;              ///< Maximum health shown.
+    int Power;                  ///< Power shown.
+    int MaxPower;               ///< Maximum power shown.
+    AILMENT_ID Ailment;         ///< Ailment shown.
+} HUD_STATE;
 
 /**********************************************************//**
- * @enum BATTLE_STATE
- * @brief Controls how the battle is finished.
+ * @struct SCENE_BATTLER
+ * @brief Where and how one battler is drawn.
  **************************************************************/
-typedef enum {
-    BATTLE_STATE_INTRO,         ///< The battle is being introduced.
-    BATTLE_STATE_ACTIVE,        ///< Battle is ongoing.
-    BATTLE_STATE_WIN,           ///< The user won.
-    BATTLE_STATE_LOSE,          ///< The user lost.
-    BATTLE_STATE_ESCAPE,        ///< The user escaped.
-    BATTLE_STATE_NO_ESCAPE,     ///< The user failed to escape.
-    BATTLE_STATE_EXIT,          ///< The battle is just ending.
-} BATTLE_STATE;
+typedef struct {
+    COORDINATE Position;        ///< Center of the battler's feet.
+    ALLEGRO_BITMAP *Image;      ///< Sprite of the battler.
+    float ImageX;               ///< Left of the sprite.
+    float ImageY;               ///< Top of the sprite.
+    int Flags;                  ///< Set to flip enemies.
+    int HudX;                   ///< Left of the HUD.
+    int HudY;                   ///< Top of the HUD.
+    HUD_STATE Hud;              ///< What HudImage shows.
+    ALLEGRO_BITMAP *HudImage;   ///< The HUD, drawn ahead of time.
+    bool HudAlly;               ///< Set if HudImage is an ally's HUD.
+} SCENE_BATTLER;
+
+/**********************************************************//**
+ * @struct BATTLE_SCENE
+ * @brief Layout of the battle screen, worked out only when
+ * someone passes out or leaves the battle.
+ **************************************************************/
+typedef struct {
+    bool Ready;                         ///< Set once the layout is worked out.
+    int Active;                         ///< Bit set for each battler taking part.
+    int Alive;                          ///< Bit set for each battler standing.
+    int nSprites;                       ///< Number of sprites drawn.
+    int Sprites[BATTLE_LIMIT];          ///< IDs of the sprites in layer order.
+    ALLEGRO_BITMAP *Shadow;             ///< White drop shadow, tinted when drawn.
+    SCENE_BATTLER Battler[BATTLE_LIMIT]; ///< Layout of each battler.
+} BATTLE_SCENE;
 
 /**************************************************************/
-/// @brief Battlers in the player's team.
-static TEAM PlayerTeam;
+/// @brief The battle being played.
+static BATTLE_CONTEXT Battle;
 
-/// @brief Battlers in the enemy team.
-static TEAM EnemyTeam;
+/// @brief Layout of the battle screen.
+static BATTLE_SCENE Scene;
 
-/// @brief Pointer to a battler that was successfully captured
-/// during this turn, or NULL.
-static BATTLER *Captured = NULL;
+/// @brief Log of the battle being played or replayed.
+static BATTLE_LOG Log;
 
-/// @brief The state of the current battle.
-static BATTLE_STATE BattleState;
+/// @brief Position in the log while replaying.
+static BATTLE_REPLAY Replay;
 
-/// @brief Buffer for actions the battlers will take on this turn.
-static TURN Turns[BATTLE_SIZE];
+/// @brief Set while a logged battle is being replayed.
+static bool Replaying = false;
 
-/// @brief Turn being executed currently.
-static TURN *CurrentTurn = NULL;
+/// @brief How the enemy team chooses its turns.
+static ENEMY_AI EnemyAI = AI_RANDOM;
 
-/**********************************************************//**
- * @brief Gets the team the BATTLER belongs to.
- * @param id: BATTLER's unique ID.
- * @return Pointer to the BATTLER's team.
- **************************************************************/
-static inline bool BattlerIsAlly(int id) {
-    return (id<TEAM_SIZE);
-}
+/// @brief Milliseconds the enemy AI may think each round.
+static int EnemyBudget = 0;
+
+/**************************************************************/
+static void ShowTechnique(void *data, const BATTLE_NOTICE *notice);
 
 /**********************************************************//**
  * @brief Gets the BATTLER data from its ID.
@@ -72,11 +114,7 @@ static inline bool BattlerIsAlly(int id) {
  * @return Pointer to the BATTLER's data.
  **************************************************************/
 BATTLER *BattlerByID(int id) {
-    if (BattlerIsAlly(id)) {
-        return &PlayerTeam.Member[id];
-    } else {
-        return &EnemyTeam.Member[id-TEAM_SIZE];
-    }
+    return ContextBattler(&Battle, id);
 }
 
 /**********************************************************//**
@@ -85,59 +123,98 @@ BATTLER *BattlerByID(int id) {
  * @return Pointer to the TURN data.
  **************************************************************/
 TURN *TurnByID(int id) {
-    return &Turns[id];
+    return &Battle.Turns[id];
 }
 
 /**********************************************************//**
- * @brief Sets up the player's team.
+ * @brief Gets the size of the player's team. Battlers up to
+ * this ID are the player's.
+ * @return Number of battlers on the player's team.
  **************************************************************/
-static void InitializePlayerTeam(void) {
-    for (int id=0; id<TEAM_SIZE; id++) {
-        // Collect data that we'll use to set up the battler.
-        SPECTRA *spectra = &Player->Spectra[id];
-        BATTLER *battler = &PlayerTeam.Member[id];
-        
-        // Initialize battler data
-        if (spectra->Species) {
-            InitializeBattler(battler, spectra);
-        } else {
-            InitializeBattlerAsInactive(battler);
-        }
+int AllyCount(void) {
+    return Battle.nAllies;
+}
+
+/**********************************************************//**
+ * @brief Gets the number of battlers on both teams.
+ * @return Number of battlers.
+ **************************************************************/
+int BattlerCount(void) {
+    return Battle.nBattlers;
+}
+
+/**********************************************************//**
+ * @brief Works out the size of a team an encounter asks for.
+ * @param size: Size asked for, or 0 for TEAM_SIZE.
+ * @return The size, from 1 to TEAM_LIMIT.
+ **************************************************************/
+static int TeamSize(int size) {
+    if (size <= 0) {
+        return TEAM_SIZE;
     }
+    return (size > TEAM_LIMIT)? TEAM_LIMIT: size;
 }
 
 /**********************************************************//**
- * @brief Set up the enemy's team.
+ * @brief Adds a captured spectra to the player's party, or
+ * to storage if the party is full.
+ * @param spectra: The spectra captured.
+ **************************************************************/
+static void KeepCaptured(const SPECTRA *spectra) {
+    bool stored = PartyFull();
+    if (GetSpectra(spectra) && stored) {
+        Output("It was sent to storage.");
+    }
+}
+
+/**********************************************************//**
+ * @brief Sets up the battle between the player's team and
+ * the enemy's team. The battle works on copies of the party,
+ * which are returned by ReturnParty when it's over.
  * @param enemies: Basic ENEMY data to set up.
+ * @param nAllies: Size of the player's team, up to TEAM_LIMIT.
+ * @param nEnemies: Size of the enemy's team, up to TEAM_LIMIT.
  **************************************************************/
-static void InitializeEnemyTeam(const ENEMY *enemies) {
-    // Enemy team members will point into this static space when
-    // they are initialized.
-    static SPECTRA EnemySpectra[TEAM_SIZE];
-    for (int id=0; id<TEAM_SIZE; id++) {
-        BATTLER *enemy = &EnemyTeam.Member[id];
+static void InitializeTeams(const ENEMY *enemies, int nAllies, int nEnemies) {
+    SPECTRA enemySpectra[TEAM_LIMIT];
+    for (int id=0; id<nEnemies; id++) {
         if (enemies[id].Species) {
-            CreateSpectra(&EnemySpectra[id], enemies[id].Species, enemies[id].Level);
-            InitializeBattler(enemy, &EnemySpectra[id]);
+            CreateSpectra(&enemySpectra[id], enemies[id].Species, enemies[id].Level);
         } else {
-            EnemySpectra[id].Species = 0;
-            InitializeBattlerAsInactive(enemy);
+            enemySpectra[id].Species = 0;
         }
     }
+    InitializeBattleContext(&Battle, Player->Spectra, nAllies, enemySpectra, nEnemies);
+    // Anything that doesn't fit in the party goes to storage.
+    Battle.CaptureRoom = nEnemies;
+    Battle.Capture = KeepCaptured;
+    Battle.UseItem = DropItem;
+    Battle.Notify = ShowTechnique;
+    Scene.Ready = false;
+    ClearParticles();
+    StartBattleLog(&Battle, &Log);
+    Replaying = false;
 }
 
 /**********************************************************//**
- * @brief Generates a random ENEMY based on the encounters
- * defined for the map.
- * @param enemy: ENEMY to generate.
- * @param encounters: ENCOUNTER data from the map.
+ * @brief Copies the player's battlers back into the party
+ * once the battle is over.
  **************************************************************/
-static void RandomEnemy(ENEMY *enemy, const ENCOUNTER *encounters) {
-    int chance = randint(1, 100);
-    const ENCOUNTER *encounter = NULL;
-    for (int i=0, total=0; total<chance; total+=encounters[i++].Chance) {
-        encounter = &encounters[i];
+static void ReturnParty(void) {
+    for (int id=0; id<Battle.nAllies; id++) {
+        const BATTLER *battler = BattlerByID(id);
+        if (BattlerIsActive(battler)) {
+            Player->Spectra[id] = battler->Spectra;
+        }
     }
+}
+
+/**********************************************************//**
+ * @brief Sets up an enemy from an encounter.
+ * @param enemy: ENEMY data to initialize.
+ * @param encounter: The encounter rolled, or NULL.
+ **************************************************************/
+static void SetEnemy(ENEMY *enemy, const ENCOUNTER *encounter) {
     if (encounter) {
         enemy->Species = encounter->Spectra;
         enemy->Level = randint(encounter->LevelRange[0], encounter->LevelRange[1]);
@@ -154,11 +231,11 @@ static void RandomEnemy(ENEMY *enemy, const ENCOUNTER *encounters) {
  * @param type: The type of encounter happening.
  **************************************************************/
 static void IntroduceBattle(ENCOUNTER_TYPE type) {
-    BattleState = BATTLE_STATE_INTRO;
+    Battle.State = BATTLE_STATE_INTRO;
     int count = 0;
     const BATTLER *leader = NULL;
-    for (int i=0; i<TEAM_SIZE; i++) {
-        const BATTLER *battler = &EnemyTeam.Member[i];
+    for (int id=Battle.nAllies; id<Battle.nBattlers; id++) {
+        const BATTLER *battler = BattlerByID(id);
         if (BattlerIsActive(battler)) {
             if (!leader) {
                 leader = battler;
@@ -220,10 +297,12 @@ static void IntroduceBattle(ENCOUNTER_TYPE type) {
  * @brief Initializes setup for the current round of battle.
  **************************************************************/
 static void InitializeRound(void) {
-    CurrentTurn = NULL;
-    BattleState = BATTLE_STATE_ACTIVE;
-    for (int i=0; i<BATTLE_SIZE; i++) {
-        Turns[i].State = TURN_INACTIVE;
+    BeginRound(&Battle);
+    if (Replaying) {
+        return;
+    }
+    if (EnemyAI == AI_SEARCH) {
+        StartEnemyAI(&Battle, EnemyBudget);
     }
     InitializeBattleMenu();
 }
@@ -231,34 +310,28 @@ static void InitializeRound(void) {
 /**********************************************************//**
  * @brief Set up a new random encounter with spectra on the
  * overworld (normal or fishing).
- * @param count: Number of enemies.
+ * @param count: Number of enemies, up to TEAM_LIMIT.
  * @param type: Type of random encounter.
  **************************************************************/
 void InitializeRandomEncounter(int count, ENCOUNTER_TYPE type) {
-    // Get the encounter table
-    const ENCOUNTER *encounters = NULL;
-    switch (type) {
-    case ENCOUNTER_FISHING:
-        encounters = Location(Player->Location)->Fishing;
-        break;
-    case ENCOUNTER_OVERWORLD:
-        encounters = Location(Player->Location)->Encounters;
-        break;
-    default:
-        break;
-    }
+    // Tiles painted with an encounter zone roll from the
+    // zone's table instead of the location's.
+    int zone = (type == ENCOUNTER_OVERWORLD)? EncounterZone(): 0;
     
     // Get random enemies
-    ENEMY enemies[TEAM_SIZE];
-    for (int i=0; i<TEAM_SIZE; i++) {
-        if (i < count) {
-            RandomEnemy(&enemies[i], encounters);
+    count = TeamSize(count);
+    ENEMY enemies[TEAM_LIMIT];
+    for (int i=0; i<count; i++) {
+        if (zone) {
+            SetEnemy(&enemies[i], ZoneEncounter(Player->Location, zone));
+        } else if (type == ENCOUNTER_FISHING) {
+            SetEnemy(&enemies[i], FishingEncounter(Player->Location));
         } else {
-            enemies[i].Species = 0;
+            SetEnemy(&enemies[i], OverworldEncounter(Player->Location));
         }
     }
-    InitializeEnemyTeam(enemies);
-    InitializePlayerTeam();
+    InitializeTeams(enemies, TEAM_SIZE, count);
+    EnemyAI = AI_RANDOM;
     InitializeRound();
     IntroduceBattle(type);
 }
@@ -268,8 +341,9 @@ void InitializeRandomEncounter(int count, ENCOUNTER_TYPE type) {
  * @param bosses: Boss enemies to generate.
  **************************************************************/
 void InitializeBossEncounter(const BOSS *bosses) {
-    InitializeEnemyTeam(bosses->Boss);
-    InitializePlayerTeam();
+    InitializeTeams(bosses->Boss, TeamSize(bosses->Allies), TeamSize(bosses->Enemies));
+    EnemyAI = bosses->Ai;
+    EnemyBudget = bosses->Budget;
     InitializeRound();
     IntroduceBattle(ENCOUNTER_BOSS);
 }
@@ -282,24 +356,7 @@ void InitializeBossEncounter(const BOSS *bosses) {
  * @return Number of targets loaded.
  **************************************************************/
 int GetTargets(int *targets, int user, TARGET_TYPE type) {
-    int i = 0;
-    for (int id=0; id<BATTLE_SIZE; id++) {
-        const BATTLER *battler = BattlerByID(id);
-        // Can't target gone or incapacitated battlers
-        if (!BattlerIsAlive(battler)) {
-            continue;
-        } else if (type&TARGET_USER && id==user) {
-            // Targetting yourself
-            targets[i++] = id;
-        } else if (type&TARGET_ALLY && BattlerIsAlly(id)==BattlerIsAlly(user)) {
-            // Targetting any ally
-            targets[i++] = id;
-        } else if (type&TARGET_ENEMY && BattlerIsAlly(id)!=BattlerIsAlly(user)) {
-            // Targetting any enemy
-            targets[i++] = id;
-        }
-    }
-    return i;
+    return ContextTargets(&Battle, targets, user, type);
 }
 
 /**********************************************************//**
@@ -307,33 +364,7 @@ int GetTargets(int *targets, int user, TARGET_TYPE type) {
  * @return True if the battle was escaped.
  **************************************************************/
 bool EscapeBattle(void) {
-    // Get the escape chance
-    int ally = 0;
-    int enemy = 0;
-    for (int id=0; id<BATTLE_SIZE; id++) {
-        const BATTLER *battler = BattlerByID(id);
-        if (BattlerIsAlive(battler)) {
-            if (id<TEAM_SIZE) {
-                ally += BattlerEvade(battler)+BattlerLuck(battler);
-            } else {
-                enemy += BattlerEvade(battler);
-            }
-        }
-    }
-    assert(ally && enemy);
-    float chance = (float)ally / (ally+enemy);
-    
-    // Maybe escape
-    Output("The party tries to escape...");
-    if (uniform(0.0, 1.0) < chance) {
-        Output("And succeeds!");
-        BattleState = BATTLE_STATE_ESCAPE;
-        return true;
-    } else {
-        Output("And fails...");
-        BattleState = BATTLE_STATE_NO_ESCAPE;
-        return false;
-    }
+    return TryEscape(&Battle);
 }
 
 /**********************************************************//**
@@ -341,301 +372,12 @@ bool EscapeBattle(void) {
  * the current battle.
  **************************************************************/
 static void LoadEnemyTurns(void) {
-    for (int id=TEAM_SIZE; id<BATTLE_SIZE; id++) {
-        BATTLER *enemy = BattlerByID(id);
-        TURN *turn = &Turns[id];
-        if (BattlerIsAlive(enemy)) {
-            turn->State = TURN_PENDING;
-            turn->User = id;
-            
-            // Get a list of legal techniques to use here
-            TECHNIQUE_ID usableTechniques[MOVESET_SIZE+2];
-            usableTechniques[0] = DEFAULT_ATTACK;
-            usableTechniques[1] = DEFAULT_DEFEND;
-            int u = 2;
-            for (int t=0; t<enemy->Spectra->MovesetSize; t++) {
-                const TECHNIQUE *technique = TechniqueByID(enemy->Spectra->Moveset[t]);
-                if (technique->Cost > enemy->Spectra->Power) {
-                    continue;
-                }
-                usableTechniques[u++] = enemy->Spectra->Moveset[t];
-            }
-            turn->Technique = usableTechniques[randint(0,u-1)];
-            
-            // Get the primary target, if applicable
-            TARGET_TYPE type = TechniqueByID(turn->Technique)->Target;
-            if (type&TARGET_GROUP) {
-                turn->Target = -1;
-            } else {
-                int targets[BATTLE_SIZE];
-                int nTargets = GetTargets(targets, id, type);
-                turn->Target = targets[randint(0,nTargets-1)];
-            }
-        } else {
-            // Turn skipped
-            turn->State = TURN_INACTIVE;
-        }
-    }
-}
-
-/**********************************************************//**
- * @brief Attempts to capture the target.
- * @param battler: Target to capture.
- * @return True if the target was captured.
- **************************************************************/
-static bool ExecuteCapture(BATTLER *battler) {
-    // Determine if capture succeeds
-    int rate = BattlerSpecies(battler)->CatchRate;
-    float percent = (float)BattlerHealth(battler)/BattlerMaxHealth(battler);
-    
-    // Increased rate if ailed
-    switch (battler->Spectra->Ailment) {
-    case ASLEEP:
-    case BURIED:
-        rate += 10;
-        break;
-    case SHOCKED:
-        rate += 5;
-        break;
-    default:
-        break;
-    }
-    
-    // Test rate
-    OutputSplitByCR("...\r......\r.........");
-    int test = randint(0, 99);
-    int threshold = rate + (100-rate)*(1-percent)*(1-percent);
-    if (test < threshold) {
-        if (GetSpectra(battler->Spectra)) {
-            Output("The capture succeeded!");
-            Captured = battler;
-            return true;
-        } else {
-            Output("You can't capture any more!");
-        }
-    } else if (test-10 < threshold) {
-        Output("It just got away...");
-    } else if (test-20 < threshold) {
-        Output("It managed to break free!");
-    } else {
-        Output("The capture failed!");
-    }
-    return false;
-}
-
-static float HitRate(int uid, int tid, const TECHNIQUE *technique) {
-    if (uid==tid) {
-        // Can't miss yourself
-        return 1.0;
-    } else if (BattlerIsAlly(uid)==BattlerIsAlly(tid) && technique->Power==0) {
-        // Can't miss an ally with non-damaging attack
-        return 1.0;
-    } else {
-        // Can never have worse than 50% chance to hit.
-        const BATTLER *user = BattlerByID(uid);
-        const BATTLER *target = BattlerByID(tid);
-        float base = (float)BattlerLuck(user)/BattlerEvade(target);
-        return (base < 0.5)? 0.5: base;
-    }
-}
-
-static float CriticalHitRate(const BATTLER *user, const BATTLER *target) {
-    float ratio = (float)BattlerLuck(user)/BattlerLuck(target);
-    
-    // Minimum critical hit rate:  0%
-    // Average critical hit rate: 10%
-    // Maximum critical hit rate: 20%
-    float base = 0.1*ratio;
-    return (base > 0.2)? 0.2: base;
-}
-
-/**********************************************************//**
- * @brief Performs one turn during battle.
- * @param turn: Turn to execute.
- **************************************************************/
-static void ExecuteTurn(const TURN *turn) {
-    // Get the targets of the technique
-    int Targets[BATTLE_SIZE];
-    TARGET_TYPE targetType = TechniqueByID(turn->Technique)->Target;
-    int nTargets;
-    if (targetType & TARGET_GROUP) {
-        nTargets = GetTargets(Targets, turn->User, targetType);
-    } else {
-        Targets[0] = turn->Target;
-        nTargets = 1;
-    }
-    
-    // Maybe fail if there are status conditions
-    BATTLER *user = BattlerByID(turn->User);
-    const TECHNIQUE *technique = TechniqueByID(turn->Technique);
-    switch (user->Spectra->Ailment) {
-    case SHOCKED:
-        if (uniform(0.0,1.0)<0.5) {
-            OutputF("%s can't move...", BattlerName(user));
-            return;
-        }
-        break;
-    case BURIED:
-        OutputF("%s is buried in the ground...", BattlerName(user));
-        user->Spectra->Ailment = 0;
-        return;
-    case ASLEEP:
-        OutputF("%s is fast asleep...", BattlerName(user));
-        return;
-    default:
-        break;
-    }
-    
-    // Spend P
-    if (BattlerPower(user) >= technique->Cost) {
-        user->Spectra->Power -= technique->Cost;
-    } else {
-        OutputF("%s is out of power!", BattlerName(user));
-        return;
-    }
-    
-    // Perform the turn
-    bool allInvalid = true;
-    for (int i=0; i<nTargets; i++) {
-        BATTLER *target = BattlerByID(Targets[i]);
-        if (!BattlerIsAlive(target)) {
-            continue;
-        }
-        allInvalid = false;
-        
-        // Maybe miss the target
-        if (uniform(0.0, 1.0) > HitRate(turn->User, Targets[i], technique)) {
-            OutputF("%s avoided the attack!", BattlerName(target));
-            continue;
-        }
-        
-        // Inflict damage
-        int damage = 0;
-        if (technique->Power) {
-            float ratio = (float)BattlerAttack(user)/BattlerDefend(target);
-            float scale = (float)user->Spectra->Level/LEVEL_MAX;
-            const TYPE_ID *targetType = SpeciesByID(target->Spectra->Species)->Type;
-            float matchup = TypeMatchup(technique->Type, targetType[0]);
-            if (targetType[1]) {
-                matchup *= TypeMatchup(technique->Type, targetType[1]);
-            }
-            float power = (technique->Power>10)? (technique->Power-10)*scale+10: 10;
-            damage = 1 + power*ratio*matchup;
-            
-            // Maybe critical hit?
-            if (uniform(0.0, 1.0) < CriticalHitRate(user, target)) {
-                damage *= 2;
-                OutputF("A critical hit on %s!", BattlerName(target));
-            }
-            
-            // Inflict damage
-            target->Spectra->Health -= damage;
-            if (target->Spectra->Health < 0) {
-                target->Spectra->Health = 0;
-            }
-            
-            // Messages
-            if (damage) {
-                OutputF("%s took %d damage!", BattlerName(target), damage);
-                if (!BattlerIsAlive(target)) {
-                    OutputF("%s passed out!", BattlerName(target));
-                }
-            } else {
-                OutputF("%s didn't take any damage!", BattlerName(target));
-            }
-        }
-        
-        // Apply effect if applicable
-        if (BattlerIsAlive(target) && !(technique->Flags&TECHNIQUE_EFFECT_ONCE)) {
-            const ITEM *item;
-            switch (turn->Technique) {
-            case DEFAULT_ITEM:
-                item = ItemByID(turn->Item);
-                if (item->Flags&BATTLE_ONLY) {
-                    if (ApplyEffectInBattle(item->Effect, user, target, item->Argument)) {
-                        DropItem(turn->Item);
-                    } else {
-                        Output("There was no effect...");
-                    }
-                } else {
-                    Output("That's not useful right now!");
-                }
-                
-                break;
-            
-            case CAPTURE:
-                ExecuteCapture(target);
-                break;
-            
-            default:
-                if (ShouldEffectActivate(technique->Effect, technique->Argument)) {
-                    ApplyEffectInBattle(technique->Effect, user, target, technique->Argument);
-                } else if (!technique->Power) {
-                // Technique doesn't do damage, and effect missed.
-                OutputF("%s avoided the attack!", BattlerName(target));
-                }
-                break;
-            }
-        }
-    }
-    
-    // All invalid targets?
-    if (allInvalid) {
-        Output("There was no target...");
-    }
-    
-    // Perform effect if it activates after all targets are hit
-    if (technique->Flags&TECHNIQUE_EFFECT_ONCE) {
-        if (ShouldEffectActivate(technique->Effect, technique->Argument)) {
-            ApplyEffectInBattle(technique->Effect, user, NULL, technique->Argument);
-        }
-    }
-}
-
-/**********************************************************//**
- * @brief Check if the battle shound end.
- **************************************************************/
-static void MaybeUpdateBattleState(void) {
-    // No point calling this again
-    if (BattleState != BATTLE_STATE_ACTIVE) {
+    if (EnemyAI == AI_SEARCH) {
+        FinishEnemyAI(&Battle);
         return;
     }
-    
-    // Clean up any dead battlers
-    bool win = true;
-    bool lose = true;
-    for (int id=0; id<BATTLE_SIZE; id++) {
-        BATTLER *battler = BattlerByID(id);
-        if(BattlerIsAlive(battler)) {
-            if (BattlerIsAlly(id)) {
-                lose = false;
-            } else {
-                win = false;
-            }
-        }
-    }
-    
-    // If it's a tie, you lose.
-    if (lose) {
-        BattleState = BATTLE_STATE_LOSE;
-        Output("You lost!");
-    } else if (win) {
-        BattleState = BATTLE_STATE_WIN;
-        Output("You won!");
-    }
-}
-
-/**********************************************************//**
- * @brief Gets the turn priority for a battler.
- * @param battler: Battler to check.
- * @return Priority
- **************************************************************/
-static inline int Priority(const BATTLER *battler) {
-    int evade = BattlerEvade(battler);
-    if (battler->Spectra->Ailment==SHOCKED) {
-        return evade/2;
-    } else {
-        return evade;
+    for (int id=Battle.nAllies; id<Battle.nBattlers; id++) {
+        ChooseRandomTurn(&Battle, id);
     }
 }
 
@@ -645,39 +387,24 @@ static inline int Priority(const BATTLER *battler) {
  **************************************************************/
 static void UpdateBattleExecution(void) {
     // Update to the next turn; if needed.
-    if (!CurrentTurn || CurrentTurn->State==TURN_DONE) {
-        CurrentTurn = NULL;
-        int maxPriority = 0;
-        for (int id=0; id<BATTLE_SIZE; id++) {
-            BATTLER *battler = BattlerByID(id);
-            if (Turns[id].State == TURN_PENDING) {
-                if (BattlerIsAlive(battler)) {
-                    int priority = Priority(BattlerByID(id));
-                    if (priority > maxPriority || !CurrentTurn) {
-                        maxPriority = priority;
-                        CurrentTurn = &Turns[id];
-                    }
-                } else {
-                    // Inactivate turns for dead battlers
-                    Turns[id].State = TURN_INACTIVE;
-                }
-            }
-        }
-        if (!CurrentTurn) {
+    TURN *turn = (Battle.CurrentTurn<0)? NULL: &Battle.Turns[Battle.CurrentTurn];
+    if (!turn || turn->State==TURN_DONE) {
+        turn = NextTurn(&Battle);
+        if (!turn) {
             return;
         }
     }
     
     // Execute the current turn
-    switch (CurrentTurn->State) {
+    switch (turn->State) {
     case TURN_PENDING:
-        CurrentTurn->State = TURN_ACTIVE;
-        if (CurrentTurn->Technique==DEFAULT_ITEM) {
-            const ITEM *item = ItemByID(CurrentTurn->Item);
-            OutputF("%s used %s!", BattlerNameByID(CurrentTurn->User), item->Name);
+        turn->State = TURN_ACTIVE;
+        if (turn->Technique==DEFAULT_ITEM) {
+            const ITEM *item = ItemByID(turn->Item);
+            OutputMessage(MESSAGE_USED, BattlerNameByID(turn->User), item->Name);
         } else {
-            const TECHNIQUE *technique = TechniqueByID(CurrentTurn->Technique);
-            OutputF("%s used %s!", BattlerNameByID(CurrentTurn->User), technique->Name);
+            const TECHNIQUE *technique = TechniqueByID(turn->Technique);
+            OutputMessage(MESSAGE_USED, BattlerNameByID(turn->User), technique->Name);
         }
         break;
     
@@ -685,8 +412,8 @@ static void UpdateBattleExecution(void) {
         // Await previous phase completion
         UpdateOutput();
         if (OutputDone()) {
-            CurrentTurn->State = TURN_RESULT;
-            ExecuteTurn(CurrentTurn);
+            turn->State = TURN_RESULT;
+            ExecuteTurn(&Battle, turn);
         }
         break;
     
@@ -694,12 +421,7 @@ static void UpdateBattleExecution(void) {
         // Await previous phase completion
         UpdateOutput();
         if (OutputDone()) {
-            if (Captured) {
-                Captured->Spectra = 0;
-                Captured = NULL;
-            }
-            CurrentTurn->State = TURN_DONE;
-            MaybeUpdateBattleState();
+            FinishTurn(&Battle, turn);
         }
         break;
     default:
@@ -707,86 +429,6 @@ static void UpdateBattleExecution(void) {
     }
 }
 
-/**********************************************************//**
- * @brief Determines if the battle execution step has finished.
- * @return True if battle execution is done and we should go
- * to the next turn.
- **************************************************************/
-static bool BattleExecutionDone(void) {
-    for (int i=0; i<BATTLE_SIZE; i++) {
-        switch (Turns[i].State) {
-        case TURN_PENDING:
-        case TURN_ACTIVE:
-        case TURN_RESULT:
-            return false;
-        case TURN_INACTIVE:
-        case TURN_DONE:
-        default:
-            break;
-        }
-    }
-    return true;
-}
-
-/**********************************************************//**
- * @brief Apply effects to battlers at the end of each round.
- **************************************************************/
-static void ApplyEndOfRoundEffects(void) {
-    for (int id=0; id<BATTLE_SIZE; id++) {
-        BATTLER *battler = BattlerByID(id);
-        if (!BattlerIsAlive(battler)) {
-            continue;
-        }
-        
-        // Unset the battler's flags.
-        battler->Flags = 0;
-        
-        // Apply status ailments
-        int damage;
-        switch (battler->Spectra->Ailment) {
-        case ASLEEP:
-            if (uniform(00.0,1.0)<0.5) {
-                OutputF("%s woke up!", BattlerName(battler));
-                battler->Spectra->Ailment =0;
-            }
-            break;
-        
-        case POISONED:
-            damage = 1 + BattlerMaxHealth(battler)/8;
-            battler->Spectra->Health -= damage;
-            if (battler->Spectra->Health < 0) {
-                battler->Spectra->Health = 0;
-            }
-            OutputF("%s took %d damage from poison!", BattlerName(battler), damage);
-            if (!BattlerIsAlive(battler)) {
-                OutputF("%s passed out!", BattlerName(battler));
-            }
-            break;  
-            
-        case AFLAME:
-            damage = 1 + BattlerMaxHealth(battler)/8;
-            battler->Spectra->Health -= damage;
-            if (battler->Spectra->Health < 0) {
-                battler->Spectra->Health = 0;
-            }
-            OutputF("%s took %d damage from fire!", BattlerName(battler), damage);
-            if (!BattlerIsAlive(battler)) {
-                OutputF("%s passed out!", BattlerName(battler));
-            }
-            break;
-            
-        default:
-            break;
-        }
-        
-        // Check win and lose conditions
-        MaybeUpdateBattleState();
-        if (BattleState!=BATTLE_STATE_ACTIVE) {
-            return;
-        }
-    }
-}
-
 /**********************************************************//**
  * @brief Give experience to a spectra.
  * @param spectra: Spectra to gain experience.
@@ -800,7 +442,7 @@ static void GainExperience(SPECTRA *spectra, int experience) {
         
         // Manage level-up
         const SPECIES *species = SpeciesOfSpectra(spectra);
-        OutputF("%s gained %d experience!", species->Name, experience);
+        OutputMessage(MESSAGE_EXPERIENCE, species->Name, experience);
         spectra->Experience -= experience;
         int gained = 0;
         while (spectra->Experience <= 0 && spectra->Level < LEVEL_MAX) {
@@ -817,9 +459,9 @@ static void GainExperience(SPECTRA *spectra, int experience) {
             
             // Output level gains.
             if (gained == 1) {
-                OutputF("%s's level went up!\n", species->Name);
+                OutputMessage(MESSAGE_LEVEL_UP, species->Name);
             } else if (gained > 1) {
-                OutputF("%s's level went up by %d!\n", species->Name, gained);
+                OutputMessage(MESSAGE_LEVELS_UP, species->Name, gained);
             }
             
             // Health gain
@@ -836,40 +478,96 @@ static void GainExperience(SPECTRA *spectra, int experience) {
 void ApplyWinEffects(void) {
     int experience = 0;
     int money = 0;
-    for (int id=TEAM_SIZE; id<BATTLE_SIZE; id++) {
+    for (int id=Battle.nAllies; id<Battle.nBattlers; id++) {
         BATTLER *battler = BattlerByID(id);
         if (!BattlerIsActive(battler)) {
             continue;
         }
         
         // Gain exp from this battler
-        experience += BattlerSpecies(battler)->Experience*battler->Spectra->Level/5;
+        experience += BattlerSpecies(battler)->Experience*battler->Spectra.Level/5;
         money += BattlerSpecies(battler)->Money;
     }
     
     // Each user gains experience
-    for (int id=0; id<TEAM_SIZE; id++) {
+    for (int id=0; id<Battle.nAllies; id++) {
         BATTLER *battler = BattlerByID(id);
         if (!BattlerIsAlive(battler)) {
             continue;
         }
         
         // This user's spectra gains the experience
-        GainExperience(battler->Spectra, experience);
+        GainExperience(&Player->Spectra[id], experience);
     }
     
     // You gain money
     if (money) {
-        OutputF("Gained $%.2f", (double)money);
+        OutputMessage(MESSAGE_MONEY, (double)money);
         Player->Money += money;
     }
 }
 
+/**********************************************************//**
+ * @brief Loads the next round of a replay. Holding MENU skips
+ * straight to the end.
+ **************************************************************/
+static void UpdateReplay(void) {
+    if (KeyDown(KEY_MENU)) {
+        MuteOutput(true);
+        FastForwardReplay(&Replay, &Battle);
+        MuteOutput(false);
+        Output("Fast-forwarded to the end.");
+        if (Battle.State == BATTLE_STATE_ACTIVE) {
+            Battle.State = BATTLE_STATE_EXIT;
+        }
+        return;
+    }
+    switch (ReplayNext(&Replay, &Battle)) {
+    case REPLAY_ROUND:
+        break;
+    case REPLAY_ESCAPE:
+        TryEscape(&Battle);
+        break;
+    case REPLAY_END:
+        Output("That's the end of the log.");
+        Battle.State = BATTLE_STATE_EXIT;
+        break;
+    }
+}
+
+/**********************************************************//**
+ * @brief Replays the last battle from its log, exactly as it
+ * happened. Nothing in the replay affects the player.
+ * @return True if there was a log that fits on the screen.
+ **************************************************************/
+bool ReplayLastBattle(void) {
+    if (!LoadBattleLog(&Log, BATTLE_LOG_FILE)) {
+        return false;
+    }
+    // Logs from battlesim can be bigger than the screen holds.
+    const BATTLE_LOG_HEADER *header = &Log.Header;
+    if (header->nAllies > TEAM_LIMIT || header->nBattlers-header->nAllies > TEAM_LIMIT) {
+        eprintf("The logged battle is too big to show.\n");
+        return false;
+    }
+    StartReplay(&Replay, &Log, &Battle);
+    Battle.Notify = ShowTechnique;
+    Scene.Ready = false;
+    ClearParticles();
+    Replaying = true;
+    EnemyAI = AI_RANDOM;
+    Battle.State = BATTLE_STATE_INTRO;
+    Output("Replaying the last battle...");
+    SetMode(MODE_BATTLE);
+    return true;
+}
+
 /**********************************************************//**
  * @brief Updates one step of the battle system.
  **************************************************************/
 void UpdateBattle(void) {
-    switch (BattleState) {
+    UpdateParticles(LastFrameTime());
+    switch (Battle.State) {
     case BATTLE_STATE_INTRO:
         // Happens once at the start of each battle
         UpdateOutput();
@@ -880,16 +578,19 @@ void UpdateBattle(void) {
 
     case BATTLE_STATE_ACTIVE:
         // Typical ongoing battle
-        if (!BattleMenuDone()) {
+        if (Replaying && RoundDone(&Battle) && OutputDone()) {
+            UpdateReplay();
+        } else if (!Replaying && !BattleMenuDone()) {
             UpdateBattleMenu();
             // Get enemy turns
             if (BattleMenuDone()) {
                 LoadEnemyTurns();
+                CommitTurns(&Battle);
             }
-        } else if (!BattleExecutionDone()) {
+        } else if (!RoundDone(&Battle)) {
             UpdateBattleExecution();
-            if (BattleExecutionDone()) {
-                ApplyEndOfRoundEffects();
+            if (RoundDone(&Battle)) {
+                ApplyEndOfRoundEffects(&Battle);
                 if (OutputDone()) {
                     InitializeRound();
                 }
@@ -905,171 +606,440 @@ void UpdateBattle(void) {
     case BATTLE_STATE_NO_ESCAPE:
         UpdateOutput();
         if (OutputDone()) {
-            BattleState = BATTLE_STATE_ACTIVE;
+            Battle.State = BATTLE_STATE_ACTIVE;
         }
         break;
     
     // End conditions
     case BATTLE_STATE_WIN:
         UpdateOutput();
-        if (OutputDone()) {
+        if (OutputDone() && Replaying) {
+            Battle.State = BATTLE_STATE_EXIT;
+        } else if (OutputDone()) {
+            ReturnParty();
             ApplyWinEffects();
-            BattleState = BATTLE_STATE_EXIT;
+            Battle.State = BATTLE_STATE_EXIT;
         }
         break;
     
     case BATTLE_STATE_LOSE:
         UpdateOutput();
-        if (OutputDone()) {
+        if (OutputDone() && Replaying) {
+            Battle.State = BATTLE_STATE_EXIT;
+        } else if (OutputDone()) {
+            ReturnParty();
             WarpToLastHospital();
             RecoverParty();
-            BattleState = BATTLE_STATE_EXIT;
+            Battle.State = BATTLE_STATE_EXIT;
         }
         break;
 
     case BATTLE_STATE_ESCAPE:
         UpdateOutput();
         if (OutputDone()) {
-            BattleState = BATTLE_STATE_EXIT;
+            if (!Replaying) {
+                ReturnParty();
+            }
+            Battle.State = BATTLE_STATE_EXIT;
         }
         break;
     
     case BATTLE_STATE_EXIT:
         UpdateOutput();
         if (OutputDone()) {
+            StopEnemyAI();
+            if (!Replaying && Battle.Log && !SaveBattleLog(&Log, BATTLE_LOG_FILE)) {
+                eprintf("Failed to save %s\n", BATTLE_LOG_FILE);
+            }
             RecoverPartyPower();
+            if (!Replaying) {
+                // Experience, health and winnings aren't
+                // journaled one by one.
+                JournalParty();
+                Journal(JOURNAL_MONEY, Player->Money);
+            }
+            Replaying = false;
             SetMode(MODE_MAP);
         }
         break;
     }
 }
 
-static inline COORDINATE BattlerPosition(int current) {
-    int activeCount = 0;
-    COORDINATE position;
-    if (BattlerIsAlly(current)) {
-        for (int id=0; id<TEAM_SIZE; id++) {
-            const BATTLER *battler = BattlerByID(id);
-            if (BattlerIsActive(battler)) {
-                activeCount++;
-            }
+
+/**********************************************************//**
+ * @brief Checks if the battle can be snapshotted, which is
+ * only while the player is choosing turns.
+ * @return True if the battle is waiting on the player.
+ **************************************************************/
+bool BattleSnapshotReady(void) {
+    return Battle.State == BATTLE_STATE_ACTIVE && !Replaying
+        && OutputDone() && !BattleMenuDone();
+}
+
+/**********************************************************//**
+ * @brief Saves the state of the battle.
+ * @param snapshot: Where to save it.
+ **************************************************************/
+void SnapshotBattle(BATTLE_SNAPSHOT *snapshot) {
+    CopyBattleContext(&snapshot->Context, &Battle);
+    snapshot->EnemyAI = EnemyAI;
+    snapshot->EnemyBudget = EnemyBudget;
+}
+
+/**********************************************************//**
+ * @brief Puts the battle back the way it was, with the
+ * player choosing turns again.
+ * @param snapshot: The saved state.
+ **************************************************************/
+void RestoreBattleSnapshot(const BATTLE_SNAPSHOT *snapshot) {
+    StopEnemyAI();
+    CopyBattleContext(&Battle, &snapshot->Context);
+    Battle.Capture = KeepCaptured;
+    Battle.UseItem = DropItem;
+    Battle.Notify = ShowTechnique;
+    // The log no longer matches what happened, so stop
+    // recording it rather than save a broken replay.
+    Battle.Log = NULL;
+    EnemyAI = snapshot->EnemyAI;
+    EnemyBudget = snapshot->EnemyBudget;
+    Replaying = false;
+    Scene.Ready = false;
+    ClearParticles();
+    if (EnemyAI == AI_SEARCH) {
+        StartEnemyAI(&Battle, EnemyBudget);
+    }
+    InitializeBattleMenu();
+}
+
+/**********************************************************//**
+ * @brief Drops the battle being played, without returning
+ * the party or saving the log.
+ **************************************************************/
+void AbandonBattle(void) {
+    StopEnemyAI();
+    ClearParticles();
+    Replaying = false;
+}
+
+/**********************************************************//**
+ * @brief Checks if one sprite is drawn behind another. Sprites
+ * further up the screen are behind, and enemies are behind
+ * allies standing level with them.
+ * @param a: ID of one battler.
+ * @param b: ID of the other battler.
+ * @return True if a is drawn before b.
+ **************************************************************/
+static bool SpriteBehind(int a, int b) {
+    int ay = Scene.Battler[a].Position.Y;
+    int by = Scene.Battler[b].Position.Y;
+    if (ay != by) {
+        return ay < by;
+    }
+    return !BattlerIsAlly(&Battle, a) && BattlerIsAlly(&Battle, b);
+}
+
+/**********************************************************//**
+ * @brief Works out where every battler and HUD goes. Each
+ * team stands in a line through its own center, and closes
+ * up once there are more than TEAM_SIZE of them, so however
+ * many are taking part they fill the same space.
+ **************************************************************/
+static void LayoutScene(void) {
+    int count[2] = {0, 0};
+    for (int id=0; id<Battle.nBattlers; id++) {
+        if (BattlerIsActive(BattlerByID(id))) {
+            count[!BattlerIsAlly(&Battle, id)]++;
         }
-        position.X = 60  + (TEAM_SIZE-activeCount)*25 + 50*current;
-        position.Y = 260 - (TEAM_SIZE-activeCount)*10 - 20*current;
-    } else {
-        for (int id=TEAM_SIZE; id<BATTLE_SIZE; id++) {
-            const BATTLER *battler = BattlerByID(id);
-            if (BattlerIsActive(battler)) {
-                activeCount++;
-            }
+    }
+    int index[2] = {0, 0};
+    for (int id=0; id<Battle.nBattlers; id++) {
+        SCENE_BATTLER *scene = &Scene.Battler[id];
+        const BATTLER *battler = BattlerByID(id);
+        if (!BattlerIsActive(battler)) {
+            scene->Image = NULL;
+            continue;
+        }
+        bool ally = BattlerIsAlly(&Battle, id);
+        int n = count[!ally];
+        int i = index[!ally]++;
+        float step = (n > TEAM_SIZE)? 50.0*(TEAM_SIZE-1)/(n-1): 50.0;
+        float along = step*(i-(n-1)/2.0);
+        scene->Position.X = (ally? 110: 370) + along;
+        scene->Position.Y = 240 + (ally? -0.4: 0.4)*along;
+
+        // Flip enemies
+        SPECIES_ID speciesID = battler->Spectra.Species;
+        const COORDINATE *offset = &SpeciesByID(speciesID)->Offset;
+        scene->Image = (speciesID==AMY)? CostumeImage(Player->Costume): SpeciesImage(speciesID);
+        if (ally) {
+            scene->ImageX = scene->Position.X - offset->X;
+            scene->Flags = 0;
+            scene->HudX = 4;
+        } else {
+            int flipped = al_get_bitmap_width(scene->Image) - offset->X;
+            scene->ImageX = scene->Position.X - flipped;
+            scene->Flags = ALLEGRO_FLIP_HORIZONTAL;
+            scene->HudX = 275;
+        }
+        scene->HudY = 4 + 29*i;
+        scene->ImageY = scene->Position.Y - offset->Y;
+    }
+
+    // Draw existing spectra back to front
+    Scene.nSprites = 0;
+    for (int id=0; id<Battle.nBattlers; id++) {
+        if (!BattlerIsAlive(BattlerByID(id))) {
+            continue;
+        }
+        int at = Scene.nSprites++;
+        while (at > 0 && SpriteBehind(id, Scene.Sprites[at-1])) {
+            Scene.Sprites[at] = Scene.Sprites[at-1];
+            at--;
+        }
+        Scene.Sprites[at] = id;
+    }
+}
+
+/**********************************************************//**
+ * @brief Lays the scene out again if anyone has passed out
+ * or left the battle since it was last laid out.
+ **************************************************************/
+static void UpdateSceneLayout(void) {
+    int active = 0;
+    int alive = 0;
+    for (int id=0; id<Battle.nBattlers; id++) {
+        const BATTLER *battler = BattlerByID(id);
+        active |= BattlerIsActive(battler) << id;
+        alive |= BattlerIsAlive(battler) << id;
+    }
+    if (!Scene.Ready || active != Scene.Active || alive != Scene.Alive) {
+        Scene.Ready = true;
+        Scene.Active = active;
+        Scene.Alive = alive;
+        LayoutScene();
+    }
+}
+
+/**********************************************************//**
+ * @brief Creates a blank image to draw part of the scene on.
+ * @param width: Width of the image.
+ * @param height: Height of the image.
+ * @return The image, or NULL on failure.
+ **************************************************************/
+static ALLEGRO_BITMAP *CreateSceneImage(int width, int height) {
+    ALLEGRO_BITMAP *image = al_create_bitmap(width, height);
+    if (!image) {
+        eprintf("Failed to create a battle scene image.\n");
+        return NULL;
+    }
+    return image;
+}
+
+/**********************************************************//**
+ * @brief Draws a battler's HUD onto its image if anything on
+ * it has changed.
+ * @param id: ID of the battler.
+ **************************************************************/
+static void UpdateSceneHud(int id) {
+    SCENE_BATTLER *scene = &Scene.Battler[id];
+    bool ally = BattlerIsAlly(&Battle, id);
+    if (scene->HudImage && scene->HudAlly != ally) {
+        // The battler changed sides since the last battle.
+        al_destroy_bitmap(scene->HudImage);
+        scene->HudImage = NULL;
+    }
+    const SPECTRA *spectra = &BattlerByID(id)->Spectra;
+    HUD_STATE hud = {
+        .Species = spectra->Species,
+        .Level = spectra->Level,
+        .Health = spectra->Health,
+        .MaxHealth = spectra->MaxHealth,
+        .Power = spectra->Power,
+        .MaxPower = spectra->MaxPower,
+        .Ailment = spectra->Ailment,
+    };
+    if (scene->HudImage
+    && hud.Species == scene->Hud.Species
+    && hud.Level == scene->Hud.Level
+    && hud.Health == scene->Hud.Health
+    && hud.MaxHealth == scene->Hud.MaxHealth
+    && hud.Power == scene->Hud.Power
+    && hud.MaxPower == scene->Hud.MaxPower
+    && hud.Ailment == scene->Hud.Ailment) {
+        return;
+    }
+    if (!scene->HudImage) {
+        ALLEGRO_BITMAP *window = WindowImage(ally? HUD_USER: HUD_ENEMY);
+        scene->HudImage = CreateSceneImage(al_get_bitmap_width(window), al_get_bitmap_height(window));
+        if (!scene->HudImage) {
+            return;
         }
-        position.X = 320 + (TEAM_SIZE-activeCount)*25 + 50*(current-TEAM_SIZE);
-        position.Y = 220 + (TEAM_SIZE-activeCount)*10 + 20*(current-TEAM_SIZE);
+        scene->HudAlly = ally;
+    }
+    scene->Hud = hud;
+
+    // Keep the alpha of the window, so the image draws the
+    // same way the window would have.
+    ALLEGRO_STATE state;
+    FlushDrawList();
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP|ALLEGRO_STATE_BLENDER);
+    al_set_target_bitmap(scene->HudImage);
+    al_set_separate_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA, ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_INVERSE_ALPHA);
+    al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+    DrawAt(0, 0);
+    if (ally) {
+        DrawHudUser(spectra);
+    } else {
+        DrawHudEnemy(spectra);
+    }
+    FlushDrawList();
+    al_restore_state(&state);
+}
+
+/**********************************************************//**
+ * @brief Draws the white drop shadow every battler shares.
+ * @return True on success.
+ **************************************************************/
+static bool CreateSceneShadow(void) {
+    Scene.Shadow = CreateSceneImage(80, 20);
+    if (!Scene.Shadow) {
+        return false;
+    }
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP);
+    al_set_target_bitmap(Scene.Shadow);
+    al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+    DrawAt(0, 0);
+    al_draw_filled_ellipse(40, 10, 40, 10, al_map_rgb(255, 255, 255));
+    al_restore_state(&state);
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Starts the particle effect for a technique when it
+ * hits, centered on the target. Critical hits get twice the
+ * particles.
+ * @param data: Unused.
+ * @param notice: What happened.
+ **************************************************************/
+static void ShowTechnique(void *data, const BATTLE_NOTICE *notice) {
+    (void)data;
+    if (notice->Type != NOTICE_HIT || notice->Target < 0) {
+        return;
+    }
+    const TURN *turn = TurnByID(notice->User);
+    if (turn->Technique == DEFAULT_ITEM) {
+        return;
+    }
+    TYPE_ID type = TechniqueByID(turn->Technique)->Type;
+    UpdateSceneLayout();
+    COORDINATE center = Scene.Battler[notice->Target].Position;
+    for (int i = 0; i < 1+notice->Critical; i++) {
+        StartParticleEffect(type, center.X, center.Y-32);
     }
-    return position;
 }
 
 /**********************************************************//**
  * @brief Draws each battler's sprite on the screen.
  **************************************************************/
 static void DrawBattlers(void) {
-    // Draw drop shadows
+    // Draw drop shadows; they all share one image so they
+    // draw together.
     int target = BattleMenuCurrentTargetID();
-    for (int id=0; id<BATTLE_SIZE; id++) {
-        const COORDINATE center = BattlerPosition(id);
-        if (!BattlerIsActive(BattlerByID(id))) {
+    al_hold_bitmap_drawing(true);
+    for (int id=0; id<Battle.nBattlers; id++) {
+        if (!(Scene.Active & (1<<id))) {
             continue;
         }
+        const COORDINATE center = Scene.Battler[id].Position;
         
         // Different colors for seletion
         ALLEGRO_COLOR color = al_map_rgba(0, 0, 0, 60);
-        if (!BattleMenuDone()) {
-            if (id==BattleMenuCurrentUserID() && BattlerIsAlly(id)) {
+        if (!Replaying && !BattleMenuDone()) {
+            if (id==BattleMenuCurrentUserID() && BattlerIsAlly(&Battle, id)) {
                 color = al_map_rgba(0, 127, 255, 200);
             } else if (id==target) {
                 color = al_map_rgba(255, 20, 0, 200);
             }
         }
-        al_draw_filled_ellipse(center.X, center.Y, 40, 10, color);
+        if (Scene.Shadow) {
+            al_draw_tinted_bitmap(Scene.Shadow, color, center.X-40, center.Y-10, 0);
+        } else {
+            al_draw_filled_ellipse(center.X, center.Y, 40, 10, color);
+        }
     }
+    al_hold_bitmap_drawing(false);
     
     // Draw existing spectra in layer order
-    static const int Order[] = {3, 2, 4, 1, 5, 0};
-    for (int i=0; i<6; i++) {
-        int id = Order[i];
-        BATTLER *battler = BattlerByID(id);
-        if (!BattlerIsAlive(battler)) {
-            continue;
-        }
-        SPECIES_ID speciesID = BattlerByID(id)->Spectra->Species;
-        const SPECIES *species = SpeciesByID(speciesID);
-        const COORDINATE center = BattlerPosition(id);
-        const COORDINATE *offset = &species->Offset;
-        ALLEGRO_BITMAP *image = NULL;
-        if (speciesID == AMY) {
-            image = CostumeImage(Player->Costume);
-        } else {
-            image = SpeciesImage(speciesID);
-        }
-        
-        // Flip enemies
-        if (id<TEAM_SIZE) {
-            al_draw_bitmap(image, center.X-offset->X, center.Y-offset->Y, 0);
-        } else {
-            int flipped = al_get_bitmap_width(image) - offset->X;
-            al_draw_bitmap(image, center.X-flipped, center.Y-offset->Y, ALLEGRO_FLIP_HORIZONTAL);
-        }
+    for (int i=0; i<Scene.nSprites; i++) {
+        const SCENE_BATTLER *scene = &Scene.Battler[Scene.Sprites[i]];
+        al_draw_bitmap(scene->Image, scene->ImageX, scene->ImageY, scene->Flags);
     }
 }
 
 /**********************************************************//**
- * @brief Draws all the battle HUDs on the screen.
+ * @brief Draws all the battle HUDs on the screen. They go on
+ * the draw list in screen coordinates, so they're batched
+ * with the battle menu.
  **************************************************************/
 static void DrawHUDs(void) {
-    // User HUDs
-    for (int id=0, y=4; id<TEAM_SIZE; id++) {
-        if (!BattlerIsActive(BattlerByID(id))) {
+    int current = (!Replaying && !BattleMenuDone())? BattleMenuCurrentUserID(): -1;
+    DrawAt(0, 0);
+    for (int id=0; id<Battle.nBattlers; id++) {
+        if (!(Scene.Active & (1<<id))) {
             continue;
         }
-        DrawAt(4, y);
-        DrawHudUser(PlayerTeam.Member[id].Spectra);
+        const SCENE_BATTLER *scene = &Scene.Battler[id];
+        if (scene->HudImage) {
+            ListBitmap(scene->HudImage, scene->HudX, scene->HudY, 0);
+        } else {
+            DrawAt(scene->HudX, scene->HudY);
+            if (BattlerIsAlly(&Battle, id)) {
+                DrawHudUser(&BattlerByID(id)->Spectra);
+            } else {
+                DrawHudEnemy(&BattlerByID(id)->Spectra);
+            }
+            DrawAt(0, 0);
+        }
+
         // Hud tag
-        if (!BattleMenuDone()) {
-            int current = BattleMenuCurrentUserID();
+        if (BattlerIsAlly(&Battle, id) && current>=0) {
             if (id==current) {
-                al_draw_bitmap(MiscImage(HUD_UP), 200, 5, 0);
+                ListBitmap(MiscImage(HUD_UP), scene->HudX+200, scene->HudY+5, 0);
             } else if (id<current) {
-                al_draw_bitmap(MiscImage(HUD_OK), 200, 5, 0);
+                ListBitmap(MiscImage(HUD_OK), scene->HudX+200, scene->HudY+5, 0);
             }
         }
-        y += 29;
-    }
-    
-    // Enemy HUDs
-    for (int id=TEAM_SIZE, y=4; id<BATTLE_SIZE; id++) {
-        if (!BattlerIsActive(BattlerByID(id))) {
-            continue;
-        }
-        DrawAt(275, y);
-        DrawHudEnemy(EnemyTeam.Member[id-TEAM_SIZE].Spectra);
-        y += 29;
     }
 }
 
 /**********************************************************//**
  * @brief Renders the current state of the battle system on
- * the screen.
+ * the screen. The layout and HUDs are only worked out again
+ * when something on them changes, so most frames are just a
+ * few blits.
  **************************************************************/
 void DrawBattle(void) {
+    UpdateSceneLayout();
+    if (!Scene.Shadow) {
+        CreateSceneShadow();
+    }
+    for (int id=0; id<Battle.nBattlers; id++) {
+        if (Scene.Active & (1<<id)) {
+            UpdateSceneHud(id);
+        }
+    }
+
     // Draw background image
     DrawAt(0, 0);
     BACKGROUND_ID background = Location(Player->Location)->Background;
     al_draw_bitmap(BackgroundImage(background? background: CHARCOAL), 0, 0, 0);
     DrawBattlers();
+    DrawParticles();
     DrawHUDs();
     
     // Battle menu phase
-    if (!BattleMenuDone() && BattleState==BATTLE_STATE_ACTIVE) {
+    if (!Replaying && !BattleMenuDone() && Battle.State==BATTLE_STATE_ACTIVE) {
         DrawBattleMenu();
     } else {
         DrawAt(0, 0);
@@ -1077,4 +1047,24 @@ void DrawBattle(void) {
     }
 }
 
+/**********************************************************//**
+ * @brief Frees the images drawn ahead of time for the battle
+ * screen.
+ **************************************************************/
+void DestroyBattleScene(void) {
+    for (int id=0; id<BATTLE_LIMIT; id++) {
+        SCENE_BATTLER *scene = &Scene.Battler[id];
+        if (scene->HudImage) {
+            al_destroy_bitmap(scene->HudImage);
+        }
+        scene->HudImage = NULL;
+        scene->Hud.Species = 0;
+    }
+    if (Scene.Shadow) {
+        al_destroy_bitmap(Scene.Shadow);
+    }
+    Scene.Shadow = NULL;
+    Scene.Ready = false;
+}
+
 /**************************************************************/
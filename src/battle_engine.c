@@ -0,0 +1,896 @@
+/**********************************************************//**
+ * @file battle_engine.c
+ * @brief Implements the battle engine: choosing targets,
+ * executing turns and deciding when the battle is over.
+ * @author Rena Shinomiya
+ * @date June 5, 2018
+ **************************************************************/
+
+#include <stdbool.h>            // bool
+#include <stdint.h>             // uint64_t
+#include <stdlib.h>             // qsort
+#include <stddef.h>             // offsetof
+
+#include "debug.h"              // assert, eprintf
+#include "random.h"             // RandomState, randint, uniform
+#include "output.h"             // OutputMessage
+#include "battle_rules.h"       // HitRate, TechniqueDamage
+#include "effect.h"             // ApplyEffectInBattle
+#include "battle_log.h"         // LogEvent
+#include "battle_engine.h"      // BATTLE_CONTEXT
+
+/**************************************************************/
+/// @brief Most turns sorted without qsort.
+#define SHORT_ORDER 8
+
+/// @brief Queues a battle message and its arguments unless
+/// the battle is quiet.
+#define Say(context, ...) do {\
+    if (!(context)->Quiet) {\
+        OutputMessage(__VA_ARGS__);\
+    }\
+} while (0)
+
+/**********************************************************//**
+ * @brief Tells the context's Notify hook about something.
+ * @param context: The battle.
+ * @param type: What happened.
+ * @param user: ID of the user.
+ * @param target: ID of the target, or -1.
+ * @param damage: Damage dealt.
+ * @param critical: Set for critical hits.
+ **************************************************************/
+static inline void Notify(const BATTLE_CONTEXT *context, NOTICE_TYPE type, int user, int target, int damage, bool critical) {
+    if (context->Notify) {
+        BATTLE_NOTICE notice = {type, user, target, damage, critical};
+        context->Notify(context->NotifyData, &notice);
+    }
+}
+
+/**********************************************************//**
+ * @brief Records an event if the battle is being logged.
+ * @param context: The battle.
+ * @param type: What happened.
+ * @param a: Usually the user, or -1.
+ * @param b: Technique, ailment or flag.
+ * @param c: Usually the target, or -1.
+ * @param value: Damage or item.
+ **************************************************************/
+static inline void Record(const BATTLE_CONTEXT *context, BATTLE_EVENT_TYPE type, int a, int b, int c, int value) {
+    if (context->Log) {
+        LogEvent(context->Log, type, a, b, c, value);
+    }
+}
+
+/**********************************************************//**
+ * @brief Switches the thread's random numbers over to the
+ * battle's own state.
+ * @param context: The battle.
+ * @return The thread's state, for LeaveBattleRandom.
+ **************************************************************/
+static inline uint64_t EnterBattleRandom(const BATTLE_CONTEXT *context) {
+    uint64_t saved = RandomState;
+    RandomState = context->Random;
+    return saved;
+}
+
+/**********************************************************//**
+ * @brief Saves the battle's random number state and gives
+ * the thread its own back.
+ * @param context: The battle.
+ * @param saved: What EnterBattleRandom returned.
+ **************************************************************/
+static inline void LeaveBattleRandom(BATTLE_CONTEXT *context, uint64_t saved) {
+    context->Random = RandomState;
+    RandomState = saved;
+}
+
+/**********************************************************//**
+ * @struct TURN_PRIORITY
+ * @brief A turn waiting to be sorted into the round's order.
+ **************************************************************/
+typedef struct {
+    int Priority;               ///< Priority of the user.
+    int ID;                     ///< ID of the user.
+} TURN_PRIORITY;
+
+/**********************************************************//**
+ * @brief Sets up a battle between two teams.
+ * @param context: Context to set up.
+ * @param allies: Spectra on the player's team. Those with
+ * Species 0 don't take part.
+ * @param nAllies: Size of the player's team, up to TEAM_MAX.
+ * @param enemies: Spectra on the enemy team.
+ * @param nEnemies: Size of the enemy team, up to TEAM_MAX.
+ **************************************************************/
+void InitializeBattleContext(BATTLE_CONTEXT *context, const SPECTRA *allies, int nAllies, const SPECTRA *enemies, int nEnemies) {
+    assert(0 < nAllies && nAllies <= TEAM_MAX);
+    assert(0 < nEnemies && nEnemies <= TEAM_MAX);
+    memset(context, 0, offsetof(BATTLE_CONTEXT, Order));
+    context->nAllies = nAllies;
+    context->nBattlers = nAllies+nEnemies;
+    for (int id=0; id<context->nBattlers; id++) {
+        const SPECTRA *spectra = (id<nAllies)? &allies[id]: &enemies[id-nAllies];
+        BATTLER *battler = &context->Battler[id];
+        if (spectra->Species) {
+            InitializeBattler(battler, spectra);
+        } else {
+            InitializeBattlerAsInactive(battler);
+        }
+    }
+    context->Survivor[0] = 0;
+    context->Survivor[1] = nAllies;
+    SeedBattleContext(context, RandomNext());
+    BeginRound(context);
+}
+
+/**********************************************************//**
+ * @brief Seeds the battle's random numbers. The same seed and
+ * the same choices always give the same battle.
+ * @param context: The battle.
+ * @param seed: Any number.
+ **************************************************************/
+void SeedBattleContext(BATTLE_CONTEXT *context, uint64_t seed) {
+    uint64_t saved = RandomState;
+    SeedRandom(seed);
+    context->Random = RandomState;
+    RandomState = saved;
+}
+
+/**********************************************************//**
+ * @brief Starts recording the battle. Call this before the
+ * first round.
+ * @param context: The battle.
+ * @param log: Log to record into. The log should already be
+ * zeroed or used before.
+ **************************************************************/
+void StartBattleLog(BATTLE_CONTEXT *context, BATTLE_LOG *log) {
+    SPECTRA spectra[BATTLE_MAX];
+    for (int id=0; id<context->nBattlers; id++) {
+        spectra[id] = context->Battler[id].Spectra;
+    }
+    InitializeBattleLog(log, context->Random, context->CaptureRoom, spectra, context->nAllies, context->nBattlers);
+    context->Log = log;
+}
+
+/**********************************************************//**
+ * @brief Gets a list of target IDs for the given type.
+ * @param context: The battle.
+ * @param targets: Location to store the list of targets.
+ * @param user: User ID
+ * @param type: Targetting type
+ * @return Number of targets loaded.
+ **************************************************************/
+int ContextTargets(const BATTLE_CONTEXT *context, int *targets, int user, TARGET_TYPE type) {
+    int i = 0;
+    bool ally = BattlerIsAlly(context, user);
+    for (int id=0; id<context->nBattlers; id++) {
+        const BATTLER *battler = &context->Battler[id];
+        // Can't target gone or incapacitated battlers
+        if (!BattlerIsAlive(battler)) {
+            continue;
+        } else if (type&TARGET_USER && id==user) {
+            // Targetting yourself
+            targets[i++] = id;
+        } else if (type&TARGET_ALLY && BattlerIsAlly(context, id)==ally) {
+            // Targetting any ally
+            targets[i++] = id;
+        } else if (type&TARGET_ENEMY && BattlerIsAlly(context, id)!=ally) {
+            // Targetting any enemy
+            targets[i++] = id;
+        }
+    }
+    return i;
+}
+
+/**********************************************************//**
+ * @brief Gets the chance for the player's team to escape.
+ * @param context: The battle.
+ * @return Chance to escape.
+ **************************************************************/
+float EscapeChance(const BATTLE_CONTEXT *context) {
+    int ally = 0;
+    int enemy = 0;
+    for (int id=0; id<context->nBattlers; id++) {
+        const BATTLER *battler = &context->Battler[id];
+        if (BattlerIsAlive(battler)) {
+            if (BattlerIsAlly(context, id)) {
+                ally += BattlerEvade(battler)+BattlerLuck(battler);
+            } else {
+                enemy += BattlerEvade(battler);
+            }
+        }
+    }
+    assert(ally && enemy);
+    return (float)ally / (ally+enemy);
+}
+
+/**********************************************************//**
+ * @brief Attempt to escape the battle.
+ * @param context: The battle.
+ * @return True if the battle was escaped.
+ **************************************************************/
+bool TryEscape(BATTLE_CONTEXT *context) {
+    float chance = EscapeChance(context);
+    uint64_t saved = EnterBattleRandom(context);
+    bool escaped = uniform(0.0, 1.0) < chance;
+    LeaveBattleRandom(context, saved);
+    Record(context, LOG_ESCAPE, -1, escaped, -1, 0);
+
+    Say(context, MESSAGE_ESCAPE);
+    if (escaped) {
+        Say(context, MESSAGE_ESCAPE_SUCCESS);
+        context->State = BATTLE_STATE_ESCAPE;
+        Record(context, LOG_END, -1, context->State, -1, 0);
+    } else {
+        Say(context, MESSAGE_ESCAPE_FAILURE);
+        context->State = BATTLE_STATE_NO_ESCAPE;
+    }
+    return escaped;
+}
+
+/**********************************************************//**
+ * @brief Initializes setup for the next round of battle.
+ * @param context: The battle.
+ **************************************************************/
+void BeginRound(BATTLE_CONTEXT *context) {
+    context->CurrentTurn = -1;
+    context->Captured = -1;
+    context->State = BATTLE_STATE_ACTIVE;
+    context->nOrder = -1;
+    context->NextOrder = 0;
+    for (int i=0; i<context->nBattlers; i++) {
+        context->Turns[i].State = TURN_INACTIVE;
+    }
+}
+
+/**********************************************************//**
+ * @brief Picks a living target of a type at random. Rather
+ * than listing every battler, this tries random IDs from the
+ * ranges the type allows until one is alive, which is just as
+ * fair and doesn't grow with the size of the battle.
+ * @param context: The battle.
+ * @param user: ID of the user.
+ * @param type: Targetting type.
+ * @return ID of the target, or -1 if there's nobody.
+ **************************************************************/
+static int RandomTarget(const BATTLE_CONTEXT *context, int user, TARGET_TYPE type) {
+    // The user's own team, or just the user.
+    bool ally = BattlerIsAlly(context, user);
+    int first[2] = {user, 0};
+    int size[2] = {0, 0};
+    if (type&TARGET_ALLY) {
+        first[0] = ally? 0: context->nAllies;
+        size[0] = ally? context->nAllies: context->nBattlers-context->nAllies;
+    } else if (type&TARGET_USER) {
+        size[0] = 1;
+    }
+
+    // The other team.
+    if (type&TARGET_ENEMY) {
+        first[1] = ally? context->nAllies: 0;
+        size[1] = ally? context->nBattlers-context->nAllies: context->nAllies;
+    }
+
+    // Give up guessing if most of them have passed out.
+    for (int tries=0; tries<8 && size[0]+size[1]; tries++) {
+        int i = randint(0, size[0]+size[1]-1);
+        int id = (i<size[0])? first[0]+i: first[1]+i-size[0];
+        if (BattlerIsAlive(&context->Battler[id])) {
+            return id;
+        }
+    }
+    int targets[BATTLE_MAX];
+    int nTargets = ContextTargets(context, targets, user, type);
+    return nTargets? targets[randint(0, nTargets-1)]: -1;
+}
+
+/**********************************************************//**
+ * @brief Chooses a technique and target for a battler the
+ * way wild spectra do.
+ * @param context: The battle.
+ * @param id: ID of the battler choosing.
+ **************************************************************/
+void ChooseRandomTurn(BATTLE_CONTEXT *context, int id) {
+    BATTLER *battler = &context->Battler[id];
+    TURN *turn = &context->Turns[id];
+    if (!BattlerIsAlive(battler)) {
+        // Turn skipped
+        turn->State = TURN_INACTIVE;
+        return;
+    }
+    turn->State = TURN_PENDING;
+    turn->User = id;
+    turn->Technique = RandomTechnique(battler);
+
+    // Get the primary target, if applicable
+    TARGET_TYPE type = TechniqueByID(turn->Technique)->Target;
+    if (type&TARGET_GROUP) {
+        turn->Target = -1;
+    } else {
+        turn->Target = RandomTarget(context, id, type);
+    }
+}
+
+/**********************************************************//**
+ * @brief Records the turns chosen for the round. Call this
+ * once every turn is chosen, before executing any of them.
+ * @param context: The battle.
+ **************************************************************/
+void CommitTurns(BATTLE_CONTEXT *context) {
+    if (!context->Log) {
+        return;
+    }
+    Record(context, LOG_ROUND, -1, 0, -1, 0);
+    for (int id=0; id<context->nBattlers; id++) {
+        const TURN *turn = &context->Turns[id];
+        if (turn->State == TURN_PENDING) {
+            int item = (turn->Technique==DEFAULT_ITEM)? turn->Item: 0;
+            Record(context, LOG_CHOICE, id, turn->Technique, turn->Target, item);
+        }
+    }
+}
+
+/**********************************************************//**
+ * @brief Sorts two turns by priority. Ties go to the lower
+ * ID, so the player's team moves first.
+ * @param a: A TURN_PRIORITY.
+ * @param b: Another TURN_PRIORITY.
+ * @return Negative if a goes first.
+ **************************************************************/
+static int CompareTurnPriority(const void *a, const void *b) {
+    const TURN_PRIORITY *x = (const TURN_PRIORITY *)a;
+    const TURN_PRIORITY *y = (const TURN_PRIORITY *)b;
+    if (x->Priority != y->Priority) {
+        return (x->Priority > y->Priority)? -1: 1;
+    }
+    return x->ID - y->ID;
+}
+
+/**********************************************************//**
+ * @brief Works out the order of this round's turns from each
+ * user's priority at the start of the round.
+ * @param context: The battle.
+ **************************************************************/
+static void OrderTurns(BATTLE_CONTEXT *context) {
+    TURN_PRIORITY turns[BATTLE_MAX];
+    int n = 0;
+    for (int id=0; id<context->nBattlers; id++) {
+        TURN *turn = &context->Turns[id];
+        if (turn->State != TURN_PENDING) {
+            continue;
+        }
+        const BATTLER *battler = &context->Battler[id];
+        if (BattlerIsAlive(battler)) {
+            turns[n].Priority = Priority(battler);
+            turns[n].ID = id;
+            n++;
+        } else {
+            // Inactivate turns for dead battlers
+            turn->State = TURN_INACTIVE;
+        }
+    }
+    if (n > SHORT_ORDER) {
+        qsort(turns, n, sizeof(TURN_PRIORITY), CompareTurnPriority);
+    } else {
+        // Insertion sort beats qsort for the usual three-on-three.
+        for (int i=1; i<n; i++) {
+            TURN_PRIORITY turn = turns[i];
+            int j = i;
+            while (j>0 && CompareTurnPriority(&turn, &turns[j-1])<0) {
+                turns[j] = turns[j-1];
+                j--;
+            }
+            turns[j] = turn;
+        }
+    }
+    for (int i=0; i<n; i++) {
+        context->Order[i] = turns[i].ID;
+    }
+    context->nOrder = n;
+    context->NextOrder = 0;
+}
+
+/**********************************************************//**
+ * @brief Takes the next pending turn in priority order and
+ * makes it the current turn. Turns of battlers that have
+ * passed out are skipped. The order is worked out the first
+ * time this is called in a round.
+ * @param context: The battle.
+ * @return The next turn, or NULL if every turn is done.
+ **************************************************************/
+TURN *NextTurn(BATTLE_CONTEXT *context) {
+    if (context->nOrder < 0) {
+        OrderTurns(context);
+    }
+    context->CurrentTurn = -1;
+    while (context->NextOrder < context->nOrder) {
+        int id = context->Order[context->NextOrder++];
+        TURN *turn = &context->Turns[id];
+        if (turn->State != TURN_PENDING) {
+            continue;
+        }
+        if (BattlerIsAlive(&context->Battler[id])) {
+            context->CurrentTurn = id;
+            return turn;
+        }
+        // Inactivate turns for dead battlers
+        turn->State = TURN_INACTIVE;
+    }
+    return NULL;
+}
+
+/**********************************************************//**
+ * @brief Attempts to capture the target.
+ * @param context: The battle.
+ * @param user: ID of the battler capturing.
+ * @param id: ID of the target to capture.
+ * @return True if the target was captured.
+ **************************************************************/
+static bool ExecuteCapture(BATTLE_CONTEXT *context, int user, int id) {
+    // Determine if capture succeeds
+    BATTLER *battler = &context->Battler[id];
+    int rate = BattlerSpecies(battler)->CatchRate;
+    float percent = (float)BattlerHealth(battler)/BattlerMaxHealth(battler);
+
+    // Increased rate if ailed
+    switch (battler->Spectra.Ailment) {
+    case ASLEEP:
+    case BURIED:
+        rate += 10;
+        break;
+    case SHOCKED:
+        rate += 5;
+        break;
+    default:
+        break;
+    }
+
+    // Test rate
+    if (!context->Quiet) {
+        OutputSplitByCR("...\r......\r.........");
+    }
+    int test = randint(0, 99);
+    int threshold = rate + (100-rate)*(1-percent)*(1-percent);
+    bool captured = test < threshold && context->CaptureRoom > 0;
+    Record(context, LOG_CAPTURE, user, captured, id, 0);
+    if (captured) {
+        Say(context, MESSAGE_CAPTURE_SUCCESS);
+        context->CaptureRoom--;
+        context->Captured = id;
+        if (context->Capture) {
+            context->Capture(&battler->Spectra);
+        }
+        return true;
+    } else if (test < threshold) {
+        Say(context, MESSAGE_CAPTURE_NO_ROOM);
+    } else if (test-10 < threshold) {
+        Say(context, MESSAGE_CAPTURE_GOT_AWAY);
+    } else if (test-20 < threshold) {
+        Say(context, MESSAGE_CAPTURE_BROKE_FREE);
+    } else {
+        Say(context, MESSAGE_CAPTURE_FAILURE);
+    }
+    return false;
+}
+
+/**********************************************************//**
+ * @brief Performs one turn during battle, using the thread's
+ * random numbers.
+ * @param context: The battle.
+ * @param turn: Turn to execute.
+ **************************************************************/
+static void PlayTurn(BATTLE_CONTEXT *context, const TURN *turn) {
+    // Get the targets of the technique
+    int Targets[BATTLE_MAX];
+    TARGET_TYPE targetType = TechniqueByID(turn->Technique)->Target;
+    int nTargets;
+    if (targetType & TARGET_GROUP) {
+        nTargets = ContextTargets(context, Targets, turn->User, targetType);
+    } else {
+        Targets[0] = turn->Target;
+        nTargets = 1;
+    }
+
+    // Maybe fail if there are status conditions
+    BATTLER *user = &context->Battler[turn->User];
+    const TECHNIQUE *technique = TechniqueByID(turn->Technique);
+    AILMENT_ID blocked = BlockingAilment(user);
+    if (blocked) {
+        Notify(context, NOTICE_BLOCKED, turn->User, -1, 0, false);
+        Record(context, LOG_BLOCKED, turn->User, blocked, -1, 0);
+    }
+    switch (blocked) {
+    case SHOCKED:
+        Say(context, MESSAGE_BLOCKED_SHOCKED, BattlerName(user));
+        return;
+    case BURIED:
+        Say(context, MESSAGE_BLOCKED_BURIED, BattlerName(user));
+        return;
+    case ASLEEP:
+        Say(context, MESSAGE_BLOCKED_ASLEEP, BattlerName(user));
+        return;
+    default:
+        break;
+    }
+
+    // Spend P
+    if (BattlerPower(user) >= technique->Cost) {
+        user->Spectra.Power -= technique->Cost;
+    } else {
+        Record(context, LOG_BLOCKED, turn->User, 0, -1, 0);
+        Say(context, MESSAGE_NO_POWER, BattlerName(user));
+        return;
+    }
+
+    // Perform the turn
+    bool allInvalid = true;
+    for (int i=0; i<nTargets; i++) {
+        BATTLER *target = &context->Battler[Targets[i]];
+        if (!BattlerIsAlive(target)) {
+            continue;
+        }
+        allInvalid = false;
+
+        // Maybe miss the target
+        bool allied = BattlerIsAlly(context, turn->User)==BattlerIsAlly(context, Targets[i]);
+        if (uniform(0.0, 1.0) > HitRate(user, target, allied, technique)) {
+            Notify(context, NOTICE_MISS, turn->User, Targets[i], 0, false);
+            Record(context, LOG_MISS, turn->User, 0, Targets[i], 0);
+            Say(context, MESSAGE_AVOIDED, BattlerName(target));
+            continue;
+        }
+
+        // Inflict damage
+        int damage = 0;
+        if (technique->Power) {
+            damage = TechniqueDamage(user, target, technique);
+
+            // Maybe critical hit?
+            bool critical = uniform(0.0, 1.0) < CriticalHitRate(user, target);
+            if (critical) {
+                damage *= 2;
+                Say(context, MESSAGE_CRITICAL_HIT, BattlerName(target));
+            }
+
+            // Inflict damage
+            InflictDamage(target, damage);
+            Notify(context, NOTICE_HIT, turn->User, Targets[i], damage, critical);
+            Record(context, LOG_HIT, turn->User, critical, Targets[i], damage);
+
+            // Messages
+            if (damage) {
+                Say(context, MESSAGE_DAMAGE, BattlerName(target), damage);
+                if (!BattlerIsAlive(target)) {
+                    Say(context, MESSAGE_PASSED_OUT, BattlerName(target));
+                }
+            } else {
+                Say(context, MESSAGE_NO_DAMAGE, BattlerName(target));
+            }
+        }
+
+        // Apply effect if applicable
+        if (BattlerIsAlive(target) && !(technique->Flags&TECHNIQUE_EFFECT_ONCE)) {
+            const ITEM *item;
+            switch (turn->Technique) {
+            case DEFAULT_ITEM:
+                item = ItemByID(turn->Item);
+                if (item->Flags&BATTLE_ONLY) {
+                    if (ApplyEffectInBattle(item->Effect, user, target, item->Argument)) {
+                        if (context->UseItem) {
+                            context->UseItem(turn->Item);
+                        }
+                    } else {
+                        Say(context, MESSAGE_NO_EFFECT);
+                    }
+                } else {
+                    Say(context, MESSAGE_NOT_USEFUL);
+                }
+
+                break;
+
+            case CAPTURE:
+                ExecuteCapture(context, turn->User, Targets[i]);
+                break;
+
+            default:
+                if (ShouldEffectActivate(technique->Effect, technique->Argument)) {
+                    ApplyEffectInBattle(technique->Effect, user, target, technique->Argument);
+                } else if (!technique->Power) {
+                    // Technique doesn't do damage, and effect missed.
+                    Say(context, MESSAGE_AVOIDED, BattlerName(target));
+                }
+                break;
+            }
+        }
+    }
+
+    // All invalid targets?
+    if (allInvalid) {
+        Say(context, MESSAGE_NO_TARGET);
+    }
+
+    // Perform effect if it activates after all targets are hit
+    if (technique->Flags&TECHNIQUE_EFFECT_ONCE) {
+        if (ShouldEffectActivate(technique->Effect, technique->Argument)) {
+            ApplyEffectInBattle(technique->Effect, user, NULL, technique->Argument);
+        }
+    }
+}
+
+/**********************************************************//**
+ * @brief Performs one turn during battle.
+ * @param context: The battle.
+ * @param turn: Turn to execute.
+ **************************************************************/
+void ExecuteTurn(BATTLE_CONTEXT *context, const TURN *turn) {
+    // Effects don't know about the log, so compare ailments
+    // before and after.
+    AILMENT_ID ailments[BATTLE_MAX];
+    if (context->Log) {
+        for (int id=0; id<context->nBattlers; id++) {
+            ailments[id] = context->Battler[id].Spectra.Ailment;
+        }
+        Record(context, LOG_TURN, turn->User, 0, -1, 0);
+    }
+
+    uint64_t saved = EnterBattleRandom(context);
+    PlayTurn(context, turn);
+    LeaveBattleRandom(context, saved);
+
+    if (context->Log) {
+        for (int id=0; id<context->nBattlers; id++) {
+            AILMENT_ID ailment = context->Battler[id].Spectra.Ailment;
+            if (ailment != ailments[id]) {
+                Record(context, LOG_AILMENT, -1, ailment, id, 0);
+            }
+        }
+    }
+}
+
+/**********************************************************//**
+ * @brief Finishes a turn after it's been executed: removes a
+ * captured battler and checks if the battle is over.
+ * @param context: The battle.
+ * @param turn: The turn that was executed.
+ **************************************************************/
+void FinishTurn(BATTLE_CONTEXT *context, TURN *turn) {
+    if (context->Captured >= 0) {
+        InitializeBattlerAsInactive(&context->Battler[context->Captured]);
+        context->Captured = -1;
+    }
+    turn->State = TURN_DONE;
+    UpdateBattleState(context);
+}
+
+/**********************************************************//**
+ * @brief Determines if every turn this round has finished.
+ * @param context: The battle.
+ * @return True if battle execution is done and we should go
+ * to the next round.
+ **************************************************************/
+bool RoundDone(const BATTLE_CONTEXT *context) {
+    for (int i=0; i<context->nBattlers; i++) {
+        switch (context->Turns[i].State) {
+        case TURN_PENDING:
+        case TURN_ACTIVE:
+        case TURN_RESULT:
+            return false;
+        case TURN_INACTIVE:
+        case TURN_DONE:
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Apply effects to battlers at the end of each round.
+ * @param context: The battle.
+ **************************************************************/
+void ApplyEndOfRoundEffects(BATTLE_CONTEXT *context) {
+    uint64_t saved = EnterBattleRandom(context);
+    for (int id=0; id<context->nBattlers; id++) {
+        BATTLER *battler = &context->Battler[id];
+        if (!BattlerIsAlive(battler)) {
+            continue;
+        }
+
+        // Unset the battler's flags.
+        battler->Flags = 0;
+
+        // Apply status ailments
+        int damage;
+        AILMENT_ID ailment = battler->Spectra.Ailment;
+        switch (ApplyRoundAilment(battler, &damage)) {
+        case ROUND_WOKE_UP:
+            Record(context, LOG_AILMENT, -1, 0, id, 0);
+            Say(context, MESSAGE_WOKE_UP, BattlerName(battler));
+            break;
+
+        case ROUND_POISON:
+            Record(context, LOG_ROUND_DAMAGE, -1, ailment, id, damage);
+            Say(context, MESSAGE_POISON_DAMAGE, BattlerName(battler), damage);
+            if (!BattlerIsAlive(battler)) {
+                Say(context, MESSAGE_PASSED_OUT, BattlerName(battler));
+            }
+            break;
+
+        case ROUND_FIRE:
+            Record(context, LOG_ROUND_DAMAGE, -1, ailment, id, damage);
+            Say(context, MESSAGE_FIRE_DAMAGE, BattlerName(battler), damage);
+            if (!BattlerIsAlive(battler)) {
+                Say(context, MESSAGE_PASSED_OUT, BattlerName(battler));
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        // Check win and lose conditions
+        if (UpdateBattleState(context)) {
+            break;
+        }
+    }
+    LeaveBattleRandom(context, saved);
+}
+
+/**********************************************************//**
+ * @brief Checks if anyone on a team is still alive. The
+ * search starts from whoever was alive last time, so checking
+ * after every turn doesn't rescan the whole team.
+ * @param context: The battle.
+ * @param team: 0 for the player's team, 1 for the enemy.
+ * @return True if someone on the team is alive.
+ **************************************************************/
+static bool TeamAlive(BATTLE_CONTEXT *context, int team) {
+    int first = team? context->nAllies: 0;
+    int size = team? context->nBattlers-context->nAllies: context->nAllies;
+    int start = context->Survivor[team]-first;
+    for (int i=0; i<size; i++) {
+        int id = first + (start+i)%size;
+        if (BattlerIsAlive(&context->Battler[id])) {
+            context->Survivor[team] = id;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**********************************************************//**
+ * @brief Check if the battle should end.
+ * @param context: The battle.
+ * @return True if the battle isn't active any more.
+ **************************************************************/
+bool UpdateBattleState(BATTLE_CONTEXT *context) {
+    // No point checking again
+    if (context->State != BATTLE_STATE_ACTIVE) {
+        return true;
+    }
+
+    bool lose = !TeamAlive(context, 0);
+    bool win = !TeamAlive(context, 1);
+
+    // If it's a tie, you lose.
+    if (lose) {
+        context->State = BATTLE_STATE_LOSE;
+        Say(context, MESSAGE_LOSE);
+    } else if (win) {
+        context->State = BATTLE_STATE_WIN;
+        Say(context, MESSAGE_WIN);
+    }
+    if (context->State != BATTLE_STATE_ACTIVE) {
+        Record(context, LOG_END, -1, context->State, -1, 0);
+        return true;
+    }
+    return false;
+}
+
+/**********************************************************//**
+ * @brief Executes every pending turn in priority order and
+ * applies end of round effects, all at once. The turns must
+ * already be chosen.
+ * @param context: The battle.
+ **************************************************************/
+void RunRound(BATTLE_CONTEXT *context) {
+    CommitTurns(context);
+    TURN *turn;
+    while ((turn = NextTurn(context))) {
+        turn->State = TURN_RESULT;
+        ExecuteTurn(context, turn);
+        FinishTurn(context, turn);
+        if (context->State != BATTLE_STATE_ACTIVE) {
+            return;
+        }
+    }
+    ApplyEndOfRoundEffects(context);
+}
+
+/**********************************************************//**
+ * @brief Sets up a battle from the start of a log, ready to
+ * be replayed. The context doesn't record or have any hooks.
+ * @param replay: Replay position to set up.
+ * @param log: The log to replay.
+ * @param context: Context to set up.
+ **************************************************************/
+void StartReplay(BATTLE_REPLAY *replay, const BATTLE_LOG *log, BATTLE_CONTEXT *context) {
+    const BATTLE_LOG_HEADER *header = &log->Header;
+    int nAllies = header->nAllies;
+    InitializeBattleContext(context, header->Spectra, nAllies, header->Spectra+nAllies, header->nBattlers-nAllies);
+    context->Random = log->Header.Seed;
+    context->CaptureRoom = log->Header.CaptureRoom;
+    replay->Log = log;
+    replay->Cursor = 0;
+}
+
+/**********************************************************//**
+ * @brief Reads the log up to the next thing the player or
+ * enemies did. Outcomes in the log are skipped, because the
+ * engine reproduces them.
+ * @param replay: Replay position.
+ * @param context: The battle, which is at the start of a
+ * round. Turns are loaded into it for REPLAY_ROUND.
+ * @return What to do next.
+ **************************************************************/
+REPLAY_STEP ReplayNext(BATTLE_REPLAY *replay, BATTLE_CONTEXT *context) {
+    const BATTLE_LOG *log = replay->Log;
+    while (replay->Cursor < log->nEvents) {
+        const BATTLE_EVENT *event = &log->Events[replay->Cursor++];
+        switch (event->Type) {
+        case LOG_ESCAPE:
+            return REPLAY_ESCAPE;
+
+        case LOG_ROUND:
+            // Load the turns chosen for this round.
+            while (replay->Cursor < log->nEvents && log->Events[replay->Cursor].Type == LOG_CHOICE) {
+                event = &log->Events[replay->Cursor++];
+                if (event->A >= context->nBattlers) {
+                    eprintf("Battle log has a turn for battler %d.\n", event->A);
+                    continue;
+                }
+                TURN *turn = &context->Turns[event->A];
+                turn->State = TURN_PENDING;
+                turn->User = event->A;
+                turn->Technique = event->B;
+                turn->Target = (event->C==LOG_NOBODY)? -1: event->C;
+                turn->Item = event->Value;
+            }
+            return REPLAY_ROUND;
+
+        default:
+            break;
+        }
+    }
+    return REPLAY_END;
+}
+
+/**********************************************************//**
+ * @brief Replays the rest of a log at once.
+ * @param replay: Replay position.
+ * @param context: The battle, at the start of a round.
+ **************************************************************/
+void FastForwardReplay(BATTLE_REPLAY *replay, BATTLE_CONTEXT *context) {
+    while (context->State == BATTLE_STATE_ACTIVE) {
+        switch (ReplayNext(replay, context)) {
+        case REPLAY_ROUND:
+            RunRound(context);
+            if (context->State == BATTLE_STATE_ACTIVE) {
+                BeginRound(context);
+            }
+            break;
+
+        case REPLAY_ESCAPE:
+            if (!TryEscape(context)) {
+                context->State = BATTLE_STATE_ACTIVE;
+            }
+            break;
+
+        case REPLAY_END:
+            return;
+        }
+    }
+}
+
+/**************************************************************/
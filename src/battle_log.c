@@ -0,0 +1,287 @@
+/**********************************************************//**
+ * @file battle_log.c
+ * @brief Records, saves and exports battle logs.
+ * @author Rena Shinomiya
+ * @date June 7, 2018
+ **************************************************************/
+
+#include <stdio.h>              // FILE, fopen, fprintf
+#include <stdlib.h>             // realloc, free
+#include <stddef.h>             // offsetof
+#include <string.h>             // memcpy, memcmp, memset
+
+#include "debug.h"              // eprintf
+#include "technique.h"          // TechniqueByID, N_TECHNIQUES
+#include "item.h"               // ItemByID, IsItem
+#include "battle_log.h"         // BATTLE_LOG
+
+/**************************************************************/
+/// @brief Events the log has room for when it's first used.
+#define INITIAL_CAPACITY 256
+
+/// @brief Size of the header before the spectra.
+#define HEADER_SIZE offsetof(BATTLE_LOG_HEADER, Spectra)
+
+/**********************************************************//**
+ * @brief Starts an empty log.
+ * @param log: Log to set up.
+ * @param seed: Random number state at the start of battle.
+ * @param room: Number of spectra the player could capture.
+ * @param spectra: Every battler's spectra at the start of
+ * battle, allies first.
+ * @param nAllies: Battlers on the player's team.
+ * @param nBattlers: Battlers on both teams.
+ **************************************************************/
+void InitializeBattleLog(BATTLE_LOG *log, uint64_t seed, int room, const SPECTRA *spectra, int nAllies, int nBattlers) {
+    memset(&log->Header, 0, sizeof(BATTLE_LOG_HEADER));
+    memcpy(log->Header.Magic, "SPBL", 4);
+    log->Header.Version = BATTLE_LOG_VERSION;
+    log->Header.Seed = seed;
+    log->Header.CaptureRoom = room;
+    log->Header.nAllies = nAllies;
+    log->Header.nBattlers = nBattlers;
+    memcpy(log->Header.Spectra, spectra, nBattlers*sizeof(SPECTRA));
+    log->nEvents = 0;
+}
+
+/**********************************************************//**
+ * @brief Frees the log's events.
+ * @param log: Log to destroy.
+ **************************************************************/
+void DestroyBattleLog(BATTLE_LOG *log) {
+    free(log->Events);
+    log->Events = NULL;
+    log->nEvents = 0;
+    log->Capacity = 0;
+}
+
+/**********************************************************//**
+ * @brief Makes sure the log has space for more events.
+ * @param log: The log.
+ * @param capacity: Events needed.
+ * @return True if there's space.
+ **************************************************************/
+static bool ReserveEvents(BATTLE_LOG *log, int capacity) {
+    if (capacity <= log->Capacity) {
+        return true;
+    }
+    int size = log->Capacity? log->Capacity: INITIAL_CAPACITY;
+    while (size < capacity) {
+        size *= 2;
+    }
+    BATTLE_EVENT *events = realloc(log->Events, size*sizeof(BATTLE_EVENT));
+    if (!events) {
+        eprintf("Out of memory for %d battle events.\n", size);
+        return false;
+    }
+    log->Events = events;
+    log->Capacity = size;
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Adds an event to the end of the log.
+ * @param log: The log.
+ * @param type: What happened.
+ * @param a: Usually the user, or -1.
+ * @param b: Technique, ailment or flag.
+ * @param c: Usually the target, or -1.
+ * @param value: Damage or item. Clamped to 16 bits.
+ **************************************************************/
+void LogEvent(BATTLE_LOG *log, BATTLE_EVENT_TYPE type, int a, int b, int c, int value) {
+    if (!ReserveEvents(log, log->nEvents+1)) {
+        return;
+    }
+    BATTLE_EVENT *event = &log->Events[log->nEvents++];
+    event->Type = type;
+    event->A = (a<0)? LOG_NOBODY: a;
+    event->B = b;
+    event->C = (c<0)? LOG_NOBODY: c;
+    event->Value = (value<0)? 0: (value>UINT16_MAX)? UINT16_MAX: value;
+}
+
+/**********************************************************//**
+ * @brief Writes a log to disk.
+ * @param log: The log.
+ * @param filename: File to write.
+ * @return True if the log was written.
+ **************************************************************/
+bool SaveBattleLog(const BATTLE_LOG *log, const char *filename) {
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        return false;
+    }
+    int32_t count = log->nEvents;
+    int32_t n = log->Header.nBattlers;
+    bool ok = fwrite(&log->Header, HEADER_SIZE, 1, file) == 1
+        && fwrite(log->Header.Spectra, sizeof(SPECTRA), n, file) == (size_t)n
+        && fwrite(&count, sizeof(count), 1, file) == 1
+        && fwrite(log->Events, sizeof(BATTLE_EVENT), count, file) == (size_t)count;
+    fclose(file);
+    return ok;
+}
+
+/**********************************************************//**
+ * @brief Checks that a spectra read from a log can be put in
+ * a battle.
+ * @param spectra: The spectra.
+ * @return True if its IDs are in range.
+ **************************************************************/
+static bool IsValidSpectra(const SPECTRA *spectra) {
+    if (spectra->Species >= N_SPECIES || spectra->Ailment >= N_AILMENT
+    || spectra->MovesetSize < 0 || spectra->MovesetSize > MOVESET_SIZE) {
+        return false;
+    }
+    for (int i = 0; i < MOVESET_SIZE; i++) {
+        if (spectra->Moveset[i] >= N_TECHNIQUES) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Checks that an event read from a log can be played
+ * back, so replaying and exporting it can look up its IDs.
+ * @param header: The log's header.
+ * @param event: The event.
+ * @return True if its type and IDs are in range.
+ **************************************************************/
+static bool IsValidEvent(const BATTLE_LOG_HEADER *header, const BATTLE_EVENT *event) {
+    if (event->Type < LOG_ROUND || event->Type > LOG_END) {
+        return false;
+    }
+    if ((event->A >= header->nBattlers && event->A != LOG_NOBODY)
+    || (event->C >= header->nBattlers && event->C != LOG_NOBODY)) {
+        return false;
+    }
+    if (event->Type == LOG_CHOICE) {
+        return event->B < N_TECHNIQUES && (!event->Value || IsItem(event->Value));
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Reads a log from disk, replacing what's in the log.
+ * @param log: The log.
+ * @param filename: File to read.
+ * @return True if the file held a valid log.
+ **************************************************************/
+bool LoadBattleLog(BATTLE_LOG *log, const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        return false;
+    }
+    int32_t count = 0;
+    int32_t n = 0;
+    bool ok = fread(&log->Header, HEADER_SIZE, 1, file) == 1
+        && !memcmp(log->Header.Magic, "SPBL", 4)
+        && log->Header.Version == BATTLE_LOG_VERSION
+        && (n = log->Header.nBattlers) > log->Header.nAllies
+        && log->Header.nAllies > 0
+        && n <= BATTLE_MAX
+        && log->Header.nAllies <= TEAM_MAX
+        && n-log->Header.nAllies <= TEAM_MAX
+        && fread(log->Header.Spectra, sizeof(SPECTRA), n, file) == (size_t)n
+        && fread(&count, sizeof(count), 1, file) == 1
+        && count >= 0
+        && ReserveEvents(log, count)
+        && fread(log->Events, sizeof(BATTLE_EVENT), count, file) == (size_t)count;
+    fclose(file);
+    for (int i = 0; ok && i < n; i++) {
+        ok = IsValidSpectra(&log->Header.Spectra[i]);
+    }
+    for (int i = 0; ok && i < count; i++) {
+        ok = IsValidEvent(&log->Header, &log->Events[i]);
+    }
+    log->nEvents = ok? count: 0;
+    if (!ok) {
+        eprintf("%s is not a valid battle log.\n", filename);
+    }
+    return ok;
+}
+
+/**********************************************************//**
+ * @brief Writes an ID to a CSV row, or nothing if there's
+ * nobody.
+ * @param file: The CSV file.
+ * @param id: The ID.
+ **************************************************************/
+static void ExportID(FILE *file, int id) {
+    if (id != LOG_NOBODY) {
+        fprintf(file, "%d", id);
+    }
+}
+
+/**********************************************************//**
+ * @brief Writes a log as CSV, one row per event after the
+ * round choices. Columns that don't apply are left empty.
+ * @param log: The log.
+ * @param file: File to write to.
+ **************************************************************/
+void ExportBattleLog(const BATTLE_LOG *log, FILE *file) {
+    static const char *const Names[] = {
+        [LOG_ROUND]         = "round",
+        [LOG_CHOICE]        = "choice",
+        [LOG_TURN]          = "turn",
+        [LOG_BLOCKED]       = "blocked",
+        [LOG_MISS]          = "miss",
+        [LOG_HIT]           = "hit",
+        [LOG_AILMENT]       = "ailment",
+        [LOG_ROUND_DAMAGE]  = "round damage",
+        [LOG_CAPTURE]       = "capture",
+        [LOG_ESCAPE]        = "escape",
+        [LOG_END]           = "end",
+    };
+    fprintf(file, "seed,%llu\n", (unsigned long long)log->Header.Seed);
+    fprintf(file, "round,event,user,target,technique,item,ailment,damage,critical,success\n");
+    int round = 0;
+    for (int i=0; i<log->nEvents; i++) {
+        const BATTLE_EVENT *event = &log->Events[i];
+        if (event->Type == LOG_ROUND) {
+            round++;
+        }
+        fprintf(file, "%d,%s,", round, (event->Type<=LOG_END && Names[event->Type])? Names[event->Type]: "?");
+        switch (event->Type) {
+        case LOG_CHOICE:
+            ExportID(file, event->A);
+            fprintf(file, ",");
+            ExportID(file, event->C);
+            fprintf(file, ",%s,%s,,,,\n", TechniqueByID(event->B)->Name,
+                event->Value? ItemByID(event->Value)->Name: "");
+            break;
+        case LOG_TURN:
+            fprintf(file, "%d,,,,,,,\n", event->A);
+            break;
+        case LOG_BLOCKED:
+            fprintf(file, "%d,,,,%d,,,\n", event->A, event->B);
+            break;
+        case LOG_MISS:
+            fprintf(file, "%d,%d,,,,,,\n", event->A, event->C);
+            break;
+        case LOG_HIT:
+            fprintf(file, "%d,%d,,,,%d,%d,\n", event->A, event->C, event->Value, event->B);
+            break;
+        case LOG_AILMENT:
+            fprintf(file, ",%d,,,%d,,,\n", event->C, event->B);
+            break;
+        case LOG_ROUND_DAMAGE:
+            fprintf(file, ",%d,,,%d,%d,,\n", event->C, event->B, event->Value);
+            break;
+        case LOG_CAPTURE:
+            fprintf(file, "%d,%d,,,,,,%d\n", event->A, event->C, event->B);
+            break;
+        case LOG_ESCAPE:
+            fprintf(file, ",,,,,,,%d\n", event->B);
+            break;
+        case LOG_END:
+            fprintf(file, ",,,,,,,%d\n", event->B);
+            break;
+        default:
+            fprintf(file, ",,,,,,,\n");
+            break;
+        }
+    }
+}
+
+/**************************************************************/
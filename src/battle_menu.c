@@ -36,13 +36,13 @@ typedef struct {
 
 /**************************************************************/
 /// @brief Buffers the player's spectra's battle menus.
-static PLAYER_MENU PlayerMenu[TEAM_SIZE];
+static PLAYER_MENU PlayerMenu[TEAM_LIMIT];
 
 /// @brief Temporary buffer for target menu.
 static MENU TargetMenu;
 
 /// @brief ID of each enemy on the TargetMenu.
-static int TargetID[BATTLE_SIZE];
+static int TargetID[BATTLE_LIMIT];
 
 /// @brief Used in battle menu code to denote whose turn
 /// is being inputted by the user.
@@ -73,14 +73,14 @@ static MENU ItemMenu;
 
 /// @brief Stores items that are already queued for use
 /// by another battler.
-static int LockedItemIndices[TEAM_SIZE] = {NOT_LOCKED};
+static int LockedItemIndices[TEAM_LIMIT] = {NOT_LOCKED};
 
 /**********************************************************//**
  * @brief Initializes technique menus for each battler.
  **************************************************************/
 static void InitializePlayerMenus(void) {
-    for (int id=0; id<TEAM_SIZE; id++) {
-        SPECTRA *spectra = &Player->Spectra[id];
+    for (int id=0; id<AllyCount(); id++) {
+        const SPECTRA *spectra = &BattlerByID(id)->Spectra;
         PLAYER_MENU *menu = &PlayerMenu[id];
         if (spectra->Species) {
             // Initialize menu data
@@ -115,7 +115,7 @@ static void InitializeItemsMenu(void) {
     InitializeMenuScroll(&ItemMenu, MENU_OPTION);
     
     // Unlock all items
-    for (int i=0; i<TEAM_SIZE; i++) {
+    for (int i=0; i<TEAM_LIMIT; i++) {
         LockedItemIndices[i] = -1;
     }
 }
@@ -125,7 +125,7 @@ static void InitializeItemsMenu(void) {
  * @return True if the user is finished.
  **************************************************************/
 bool BattleMenuDone(void) {
-    return CurrentUser>=TEAM_SIZE || !BattlerIsAlive(BattlerByID(CurrentUser));
+    return CurrentUser>=AllyCount() || !BattlerIsAlive(BattlerByID(CurrentUser));
 }
 
 /**********************************************************//**
@@ -157,7 +157,7 @@ int BattleMenuCurrentTargetID(void) {
  **************************************************************/
 static int FirstUser(void) {
     int id = 0;
-    while (id<TEAM_SIZE) {
+    while (id<AllyCount()) {
         BATTLER *battler = BattlerByID(id);
         if (!BattlerIsAlive(battler)) {
             id++;
@@ -173,7 +173,7 @@ static int FirstUser(void) {
  **************************************************************/
 static void JumpToNextUser(void) {
     CurrentUser++;
-    while (CurrentUser<TEAM_SIZE) {
+    while (CurrentUser<AllyCount()) {
         BATTLER *battler = BattlerByID(CurrentUser);
         if (!BattlerIsAlive(battler)) {
             CurrentUser++;
@@ -215,7 +215,7 @@ void InitializeBattleMenu(void) {
  **************************************************************/
 static void LoadTargetMenu(TARGET_TYPE type) {
     // Temporary buffer for strings used on the TargetMenu.
-    static char EnemyNames[TEAM_SIZE][21];
+    static char EnemyNames[TEAM_LIMIT][21];
     
     if (type&TARGET_GROUP) {
         // Only one group ever, so no menu needed.
@@ -237,10 +237,10 @@ static void LoadTargetMenu(TARGET_TYPE type) {
             int id = TargetID[i];
             if (id==CurrentUser) {
                 TargetMenu.Option[i] = "Yourself";
-            } else if (TargetID[i]>=TEAM_SIZE && type&TARGET_ALLY) {
+            } else if (TargetID[i]>=AllyCount() && type&TARGET_ALLY) {
                 // Disambiguate enemies and users if necessary
-                snprintf(EnemyNames[id-TEAM_SIZE], 20, "Enemy %s", BattlerNameByID(id));
-                TargetMenu.Option[i] = EnemyNames[id-TEAM_SIZE];
+                snprintf(EnemyNames[id-AllyCount()], 20, "Enemy %s", BattlerNameByID(id));
+                TargetMenu.Option[i] = EnemyNames[id-AllyCount()];
             } else {
                 TargetMenu.Option[i] = BattlerNameByID(id);
             }
@@ -340,7 +340,7 @@ void DrawBattleMenu(void) {
  **************************************************************/
 static inline bool SelectedItemLocked(void) {
     int index = MenuItem(&ItemMenu);
-    for (int i=0; i<TEAM_SIZE; i++) {
+    for (int i=0; i<AllyCount(); i++) {
         if (LockedItemIndices[i]==index) {
             return true;
         }
@@ -355,7 +355,7 @@ static inline bool SelectedItemLocked(void) {
  **************************************************************/
 static inline TECHNIQUE_ID SelectedTechniqueID(void) {
     int index = MenuItem(&PlayerMenu[CurrentUser].TechniqueMenu);
-    return BattlerByID(CurrentUser)->Spectra->Moveset[index];
+    return BattlerByID(CurrentUser)->Spectra.Moveset[index];
 }
 
 /**********************************************************//**
@@ -501,10 +501,10 @@ void UpdateBattleMenu(void) {
             if (CurrentUser == FirstUser()) {
                 // Fast-forward out of the battle menu
                 if (!EscapeBattle()) {
-                    for (int id=0; id<TEAM_SIZE; id++) {
+                    for (int id=0; id<AllyCount(); id++) {
                         TurnByID(id)->State = TURN_INACTIVE;
                     }
-                    CurrentUser = TEAM_SIZE;
+                    CurrentUser = AllyCount();
                 }
             } else {
                 JumpToPreviousUser();
@@ -0,0 +1,189 @@
+/**********************************************************//**
+ * @file battle_rules.c
+ * @brief Implements the rules of battle shared by the game
+ * and the battle tools.
+ * @author Rena Shinomiya
+ * @date June 4, 2018
+ **************************************************************/
+
+#include <stdbool.h>            // bool
+
+#include "battle_rules.h"       // ROUND_EFFECT
+#include "random.h"             // randint, uniform
+#include "damage.h"             // DamageFormula, SpeciesMatchup
+
+/**********************************************************//**
+ * @brief Gets the chance for a technique to hit a target.
+ * @param user: Battler using the technique.
+ * @param target: Battler being targetted.
+ * @param allied: Set if the user and target are on the same
+ * team.
+ * @param technique: Technique being used.
+ * @return Chance to hit, from 0.5 up.
+ **************************************************************/
+float HitRate(const BATTLER *user, const BATTLER *target, bool allied, const TECHNIQUE *technique) {
+    if (user==target) {
+        // Can't miss yourself
+        return 1.0;
+    } else if (allied && technique->Power==0) {
+        // Can't miss an ally with non-damaging attack
+        return 1.0;
+    } else {
+        // Can never have worse than 50% chance to hit.
+        float base = (float)BattlerLuck(user)/BattlerEvade(target);
+        return (base < 0.5)? 0.5: base;
+    }
+}
+
+/**********************************************************//**
+ * @brief Gets the chance for a hit to be critical.
+ * @param user: Battler using the technique.
+ * @param target: Battler being hit.
+ * @return Chance of a critical hit.
+ **************************************************************/
+float CriticalHitRate(const BATTLER *user, const BATTLER *target) {
+    float ratio = (float)BattlerLuck(user)/BattlerLuck(target);
+
+    // Minimum critical hit rate:  0%
+    // Average critical hit rate: 10%
+    // Maximum critical hit rate: 20%
+    float base = 0.1*ratio;
+    return (base > 0.2)? 0.2: base;
+}
+
+/**********************************************************//**
+ * @brief Computes the damage of a technique before any
+ * critical hit.
+ * @param user: Battler using the technique.
+ * @param target: Battler being hit.
+ * @param technique: A technique with nonzero power.
+ * @return Damage dealt.
+ **************************************************************/
+int TechniqueDamage(const BATTLER *user, const BATTLER *target, const TECHNIQUE *technique) {
+    return DamageFormula(
+        BattlerAttack(user),
+        BattlerDefend(target),
+        user->Spectra.Level,
+        technique->Power,
+        SpeciesMatchup(technique->Type, target->Spectra.Species)
+    );
+}
+
+/**********************************************************//**
+ * @brief Takes health away from a battler. Health never goes
+ * below 0.
+ * @param battler: Battler to damage.
+ * @param damage: Damage dealt.
+ * @return The damage dealt.
+ **************************************************************/
+int InflictDamage(BATTLER *battler, int damage) {
+    battler->Spectra.Health -= damage;
+    if (battler->Spectra.Health < 0) {
+        battler->Spectra.Health = 0;
+    }
+    return damage;
+}
+
+/**********************************************************//**
+ * @brief Gets the turn priority for a battler.
+ * @param battler: Battler to check.
+ * @return Priority; higher priorities move first.
+ **************************************************************/
+int Priority(const BATTLER *battler) {
+    int evade = BattlerEvade(battler);
+    if (battler->Spectra.Ailment==SHOCKED) {
+        return evade/2;
+    } else {
+        return evade;
+    }
+}
+
+/**********************************************************//**
+ * @brief Lists the techniques the battler can afford, along
+ * with the default attack and defend. Special techniques,
+ * like capturing, are left out.
+ * @param battler: Battler choosing a technique.
+ * @param techniques: Filled with up to MOVESET_SIZE+2
+ * techniques.
+ * @return Number of techniques listed.
+ **************************************************************/
+int UsableTechniques(const BATTLER *battler, TECHNIQUE_ID *techniques) {
+    techniques[0] = DEFAULT_ATTACK;
+    techniques[1] = DEFAULT_DEFEND;
+    int u = 2;
+    for (int t=0; t<battler->Spectra.MovesetSize; t++) {
+        const TECHNIQUE *technique = TechniqueByID(battler->Spectra.Moveset[t]);
+        if (technique->Cost > battler->Spectra.Power || technique->Effect == EFFECT_SPECIAL) {
+            continue;
+        }
+        techniques[u++] = battler->Spectra.Moveset[t];
+    }
+    return u;
+}
+
+/**********************************************************//**
+ * @brief Picks a technique at random from those listed by
+ * UsableTechniques.
+ * @param battler: Battler choosing a technique.
+ * @return The technique chosen.
+ **************************************************************/
+TECHNIQUE_ID RandomTechnique(const BATTLER *battler) {
+    TECHNIQUE_ID usableTechniques[MOVESET_SIZE+2];
+    int u = UsableTechniques(battler, usableTechniques);
+    return usableTechniques[randint(0,u-1)];
+}
+
+/**********************************************************//**
+ * @brief Checks if a status ailment stops the battler from
+ * acting this turn. Being buried only lasts one turn.
+ * @param user: Battler about to take its turn.
+ * @return The ailment that blocked the turn, or 0.
+ **************************************************************/
+AILMENT_ID BlockingAilment(BATTLER *user) {
+    switch (user->Spectra.Ailment) {
+    case SHOCKED:
+        if (uniform(0.0,1.0)<0.5) {
+            return SHOCKED;
+        }
+        return 0;
+    case BURIED:
+        user->Spectra.Ailment = 0;
+        return BURIED;
+    case ASLEEP:
+        return ASLEEP;
+    default:
+        return 0;
+    }
+}
+
+/**********************************************************//**
+ * @brief Applies a battler's status ailment at the end of a
+ * round.
+ * @param battler: A battler that is alive.
+ * @param damage: Set to the damage taken, if any.
+ * @return What the ailment did.
+ **************************************************************/
+ROUND_EFFECT ApplyRoundAilment(BATTLER *battler, int *damage) {
+    *damage = 0;
+    switch (battler->Spectra.Ailment) {
+    case ASLEEP:
+        if (uniform(00.0,1.0)<0.5) {
+            battler->Spectra.Ailment = 0;
+            return ROUND_WOKE_UP;
+        }
+        return ROUND_NO_EFFECT;
+
+    case POISONED:
+        *damage = InflictDamage(battler, 1 + BattlerMaxHealth(battler)/8);
+        return ROUND_POISON;
+
+    case AFLAME:
+        *damage = InflictDamage(battler, 1 + BattlerMaxHealth(battler)/8);
+        return ROUND_FIRE;
+
+    default:
+        return ROUND_NO_EFFECT;
+    }
+}
+
+/**************************************************************/
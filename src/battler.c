@@ -6,23 +6,7 @@
  **************************************************************/
 
 #include "battler.h"        // BATTLER
-
-/**********************************************************//**
- * @brief Gets the multiplication factor for the battler's
- * base stat, given a certain boost level.
- * @param boost: Levels of boosting to apply.
- * @return Factor to multiply a stat by.
- **************************************************************/
-static inline float BoostScale(int boost) {
-    float scale = (float)boost/BOOST_MAX;
-    if (boost>0) {
-        return 1.0 + 3.0*scale*scale;
-    } else if (boost<0) {
-        return 1.0 - 0.75*scale*scale;
-    } else {
-        return 1.0;
-    }
-}
+#include "damage.h"         // BoostScale
 
 /**********************************************************//**
  * @brief Get the battler's boosted attack stat.
@@ -30,7 +14,7 @@ static inline float BoostScale(int boost) {
  * @return Boosted attack stat.
  **************************************************************/
 int BattlerAttack(const BATTLER *battler) {
-    return battler->Spectra->Attack*BoostScale(battler->AttackBoost);
+    return battler->Spectra.Attack*BoostScale(battler->AttackBoost);
 }
 
 /**********************************************************//**
@@ -39,7 +23,7 @@ int BattlerAttack(const BATTLER *battler) {
  * @return Boosted defend stat.
  **************************************************************/
 int BattlerDefend(const BATTLER *battler) {
-    return battler->Spectra->Defend*BoostScale(battler->DefendBoost);
+    return battler->Spectra.Defend*BoostScale(battler->DefendBoost);
 }
 
 /**********************************************************//**
@@ -48,7 +32,7 @@ int BattlerDefend(const BATTLER *battler) {
  * @return Boosted evade stat.
  **************************************************************/
 int BattlerEvade(const BATTLER *battler) {
-    return battler->Spectra->Evade*BoostScale(battler->EvadeBoost);
+    return battler->Spectra.Evade*BoostScale(battler->EvadeBoost);
 }
 
 /**********************************************************//**
@@ -57,7 +41,7 @@ int BattlerEvade(const BATTLER *battler) {
  * @return Boosted luck stat.
  **************************************************************/
 int BattlerLuck(const BATTLER *battler) {
-    return battler->Spectra->Luck*BoostScale(battler->LuckBoost);
+    return battler->Spectra.Luck*BoostScale(battler->LuckBoost);
 }
 
 /**************************************************************/
@@ -0,0 +1,97 @@
+/**********************************************************//**
+ * @file damage.c
+ * @brief Builds the damage lookup tables and runs batches of
+ * damage calculations.
+ * @author Rena Shinomiya
+ * @date June 9, 2018
+ **************************************************************/
+
+#include <stdbool.h>            // bool
+
+#include "damage.h"             // DAMAGE_BATCH
+
+/**************************************************************/
+float BoostScaleTable[2*BOOST_MAX+1];
+float SpeciesMatchupTable[N_TYPE][N_SPECIES];
+
+/**********************************************************//**
+ * @brief Works out the multiplication factor for a boost
+ * level. Only used to fill in BoostScaleTable.
+ * @param boost: Levels of boosting to apply.
+ * @return Factor to multiply a stat by.
+ **************************************************************/
+static float ComputeBoostScale(int boost) {
+    float scale = (float)boost/BOOST_MAX;
+    if (boost>0) {
+        return 1.0 + 3.0*scale*scale;
+    } else if (boost<0) {
+        return 1.0 - 0.75*scale*scale;
+    } else {
+        return 1.0;
+    }
+}
+
+/**********************************************************//**
+ * @brief Fills in the boost and matchup tables. Call this
+ * before any battle starts.
+ **************************************************************/
+void InitializeDamageTables(void) {
+    for (int boost = -BOOST_MAX; boost <= BOOST_MAX; boost++) {
+        BoostScaleTable[boost+BOOST_MAX] = ComputeBoostScale(boost);
+    }
+    for (TYPE_ID type = 1; type < N_TYPE; type++) {
+        for (SPECIES_ID id = 1; id < N_SPECIES; id++) {
+            const TYPE_ID *defending = SpeciesByID(id)->Type;
+            if (!defending[0]) {
+                // Missing species
+                SpeciesMatchupTable[type][id] = 1.0;
+                continue;
+            }
+            float matchup = TypeMatchup(type, defending[0]);
+            if (defending[1]) {
+                matchup *= TypeMatchup(type, defending[1]);
+            }
+            SpeciesMatchupTable[type][id] = matchup;
+        }
+    }
+}
+
+/**********************************************************//**
+ * @brief Adds a damage calculation to a batch.
+ * @param batch: The batch.
+ * @param user: Battler using the technique.
+ * @param target: Battler being hit.
+ * @param technique: A technique with nonzero power.
+ * @return False if the batch is full.
+ **************************************************************/
+bool AddDamageBatch(DAMAGE_BATCH *batch, const BATTLER *user, const BATTLER *target, const TECHNIQUE *technique) {
+    if (batch->Count >= DAMAGE_BATCH_SIZE) {
+        return false;
+    }
+    int i = batch->Count++;
+    batch->Attack[i] = BattlerAttack(user);
+    batch->Defend[i] = BattlerDefend(target);
+    batch->Level[i] = user->Spectra.Level;
+    batch->Power[i] = technique->Power;
+    batch->Matchup[i] = SpeciesMatchup(technique->Type, target->Spectra.Species);
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Works out the damage of every calculation in a
+ * batch. The damage matches TechniqueDamage exactly.
+ * @param batch: The batch.
+ **************************************************************/
+void ComputeDamageBatch(DAMAGE_BATCH *batch) {
+    for (int i = 0; i < batch->Count; i++) {
+        batch->Damage[i] = DamageFormula(
+            batch->Attack[i],
+            batch->Defend[i],
+            batch->Level[i],
+            batch->Power[i],
+            batch->Matchup[i]
+        );
+    }
+}
+
+/**************************************************************/
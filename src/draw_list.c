@@ -0,0 +1,388 @@
+/**********************************************************//**
+ * @file draw_list.c
+ * @brief Records the windows, text and bars of the interface
+ * as they're drawn, then draws them together. Each command
+ * is given a depth just above the commands it covers, so
+ * commands at the same depth never overlap and can be drawn
+ * in any order. Sorting them by texture within each depth
+ * means the whole list goes out under one transform, with a
+ * texture switch only where one is really needed.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#include <stdlib.h>             // realloc, free, qsort
+#include <stdbool.h>            // bool
+#include <stdint.h>             // uintptr_t
+#include <string.h>             // memcpy
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+#include <allegro5/allegro_primitives.h>
+
+#include "draw_list.h"          // DRAW_LIST_SIZE
+#include "debug.h"              // eprintf
+
+/**************************************************************/
+/// @brief Bytes of text the list starts with.
+#define DRAW_TEXT_SIZE 4096
+
+/// @brief Number of recent commands a new command is checked
+/// against for overlap.
+#define DRAW_SCAN 64
+
+/**********************************************************//**
+ * @enum DRAW_KIND
+ * @brief Things a draw command can draw.
+ **************************************************************/
+typedef enum {
+    DRAW_BITMAP,                ///< A whole bitmap.
+    DRAW_RECTANGLE,             ///< A filled rectangle.
+    DRAW_TEXT,                  ///< One line of text.
+} DRAW_KIND;
+
+/**********************************************************//**
+ * @struct DRAW_COMMAND
+ * @brief One recorded draw, in screen coordinates.
+ **************************************************************/
+typedef struct {
+    DRAW_KIND Kind;             ///< What to draw.
+    const void *Texture;        ///< Texture it's drawn from, for sorting.
+    ALLEGRO_BITMAP *Bitmap;     ///< Bitmap, for DRAW_BITMAP.
+    const ALLEGRO_FONT *Font;   ///< Font, for DRAW_TEXT.
+    ALLEGRO_COLOR Color;        ///< Color of a rectangle or text.
+    float X, Y;                 ///< Where it's drawn.
+    float Left, Top;            ///< Upper-left of what it covers.
+    float Right, Bottom;        ///< Lower-right of what it covers.
+    int Flags;                  ///< Bitmap or text flags.
+    int Text;                   ///< Offset of the text in TextArena.
+    int Length;                 ///< Length of the text.
+    int Depth;                  ///< Commands are drawn lowest first.
+    int Sequence;               ///< Order the command was recorded in.
+} DRAW_COMMAND;
+
+/**************************************************************/
+/// @brief Commands recorded since the list was last drawn.
+static DRAW_COMMAND *Commands = NULL;
+
+/// @brief Number of recorded commands.
+static int nCommands = 0;
+
+/// @brief Number of commands there's room for.
+static int CommandCapacity = 0;
+
+/// @brief Highest depth of the commands too old to be checked
+/// for overlap, or -1 if there aren't any.
+static int CoveredDepth = -1;
+
+/// @brief Text of every DRAW_TEXT command, back to back.
+static char *TextArena = NULL;
+
+/// @brief Bytes of TextArena in use.
+static int nText = 0;
+
+/// @brief Bytes TextArena can hold.
+static int TextCapacity = 0;
+
+/// @brief One white pixel, stretched and tinted to draw
+/// rectangles without leaving bitmap drawing.
+static ALLEGRO_BITMAP *Blank = NULL;
+
+/// @brief True once making Blank has been tried.
+static bool BlankTried = false;
+
+/**********************************************************//**
+ * @brief Makes room for one more command, drawing the list
+ * early if it can't grow.
+ * @return True if there's room.
+ **************************************************************/
+static bool ReserveCommand(void) {
+    if (nCommands < CommandCapacity) {
+        return true;
+    }
+    int capacity = CommandCapacity? 2*CommandCapacity: DRAW_LIST_SIZE;
+    DRAW_COMMAND *commands = (DRAW_COMMAND *)realloc(Commands, capacity*sizeof(DRAW_COMMAND));
+    if (!commands) {
+        eprintf("Failed to grow the draw list to %d commands.\n", capacity);
+        FlushDrawList();
+        return nCommands < CommandCapacity;
+    }
+    Commands = commands;
+    CommandCapacity = capacity;
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Copies text into the TextArena.
+ * @param text: The text.
+ * @param length: Length of the text.
+ * @return Offset of the copy, or -1 if there's no room.
+ **************************************************************/
+static int PushText(const char *text, int length) {
+    if (nText+length > TextCapacity) {
+        int capacity = TextCapacity? TextCapacity: DRAW_TEXT_SIZE;
+        while (capacity < nText+length) {
+            capacity *= 2;
+        }
+        char *arena = (char *)realloc(TextArena, capacity);
+        if (!arena) {
+            eprintf("Failed to grow the draw list text to %d bytes.\n", capacity);
+            return -1;
+        }
+        TextArena = arena;
+        TextCapacity = capacity;
+    }
+    int offset = nText;
+    memcpy(&TextArena[offset], text, length);
+    nText += length;
+    return offset;
+}
+
+/**********************************************************//**
+ * @brief Records a command, placing it just above whatever it
+ * might cover. Overlapping commands from the same texture can
+ * share a depth, since they keep their order when sorted.
+ * @param kind: What the command draws.
+ * @param texture: Texture it's drawn from.
+ * @param left: Left of what it covers, before the transform.
+ * @param top: Top of what it covers, before the transform.
+ * @param right: Right of what it covers, before the transform.
+ * @param bottom: Bottom of what it covers, before the transform.
+ * @return The command, or NULL if there's no room.
+ **************************************************************/
+static DRAW_COMMAND *NewCommand(DRAW_KIND kind, const void *texture, float left, float top, float right, float bottom) {
+    if (!ReserveCommand()) {
+        return NULL;
+    }
+
+    // Only translations are used on the interface (DrawAt), so
+    // that's all that gets applied.
+    const ALLEGRO_TRANSFORM *transform = al_get_current_transform();
+    float dx = transform? transform->m[3][0]: 0.0;
+    float dy = transform? transform->m[3][1]: 0.0;
+    DRAW_COMMAND *command = &Commands[nCommands];
+    command->Kind = kind;
+    command->Texture = texture;
+    command->Left = left+dx;
+    command->Top = top+dy;
+    command->Right = right+dx;
+    command->Bottom = bottom+dy;
+    command->Sequence = nCommands;
+
+    // Only the last few commands are checked, so recording stays
+    // cheap however long the list gets. Anything older is taken
+    // to be covered, and the command goes above all of it.
+    int first = (nCommands > DRAW_SCAN)? nCommands-DRAW_SCAN: 0;
+    if (first > 0 && Commands[first-1].Depth > CoveredDepth) {
+        CoveredDepth = Commands[first-1].Depth;
+    }
+    command->Depth = CoveredDepth+1;
+    for (int i = first; i < nCommands; i++) {
+        const DRAW_COMMAND *other = &Commands[i];
+        int depth = other->Depth + (other->Texture != texture);
+        if (depth > command->Depth
+        && other->Left < command->Right && command->Left < other->Right
+        && other->Top < command->Bottom && command->Top < other->Bottom) {
+            command->Depth = depth;
+        }
+    }
+    nCommands++;
+    return command;
+}
+
+/**********************************************************//**
+ * @brief Records a bitmap to be drawn.
+ * @param bitmap: The bitmap.
+ * @param x: Left of the bitmap.
+ * @param y: Top of the bitmap.
+ * @param flags: Flags for al_draw_bitmap.
+ **************************************************************/
+void ListBitmap(ALLEGRO_BITMAP *bitmap, float x, float y, int flags) {
+    // Sub-bitmaps are drawn from their parent's texture.
+    ALLEGRO_BITMAP *parent = al_get_parent_bitmap(bitmap);
+    float right = x+al_get_bitmap_width(bitmap);
+    float bottom = y+al_get_bitmap_height(bitmap);
+    DRAW_COMMAND *command = NewCommand(DRAW_BITMAP, parent? parent: bitmap, x, y, right, bottom);
+    if (command) {
+        command->Bitmap = bitmap;
+        command->X = command->Left;
+        command->Y = command->Top;
+        command->Flags = flags;
+    }
+}
+
+/**********************************************************//**
+ * @brief Records a filled rectangle to be drawn.
+ * @param x0: Left of the rectangle.
+ * @param y0: Top of the rectangle.
+ * @param x1: Right of the rectangle.
+ * @param y1: Bottom of the rectangle.
+ * @param color: Color of the rectangle.
+ **************************************************************/
+void ListRectangle(float x0, float y0, float x1, float y1, ALLEGRO_COLOR color) {
+    if (x1 <= x0 || y1 <= y0) {
+        return;
+    }
+    DRAW_COMMAND *command = NewCommand(DRAW_RECTANGLE, &Blank, x0, y0, x1, y1);
+    if (command) {
+        command->Color = color;
+    }
+}
+
+/**********************************************************//**
+ * @brief Records a line of text to be drawn. The text is
+ * copied, so it doesn't have to last until it's drawn.
+ * @param font: Font of the text.
+ * @param color: Color of the text.
+ * @param x: X position to draw at.
+ * @param y: Y position to draw at.
+ * @param flags: Flags for al_draw_text.
+ * @param text: The text.
+ * @param length: Length of the text.
+ **************************************************************/
+void ListText(const ALLEGRO_FONT *font, ALLEGRO_COLOR color, float x, float y, int flags, const char *text, int length) {
+    ALLEGRO_USTR_INFO info;
+    int width = al_get_ustr_width(font, al_ref_buffer(&info, text, length));
+    float left = x;
+    if (flags & ALLEGRO_ALIGN_RIGHT) {
+        left -= width;
+    } else if (flags & ALLEGRO_ALIGN_CENTRE) {
+        left -= width/2.0;
+    }
+    int offset = PushText(text, length);
+    if (offset < 0) {
+        return;
+    }
+    float bottom = y+al_get_font_line_height(font);
+    DRAW_COMMAND *command = NewCommand(DRAW_TEXT, font, left, y, left+width, bottom);
+    if (command) {
+        command->Font = font;
+        command->Color = color;
+        command->X = x+(command->Left-left);
+        command->Y = command->Top;
+        command->Flags = flags;
+        command->Text = offset;
+        command->Length = length;
+    }
+}
+
+/**********************************************************//**
+ * @brief Orders commands by depth, then texture, then the
+ * order they were recorded in.
+ * @param a: First DRAW_COMMAND.
+ * @param b: Second DRAW_COMMAND.
+ * @return Negative if a goes first, positive if b goes first.
+ **************************************************************/
+static int CompareCommands(const void *a, const void *b) {
+    const DRAW_COMMAND *first = (const DRAW_COMMAND *)a;
+    const DRAW_COMMAND *second = (const DRAW_COMMAND *)b;
+    if (first->Depth != second->Depth) {
+        return first->Depth - second->Depth;
+    }
+    uintptr_t t1 = (uintptr_t)first->Texture;
+    uintptr_t t2 = (uintptr_t)second->Texture;
+    if (t1 != t2) {
+        return (t1 < t2)? -1: 1;
+    }
+    return first->Sequence - second->Sequence;
+}
+
+/**********************************************************//**
+ * @brief Makes the white pixel rectangles are drawn with.
+ **************************************************************/
+static void CreateBlank(void) {
+    BlankTried = true;
+    Blank = al_create_bitmap(1, 1);
+    if (!Blank) {
+        eprintf("Failed to create the draw list's blank bitmap.\n");
+        return;
+    }
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP);
+    al_set_target_bitmap(Blank);
+    al_clear_to_color(al_map_rgb(255, 255, 255));
+    al_restore_state(&state);
+}
+
+/**********************************************************//**
+ * @brief Draws every recorded command onto the target bitmap
+ * and empties the list. This has to be called before the
+ * target changes, and before anything is drawn straight to
+ * the target over the interface.
+ **************************************************************/
+void FlushDrawList(void) {
+    if (!nCommands) {
+        return;
+    }
+    if (!BlankTried) {
+        CreateBlank();
+    }
+    qsort(Commands, nCommands, sizeof(DRAW_COMMAND), CompareCommands);
+
+    // Commands are already in screen coordinates.
+    ALLEGRO_STATE state;
+    ALLEGRO_TRANSFORM identity;
+    al_store_state(&state, ALLEGRO_STATE_TRANSFORM);
+    al_identity_transform(&identity);
+    al_use_transform(&identity);
+    al_hold_bitmap_drawing(true);
+    for (int i = 0; i < nCommands; i++) {
+        const DRAW_COMMAND *command = &Commands[i];
+        ALLEGRO_USTR_INFO info;
+        switch (command->Kind) {
+        case DRAW_BITMAP:
+            al_draw_bitmap(command->Bitmap, command->X, command->Y, command->Flags);
+            break;
+        case DRAW_RECTANGLE:
+            if (Blank) {
+                al_draw_tinted_scaled_bitmap(
+                    Blank,
+                    command->Color,
+                    0, 0, 1, 1,
+                    command->Left,
+                    command->Top,
+                    command->Right-command->Left,
+                    command->Bottom-command->Top,
+                    0);
+            } else {
+                al_hold_bitmap_drawing(false);
+                al_draw_filled_rectangle(command->Left, command->Top, command->Right, command->Bottom, command->Color);
+                al_hold_bitmap_drawing(true);
+            }
+            break;
+        case DRAW_TEXT:
+            al_draw_ustr(
+                command->Font,
+                command->Color,
+                command->X,
+                command->Y,
+                command->Flags,
+                al_ref_buffer(&info, &TextArena[command->Text], command->Length));
+            break;
+        }
+    }
+    al_hold_bitmap_drawing(false);
+    al_restore_state(&state);
+    nCommands = 0;
+    nText = 0;
+    CoveredDepth = -1;
+}
+
+/**********************************************************//**
+ * @brief Frees the draw list. Anything still in it is lost.
+ **************************************************************/
+void DestroyDrawList(void) {
+    free(Commands);
+    free(TextArena);
+    Commands = NULL;
+    TextArena = NULL;
+    nCommands = CommandCapacity = 0;
+    nText = TextCapacity = 0;
+    if (Blank) {
+        al_destroy_bitmap(Blank);
+        Blank = NULL;
+    }
+    BlankTried = false;
+}
+
+/**************************************************************/
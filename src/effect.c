@@ -10,7 +10,7 @@
 #include "random.h"         // randint
 #include "effect.h"         // EFFECT_ID
 #include "battler.h"        // BATTLER
-#include "output.h"         // Output
+#include "output.h"         // OutputMessage
 #include "debug.h"          // eprintf, assert
 
 /**********************************************************//**
@@ -54,7 +54,7 @@ bool ShouldEffectActivate(EFFECT_ID id, int argument) {
  **************************************************************/
 static bool Afflict(BATTLER *battler, AILMENT_ID ailment) {
     // Already afflicted?
-    if (battler->Spectra->Ailment) {
+    if (battler->Spectra.Ailment) {
         return false;
     }
     
@@ -81,22 +81,22 @@ static bool Afflict(BATTLER *battler, AILMENT_ID ailment) {
     }
     
     // Apply effect
-    battler->Spectra->Ailment = ailment;
+    battler->Spectra.Ailment = ailment;
     switch (ailment) {
     case POISONED:
-        OutputF("%s was poisoned!", BattlerName(battler));
+        OutputMessage(MESSAGE_POISONED, BattlerName(battler));
         break;
     case SHOCKED:
-        OutputF("%s was shocked!", BattlerName(battler));
+        OutputMessage(MESSAGE_SHOCKED, BattlerName(battler));
         break;
     case BURIED:
-        OutputF("%s was buried in the ground!", BattlerName(battler));
+        OutputMessage(MESSAGE_BURIED, BattlerName(battler));
         break;
     case ASLEEP:
-        OutputF("%s fell asleep!", BattlerName(battler));
+        OutputMessage(MESSAGE_FELL_ASLEEP, BattlerName(battler));
         break;
     case AFLAME:
-        OutputF("%s was set on fire!", BattlerName(battler));
+        OutputMessage(MESSAGE_SET_ON_FIRE, BattlerName(battler));
         break;
     default:
         break;
@@ -115,19 +115,19 @@ static bool Cure(SPECTRA *spectra, AILMENT_ID id) {
         spectra->Ailment = 0;
         switch (id) {
         case POISONED:
-            OutputF("%s is no longer poisoned!", SpectraName(spectra));
+            OutputMessage(MESSAGE_CURED_POISON, SpectraName(spectra));
             break;
         case SHOCKED:
-            OutputF("%s is no longer shocked!", SpectraName(spectra));
+            OutputMessage(MESSAGE_CURED_SHOCK, SpectraName(spectra));
             break;
         case BURIED:
-            OutputF("%s was unburied!", SpectraName(spectra));
+            OutputMessage(MESSAGE_UNBURIED, SpectraName(spectra));
             break;
         case ASLEEP:
-            OutputF("%s woke up!", SpectraName(spectra));
+            OutputMessage(MESSAGE_WOKE_UP, SpectraName(spectra));
             break;
         case AFLAME:
-            OutputF("%s was extinguished!", SpectraName(spectra));
+            OutputMessage(MESSAGE_EXTINGUISHED, SpectraName(spectra));
             break;
         default:
             break;
@@ -151,7 +151,7 @@ static bool Heal(SPECTRA *spectra, int amount) {
     }
     int delta = spectra->Health - before;
     if (delta) {
-        OutputF("%s healed by %d!", SpectraName(spectra), delta);
+        OutputMessage(MESSAGE_HEALED, SpectraName(spectra), delta);
         return true;
     }
     return false;
@@ -204,22 +204,22 @@ static bool BoostStat(BATTLER *battler, STAT_ID stat, int boost) {
     switch (stat) {
     case ATTACK:
         battler->AttackBoost = final;
-        OutputF("%s's attack %s %s!", BattlerName(battler), change, magnitude);
+        OutputMessage(MESSAGE_ATTACK_BOOST, BattlerName(battler), change, magnitude);
         break;
     
     case DEFEND:
         battler->DefendBoost = final;
-        OutputF("%s's defend %s %s!", BattlerName(battler), change, magnitude);
+        OutputMessage(MESSAGE_DEFEND_BOOST, BattlerName(battler), change, magnitude);
         break;
     
     case EVADE:
         battler->EvadeBoost = final;
-        OutputF("%s's evade %s %s!", BattlerName(battler), change, magnitude);
+        OutputMessage(MESSAGE_EVADE_BOOST, BattlerName(battler), change, magnitude);
         break;
     
     case LUCK:
         battler->DefendBoost = final;
-        OutputF("%s's luck %s %s!", BattlerName(battler), change, magnitude);
+        OutputMessage(MESSAGE_LUCK_BOOST, BattlerName(battler), change, magnitude);
         break;
     }
     return true;
@@ -234,7 +234,7 @@ static void ResetStats(BATTLER *battler) {
     battler->DefendBoost = 0;
     battler->EvadeBoost = 0;
     battler->LuckBoost = 0;
-    OutputF("%s's stats went back to normal.", BattlerName(battler));
+    OutputMessage(MESSAGE_STATS_RESET, BattlerName(battler));
 }
 
 /**********************************************************//**
@@ -242,8 +242,8 @@ static void ResetStats(BATTLER *battler) {
  * @param battler: Battler to kill.
  **************************************************************/
 static void Kill(BATTLER *battler) {
-    battler->Spectra->Health = 0;
-    OutputF("%s died!", BattlerName(battler));
+    battler->Spectra.Health = 0;
+    OutputMessage(MESSAGE_DIED, BattlerName(battler));
 }
 
 /**********************************************************//**
@@ -255,7 +255,7 @@ static void SetFlag(BATTLER *battler, BATTLER_FLAGS flag) {
     battler->Flags |= flag;
     switch (flag) {
     case BATTLER_DEFEND:
-        OutputF("%s is defending.", BattlerName(battler));
+        OutputMessage(MESSAGE_DEFENDING, BattlerName(battler));
         break;
     default:
         break;
@@ -288,23 +288,23 @@ bool ApplyEffectInBattle(EFFECT_ID id, BATTLER *user, BATTLER *target, int argum
     
     // Curing ailments
     case CURE_BURY:
-        return Cure(target->Spectra, BURIED);
+        return Cure(&target->Spectra, BURIED);
     case CURE_AFLAME:
-        return Cure(target->Spectra, AFLAME);
+        return Cure(&target->Spectra, AFLAME);
     case CURE_POISON:
-        return Cure(target->Spectra, POISONED);
+        return Cure(&target->Spectra, POISONED);
     case CURE_SHOCK:
-        return Cure(target->Spectra, SHOCKED);
+        return Cure(&target->Spectra, SHOCKED);
     case CURE_SLEEP:
-        return Cure(target->Spectra, ASLEEP);
+        return Cure(&target->Spectra, ASLEEP);
     case CURE_ANY:
-        return Cure(target->Spectra, target->Spectra->Ailment);
+        return Cure(&target->Spectra, target->Spectra.Ailment);
     
     // Healing
     case HEAL_CONSTANT:
-        return Heal(target->Spectra, argument);
+        return Heal(&target->Spectra, argument);
     case HEAL_PERCENT:
-        return Heal(target->Spectra, target->Spectra->MaxHealth*argument/100);
+        return Heal(&target->Spectra, target->Spectra.MaxHealth*argument/100);
     
     // Stat boosting
     case RESET_STATS:
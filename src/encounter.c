@@ -0,0 +1,322 @@
+/**********************************************************//**
+ * @file encounter.c
+ * @brief Builds alias tables so random encounters can be
+ * rolled in constant time.
+ * @author Rena Shinomiya
+ * @date May 31, 2018
+ **************************************************************/
+
+#include <stdlib.h>             // malloc, free
+#include <stdbool.h>            // bool
+
+#include "species.h"            // N_SPECIES, LEVEL_MAX
+#include "encounter.h"          // ENCOUNTER
+#include "random.h"             // randint, uniform
+#include "debug.h"              // eprintf
+
+/**********************************************************//**
+ * @struct ENCOUNTER_TABLE
+ * @brief Alias table for one list of encounters. Rolling
+ * picks a column uniformly, then either keeps it or takes its
+ * alias.
+ **************************************************************/
+typedef struct {
+    const ENCOUNTER *Encounters;    ///< The encounters being rolled.
+    int Size;                       ///< Number of encounters.
+    float Chance;                   ///< Encounter chance per second of walking.
+    float *Probability;             ///< Chance to keep each column.
+    int *Alias;                     ///< Replacement for each column.
+} ENCOUNTER_TABLE;
+
+/**************************************************************/
+/// @brief Alias tables for each location's encounter zones.
+/// Zone n is stored at index n-1.
+static ENCOUNTER_TABLE *ZoneTables[N_LOCATION];
+
+/// @brief Number of encounter zones in each location.
+static int ZoneCount[N_LOCATION];
+
+/// @brief Alias tables for each location's own overworld
+/// encounters.
+static ENCOUNTER_TABLE OverworldTables[N_LOCATION];
+
+/// @brief Alias tables for each location's fishing encounters.
+static ENCOUNTER_TABLE FishingTables[N_LOCATION];
+
+/**********************************************************//**
+ * @brief Gets the chance of an encounter per second of
+ * walking for an encounter rate.
+ * @param rate: The encounter rate.
+ * @return Chance of an encounter per second.
+ **************************************************************/
+float EncounterChance(ENCOUNTER_RATE rate) {
+    switch (rate) {
+    case RARE:
+        return 0.05;
+    case UNCOMMON:
+        return 0.10;
+    case COMMON:
+        return 0.20;
+    default:
+        return 0.0;
+    }
+}
+
+/**********************************************************//**
+ * @brief Reports problems with a list of encounters: chances
+ * that don't add up to 100, unknown species and bad level
+ * ranges. The alias table still rolls a list whose chances
+ * are off in exact proportion to them.
+ * @param encounters: Encounters ending with a 0 Chance.
+ * @param id: Location the encounters belong to.
+ * @param name: Which of the location's lists it is.
+ * @return True if the list is well-formed.
+ **************************************************************/
+static bool ValidateEncounters(const ENCOUNTER *encounters, LOCATION_ID id, const char *name) {
+    bool valid = true;
+    int total = 0;
+    for (int i = 0; encounters[i].Chance > 0; i++) {
+        const ENCOUNTER *encounter = &encounters[i];
+        total += encounter->Chance;
+        if (encounter->Spectra <= 0 || encounter->Spectra >= N_SPECIES) {
+            eprintf("%s encounter %d of location %d has unknown species %d.\n",
+                name, i+1, id, encounter->Spectra);
+            valid = false;
+        }
+        int min = encounter->LevelRange[0];
+        int max = encounter->LevelRange[1];
+        if (min < 1 || min > max || max > LEVEL_MAX) {
+            eprintf("%s encounter %d of location %d has level range {%d, %d}.\n",
+                name, i+1, id, min, max);
+            valid = false;
+        }
+    }
+    if (total != 100) {
+        eprintf("%s encounters of location %d add up to %d%%.\n", name, id, total);
+        valid = false;
+    }
+    return valid;
+}
+
+/**********************************************************//**
+ * @brief Builds an alias table from a list of encounters.
+ * @param table: The table to fill in.
+ * @param encounters: Encounters ending with a 0 Chance.
+ * @return True on success.
+ **************************************************************/
+static bool BuildEncounterTable(ENCOUNTER_TABLE *table, const ENCOUNTER *encounters) {
+    table->Encounters = encounters;
+    table->Size = 0;
+    table->Probability = NULL;
+    table->Alias = NULL;
+    int total = 0;
+    while (encounters && encounters[table->Size].Chance > 0) {
+        total += encounters[table->Size++].Chance;
+    }
+    if (!table->Size) {
+        return true;
+    }
+
+    // Scratch space for the scaled chances and work lists.
+    int n = table->Size;
+    float *scaled = (float *)malloc(sizeof(float)*n);
+    int *small = (int *)malloc(sizeof(int)*n);
+    int *large = (int *)malloc(sizeof(int)*n);
+    table->Probability = (float *)malloc(sizeof(float)*n);
+    table->Alias = (int *)malloc(sizeof(int)*n);
+    bool success = scaled && small && large && table->Probability && table->Alias;
+    if (success) {
+        // Split columns into under- and over-full.
+        int nSmall = 0;
+        int nLarge = 0;
+        for (int i = 0; i < n; i++) {
+            scaled[i] = (float)encounters[i].Chance*n/total;
+            if (scaled[i] < 1.0) {
+                small[nSmall++] = i;
+            } else {
+                large[nLarge++] = i;
+            }
+        }
+
+        // Top up each under-full column from an over-full one.
+        while (nSmall && nLarge) {
+            int less = small[--nSmall];
+            int more = large[--nLarge];
+            table->Probability[less] = scaled[less];
+            table->Alias[less] = more;
+            scaled[more] += scaled[less]-1.0;
+            if (scaled[more] < 1.0) {
+                small[nSmall++] = more;
+            } else {
+                large[nLarge++] = more;
+            }
+        }
+
+        // Leftovers are full up to rounding error.
+        while (nLarge) {
+            int i = large[--nLarge];
+            table->Probability[i] = 1.0;
+            table->Alias[i] = i;
+        }
+        while (nSmall) {
+            int i = small[--nSmall];
+            table->Probability[i] = 1.0;
+            table->Alias[i] = i;
+        }
+    } else {
+        eprintf("Out of memory for encounter table.\n");
+        free(table->Probability);
+        free(table->Alias);
+        table->Probability = NULL;
+        table->Alias = NULL;
+        table->Size = 0;
+    }
+    free(scaled);
+    free(small);
+    free(large);
+    return success;
+}
+
+/**********************************************************//**
+ * @brief Rolls a random encounter from an alias table.
+ * @param table: The table to roll.
+ * @return The encounter rolled, or NULL if the table is empty.
+ **************************************************************/
+static const ENCOUNTER *RollEncounterTable(const ENCOUNTER_TABLE *table) {
+    if (!table->Size) {
+        return NULL;
+    }
+    int i = randint(0, table->Size-1);
+    if (uniform(0.0, 1.0) >= table->Probability[i]) {
+        i = table->Alias[i];
+    }
+    return &table->Encounters[i];
+}
+
+/**********************************************************//**
+ * @brief Builds the encounter tables for every location.
+ * @return True on success.
+ **************************************************************/
+bool InitializeEncounters(void) {
+    DestroyEncounters();
+    bool success = true;
+    for (LOCATION_ID id = 1; id < N_LOCATION; id++) {
+        const LOCATION *location = Location(id);
+        if (location->Encounters) {
+            ValidateEncounters(location->Encounters, id, "Overworld");
+        }
+        if (location->Fishing) {
+            ValidateEncounters(location->Fishing, id, "Fishing");
+        }
+        success &= BuildEncounterTable(&OverworldTables[id], location->Encounters);
+        success &= BuildEncounterTable(&FishingTables[id], location->Fishing);
+
+        const ENCOUNTER_ZONE *zones = location->Zones;
+        int count = 0;
+        while (zones && zones[count].Encounters) {
+            count++;
+        }
+        if (!count) {
+            continue;
+        }
+        ZoneTables[id] = (ENCOUNTER_TABLE *)malloc(sizeof(ENCOUNTER_TABLE)*count);
+        if (!ZoneTables[id]) {
+            eprintf("Out of memory for encounter zones.\n");
+            success = false;
+            continue;
+        }
+        ZoneCount[id] = count;
+        for (int i = 0; i < count; i++) {
+            ENCOUNTER_TABLE *table = &ZoneTables[id][i];
+            success &= BuildEncounterTable(table, zones[i].Encounters);
+            table->Chance = table->Size? EncounterChance(zones[i].Rate): 0.0;
+            if (!table->Size) {
+                eprintf("Encounter zone %d of location %d is empty.\n", i+1, id);
+            } else {
+                ValidateEncounters(zones[i].Encounters, id, "Zone");
+            }
+        }
+    }
+    return success;
+}
+
+/**********************************************************//**
+ * @brief Releases all encounter tables.
+ **************************************************************/
+void DestroyEncounters(void) {
+    for (LOCATION_ID id = 0; id < N_LOCATION; id++) {
+        free(OverworldTables[id].Probability);
+        free(OverworldTables[id].Alias);
+        free(FishingTables[id].Probability);
+        free(FishingTables[id].Alias);
+        OverworldTables[id].Size = 0;
+        FishingTables[id].Size = 0;
+        for (int i = 0; i < ZoneCount[id]; i++) {
+            free(ZoneTables[id][i].Probability);
+            free(ZoneTables[id][i].Alias);
+        }
+        free(ZoneTables[id]);
+        ZoneTables[id] = NULL;
+        ZoneCount[id] = 0;
+    }
+}
+
+/**********************************************************//**
+ * @brief Gets the chance of an encounter per second of
+ * walking in an encounter zone.
+ * @param id: The current location.
+ * @param zone: The zone of the current tile. Zone 0 uses the
+ * location's own encounter rate.
+ * @return Chance of an encounter per second.
+ **************************************************************/
+float ZoneEncounterChance(LOCATION_ID id, int zone) {
+    if (id <= 0 || id >= N_LOCATION) {
+        return 0.0;
+    } else if (zone == 0) {
+        const LOCATION *location = Location(id);
+        return location->Encounters? EncounterChance(location->EncounterRate): 0.0;
+    } else if (zone <= ZoneCount[id]) {
+        return ZoneTables[id][zone-1].Chance;
+    }
+    return 0.0;
+}
+
+/**********************************************************//**
+ * @brief Rolls an encounter from an encounter zone.
+ * @param id: The current location.
+ * @param zone: The zone of the current tile.
+ * @return The encounter, or NULL if the zone has no table.
+ **************************************************************/
+const ENCOUNTER *ZoneEncounter(LOCATION_ID id, int zone) {
+    if (id <= 0 || id >= N_LOCATION || zone <= 0 || zone > ZoneCount[id]) {
+        return NULL;
+    }
+    return RollEncounterTable(&ZoneTables[id][zone-1]);
+}
+
+/**********************************************************//**
+ * @brief Rolls an encounter from a location's own overworld
+ * encounters.
+ * @param id: The current location.
+ * @return The encounter, or NULL if the location has none.
+ **************************************************************/
+const ENCOUNTER *OverworldEncounter(LOCATION_ID id) {
+    if (id <= 0 || id >= N_LOCATION) {
+        return NULL;
+    }
+    return RollEncounterTable(&OverworldTables[id]);
+}
+
+/**********************************************************//**
+ * @brief Rolls a fishing encounter for a location.
+ * @param id: The current location.
+ * @return The encounter, or NULL if there's no fishing here.
+ **************************************************************/
+const ENCOUNTER *FishingEncounter(LOCATION_ID id) {
+    if (id <= 0 || id >= N_LOCATION) {
+        return NULL;
+    }
+    return RollEncounterTable(&FishingTables[id]);
+}
+
+/**************************************************************/
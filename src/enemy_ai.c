@@ -0,0 +1,279 @@
+/**********************************************************//**
+ * @file enemy_ai.c
+ * @brief Implements the search-based enemy AI. Each enemy's
+ * choices are scored by Monte Carlo rollouts on copies of the
+ * battle, using the same engine and rules as the real thing.
+ * The player's side is assumed to choose at random, so the
+ * AI never peeks at the turns the player actually picked.
+ * @author Rena Shinomiya
+ * @date June 6, 2018
+ **************************************************************/
+
+#include <stdbool.h>            // bool
+#include <math.h>               // sqrt, log
+
+#include <allegro5/allegro.h>   // ALLEGRO_THREAD, al_get_time
+
+#include "random.h"             // RandomNext
+#include "output.h"             // MuteOutput
+#include "battle_rules.h"       // UsableTechniques
+#include "battle_engine.h"      // BATTLE_CONTEXT, RunRound
+#include "enemy_ai.h"           // AI_DEFAULT_BUDGET
+
+/**************************************************************/
+/// @brief Rounds played at random after the candidate round.
+#define AI_DEPTH 3
+
+/// @brief Most choices one enemy can have: every technique
+/// against every target.
+#define AI_CANDIDATES ((MOVESET_SIZE+2)*BATTLE_MAX)
+
+/// @brief How strongly the search tries choices it hasn't
+/// played out much yet.
+#define AI_EXPLORATION 0.7
+
+/**********************************************************//**
+ * @struct AI_CANDIDATE
+ * @brief One choice an enemy could make, and how it did.
+ **************************************************************/
+typedef struct {
+    TURN Turn;                  ///< The choice.
+    double Score;               ///< Sum of rollout scores.
+    int Visits;                 ///< Number of rollouts.
+} AI_CANDIDATE;
+
+/**********************************************************//**
+ * @struct AI_STATE
+ * @brief Everything the worker thread uses. The main thread
+ * only touches it while no worker is running.
+ **************************************************************/
+typedef struct {
+    BATTLE_CONTEXT Root;                                ///< Battle at the start of the round.
+    AI_CANDIDATE Candidate[TEAM_MAX][AI_CANDIDATES];    ///< Choices for each enemy.
+    int nCandidates[TEAM_MAX];                          ///< Number of choices for each enemy.
+    int Rollouts;                                       ///< Rollouts played out so far.
+    double Deadline;                                    ///< Time to stop thinking.
+    bool Ready;                                         ///< Set if the search is for this round.
+    ALLEGRO_THREAD *Thread;                             ///< The worker, or NULL.
+} AI_STATE;
+
+/**************************************************************/
+/// @brief The search for the current round.
+static AI_STATE Search;
+
+/**********************************************************//**
+ * @brief Lists every technique and target an enemy could
+ * choose this round.
+ * @param id: ID of the enemy.
+ **************************************************************/
+static void LoadCandidates(int id) {
+    BATTLER *battler = ContextBattler(&Search.Root, id);
+    AI_CANDIDATE *candidates = Search.Candidate[id-Search.Root.nAllies];
+    int n = 0;
+    if (BattlerIsAlive(battler)) {
+        TECHNIQUE_ID techniques[MOVESET_SIZE+2];
+        int nTechniques = UsableTechniques(battler, techniques);
+        for (int t=0; t<nTechniques; t++) {
+            TARGET_TYPE type = TechniqueByID(techniques[t])->Target;
+            int targets[BATTLE_MAX];
+            int nTargets;
+            if (type&TARGET_GROUP) {
+                targets[0] = -1;
+                nTargets = 1;
+            } else {
+                nTargets = ContextTargets(&Search.Root, targets, id, type);
+            }
+            for (int i=0; i<nTargets; i++) {
+                AI_CANDIDATE *candidate = &candidates[n++];
+                candidate->Turn.State = TURN_PENDING;
+                candidate->Turn.User = id;
+                candidate->Turn.Technique = techniques[t];
+                candidate->Turn.Item = 0;
+                candidate->Turn.Target = targets[i];
+                candidate->Score = 0.0;
+                candidate->Visits = 0;
+            }
+        }
+    }
+    Search.nCandidates[id-Search.Root.nAllies] = n;
+}
+
+/**********************************************************//**
+ * @brief Scores a battle from the enemy's point of view.
+ * @param battle: The battle after a rollout.
+ * @return 1 if the enemy won, -1 if the player won, and
+ * otherwise the difference in health left on each side.
+ **************************************************************/
+static double Evaluate(const BATTLE_CONTEXT *battle) {
+    if (battle->State == BATTLE_STATE_LOSE) {
+        return 1.0;
+    } else if (battle->State == BATTLE_STATE_WIN) {
+        return -1.0;
+    }
+    double score = 0.0;
+    int nAllies = battle->nAllies;
+    int nEnemies = battle->nBattlers-nAllies;
+    for (int id=0; id<battle->nBattlers; id++) {
+        const BATTLER *battler = &battle->Battler[id];
+        if (!BattlerIsAlive(battler)) {
+            continue;
+        }
+        double health = (double)BattlerHealth(battler)/BattlerMaxHealth(battler);
+        score += BattlerIsAlly(battle, id)? -health/nAllies: health/nEnemies;
+    }
+    return score;
+}
+
+/**********************************************************//**
+ * @brief Plays out the battle once with an enemy making the
+ * given choice. Everyone else chooses at random.
+ * @param turn: The choice to try.
+ * @return Score of the battle afterwards.
+ **************************************************************/
+static double Rollout(const TURN *turn) {
+    BATTLE_CONTEXT battle;
+    CopyBattleContext(&battle, &Search.Root);
+    SeedBattleContext(&battle, RandomNext());
+    for (int id=0; id<battle.nBattlers; id++) {
+        ChooseRandomTurn(&battle, id);
+    }
+    battle.Turns[turn->User] = *turn;
+    RunRound(&battle);
+    for (int depth=0; depth<AI_DEPTH && battle.State==BATTLE_STATE_ACTIVE; depth++) {
+        BeginRound(&battle);
+        for (int id=0; id<battle.nBattlers; id++) {
+            ChooseRandomTurn(&battle, id);
+        }
+        RunRound(&battle);
+    }
+    return Evaluate(&battle);
+}
+
+/**********************************************************//**
+ * @brief Picks the candidate to play out next (UCB1), trying
+ * each one once before favoring the best.
+ * @param candidates: The enemy's choices.
+ * @param n: Number of choices.
+ * @param visits: Total rollouts for this enemy.
+ * @return The candidate to try.
+ **************************************************************/
+static AI_CANDIDATE *SelectCandidate(AI_CANDIDATE *candidates, int n, int visits) {
+    AI_CANDIDATE *best = NULL;
+    double bestValue = 0.0;
+    double explore = AI_EXPLORATION*sqrt(log(visits+1));
+    for (int c=0; c<n; c++) {
+        AI_CANDIDATE *candidate = &candidates[c];
+        if (!candidate->Visits) {
+            return candidate;
+        }
+        double value = candidate->Score/candidate->Visits + explore/sqrt(candidate->Visits);
+        if (!best || value > bestValue) {
+            best = candidate;
+            bestValue = value;
+        }
+    }
+    return best;
+}
+
+/**********************************************************//**
+ * @brief Worker thread: plays out rollouts for every enemy
+ * in turn until it's told to stop or runs out of time.
+ * @param thread: The thread.
+ * @param argument: Unused.
+ * @return NULL.
+ **************************************************************/
+static void *Think(ALLEGRO_THREAD *thread, void *argument) {
+    (void)argument;
+    MuteOutput(true);
+    while (!al_get_thread_should_stop(thread) && al_get_time() < Search.Deadline) {
+        int visits = Search.Rollouts++;
+        for (int e=0; e<Search.Root.nBattlers-Search.Root.nAllies; e++) {
+            if (!Search.nCandidates[e]) {
+                continue;
+            }
+            AI_CANDIDATE *candidate = SelectCandidate(Search.Candidate[e], Search.nCandidates[e], visits);
+            candidate->Score += Rollout(&candidate->Turn);
+            candidate->Visits++;
+        }
+    }
+    return NULL;
+}
+
+/**********************************************************//**
+ * @brief Starts thinking about the enemy turns for a round.
+ * Call this at the start of the round; the search runs on a
+ * worker thread until the budget runs out or FinishEnemyAI
+ * is called.
+ * @param context: The battle at the start of the round.
+ * @param budget: Milliseconds to think, or 0 for the default.
+ **************************************************************/
+void StartEnemyAI(const BATTLE_CONTEXT *context, int budget) {
+    StopEnemyAI();
+
+    // The worker plays out copies without side effects.
+    CopyBattleContext(&Search.Root, context);
+    Search.Root.Quiet = true;
+    Search.Root.Capture = NULL;
+    Search.Root.UseItem = NULL;
+    Search.Root.Notify = NULL;
+    Search.Root.NotifyData = NULL;
+    Search.Root.Log = NULL;
+    for (int id=Search.Root.nAllies; id<Search.Root.nBattlers; id++) {
+        LoadCandidates(id);
+    }
+    Search.Rollouts = 0;
+    Search.Deadline = al_get_time() + ((budget>0)? budget: AI_DEFAULT_BUDGET)/1000.0;
+    Search.Ready = true;
+
+    // Without a thread, FinishEnemyAI falls back to random turns.
+    Search.Thread = al_create_thread(Think, NULL);
+    if (Search.Thread) {
+        al_start_thread(Search.Thread);
+    }
+}
+
+/**********************************************************//**
+ * @brief Stops the worker thread, if there is one. This only
+ * waits for the rollout in progress to finish.
+ **************************************************************/
+void StopEnemyAI(void) {
+    if (Search.Thread) {
+        al_join_thread(Search.Thread, NULL);
+        al_destroy_thread(Search.Thread);
+        Search.Thread = NULL;
+    }
+}
+
+/**********************************************************//**
+ * @brief Stops thinking and loads the best turn found for
+ * each enemy into the battle. Enemies without any results
+ * choose at random.
+ * @param context: The battle to load the turns into.
+ **************************************************************/
+void FinishEnemyAI(BATTLE_CONTEXT *context) {
+    StopEnemyAI();
+    for (int id=context->nAllies; id<context->nBattlers; id++) {
+        const AI_CANDIDATE *best = NULL;
+        if (Search.Ready) {
+            int e = id-context->nAllies;
+            const AI_CANDIDATE *candidates = Search.Candidate[e];
+            for (int c=0; c<Search.nCandidates[e]; c++) {
+                const AI_CANDIDATE *candidate = &candidates[c];
+                if (!candidate->Visits) {
+                    continue;
+                }
+                if (!best || candidate->Score/candidate->Visits > best->Score/best->Visits) {
+                    best = candidate;
+                }
+            }
+        }
+        if (best && BattlerIsAlive(ContextBattler(context, id))) {
+            context->Turns[id] = best->Turn;
+        } else {
+            ChooseRandomTurn(context, id);
+        }
+    }
+    Search.Ready = false;
+}
+
+/**************************************************************/
@@ -8,7 +8,6 @@
 #include <stddef.h>             // NULL
 #include <stdbool.h>            // bool
 #include <assert.h>             // assert
-#include <stdlib.h>             // srand
 #include <time.h>               // time
 
 #include <allegro5/allegro.h>
@@ -22,6 +21,19 @@
 
 #include "game.h"               // KEY
 #include "assets.h"             // LoadAssets, DestroyAssets
+#include "route.h"              // InitializeRoutes, DestroyRoutes
+#include "encounter.h"          // InitializeEncounters, DestroyEncounters
+#include "damage.h"             // InitializeDamageTables
+#include "animation.h"          // UpdateAnimationClock
+#include "particle.h"           // InitializeParticles, DestroyParticles
+#include "world_map.h"          // InitializeWorldMap, DestroyWorldMap
+#include "draw_list.h"          // FlushDrawList, DestroyDrawList
+#include "storage.h"            // DestroyStorage
+#include "player.h"             // LoadGame, DestroySaveGame
+#include "snapshot.h"           // UpdateSnapshots, DestroySnapshots
+#include "journal.h"            // JournalSlot, UpdateJournal, DestroyJournal
+#include "save_slot.h"          // LatestSaveSlot, DestroySaveSlots
+#include "random.h"             // SeedRandom
 #include "debug.h"              // assert
 
 // Included for debugging purposes - not final
@@ -207,13 +219,23 @@ static void Initialize(void) {
     al_register_event_source(EventQueue, al_get_timer_event_source(FrameRateTimer));
     
     // Random number generator init
-    srand(time(NULL));
+    SeedRandom(time(NULL));
 
     // Load game assets
     LoadAssets();
+    InitializeRoutes();
+    InitializeDamageTables();
+    InitializeEncounters();
+    InitializeWorldMap();
+    InitializeParticles();
+    
+    // Continue from the save the journal builds on, in case
+    // the game crashed, or else from the newest save.
+    int slot = JournalSlot();
+    bool loaded = slot >= 0 && LoadGame(slot, true);
     
     // TODO Debug information goes here... Remove!
-    if (!LoadGame()) {
+    if (!loaded && !LoadGame(LatestSaveSlot(), true)) {
         NewGame();
 
         //CreateSpectra(&Player->Spectra[1], GLACIALITH, 100);
@@ -233,6 +255,10 @@ static void Initialize(void) {
  * @brief Updates the screen on one frame.
  **************************************************************/
 static void Update(void) {
+    UpdateAnimationClock();
+#ifdef DEBUG
+    UpdateSnapshots();
+#endif
     switch (Mode) {
     case MODE_BATTLE:
         UpdateBattle();
@@ -241,6 +267,7 @@ static void Update(void) {
         UpdateMap();
         break;
     }
+    UpdateJournal();
 }
 
 /**********************************************************//**
@@ -294,6 +321,7 @@ static void MainLoop(void) {
                 Update();
                 al_clear_to_color(al_map_rgb(0, 0, 0));
                 Draw();
+                FlushDrawList();
                 al_set_target_backbuffer(Display);
                 al_clear_to_color(al_map_rgb(0, 0, 0));
                 al_draw_scaled_bitmap(ScaleBuffer, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, ScaleX, ScaleY, ScaleW, ScaleH, 0);
@@ -351,6 +379,18 @@ static void MainLoop(void) {
  **************************************************************/
 static void Destroy(void) {
     // Get rid of the assets
+    DestroyRoutes();
+    DestroyEncounters();
+    DestroyWorldMap();
+    DestroyParticles();
+    DestroyBattleScene();
+    DestroyPanels();
+    DestroyDrawList();
+    DestroySaveGame();
+    DestroySaveSlots();
+    DestroyJournal();
+    DestroySnapshots();
+    DestroyStorage();
     DestroyAssets();
     
     // Destroy the event queue
@@ -17,4 +17,14 @@ const ITEM *ItemByID(ITEM_ID id) {
     return &ITEM_DATA[id];
 }
 
+/**********************************************************//**
+ * @brief Checks whether an ID belongs to an item, since item
+ * IDs aren't contiguous.
+ * @param id: Item ID to check.
+ * @return True if the ID has ITEM data.
+ **************************************************************/
+bool IsItem(ITEM_ID id) {
+    return id > 0 && id < sizeof(ITEM_DATA)/sizeof(ITEM) && ITEM_DATA[id].Name[0];
+}
+
 /**************************************************************/
@@ -0,0 +1,768 @@
+/**********************************************************//**
+ * @file journal.c
+ * @brief Keeps a journal of changes to the player's progress.
+ * The journal is a list of records, each a header and then
+ * its data. A JOURNAL_BASE record holds the slot and checksum
+ * of the save the records after it build on, so after a crash
+ * the records after the base matching the save on disk are
+ * played back onto it. Records are only ever added to the end, except
+ * once a save is written, when the journal is rewritten to
+ * start from that save's base.
+ *
+ * Records are kept in the machine's own byte order, since the
+ * journal is only ever read back with the save next to it.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#include <stdio.h>              // FILE, fopen, fwrite
+#include <stdlib.h>             // malloc, realloc, free
+#include <string.h>             // memcpy, memcmp
+#include <stdint.h>             // int32_t, uint32_t
+
+#include <allegro5/allegro.h>   // ALLEGRO_THREAD, ALLEGRO_MUTEX, ALLEGRO_COND
+#include <zlib.h>               // crc32
+
+#include "journal.h"            // JOURNAL_KIND
+#include "player.h"             // Player, GetItem
+#include "storage.h"            // ViewStorageSpecies, TakeStoredSpectra
+#include "save_file.h"          // MoveOverFile, ReadSaveFile
+#include "snapshot.h"           // MapSnapshotReady
+#include "save_slot.h"          // CaptureThumbnail, SaveSlotPath, SAVE_SLOTS
+#include "game.h"               // GetMode
+#include "debug.h"              // eprintf
+
+/**********************************************************//**
+ * @struct JOURNAL_HEADER
+ * @brief Starts each record in the journal.
+ **************************************************************/
+typedef struct {
+    int32_t Kind;               ///< The JOURNAL_KIND.
+    int32_t Size;               ///< Bytes of data after the header.
+    uint32_t Checksum;          ///< CRC-32 of the kind and data.
+} JOURNAL_HEADER;
+
+/**********************************************************//**
+ * @struct JOURNAL_ORIGIN
+ * @brief Data of a JOURNAL_BASE record.
+ **************************************************************/
+typedef struct {
+    uint32_t Checksum;          ///< Checksum of the save's data.
+    int32_t Slot;               ///< Save slot the save is in.
+} JOURNAL_ORIGIN;
+
+/**********************************************************//**
+ * @struct JOURNAL_BUFFER
+ * @brief Records waiting to be written or kept for rewriting.
+ **************************************************************/
+typedef struct {
+    unsigned char *Data;        ///< The records.
+    int Size;                   ///< Bytes of records.
+    int Capacity;               ///< Bytes there's room for.
+} JOURNAL_BUFFER;
+
+/**************************************************************/
+/// @brief Records added since the journal thread last woke.
+/// Guarded by Lock.
+static JOURNAL_BUFFER Pending;
+
+/// @brief Records the journal thread is writing.
+static JOURNAL_BUFFER Batch;
+
+/// @brief Records since the newest base, which the journal is
+/// rewritten to once that base's save is written. Only used
+/// by the journal thread while it runs.
+static JOURNAL_BUFFER Tail;
+
+/// @brief Checksum in the base at the start of Tail.
+static uint32_t TailBase;
+
+/// @brief The journal file, or NULL until it's first rewritten.
+/// Only used by the journal thread while it runs.
+static FILE *File = NULL;
+
+/// @brief Set to rewrite the journal once its save is written.
+/// Guarded by Lock.
+static bool CompactRequested = false;
+
+/// @brief Checksum of the save that was written. Guarded by
+/// Lock.
+static uint32_t CompactBase;
+
+/// @brief Set to stop the journal thread. Guarded by Lock.
+static bool Stopping = false;
+
+/// @brief The journal thread.
+static ALLEGRO_THREAD *Thread = NULL;
+
+/// @brief Guards everything shared with the journal thread.
+static ALLEGRO_MUTEX *Lock = NULL;
+
+/// @brief Wakes the journal thread early.
+static ALLEGRO_COND *Wake = NULL;
+
+/// @brief Set while changes are being journaled.
+static bool Running = false;
+
+/// @brief Bytes journaled since the last save.
+static int BytesSinceBase = 0;
+
+/// @brief Time of the last save.
+static double BaseTime = 0.0;
+
+/// @brief Set while an autosave is being written.
+static bool Autosaving = false;
+
+/**********************************************************//**
+ * @brief Gets the number of bytes of data in a record.
+ * @param kind: Kind of the record.
+ * @return Bytes of data.
+ **************************************************************/
+static int PayloadSize(JOURNAL_KIND kind) {
+    switch (kind) {
+    case JOURNAL_BASE:
+        return sizeof(JOURNAL_ORIGIN);
+    case JOURNAL_GET_SPECTRA:
+    case JOURNAL_WITHDRAW_SPECTRA:
+        return sizeof(SPECTRA);
+    case JOURNAL_SWITCH:
+        return 2*sizeof(int32_t);
+    case JOURNAL_WARP:
+        return 4*sizeof(int32_t);
+    case JOURNAL_PARTY:
+        return PARTY_SIZE*sizeof(SPECTRA);
+    case JOURNAL_PLAYER:
+        return sizeof(PLAYER);
+    default:
+        return sizeof(int32_t);
+    }
+}
+
+/**********************************************************//**
+ * @brief Works out the checksum of a record.
+ * @param kind: Kind of the record.
+ * @param payload: The record's data.
+ * @param size: Bytes of data.
+ * @return The checksum.
+ **************************************************************/
+static uint32_t RecordChecksum(int32_t kind, const void *payload, int size) {
+    uLong checksum = crc32(0L, (const Bytef *)&kind, sizeof(kind));
+    return crc32(checksum, (const Bytef *)payload, size);
+}
+
+/**********************************************************//**
+ * @brief Adds a record to a buffer.
+ * @param buffer: The buffer.
+ * @param kind: Kind of the record.
+ * @param payload: The record's data.
+ * @return Bytes added, or 0 if there isn't memory.
+ **************************************************************/
+static int AppendRecord(JOURNAL_BUFFER *buffer, JOURNAL_KIND kind, const void *payload) {
+    JOURNAL_HEADER header;
+    header.Kind = kind;
+    header.Size = PayloadSize(kind);
+    header.Checksum = RecordChecksum(header.Kind, payload, header.Size);
+    int size = sizeof(header)+header.Size;
+    if (buffer->Size+size > buffer->Capacity) {
+        int capacity = buffer->Capacity? buffer->Capacity: 1024;
+        while (capacity < buffer->Size+size) {
+            capacity *= 2;
+        }
+        unsigned char *data = (unsigned char *)realloc(buffer->Data, capacity);
+        if (!data) {
+            eprintf("Failed to grow the journal to %d bytes.\n", capacity);
+            return 0;
+        }
+        buffer->Data = data;
+        buffer->Capacity = capacity;
+    }
+    memcpy(&buffer->Data[buffer->Size], &header, sizeof(header));
+    memcpy(&buffer->Data[buffer->Size+sizeof(header)], payload, header.Size);
+    buffer->Size += size;
+    return size;
+}
+
+/**********************************************************//**
+ * @brief Finds the record at a position in some records.
+ * @param data: The records.
+ * @param size: Bytes of records.
+ * @param offset: Position of the record.
+ * @param header: Where to put the record's header.
+ * @return The record's data, or NULL if the record is cut
+ * short or damaged.
+ **************************************************************/
+static const unsigned char *ReadRecord(const unsigned char *data, int size, int offset, JOURNAL_HEADER *header) {
+    if (offset+(int)sizeof(JOURNAL_HEADER) > size) {
+        return NULL;
+    }
+    memcpy(header, &data[offset], sizeof(JOURNAL_HEADER));
+    if (header->Kind < 0 || header->Kind >= N_JOURNAL_KIND
+    || header->Size != PayloadSize(header->Kind)
+    || offset+(int)sizeof(JOURNAL_HEADER)+header->Size > size) {
+        return NULL;
+    }
+    const unsigned char *payload = &data[offset+sizeof(JOURNAL_HEADER)];
+    if (RecordChecksum(header->Kind, payload, header->Size) != header->Checksum) {
+        return NULL;
+    }
+    return payload;
+}
+
+/**********************************************************//**
+ * @brief Adds a record for the journal thread to write.
+ * @param kind: Kind of the record.
+ * @param payload: The record's data.
+ **************************************************************/
+static void Record(JOURNAL_KIND kind, const void *payload) {
+    if (!Running) {
+        return;
+    }
+    al_lock_mutex(Lock);
+    BytesSinceBase += AppendRecord(&Pending, kind, payload);
+    al_unlock_mutex(Lock);
+}
+
+/**********************************************************//**
+ * @brief Journals a change described by one number.
+ * @param kind: Kind of change.
+ * @param value: The item, party index or amount of money.
+ **************************************************************/
+void Journal(JOURNAL_KIND kind, int value) {
+    int32_t payload = value;
+    Record(kind, &payload);
+}
+
+/**********************************************************//**
+ * @brief Journals a spectra being obtained or withdrawn.
+ * @param kind: Kind of change.
+ * @param spectra: The spectra.
+ **************************************************************/
+void JournalSpectra(JOURNAL_KIND kind, const SPECTRA *spectra) {
+    Record(kind, spectra);
+}
+
+/**********************************************************//**
+ * @brief Journals a switch being set.
+ * @param id: The switch.
+ * @param value: Its new value.
+ **************************************************************/
+void JournalSwitch(int id, int value) {
+    int32_t payload[2] = {id, value};
+    Record(JOURNAL_SWITCH, payload);
+}
+
+/**********************************************************//**
+ * @brief Journals where the player is after a warp.
+ **************************************************************/
+void JournalWarp(void) {
+    int32_t payload[4] = {
+        Player->Location,
+        Player->Position.X,
+        Player->Position.Y,
+        Player->Direction,
+    };
+    Record(JOURNAL_WARP, payload);
+}
+
+/**********************************************************//**
+ * @brief Journals the whole party, for changes that aren't
+ * worth journaling one by one, like experience.
+ **************************************************************/
+void JournalParty(void) {
+    Record(JOURNAL_PARTY, Player->Spectra);
+}
+
+/**********************************************************//**
+ * @brief Journals all of the player's data, for changes that
+ * touch more than one part of it, like visiting a hospital,
+ * or that can't be told apart from the records before them,
+ * like going back to a snapshot. Playing it back replaces
+ * everything the records before it did to the player. The
+ * storage box isn't in the record, so it has to be unchanged
+ * by whatever called for it.
+ **************************************************************/
+void JournalPlayer(void) {
+    Record(JOURNAL_PLAYER, Player);
+}
+
+/**********************************************************//**
+ * @brief Plays back one record onto the player's data.
+ * @param kind: Kind of the record.
+ * @param payload: The record's data.
+ **************************************************************/
+static void Replay(JOURNAL_KIND kind, const unsigned char *payload) {
+    int32_t value[4];
+    SPECTRA spectra;
+    STORAGE_VIEW view;
+    switch (kind) {
+    case JOURNAL_GET_ITEM:
+        memcpy(value, payload, sizeof(int32_t));
+        GetItem(value[0]);
+        break;
+
+    case JOURNAL_DROP_ITEM:
+        memcpy(value, payload, sizeof(int32_t));
+        DropItem(value[0]);
+        break;
+
+    case JOURNAL_GET_SPECTRA:
+        memcpy(&spectra, payload, sizeof(SPECTRA));
+        GetSpectra(&spectra);
+        break;
+
+    case JOURNAL_RELEASE_SPECTRA:
+        memcpy(value, payload, sizeof(int32_t));
+        if (value[0] >= 0 && value[0] < PARTY_SIZE) {
+            ReleaseSpectra(value[0]);
+        }
+        break;
+
+    case JOURNAL_DEPOSIT_SPECTRA:
+        memcpy(value, payload, sizeof(int32_t));
+        if (value[0] >= 0 && value[0] < PARTY_SIZE) {
+            DepositSpectra(value[0]);
+        }
+        break;
+
+    case JOURNAL_WITHDRAW_SPECTRA:
+        // Storage entries move around, so find it by value.
+        memcpy(&spectra, payload, sizeof(SPECTRA));
+        ViewStorageSpecies(&view, spectra.Species);
+        for (int i = 0; i < view.Count; i++) {
+            int entry = StorageViewEntry(&view, i);
+            if (!memcmp(StoredSpectra(entry), &spectra, sizeof(SPECTRA))) {
+                WithdrawSpectra(entry);
+                break;
+            }
+        }
+        break;
+
+    case JOURNAL_SWITCH:
+        memcpy(value, payload, 2*sizeof(int32_t));
+        if (value[0] >= 0 && value[0] < N_SWITCH) {
+            Player->Switch[value[0]] = value[1];
+        }
+        break;
+
+    case JOURNAL_WARP:
+        memcpy(value, payload, 4*sizeof(int32_t));
+        Player->Location = value[0];
+        Player->Position.X = value[1];
+        Player->Position.Y = value[2];
+        Player->Direction = value[3];
+        break;
+
+    case JOURNAL_PARTY:
+        memcpy(Player->Spectra, payload, PARTY_SIZE*sizeof(SPECTRA));
+        break;
+
+    case JOURNAL_MONEY:
+        memcpy(value, payload, sizeof(int32_t));
+        Player->Money = value[0];
+        break;
+
+    case JOURNAL_PLAYER:
+        memcpy(Player, payload, sizeof(PLAYER));
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**********************************************************//**
+ * @brief Writes a batch of records to the journal, and keeps
+ * them in the Tail. Runs on the journal thread.
+ **************************************************************/
+static void WriteBatch(void) {
+    JOURNAL_HEADER header;
+    for (int offset = 0; offset < Batch.Size; offset += sizeof(header)+header.Size) {
+        const unsigned char *payload = ReadRecord(Batch.Data, Batch.Size, offset, &header);
+        if (!payload) {
+            break;
+        }
+        if (header.Kind == JOURNAL_BASE) {
+            JOURNAL_ORIGIN origin;
+            memcpy(&origin, payload, sizeof(origin));
+            Tail.Size = 0;
+            TailBase = origin.Checksum;
+        }
+        AppendRecord(&Tail, header.Kind, payload);
+    }
+    if (File && Batch.Size) {
+        if (fwrite(Batch.Data, Batch.Size, 1, File) != 1 || fflush(File)) {
+            eprintf("Failed to write to the journal.\n");
+        }
+    }
+    Batch.Size = 0;
+}
+
+/**********************************************************//**
+ * @brief Rewrites the journal to hold just the Tail, once the
+ * save the Tail builds on is written. Runs on the journal
+ * thread.
+ **************************************************************/
+static void RewriteJournal(void) {
+    if (File) {
+        fclose(File);
+        File = NULL;
+    }
+    const char *temporary = JOURNAL_FILE ".tmp";
+    FILE *file = fopen(temporary, "wb");
+    bool success = false;
+    if (file) {
+        success = fwrite(Tail.Data, Tail.Size, 1, file) == 1;
+        success = (fflush(file) == 0) && success;
+        success = (fclose(file) == 0) && success;
+        success = success && MoveOverFile(temporary, JOURNAL_FILE);
+    }
+    if (!success) {
+        eprintf("Failed to rewrite the journal.\n");
+        remove(temporary);
+    }
+    File = fopen(JOURNAL_FILE, "ab");
+}
+
+/**********************************************************//**
+ * @brief Writes records to the journal every JOURNAL_FLUSH
+ * seconds until it's told to stop.
+ * @param thread: The thread.
+ * @param argument: Unused.
+ * @return NULL.
+ **************************************************************/
+static void *WriteJournal(ALLEGRO_THREAD *thread, void *argument) {
+    (void)thread;
+    (void)argument;
+    bool stop = false;
+    while (!stop) {
+        al_lock_mutex(Lock);
+        if (!Stopping && !CompactRequested) {
+            ALLEGRO_TIMEOUT timeout;
+            al_init_timeout(&timeout, JOURNAL_FLUSH);
+            al_wait_cond_until(Wake, Lock, &timeout);
+        }
+        JOURNAL_BUFFER swap = Batch;
+        Batch = Pending;
+        Pending = swap;
+        Pending.Size = 0;
+        bool compact = CompactRequested;
+        uint32_t base = CompactBase;
+        CompactRequested = false;
+        stop = Stopping;
+        al_unlock_mutex(Lock);
+
+        WriteBatch();
+        if (compact && base == TailBase) {
+            RewriteJournal();
+        }
+    }
+    if (File) {
+        fclose(File);
+        File = NULL;
+    }
+    return NULL;
+}
+
+/**********************************************************//**
+ * @brief Starts the journal thread. The Tail has to be set up
+ * first. Without a thread, nothing is journaled.
+ **************************************************************/
+static void StartJournal(void) {
+    Lock = al_create_mutex();
+    Wake = al_create_cond();
+    if (Lock && Wake) {
+        Thread = al_create_thread(WriteJournal, NULL);
+    }
+    if (!Thread) {
+        eprintf("Failed to start the journal thread.\n");
+        if (Wake) {
+            al_destroy_cond(Wake);
+            Wake = NULL;
+        }
+        if (Lock) {
+            al_destroy_mutex(Lock);
+            Lock = NULL;
+        }
+        return;
+    }
+    Stopping = false;
+    CompactRequested = false;
+    Pending.Size = 0;
+    Batch.Size = 0;
+    Running = true;
+    BytesSinceBase = 0;
+    BaseTime = al_get_time();
+    al_start_thread(Thread);
+}
+
+/**********************************************************//**
+ * @brief Reads the whole journal from disk.
+ * @param journal: Where to put the records. The caller frees
+ * its Data.
+ **************************************************************/
+static void ReadJournal(JOURNAL_BUFFER *journal) {
+    memset(journal, 0, sizeof(JOURNAL_BUFFER));
+    FILE *file = fopen(JOURNAL_FILE, "rb");
+    if (!file) {
+        return;
+    }
+    unsigned char block[4096];
+    int nRead;
+    while ((nRead = fread(block, 1, sizeof(block), file)) > 0) {
+        if (journal->Size+nRead > journal->Capacity) {
+            int capacity = journal->Capacity? 2*journal->Capacity: (int)sizeof(block);
+            while (capacity < journal->Size+nRead) {
+                capacity *= 2;
+            }
+            unsigned char *data = (unsigned char *)realloc(journal->Data, capacity);
+            if (!data) {
+                break;
+            }
+            journal->Data = data;
+            journal->Capacity = capacity;
+        }
+        memcpy(&journal->Data[journal->Size], block, nRead);
+        journal->Size += nRead;
+    }
+    fclose(file);
+}
+
+/**********************************************************//**
+ * @brief Starts journaling from a save that was just loaded,
+ * with the Tail holding anything played back onto it.
+ * @param checksum: Checksum of the save's data.
+ * @param nReplayed: Number of records played back.
+ **************************************************************/
+static void RestartJournal(unsigned long checksum, int nReplayed) {
+    StartJournal();
+    BytesSinceBase = nReplayed? Tail.Size: 0;
+    CompactJournal(checksum);
+}
+
+/**********************************************************//**
+ * @brief Checks whether the save in a slot is the one a base
+ * was taken from. A save that was started but never written
+ * leaves a base behind with nothing on disk to match it.
+ * @param origin: The base's data.
+ * @return True if the save on disk has the base's checksum.
+ **************************************************************/
+static bool IsOriginSaved(const JOURNAL_ORIGIN *origin) {
+    const char *path = SaveSlotPath(origin->Slot);
+    SAVE_DATA data;
+    if (!IsSaveFile(path) || !ReadSaveFile(path, &data)) {
+        return false;
+    }
+    bool saved = SaveDataChecksum(&data) == origin->Checksum;
+    free(data.Storage);
+    return saved;
+}
+
+/**********************************************************//**
+ * @brief Finds the save slot the journal builds on, which is
+ * the slot to recover after a crash. Bases are tried newest
+ * first, skipping any whose save never made it to disk.
+ * @return The slot of the newest base matching its save, or
+ * -1 if there isn't one.
+ **************************************************************/
+int JournalSlot(void) {
+    JOURNAL_BUFFER journal;
+    ReadJournal(&journal);
+    int maxBases = journal.Size/(sizeof(JOURNAL_HEADER)+sizeof(JOURNAL_ORIGIN));
+    JOURNAL_ORIGIN *bases = (JOURNAL_ORIGIN *)malloc((maxBases+1)*sizeof(JOURNAL_ORIGIN));
+    int nBases = 0;
+    int offset = 0;
+    JOURNAL_HEADER header;
+    const unsigned char *payload;
+    while (bases && (payload = ReadRecord(journal.Data, journal.Size, offset, &header))) {
+        if (header.Kind == JOURNAL_BASE) {
+            memcpy(&bases[nBases++], payload, sizeof(JOURNAL_ORIGIN));
+        }
+        offset += sizeof(header)+header.Size;
+    }
+    free(journal.Data);
+
+    int slot = -1;
+    for (int i = nBases-1; i >= 0 && slot < 0; i--) {
+        if (bases[i].Slot >= 0 && bases[i].Slot < SAVE_SLOTS && IsOriginSaved(&bases[i])) {
+            slot = bases[i].Slot;
+        }
+    }
+    free(bases);
+    return slot;
+}
+
+/**********************************************************//**
+ * @brief Plays back the journal onto a save that was just
+ * loaded after a crash, then starts journaling from there.
+ * If no base in the journal matches the save, nothing is
+ * played back and the journal isn't rewritten, so whatever
+ * it holds is still there if this save turns out not to be
+ * the one it builds on.
+ * @param checksum: Checksum of the save's data.
+ * @param slot: Save slot the save is in.
+ **************************************************************/
+void RecoverJournal(unsigned long checksum, int slot) {
+    StopJournal();
+    JOURNAL_ORIGIN origin = {checksum, slot};
+    JOURNAL_BUFFER journal;
+    ReadJournal(&journal);
+
+    // Find the last base matching the save. Anything after a
+    // damaged record was never finished being written.
+    int start = -1;
+    int end = 0;
+    JOURNAL_HEADER header;
+    const unsigned char *payload;
+    while ((payload = ReadRecord(journal.Data, journal.Size, end, &header))) {
+        if (header.Kind == JOURNAL_BASE && !memcmp(payload, &origin, sizeof(origin))) {
+            start = end;
+        }
+        end += sizeof(header)+header.Size;
+    }
+
+    // Play back the records after it.
+    Tail.Size = 0;
+    AppendRecord(&Tail, JOURNAL_BASE, &origin);
+    TailBase = origin.Checksum;
+    int nReplayed = 0;
+    for (int offset = start; start >= 0 && offset < end; offset += sizeof(header)+header.Size) {
+        payload = ReadRecord(journal.Data, journal.Size, offset, &header);
+        if (header.Kind != JOURNAL_BASE) {
+            Replay(header.Kind, payload);
+            AppendRecord(&Tail, header.Kind, payload);
+            nReplayed++;
+        }
+    }
+    free(journal.Data);
+    if (nReplayed) {
+        eprintf("Recovered %d changes from the journal.\n", nReplayed);
+    }
+
+    // The save on disk is the base, so start over from it. If
+    // it isn't in the journal, the journal is left alone until
+    // the next save is written, like after BeginJournal.
+    if (start >= 0) {
+        RestartJournal(checksum, nReplayed);
+    } else {
+        StartJournal();
+    }
+}
+
+/**********************************************************//**
+ * @brief Starts journaling over from a save that was just
+ * loaded on purpose. Nothing is played back, since anything
+ * that wasn't saved is meant to be lost.
+ * @param checksum: Checksum of the save's data.
+ * @param slot: Save slot the save is in.
+ **************************************************************/
+void ResetJournal(unsigned long checksum, int slot) {
+    StopJournal();
+    JOURNAL_ORIGIN origin = {checksum, slot};
+    Tail.Size = 0;
+    AppendRecord(&Tail, JOURNAL_BASE, &origin);
+    TailBase = origin.Checksum;
+    RestartJournal(checksum, 0);
+}
+
+/**********************************************************//**
+ * @brief Marks the point a save is being made from. Records
+ * after this build on that save.
+ * @param checksum: Checksum of the save's data.
+ * @param slot: Save slot the save goes in.
+ **************************************************************/
+void BeginJournal(unsigned long checksum, int slot) {
+    JOURNAL_ORIGIN origin = {checksum, slot};
+    if (Running) {
+        Record(JOURNAL_BASE, &origin);
+    } else {
+        // The old journal is left alone until this save is
+        // written, in case it doesn't get written.
+        Tail.Size = 0;
+        AppendRecord(&Tail, JOURNAL_BASE, &origin);
+        TailBase = origin.Checksum;
+        StartJournal();
+    }
+    BytesSinceBase = 0;
+    BaseTime = al_get_time();
+}
+
+/**********************************************************//**
+ * @brief Rewrites the journal to start from a save that was
+ * written, dropping everything the save already has.
+ * @param checksum: Checksum of the save's data.
+ **************************************************************/
+void CompactJournal(unsigned long checksum) {
+    if (!Running) {
+        return;
+    }
+    al_lock_mutex(Lock);
+    CompactRequested = true;
+    CompactBase = checksum;
+    al_signal_cond(Wake);
+    al_unlock_mutex(Lock);
+}
+
+/**********************************************************//**
+ * @brief Writes everything journaled so far and stops the
+ * journal thread.
+ **************************************************************/
+void StopJournal(void) {
+    if (!Running) {
+        return;
+    }
+    al_lock_mutex(Lock);
+    Stopping = true;
+    al_signal_cond(Wake);
+    al_unlock_mutex(Lock);
+    al_join_thread(Thread, NULL);
+    al_destroy_thread(Thread);
+    al_destroy_cond(Wake);
+    al_destroy_mutex(Lock);
+    Thread = NULL;
+    Wake = NULL;
+    Lock = NULL;
+    Running = false;
+    Autosaving = false;
+}
+
+/**********************************************************//**
+ * @brief Saves the game when enough has been journaled since
+ * the last save, which folds the journal into the save. This
+ * only happens while the player is walking around the map,
+ * and the save goes to the slot the game was last saved to.
+ **************************************************************/
+void UpdateJournal(void) {
+    if (Autosaving) {
+        bool success;
+        if (SaveGameDone(&success)) {
+            Autosaving = false;
+        }
+        return;
+    }
+    if (!Running || !BytesSinceBase) {
+        return;
+    }
+    if (BytesSinceBase < JOURNAL_COMPACT_SIZE && al_get_time()-BaseTime < JOURNAL_COMPACT_TIME) {
+        return;
+    }
+    if (GetMode() == MODE_MAP && MapSnapshotReady() && CurrentSaveSlot() >= 0) {
+        CaptureThumbnail();
+        StartSaveGame(CurrentSaveSlot());
+        Autosaving = true;
+    }
+}
+
+/**********************************************************//**
+ * @brief Stops the journal and frees its memory.
+ **************************************************************/
+void DestroyJournal(void) {
+    StopJournal();
+    free(Pending.Data);
+    free(Batch.Data);
+    free(Tail.Data);
+    memset(&Pending, 0, sizeof(Pending));
+    memset(&Batch, 0, sizeof(Batch));
+    memset(&Tail, 0, sizeof(Tail));
+}
+
+/**************************************************************/
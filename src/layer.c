@@ -0,0 +1,133 @@
+/**********************************************************//**
+ * @file layer.c
+ * @brief Draws large map images in culled chunks.
+ * @author Rena Shinomiya
+ * @date June 1, 2018
+ **************************************************************/
+
+#include <allegro5/allegro.h>
+
+#include <stdlib.h>             // malloc, free
+#include <stdbool.h>            // bool
+
+#include "layer.h"              // LAYER
+#include "game.h"               // DISPLAY_WIDTH, DISPLAY_HEIGHT
+#include "debug.h"              // eprintf
+
+/**********************************************************//**
+ * @brief Checks every chunk of a layer for visible pixels.
+ * @param layer: The layer to scan.
+ **************************************************************/
+static void ScanLayer(LAYER *layer) {
+    ALLEGRO_BITMAP *image = layer->Image;
+    int width = al_get_bitmap_width(image);
+    int height = al_get_bitmap_height(image);
+    ALLEGRO_LOCKED_REGION *region = al_lock_bitmap(image, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_READONLY);
+    if (!region) {
+        // Assume everything is filled if it can't be read.
+        for (int i = 0; i < layer->Columns*layer->Rows; i++) {
+            layer->Filled[i] = true;
+        }
+        return;
+    }
+    for (int y = 0; y < height; y++) {
+        const unsigned char *row = (const unsigned char *)region->data+y*region->pitch;
+        bool *filled = &layer->Filled[(y/LAYER_CHUNK)*layer->Columns];
+        for (int x = 0; x < width; x++) {
+            // Alpha is the last byte of each pixel.
+            if (row[x*4+3]) {
+                filled[x/LAYER_CHUNK] = true;
+            }
+        }
+    }
+    al_unlock_bitmap(image);
+}
+
+/**********************************************************//**
+ * @brief Splits an image into chunks for drawing.
+ * @param layer: The LAYER to set up. Any previous layer data
+ * is released.
+ * @param image: The layer image, or NULL for an empty layer.
+ * @param sparse: Set if the image is mostly transparent, so
+ * empty chunks should be found and skipped.
+ * @return True on success.
+ **************************************************************/
+bool InitializeLayer(LAYER *layer, ALLEGRO_BITMAP *image, bool sparse) {
+    DestroyLayer(layer);
+    if (!image) {
+        return true;
+    }
+    int columns = (al_get_bitmap_width(image)+LAYER_CHUNK-1)/LAYER_CHUNK;
+    int rows = (al_get_bitmap_height(image)+LAYER_CHUNK-1)/LAYER_CHUNK;
+    layer->Filled = (bool *)malloc(sizeof(bool)*columns*rows);
+    if (!layer->Filled) {
+        eprintf("Out of memory for layer chunks.\n");
+        return false;
+    }
+    layer->Image = image;
+    layer->Columns = columns;
+    layer->Rows = rows;
+    for (int i = 0; i < columns*rows; i++) {
+        layer->Filled[i] = !sparse;
+    }
+    if (sparse) {
+        ScanLayer(layer);
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Releases the chunk data of a layer. The image itself
+ * belongs to the assets.
+ * @param layer: The LAYER to clear.
+ **************************************************************/
+void DestroyLayer(LAYER *layer) {
+    free(layer->Filled);
+    layer->Image = NULL;
+    layer->Filled = NULL;
+    layer->Columns = 0;
+    layer->Rows = 0;
+}
+
+/**********************************************************//**
+ * @brief Draws the chunks of a layer that are on screen. The
+ * current transform should align to the layer's upper left
+ * corner.
+ * @param layer: The layer to draw.
+ * @param left: Layer X-coordinate at the left of the screen.
+ * @param top: Layer Y-coordinate at the top of the screen.
+ **************************************************************/
+void DrawLayer(const LAYER *layer, int left, int top) {
+    if (!layer->Image) {
+        return;
+    }
+    int column0 = (left < 0)? 0: left/LAYER_CHUNK;
+    int row0 = (top < 0)? 0: top/LAYER_CHUNK;
+    int column1 = (left+DISPLAY_WIDTH-1)/LAYER_CHUNK;
+    int row1 = (top+DISPLAY_HEIGHT-1)/LAYER_CHUNK;
+    if (column1 >= layer->Columns) {
+        column1 = layer->Columns-1;
+    }
+    if (row1 >= layer->Rows) {
+        row1 = layer->Rows-1;
+    }
+    
+    // Chunks share one texture, so they batch together.
+    int width = al_get_bitmap_width(layer->Image);
+    int height = al_get_bitmap_height(layer->Image);
+    al_hold_bitmap_drawing(true);
+    for (int row = row0; row <= row1; row++) {
+        for (int column = column0; column <= column1; column++) {
+            if (layer->Filled[row*layer->Columns+column]) {
+                int x = column*LAYER_CHUNK;
+                int y = row*LAYER_CHUNK;
+                int w = (x+LAYER_CHUNK > width)? width-x: LAYER_CHUNK;
+                int h = (y+LAYER_CHUNK > height)? height-y: LAYER_CHUNK;
+                al_draw_bitmap_region(layer->Image, x, y, w, h, x, y, 0);
+            }
+        }
+    }
+    al_hold_bitmap_drawing(false);
+}
+
+/**************************************************************/
@@ -19,46 +19,23 @@
 #include "game.h"               // KEY
 #include "assets.h"             // MapImage, SensorImage
 #include "event.h"              // EVENT, Events
+#include "battle.h"             // TEAM_SIZE, InitializeRandomEncounter
 #include "player.h"             // Player
 #include "output.h"             // Output
 #include "main_menu.h"          // MainMenu
 #include "shop.h"               // SHOP
+#include "sensor.h"             // SENSOR, TILE
+#include "route.h"              // ROUTE, FindRoute
+#include "encounter.h"          // ZoneEncounterChance
+#include "layer.h"              // LAYER, DrawLayer
+#include "animation.h"          // ANIMATION_LAYER, DrawAnimationLayer
+#include "draw_list.h"          // FlushDrawList
+#include "snapshot.h"           // MAP_SNAPSHOT
+#include "journal.h"            // JournalSwitch, JournalWarp, JournalPlayer
 #include "debug.h"              // eprintf
 
 #include "location.i"           // LOCATION_DATA
 
-/**********************************************************//**
- * @enum TILE_FLAGS
- * @brief Flags that describe a tile (16*16 cell) on a map.
- * These can be combined with a bitwise-OR.
- **************************************************************/
-typedef enum {
-    TILE_SOLID      = 0x0001,   ///< Tile can't be walked through.
-    TILE_WATER      = 0x0002,   ///< Tile can be fished in.
-    TILE_EVENT      = 0x0004,   ///< Tile contains an event.
-} TILE_FLAGS;
-
-/**********************************************************//**
- * @struct TILE
- * @brief Contains information about one 16*16 region on a
- * map. This is used by a SENSOR to control motion.
- **************************************************************/
-typedef struct {
-    TILE_FLAGS Flags;           ///< Describes the tile properties.
-    int EventID;                ///< Indexed TILE_EVENT ID.
-    int RuntimeID;              ///< Indexed runtime event ID.
-} TILE;
-
-/**********************************************************//**
- * @struct SENSOR
- * @brief Contains all the tile information for a map.
- **************************************************************/
-typedef struct {
-    int Height;                 ///< Height in tiles of the map.
-    int Width;                  ///< Width in tiles of the map.
-    TILE *Sensor;               ///< All tile information.
-} SENSOR;
-
 /**************************************************************/
 /// @brief The user's walking speed in pixels/second.
 #define WALK_SPEED 120
@@ -75,6 +52,16 @@ static const EVENT *CurrentEvents;
 /// @brief Sensor associated to the current map.
 static SENSOR CurrentSensor;
 
+/// @brief Image layer drawn below the player.
+static LAYER MapLayer;
+
+/// @brief Image layer drawn above the player, such as roofs,
+/// tree canopies, and bridges.
+static LAYER OverlayLayer;
+
+/// @brief Animated tiles (water, lava...) drawn over the map.
+static ANIMATION_LAYER AnimatedLayer;
+
 /// @brief Bounding box on the overworld map. Going outside
 /// these bounds on the overworld map will update the current
 /// location.
@@ -93,6 +80,12 @@ static bool MainMenuOpen = false;
 /// is on.
 static int PlayerWalkFrame = 0;
 
+/// @brief Route the player is automatically walking along.
+static ROUTE AutoRoute;
+
+/// @brief Set while the player is walking along AutoRoute.
+static bool AutoWalking = false;
+
 /**************************************************************/
 /// @brief The al_get_time() at which the location popup was
 /// last activated.
@@ -133,10 +126,6 @@ typedef struct {
     } Union;
 } RUNTIME_EVENT_DATA;
 
-/// @brief Number of events that can be buffered in the
-/// RuntimeMapTiles cache.
-#define N_RUNTIME_EVENT 256
-
 /// @brief Cache for all events that need to be rendered on
 /// the map at every frame.
 static RUNTIME_EVENT_DATA RuntimeEventData[N_RUNTIME_EVENT+1];
@@ -308,102 +297,66 @@ static void UpdateOverworldLocation(void) {
  * @param id: The map identity.
  **************************************************************/
 static void UseSensor(MAP_ID id) {
-    // Get rid of old sensor if it exists
-    if (CurrentSensor.Sensor) {
-        free(CurrentSensor.Sensor);
-    }
-
-    // Load the sensor image
-    ALLEGRO_BITMAP *sensorImage = SensorImage(CurrentMap);
-    al_lock_bitmap(sensorImage, al_get_bitmap_format(sensorImage), ALLEGRO_LOCK_READONLY);
-    CurrentSensor.Height = al_get_bitmap_height(sensorImage);
-    CurrentSensor.Width = al_get_bitmap_width(sensorImage);
-    CurrentSensor.Sensor = (TILE *)malloc(sizeof(TILE)*CurrentSensor.Height*CurrentSensor.Width);
-    if (!CurrentSensor.Sensor) {
-        eprintf("Failed to load sensor for map %d\n", id);
+    if (!LoadSensor(&CurrentSensor, id)) {
+        RuntimeEventData[1].EventID = 0;
         return;
     }
     
-    // Load the tile information
-    int eventID = 1;
+    // Cache the events that need drawing or runtime state
     int runtimeID = 1;
     for (int y = 0; y < CurrentSensor.Height; y++) {
         for (int x = 0; x < CurrentSensor.Width; x++) {
-            // Get the pixel color
-            ALLEGRO_COLOR color = al_get_pixel(sensorImage, x, y);
-            unsigned char r, g, b;
-            al_unmap_rgb(color, &r, &g, &b);
-            
-            // Determine the tile flags
-            TILE_FLAGS flags = 0;
-            if (r==239 && g==239 && b==239) {
-                flags = 0;
-            } else if (r==132 && g==183 && b==244) {
-                flags = TILE_SOLID;
-            } else if (r==24 && g==119 && b==235) {
-                flags = TILE_WATER;
-            } else if (r==0 && g==0 && b==0) {
-                // Warp
-                flags = TILE_EVENT;
-            } else if (r==128 && g==128 && b==128) {
-                // Sign
-                flags = TILE_EVENT;
-            } else if (r==255 && g==135 && b==139) {
-                // Gift
-                flags = TILE_EVENT;
-            } else if (r==0 && g==255 && b==0) {
-                // Person
-                flags = TILE_EVENT;
-            } else {
-                eprintf("Invalid color in sensor %d at %d,%d\n", id, x, y);
+            if (!Tile(x, y).EventID) {
+                continue;
+            }
+            int eventID = Tile(x, y).EventID;
+            const EVENT *event = &CurrentEvents[eventID];
+            RUNTIME_EVENT_DATA *data = &RuntimeEventData[runtimeID];
+            if (runtimeID >= N_RUNTIME_EVENT) {
+                eprintf("Runtime event data overflow.\n");
+                return;
             }
             
-            // Load and cache tile events
-            Tile(x, y).Flags = flags;
-            Tile(x, y).EventID = 0;
-            Tile(x, y).RuntimeID = 0;
-            if (flags == TILE_EVENT) {
-                Tile(x, y).EventID = eventID;
-                const EVENT *event = &CurrentEvents[eventID];
-                RUNTIME_EVENT_DATA *data = &RuntimeEventData[runtimeID];
-                if (runtimeID >= N_RUNTIME_EVENT) {
-                    eprintf("Runtime event data overflow.\n");
-                    return;
-                }
-                
-                // Store generic temp data
-                switch (event->Type) {
-                case EVENT_PRESENT:
-                case EVENT_PERSON:
-                case EVENT_BOSS:
-                    data->EventID = eventID;
-                    data->EventX = x;
-                    data->EventY = y;
-                    Tile(x, y).RuntimeID = runtimeID++;
-                    break;
-                    
-                default:
-                    break;
-                }
-                
-                // Store specialized temp data
-                switch (event->Type) {
-                case EVENT_PERSON:
-                    data->Union.Person.Direction = event->Union.Person.Direction;
-                    break;
-                
-                default:
-                    break;
-                }
+            // Store generic temp data
+            switch (event->Type) {
+            case EVENT_PRESENT:
+            case EVENT_PERSON:
+            case EVENT_BOSS:
+                data->EventID = eventID;
+                data->EventX = x;
+                data->EventY = y;
+                Tile(x, y).RuntimeID = runtimeID++;
+                break;
                 
-                // Advance
-                eventID++;
+            default:
+                break;
+            }
+            
+            // Store specialized temp data
+            switch (event->Type) {
+            case EVENT_PERSON:
+                data->Union.Person.Direction = event->Union.Person.Direction;
+                break;
+            
+            default:
+                break;
             }
         }
     }
     // Null terminator
     RuntimeEventData[runtimeID].EventID = 0;
-    al_unlock_bitmap(sensorImage);
+}
+
+/**********************************************************//**
+ * @brief Sets up the image layers for the given map.
+ * @param id: The map identity.
+ **************************************************************/
+static void UseLayers(MAP_ID id) {
+    InitializeLayer(&MapLayer, MapImage(id), false);
+    InitializeLayer(&OverlayLayer, MapOverlayImage(id), true);
+    int size;
+    const unsigned char *data = MapAnimationData(id, &size);
+    InitializeAnimationLayer(&AnimatedLayer, MapAtlasImage(id), data, size);
 }
 
 /**********************************************************//**
@@ -416,6 +369,7 @@ void InitializeLocation(void) {
     CurrentEvents = Events(CurrentMap);
     LocationPopupTime = al_get_time();
     UseSensor(CurrentMap);
+    UseLayers(CurrentMap);
     UpdateOverworldLocation();
 }
 
@@ -455,8 +409,9 @@ void Warp(LOCATION_ID id, int x, int y, DIRECTION direction) {
     Player->Position.Y = TileToWorldCenter(y);
     Player->Direction = direction;
     
-    // Load the sensor at the map
+    // Load the sensor and images at the map
     UseSensor(CurrentMap);
+    UseLayers(CurrentMap);
     
     // Set up warp - ensure we don't leak image resources
     if (WarpPreimage) {
@@ -467,6 +422,7 @@ void Warp(LOCATION_ID id, int x, int y, DIRECTION direction) {
     
     // Graphics maintenance
     PlayerWalkFrame = 0;
+    JournalWarp();
 }
 
 void WarpToLastHospital(void) {
@@ -621,6 +577,7 @@ static void InteractUser(void) {
             } else if (GetItem(event->Union.Present.Item)) {
                 OutputF("Amy found %s!", ItemByID(event->Union.Present.Item)->Name);
                 Switch(event->Union.Present.Switch) = true;
+                JournalSwitch(event->Union.Present.Switch, true);
             } else {
                 Output("You can't carry anything else!");
             }
@@ -637,6 +594,7 @@ static void InteractUser(void) {
                 OutputSplitByCR(event->Union.Person.Speech);
                 Player->LastHospital = Player->Location;
                 RecoverParty();
+                JournalPlayer();
                 break;
             case PERSON_SHOP:
                 OutputSplitByCR(event->Union.Person.Speech);
@@ -763,6 +721,7 @@ void DrawLocationPopup(void) {
  * @param opacity: From 0 to 1, how opaque the screen is.
  **************************************************************/
 static void DrawScreenFade(float opacity) {
+    FlushDrawList();
     DrawAt(0, 0);
     al_draw_filled_rectangle(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, al_map_rgba_f(0, 0, 0, opacity));
 }
@@ -835,9 +794,9 @@ void DrawMap(void) {
     }
     
     // Draw items not influenced by the player.
-    ALLEGRO_BITMAP *mapImage = MapImage(CurrentMap);
     DrawAtMapCenter();
-    al_draw_bitmap(mapImage, 0, 0, 0);
+    DrawLayer(&MapLayer, -MapCenterX(), -MapCenterY());
+    DrawAnimationLayer(&AnimatedLayer, -MapCenterX(), -MapCenterY());
     DrawRuntimeEvents(ABOVE);
     
     // Draw the player
@@ -847,6 +806,7 @@ void DrawMap(void) {
     // Draw things that can overlap the player.
     DrawAtMapCenter();
     DrawRuntimeEvents(BELOW);
+    DrawLayer(&OverlayLayer, -MapCenterX(), -MapCenterY());
     
     // Location popup
     if (!MainMenuOpen) {
@@ -900,34 +860,103 @@ static inline bool WorldPassableWithPadding(int x, int y) {
     WorldPassable(x+COLLISION_PADDING, y+COLLISION_PADDING);
 }
 
-static bool RandomEncounter(void) {
-    const LOCATION *location = Location(Player->Location);
-    if (!location->Encounters || !location->EncounterRate) {
-        return false;
+/**********************************************************//**
+ * @brief Starts walking the player automatically to another
+ * LOCATION, across any maps in between.
+ * @param destination: The LOCATION to walk to.
+ * @return True if there's a route to the destination.
+ **************************************************************/
+bool StartAutoWalk(LOCATION_ID destination) {
+    COORDINATE tile = {WorldToTile(Player->Position.X), WorldToTile(Player->Position.Y)};
+    AutoWalking = FindRoute(&AutoRoute, CurrentMap, tile, destination);
+    if (!AutoWalking) {
+        eprintf("No route to location %d\n", destination);
+    }
+    return AutoWalking;
+}
+
+/**********************************************************//**
+ * @brief Stops walking the player automatically.
+ **************************************************************/
+void StopAutoWalk(void) {
+    AutoWalking = false;
+}
+
+/**********************************************************//**
+ * @brief Limits a motion to a maximum step size.
+ * @param distance: Distance left to move.
+ * @param step: Maximum step size.
+ * @return The motion to apply this frame.
+ **************************************************************/
+static inline float ClampStep(float distance, float step) {
+    return (distance > step)? step: (distance < -step)? -step: distance;
+}
+
+/**********************************************************//**
+ * @brief Gets the motion that walks the player along the
+ * AutoRoute for this frame.
+ * @param dx: Set to the X-motion.
+ * @param dy: Set to the Y-motion.
+ **************************************************************/
+static void AutoWalkMotion(float *dx, float *dy) {
+    if (Player->Location == AutoRoute.Destination) {
+        AutoWalking = false;
+        return;
+    }
+    COORDINATE tile = {WorldToTile(Player->Position.X), WorldToTile(Player->Position.Y)};
+    COORDINATE next;
+    if (!RouteStep(&AutoRoute, CurrentMap, tile, &next)) {
+        // Knocked off the route (e.g. by a warp after losing a
+        // battle), so plan again from here.
+        if (!FindRoute(&AutoRoute, CurrentMap, tile, AutoRoute.Destination)
+        || !RouteStep(&AutoRoute, CurrentMap, tile, &next)) {
+            AutoWalking = false;
+            return;
+        }
+    }
+    
+    // Line up with the center of the current tile before
+    // stepping, so corners don't block the player.
+    float step = WALK_SPEED*LastFrameTime();
+    int x = Player->Position.X;
+    int y = Player->Position.Y;
+    if (next.X != tile.X) {
+        if (y != TileToWorldCenter(tile.Y)) {
+            *dy = ClampStep(TileToWorldCenter(tile.Y)-y, step);
+        } else {
+            *dx = ClampStep(TileToWorldCenter(next.X)-x, step);
+        }
     } else {
-        // Get the encounter rate
-        float rate = 0.0;
-        switch (location->EncounterRate) {
-        case RARE:
-            rate = 0.05;
-            break;
-        case UNCOMMON:
-            rate = 0.10;
-            break;
-        case COMMON:
-            rate = 0.20;
-            break;
-        default:
-            rate = 0.0;
-            break;
+        if (x != TileToWorldCenter(tile.X)) {
+            *dx = ClampStep(TileToWorldCenter(tile.X)-x, step);
+        } else {
+            *dy = ClampStep(TileToWorldCenter(next.Y)-y, step);
         }
-        
-        // Randomly generate encounter at "rate" per second
-        // of motion on the map.
-        return uniform(0.0,1.0) < rate*LastFrameTime();
     }
 }
 
+/**********************************************************//**
+ * @brief Gets the encounter zone of the tile the player is
+ * standing on.
+ * @return The zone, or 0 for the location's default.
+ **************************************************************/
+int EncounterZone(void) {
+    int x = WorldToTile(Player->Position.X);
+    int y = WorldToTile(Player->Position.Y);
+    return TileInBounds(x, y)? Tile(x, y).Zone: 0;
+}
+
+/**********************************************************//**
+ * @brief Rolls for a random encounter on this frame.
+ * @return True if an encounter should start.
+ **************************************************************/
+static bool RandomEncounter(void) {
+    // Randomly generate encounter at the zone's rate per
+    // second of motion on the map.
+    float rate = ZoneEncounterChance(Player->Location, EncounterZone());
+    return rate && uniform(0.0,1.0) < rate*LastFrameTime();
+}
+
 /**********************************************************//**
  * @brief Parses the user's keyboard input to update the map
  * position and activate any events.
@@ -962,6 +991,16 @@ void UpdateMap(void) {
             MainMenuOpen = false;
         }
 
+#ifdef DEBUG
+    } else if (KeyJustUp(KEY_DEBUG)) {
+        // Walk to the last hospital visited
+        StartAutoWalk(Player->LastHospital);
+
+    } else if (KeyJustUp(KEY_REPLAY)) {
+        // Watch the last battle again
+        ReplayLastBattle();
+#endif
+
     } else if (KeyJustUp(KEY_CONFIRM)) {
         // User interacting with an overworld object
         InteractUser();
@@ -970,6 +1009,12 @@ void UpdateMap(void) {
         // Normal map processing
         float dx = (KeyDown(KEY_RIGHT)-KeyDown(KEY_LEFT))*WALK_SPEED*LastFrameTime();
         float dy = (KeyDown(KEY_DOWN)-KeyDown(KEY_UP))*WALK_SPEED*LastFrameTime();
+        if (dx || dy) {
+            // The player took over walking
+            AutoWalking = false;
+        } else if (AutoWalking) {
+            AutoWalkMotion(&dx, &dy);
+        }
         
         // Set the player's direction if any motion is
         // REQUESTED (not if it's possible).
@@ -1023,7 +1068,8 @@ void UpdateMap(void) {
             // Maybe enter battle if no interaction is needed,
             // and a random encounter is triggered.
             if (!InteractAutomatic() && RandomEncounter()) {
-                InitializeRandomEncounter(randint(1, 3), ENCOUNTER_OVERWORLD);
+                int size = Location(Player->Location)->TeamSize;
+                InitializeRandomEncounter(randint(1, size? size: TEAM_SIZE), ENCOUNTER_OVERWORLD);
                 SetMode(MODE_BATTLE);
             } else {
                 UpdateOverworldLocation();
@@ -1034,6 +1080,46 @@ void UpdateMap(void) {
     }
 }
 
+/**********************************************************//**
+ * @brief Checks if the map can be snapshotted, which is only
+ * while the player is free to walk around.
+ * @return True if nothing else is going on.
+ **************************************************************/
+bool MapSnapshotReady(void) {
+    return FishingPhase == FISHING_DONE && OutputDone() && !WarpInProgress()
+        && ShopDone() && !MainMenuOpen;
+}
+
+/**********************************************************//**
+ * @brief Saves the state of the map that isn't kept in the
+ * PLAYER.
+ * @param snapshot: Where to save it.
+ **************************************************************/
+void SnapshotMap(MAP_SNAPSHOT *snapshot) {
+    for (int i=1; i<N_RUNTIME_EVENT && RuntimeEventData[i].EventID; i++) {
+        snapshot->Direction[i] = RuntimeEventData[i].Union.Person.Direction;
+    }
+    snapshot->WalkFrame = PlayerWalkFrame;
+}
+
+/**********************************************************//**
+ * @brief Puts the map back the way it was. The PLAYER has to
+ * be restored first, since that says where the map is.
+ * @param snapshot: The saved state.
+ **************************************************************/
+void RestoreMapSnapshot(const MAP_SNAPSHOT *snapshot) {
+    if (Location(Player->Location)->Map != CurrentMap) {
+        InitializeLocation();
+    }
+    for (int i=1; i<N_RUNTIME_EVENT && RuntimeEventData[i].EventID; i++) {
+        if (CurrentEvents[RuntimeEventData[i].EventID].Type == EVENT_PERSON) {
+            RuntimeEventData[i].Union.Person.Direction = snapshot->Direction[i];
+        }
+    }
+    PlayerWalkFrame = snapshot->WalkFrame;
+    AutoWalking = false;
+}
+
 void ChangeCostume(COSTUME_ID costume) {
     if (Player->Costume != costume) {
         Player->Costume = costume;
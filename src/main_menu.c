@@ -16,6 +16,10 @@
 #include "player.h"             // Player
 #include "output.h"             // Output
 #include "assets.h"             // WindowImage
+#include "world_map.h"          // OpenWorldMap, DrawWorldMap
+#include "storage.h"            // STORAGE_VIEW
+#include "journal.h"            // JournalParty
+#include "save_slot.h"          // SAVE_SLOTS, CaptureThumbnail
 
 /**************************************************************/
 /// @brief Wait data for when the main menu opens an overlay.
@@ -33,7 +37,9 @@ static bool ItemUseInProgress = false;
  * @brief Informs the save system of how the save is progressing.
  **************************************************************/
 typedef enum {
+    SAVE_CHOOSE,
     SAVE_BEFORE,
+    SAVE_WRITING,
     SAVE_AFTER,
 } SAVE_PHASE;
 
@@ -47,8 +53,11 @@ static SAVE_PHASE SavePhase;
 typedef enum {
     MENU_PARTY,
     MENU_ITEMS,
+    MENU_STORAGE,
+    MENU_MAP,
     MENU_INFO,
     MENU_SAVE,
+    MENU_LOAD,
     MENU_EXIT,
 } MAIN_MENU_OPTION;
 
@@ -65,22 +74,39 @@ typedef enum {
 typedef enum {
     PARTY_VIEW,
     PARTY_SWAP,
+    PARTY_STORE,
     PARTY_RELEASE,
     PARTY_CANCEL,
 } PARTY_MENU_OPTION;
 
+/**********************************************************//**
+ * @enum STORAGE_MENU_OPTION
+ * @brief Enumerates options in the storage submenu.
+ **************************************************************/
+typedef enum {
+    STORAGE_WITHDRAW,
+    STORAGE_SAME_SPECIES,
+    STORAGE_SAME_TYPE,
+    STORAGE_SHOW_ALL,
+    STORAGE_CANCEL,
+} STORAGE_MENU_OPTION;
+
 /**************************************************************/
 /// @brief Defines the main menu and its control structure.
 static MENU MainMenu = {
     .Option = {
         [MENU_PARTY]    = "Party",
         [MENU_ITEMS]    = "Items",
+        [MENU_STORAGE]  = "Storage",
+        [MENU_MAP]      = "Map",
         [MENU_INFO]     = "Options",
         [MENU_SAVE]     = "Save",
+        [MENU_LOAD]     = "Load",
         [MENU_EXIT]     = "Exit",
     },
     .Control = {
-        .IndexMax       = 4,
+        .IndexMax       = 5,
+        .ScrollMax      = 2,
     },
 };
 
@@ -100,14 +126,52 @@ static MENU PartyMenu = {
     .Option = {
         [PARTY_VIEW]    = "View",
         [PARTY_SWAP]    = "Swap",
+        [PARTY_STORE]   = "Store",
         [PARTY_RELEASE] = "Release",
         [PARTY_CANCEL]  = "Cancel",
     },
     .Control = {
-        .IndexMax       = 3,
+        .IndexMax       = 4,
     }
 };
 
+/// @brief Defines the storage submenu.
+static MENU StorageMenu = {
+    .Option = {
+        [STORAGE_WITHDRAW]      = "Withdraw",
+        [STORAGE_SAME_SPECIES]  = "Same kind",
+        [STORAGE_SAME_TYPE]     = "Same type",
+        [STORAGE_SHOW_ALL]      = "Show all",
+        [STORAGE_CANCEL]        = "Cancel",
+    },
+    .Control = {
+        .IndexMax       = 4,
+    },
+};
+
+/// @brief Controls the storage list.
+static CONTROL StorageControl = {
+    .Jump               = STORAGE_ROWS,
+    .State              = CONTROL_IDLE,
+};
+
+/// @brief Part of the storage box being listed.
+static STORAGE_VIEW StorageView;
+
+/// @brief Controls the list of save slots.
+static CONTROL SlotControl = {
+    .Jump               = STORAGE_ROWS,
+    .State              = CONTROL_IDLE,
+};
+
+/// @brief Names of each storage order, for the list heading.
+static const char *const StorageOrderName[N_STORAGE_ORDER] = {
+    [STORAGE_BY_CAPTURE]    = "Oldest first",
+    [STORAGE_BY_SPECIES]    = "By kind",
+    [STORAGE_BY_LEVEL]      = "By level",
+    [STORAGE_BY_TYPE]       = "By type",
+};
+
 static MENU YesNo = {
     .Option = {
         "Yes",
@@ -136,6 +200,7 @@ static bool UseItem(ITEM_ID id, SPECTRA *spectra) {
         }
     } else {
         if (ApplyEffectInMenu(item->Effect, spectra, item->Argument)) {
+            JournalParty();
             if (!(item->Flags&REUSABLE)) {
                 DropItem(id);
             }
@@ -160,12 +225,51 @@ static inline void InitializeItemsMenu(void) {
 }
 
 /**********************************************************//**
- * @brief Sets up the main menu when it's opened.
+ * @brief Fits the storage list to its view after the box or
+ * the view changes. An empty filter goes back to showing
+ * the whole box.
+ **************************************************************/
+static void InitializeStorageMenu(void) {
+    RefreshStorageView(&StorageView);
+    if (!StorageView.Count) {
+        ViewStorage(&StorageView, StorageView.Order);
+    }
+    int count = StorageView.Count;
+    CONTROL *control = &StorageControl;
+    control->IndexMax = ((count<STORAGE_ROWS)? count: STORAGE_ROWS)-1;
+    control->ScrollMax = (count>STORAGE_ROWS)? count-STORAGE_ROWS: 0;
+    if (control->Scroll > control->ScrollMax) {
+        control->Scroll = control->ScrollMax;
+    }
+    if (control->Index > control->IndexMax) {
+        control->Index = (control->IndexMax>0)? control->IndexMax: 0;
+    }
+}
+
+/**********************************************************//**
+ * @brief Sets up the list of save slots, starting at the slot
+ * the game was last saved to.
+ **************************************************************/
+static void InitializeSlotMenu(void) {
+    CONTROL *control = &SlotControl;
+    ResetControl(control);
+    control->IndexMax = ((SAVE_SLOTS<STORAGE_ROWS)? SAVE_SLOTS: STORAGE_ROWS)-1;
+    control->ScrollMax = (SAVE_SLOTS>STORAGE_ROWS)? SAVE_SLOTS-STORAGE_ROWS: 0;
+    for (int i=0; i<CurrentSaveSlot(); i++) {
+        ControlDown(control);
+    }
+}
+
+/**********************************************************//**
+ * @brief Sets up the main menu when it's opened. The map is
+ * still all that's on screen, so this is when the picture
+ * for a save is taken.
  **************************************************************/
 void InitializeMainMenu(void) {
     InitializePartyMenu();
     InitializeItemsMenu();
     ResetControl(&MainMenu.Control);
+    CaptureThumbnail();
 }
 
 static ITEM_ID SelectedItemID(void) {
@@ -182,6 +286,25 @@ static SPECTRA *SelectedSpectra(void) {
     return &Player->Spectra[index];
 }
 
+static int SelectedStorageEntry(void) {
+    return StorageViewEntry(&StorageView, ControlItem(&StorageControl));
+}
+
+/**********************************************************//**
+ * @brief Draws the list of save slots, the chosen slot's
+ * summary, and whether to go ahead with it.
+ **************************************************************/
+static void DrawSlotMenu(void) {
+    DrawAt(18, 18);
+    DrawSaveSlots(&SlotControl);
+    DrawAt(164, 18);
+    DrawSaveSlot(ControlItem(&SlotControl));
+    if (SlotControl.State == CONTROL_CONFIRM) {
+        DrawAt(26, 26);
+        DrawChoice(&YesNo);
+    }
+}
+
 /**********************************************************//**
  * @brief Draws the main menu and any of its descendants
  * on the screen.
@@ -246,10 +369,39 @@ void DrawMainMenu(void) {
             }
             break;
 
+        case MENU_STORAGE:
+            DrawAt(18, 18);
+            char heading[64];
+            snprintf(heading, sizeof(heading), "%s%s  %d/%d",
+                StorageOrderName[StorageView.Order],
+                (StorageView.Count<StorageSize())? ", filtered": "",
+                StorageView.Count? ControlItem(&StorageControl)+1: 0,
+                StorageView.Count);
+            DrawPopupBar(heading);
+            DrawAt(18, 38);
+            DrawStorage(&StorageView, &StorageControl);
+            if (StorageView.Count) {
+                DrawAt(164, 18);
+                DrawSpectraDisplay(StoredSpectra(SelectedStorageEntry()));
+            }
+            if (StorageControl.State == CONTROL_CONFIRM) {
+                DrawAt(26, 46);
+                DrawOption(&StorageMenu);
+            }
+            break;
+
+        case MENU_MAP:
+            DrawWorldMap();
+            break;
+
         case MENU_SAVE:
             DrawAt(18, 18);
             switch (SavePhase) {
+            case SAVE_CHOOSE:
+                DrawSlotMenu();
+                break;
             case SAVE_BEFORE:
+            case SAVE_WRITING:
                 DrawAlert("Now saving...");
                 break;
             case SAVE_AFTER:
@@ -257,6 +409,10 @@ void DrawMainMenu(void) {
                 break;
             }
             break;
+
+        case MENU_LOAD:
+            DrawSlotMenu();
+            break;
         }
     }
     
@@ -442,6 +598,15 @@ void UpdatePartySubmenu(void) {
                 PartySwapFirst = SelectedSpectraID();
                 PartyControl()->State = CONTROL_IDLE;
                 break;
+            case PARTY_STORE:
+                if (DepositSpectra(SelectedSpectraID())) {
+                    InitializePartyMenu();
+                    ResetControl(PartyControl());
+                } else {
+                    Output("That doesn't make any sense!");
+                }
+                PartyControl()->State = CONTROL_IDLE;
+                break;
             case PARTY_RELEASE:
                 if (SelectedSpectra()->Species == AMY) {
                     Output("That doesn't make any sense!");
@@ -469,6 +634,7 @@ void UpdatePartyMenu(void) {
             SPECTRA temp = Player->Spectra[swap];
             Player->Spectra[swap] = Player->Spectra[PartySwapFirst];
             Player->Spectra[PartySwapFirst] = temp;
+            JournalParty();
             PartySwapFirst = -1;
             PartyControl()->State = CONTROL_IDLE;
         }
@@ -488,6 +654,73 @@ void UpdatePartyMenu(void) {
     }
 }
 
+/**********************************************************//**
+ * @brief Carries out the storage submenu option just chosen.
+ **************************************************************/
+static void UpdateStorageSubmenuOnConfirm(void) {
+    int entry = SelectedStorageEntry();
+    const SPECTRA *spectra = StoredSpectra(entry);
+    switch (MenuItem(&StorageMenu)) {
+    case STORAGE_WITHDRAW:
+        if (WithdrawSpectra(entry)) {
+            InitializePartyMenu();
+        } else {
+            Output("The party is full!");
+        }
+        break;
+    case STORAGE_SAME_SPECIES:
+        ViewStorageSpecies(&StorageView, spectra->Species);
+        ResetControl(&StorageControl);
+        break;
+    case STORAGE_SAME_TYPE:
+        ViewStorageType(&StorageView, SpeciesOfSpectra(spectra)->Type[0]);
+        ResetControl(&StorageControl);
+        break;
+    case STORAGE_SHOW_ALL:
+        ViewStorage(&StorageView, StorageView.Order);
+        ResetControl(&StorageControl);
+        break;
+    case STORAGE_CANCEL:
+        break;
+    }
+    InitializeStorageMenu();
+    StorageControl.State = StorageView.Count? CONTROL_IDLE: CONTROL_CANCEL;
+}
+
+/**********************************************************//**
+ * @brief Updates the storage list and its submenu. The menu
+ * key changes the order of the list.
+ **************************************************************/
+static void UpdateStorageMenu(void) {
+    switch (StorageControl.State) {
+    case CONTROL_CONFIRM:
+        UpdateMenu(&StorageMenu);
+        if (StorageMenu.Control.State == CONTROL_CONFIRM) {
+            UpdateStorageSubmenuOnConfirm();
+        } else if (StorageMenu.Control.State == CONTROL_CANCEL) {
+            StorageControl.State = CONTROL_IDLE;
+        }
+        break;
+
+    case CONTROL_CANCEL:
+        MainMenu.Control.State = CONTROL_IDLE;
+        break;
+
+    case CONTROL_IDLE:
+        if (KeyJustUp(KEY_MENU)) {
+            ViewStorage(&StorageView, (StorageView.Order+1)%N_STORAGE_ORDER);
+            ResetControl(&StorageControl);
+            InitializeStorageMenu();
+            break;
+        }
+        UpdateControl(&StorageControl);
+        if (StorageControl.State == CONTROL_CONFIRM) {
+            ResetControl(&StorageMenu.Control);
+        }
+        break;
+    }
+}
+
 void UpdateItemsMenu(void) {
     switch (ItemsControl()->State) {
     case CONTROL_CONFIRM:
@@ -508,11 +741,82 @@ void UpdateItemsMenu(void) {
     }
 }
 
+/**********************************************************//**
+ * @brief Updates the list of save slots. A slot that needs
+ * asking about first is confirmed with YesNo.
+ * @param ask: Checks whether to ask before going ahead with
+ * a slot.
+ * @return True once a slot is chosen.
+ **************************************************************/
+static bool UpdateSlotMenu(bool (*ask)(int slot)) {
+    switch (SlotControl.State) {
+    case CONTROL_IDLE:
+        UpdateControl(&SlotControl);
+        if (SlotControl.State == CONTROL_CONFIRM) {
+            if (!ask(ControlItem(&SlotControl))) {
+                return true;
+            }
+            ResetControl(&YesNo.Control);
+            YesNo.Control.Index = 1;
+        }
+        break;
+
+    case CONTROL_CONFIRM:
+        UpdateMenu(&YesNo);
+        if (YesNo.Control.State == CONTROL_CONFIRM && MenuItem(&YesNo) == 0) {
+            return true;
+        } else if (YesNo.Control.State != CONTROL_IDLE) {
+            SlotControl.State = CONTROL_IDLE;
+        }
+        break;
+
+    case CONTROL_CANCEL:
+        MainMenu.Control.State = CONTROL_IDLE;
+        break;
+    }
+    return false;
+}
+
+/**********************************************************//**
+ * @brief Checks if saving to a slot would write over some
+ * other game.
+ * @param slot: The save slot.
+ * @return True to ask first.
+ **************************************************************/
+static bool AskBeforeSaving(int slot) {
+    return slot != CurrentSaveSlot() && SaveSlotState(slot) != SLOT_EMPTY;
+}
+
+/**********************************************************//**
+ * @brief Checks if there's a save in a slot to load, since
+ * anything that wasn't saved is lost by loading.
+ * @param slot: The save slot.
+ * @return True to ask first.
+ **************************************************************/
+static bool AskBeforeLoading(int slot) {
+    SLOT_STATE state = SaveSlotState(slot);
+    return state == SLOT_READY || state == SLOT_OLD;
+}
+
 void UpdateSave(void) {
     switch (SavePhase) {
+    case SAVE_CHOOSE:
+        if (UpdateSlotMenu(AskBeforeSaving)) {
+            SavePhase = SAVE_BEFORE;
+        }
+        break;
+
     case SAVE_BEFORE:
-        SaveStatus = SaveGame();
-        SavePhase = SAVE_AFTER;
+        StartSaveGame(ControlItem(&SlotControl));
+        SavePhase = SAVE_WRITING;
+        break;
+
+    case SAVE_WRITING:
+        // The file is written on another thread.
+        if (SaveGameDone(&SaveStatus)) {
+            ResetWait(&Overlay);
+            SavePhase = SAVE_AFTER;
+        }
         break;
 
     case SAVE_AFTER:
@@ -524,6 +828,26 @@ void UpdateSave(void) {
     }
 }
 
+/**********************************************************//**
+ * @brief Updates the list of save slots to load from.
+ **************************************************************/
+static void UpdateLoad(void) {
+    if (!UpdateSlotMenu(AskBeforeLoading)) {
+        return;
+    }
+    int slot = ControlItem(&SlotControl);
+    SLOT_STATE state = SaveSlotState(slot);
+    if (AskBeforeLoading(slot) && LoadGame(slot, false)) {
+        ExitMainMenu();
+    } else if (state == SLOT_UNREAD || state == SLOT_READING) {
+        // Still finding out what's there.
+        SlotControl.State = CONTROL_IDLE;
+    } else {
+        Output(state == SLOT_EMPTY? "There's nothing saved there.": "That save can't be loaded.");
+        SlotControl.State = CONTROL_IDLE;
+    }
+}
+
 void UpdateMainMenuOnConfirm(void) {
     switch (MenuItem(&MainMenu)) {
     case MENU_PARTY:
@@ -534,13 +858,32 @@ void UpdateMainMenuOnConfirm(void) {
         ResetControl(ItemsControl());
         break;
 
+    case MENU_STORAGE:
+        if (StorageSize()) {
+            ResetControl(&StorageControl);
+            InitializeStorageMenu();
+        } else {
+            Output("Storage is empty.");
+            MainMenu.Control.State = CONTROL_IDLE;
+        }
+        break;
+
+    case MENU_MAP:
+        OpenWorldMap();
+        break;
+
     case MENU_INFO:
         ResetWait(&Overlay);
         break;
 
     case MENU_SAVE:
         ResetWait(&Overlay);
-        SavePhase = SAVE_BEFORE;
+        InitializeSlotMenu();
+        SavePhase = SAVE_CHOOSE;
+        break;
+
+    case MENU_LOAD:
+        InitializeSlotMenu();
         break;
 
     case MENU_EXIT:
@@ -575,6 +918,17 @@ void UpdateMainMenu(void) {
         case MENU_ITEMS:
             UpdateItemsMenu();
             break;
+
+        case MENU_STORAGE:
+            UpdateStorageMenu();
+            break;
+        
+        case MENU_MAP:
+            UpdateWorldMap();
+            if (WorldMapClosed()) {
+                MainMenu.Control.State = CONTROL_IDLE;
+            }
+            break;
         
         case MENU_INFO:
             UpdateWait(&Overlay);
@@ -586,6 +940,10 @@ void UpdateMainMenu(void) {
         case MENU_SAVE:
             UpdateSave();
             break;
+
+        case MENU_LOAD:
+            UpdateLoad();
+            break;
         }
         break;
      
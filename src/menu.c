@@ -6,11 +6,12 @@
  **************************************************************/
 
 #include <stdio.h>              // snprintf
+#include <stdint.h>             // uint32_t
+#include <string.h>             // strlen
 #include <math.h>               // sin
 
 #include <allegro5/allegro.h>
 #include <allegro5/allegro_color.h>
-#include <allegro5/allegro_primitives.h>
 #include <allegro5/allegro_font.h>
 
 #include "game.h"               // KEY
@@ -20,8 +21,80 @@
 #include "item.h"               // ItemByID
 #include "player.h"             // Player
 #include "output.h"             // GetOutput
+#include "text_layout.h"        // TEXT_LAYOUT
+#include "storage.h"            // STORAGE_VIEW
+#include "draw_list.h"          // ListBitmap, ListText, FlushDrawList
+#include "save_slot.h"          // SaveSlotState, SaveSlotSummary
 #include "debug.h"              // eprintf
 
+/**************************************************************/
+/// @brief Number of menus whose panels are kept at once.
+#define PANEL_POOL_SIZE 16
+
+/// @brief Starting value for HashBytes.
+#define HASH_START 2166136261u
+
+/**********************************************************//**
+ * @struct PANEL
+ * @brief A window drawn ahead of time. It's only drawn again
+ * when the hash of what it shows changes.
+ **************************************************************/
+typedef struct {
+    ALLEGRO_BITMAP *Image;      ///< The drawn window, or NULL.
+    WINDOW_ID Window;           ///< Window the image is sized for.
+    const void *Owner;          ///< Menu the panel belongs to, if pooled.
+    uint32_t Key;               ///< Hash of what the image shows.
+} PANEL;
+
+/**********************************************************//**
+ * @enum PANEL_ID
+ * @brief Windows that only appear once on screen, so each
+ * has a panel of its own.
+ **************************************************************/
+typedef enum {
+    PANEL_ALERT,
+    PANEL_WARNING,
+    PANEL_SPECTRA,
+    PANEL_TECHNIQUE,
+    PANEL_ITEM,
+    PANEL_POPUP,
+    PANEL_PLAYER,
+    PANEL_PARTY,
+    PANEL_ITEMS,
+    PANEL_SLOT,
+} PANEL_ID;
+
+/// The number of unique PANEL_ID members.
+#define N_PANEL 10
+
+/**********************************************************//**
+ * @struct PLAYER_PANEL
+ * @brief What the player display shows, either about the
+ * game being played or a save.
+ **************************************************************/
+typedef struct {
+    COSTUME_ID Costume;         ///< The player's costume.
+    LOCATION_ID Location;       ///< Where the player is.
+    int nSpectra;               ///< Number of spectra in the party.
+    int nItems;                 ///< Number of items held.
+    int Time;                   ///< Seconds played.
+    int Money;                  ///< The player's money.
+    bool Ticking;               ///< Set if the clock is running.
+} PLAYER_PANEL;
+
+/**************************************************************/
+/// @brief Panels of the windows that only appear once.
+static PANEL Panels[N_PANEL];
+
+/// @brief Panels for menus, which are drawn by shared code.
+static PANEL PanelPool[PANEL_POOL_SIZE];
+
+/// @brief Next pooled panel to replace.
+static int NextPanel = 0;
+
+/// @brief Drawing state to go back to after a panel is drawn.
+static ALLEGRO_STATE PanelState;
+
 /**********************************************************//**
  * @brief Draws standard text on the screen.
  * @param text: String to draw.
@@ -29,13 +102,14 @@
  * @param y: Y position to draw at.
  **************************************************************/
 static inline void DrawText(const char *text, int x, int y) {
-    al_draw_text(
+    ListText(
         Font(FONT_WINDOW),
         al_map_rgb(0, 0, 0),
         x,
         y-3,
         ALLEGRO_ALIGN_LEFT|ALLEGRO_ALIGN_INTEGER,
-        text);
+        text,
+        strlen(text));
 }
 
 /**********************************************************//**
@@ -45,13 +119,14 @@ static inline void DrawText(const char *text, int x, int y) {
  * @param y: Y position to draw at.
  **************************************************************/
 static inline void DrawTextHighlight(const char *text, int x, int y) {
-    al_draw_text(
+    ListText(
         Font(FONT_WINDOW),
         al_map_rgb(0, 127, 255),
         x,
         y-3,
         ALLEGRO_ALIGN_LEFT|ALLEGRO_ALIGN_INTEGER,
-        text);
+        text,
+        strlen(text));
 }
 
 /**********************************************************//**
@@ -61,13 +136,14 @@ static inline void DrawTextHighlight(const char *text, int x, int y) {
  * @param y: Y position to draw at.
  **************************************************************/
 static inline void DrawTextLowlight(const char *text, int x, int y) {
-    al_draw_text(
+    ListText(
         Font(FONT_WINDOW),
         al_map_rgb(163, 163, 163),
         x,
         y-3,
         ALLEGRO_ALIGN_LEFT|ALLEGRO_ALIGN_INTEGER,
-        text);
+        text,
+        strlen(text));
 }
 
 /**********************************************************//**
@@ -77,13 +153,14 @@ static inline void DrawTextLowlight(const char *text, int x, int y) {
  * @param y: Y position to draw at.
  **************************************************************/
 static inline void DrawTextRight(const char *text, int x, int y) {
-    al_draw_text(
+    ListText(
         Font(FONT_WINDOW),
         al_map_rgb(0, 0, 0),
         x,
         y-3,
         ALLEGRO_ALIGN_RIGHT|ALLEGRO_ALIGN_INTEGER,
-        text);
+        text,
+        strlen(text));
 }
 
 /**********************************************************//**
@@ -121,13 +198,14 @@ static inline void DrawNumber(int x, int y, int number) {
     const int BUF_SIZE = 32;
     char buf[BUF_SIZE+1];
     snprintf(buf, BUF_SIZE, "%d", number);
-    al_draw_text(
+    ListText(
         Font(FONT_WINDOW),
         number? al_map_rgb(0, 0, 0): al_map_rgb(128, 128, 128),
         x,
         y-3,
         ALLEGRO_ALIGN_RIGHT|ALLEGRO_ALIGN_INTEGER,
-        buf);
+        buf,
+        strlen(buf));
 }
 
 /**********************************************************//**
@@ -137,13 +215,14 @@ static inline void DrawNumber(int x, int y, int number) {
  * @param y: Y position to draw at.
  **************************************************************/
 static inline void DrawTitle(const char *text, int x, int y) {
-    al_draw_text(
+    ListText(
         Font(FONT_WINDOW),
         al_map_rgb(226, 226, 226),
         x,
         y-3,
         ALLEGRO_ALIGN_LEFT|ALLEGRO_ALIGN_INTEGER,
-        text);
+        text,
+        strlen(text));
 }
 
 /**********************************************************//**
@@ -160,22 +239,16 @@ static inline void DrawTitle(const char *text, int x, int y) {
 }
 
 /**********************************************************//**
- * @brief Draws a text box using DrawText styling.
+ * @brief Draws a text box using DrawText styling. The text is
+ * only wrapped the first time it's drawn at this width.
  * @param text: String to draw.
  * @param x: X position to draw at.
  * @param y : Y position to draw at.
  * @param width: Width in pixels of the text box.
  **************************************************************/
 static inline void DrawTextBox(const char *text, int x, int y, int width) {
-    al_draw_multiline_text(
-        Font(FONT_WINDOW),
-        al_map_rgb(20, 20, 20),
-        x,
-        y-3,
-        width,
-        13,
-        ALLEGRO_ALIGN_LEFT|ALLEGRO_ALIGN_INTEGER,
-        text);
+    const TEXT_LAYOUT *layout = CachedTextLayout(Font(FONT_WINDOW), text, width);
+    DrawTextLayout(layout, text, -1, al_map_rgb(20, 20, 20), x, y-3, 13);
 }
 
 /**********************************************************//**
@@ -201,7 +274,7 @@ static inline void DrawTextBox(const char *text, int x, int y, int width) {
  * @param height: Height of the seelctor box.
  **************************************************************/
 static inline void DrawSelector(int x, int y, int width, int height) {
-    al_draw_filled_rectangle(x, y, x+width, y+height, al_map_rgba(0, 0, 0, 60));
+    ListRectangle(x, y, x+width, y+height, al_map_rgba(0, 0, 0, 60));
 }
 
 /**********************************************************//**
@@ -212,7 +285,133 @@ static inline void DrawSelector(int x, int y, int width, int height) {
  **************************************************************/
 static inline void DrawBar(float percent, int x, int y) {
     int x0 = x + (int)(percent*81);
-    al_draw_filled_rectangle(x, y, x0, y+8, al_color_hsv(120*percent, 0.5f, 0.8f));
+    ListRectangle(x, y, x0, y+8, al_color_hsv(120*percent, 0.5f, 0.8f));
+}
+
+/**********************************************************//**
+ * @brief Adds some bytes to a hash (FNV-1a).
+ * @param hash: Hash so far.
+ * @param data: Bytes to add.
+ * @param size: Number of bytes.
+ * @return The new hash.
+ **************************************************************/
+static uint32_t HashBytes(uint32_t hash, const void *data, int size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (int i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i])*16777619u;
+    }
+    return hash;
+}
+
+/**********************************************************//**
+ * @brief Adds a string to a hash, including its end, so
+ * neighboring strings can't run together.
+ * @param hash: Hash so far.
+ * @param text: String to add, or NULL.
+ * @return The new hash.
+ **************************************************************/
+static uint32_t HashString(uint32_t hash, const char *text) {
+    return text? HashBytes(hash, text, strlen(text)+1): HashBytes(hash, "\1", 1);
+}
+
+/**********************************************************//**
+ * @brief Gets the pooled panel for a menu. When the pool is
+ * full, the oldest panel is handed over.
+ * @param owner: The menu.
+ * @return The panel.
+ **************************************************************/
+static PANEL *MenuPanel(const void *owner) {
+    for (int i = 0; i < PANEL_POOL_SIZE; i++) {
+        if (PanelPool[i].Owner == owner) {
+            return &PanelPool[i];
+        }
+    }
+    PANEL *panel = &PanelPool[NextPanel];
+    NextPanel = (NextPanel+1)%PANEL_POOL_SIZE;
+    panel->Owner = owner;
+    panel->Key = 0;
+    return panel;
+}
+
+/**********************************************************//**
+ * @brief Starts drawing a panel, if what it shows has changed.
+ * Everything drawn until EndPanel goes onto the panel, which
+ * has its upper left at (0, 0). If the panel's image can't be
+ * made, drawing goes straight to the screen instead. What's
+ * been drawn so far is flushed first, since the draw list
+ * only ever draws to one target.
+ * @param panel: The panel.
+ * @param window: Window the panel is drawn in.
+ * @param key: Hash of everything the panel shows.
+ * @return True if the panel needs drawing.
+ **************************************************************/
+static bool BeginPanel(PANEL *panel, WINDOW_ID window, uint32_t key) {
+    if (panel->Image && panel->Window != window) {
+        al_destroy_bitmap(panel->Image);
+        panel->Image = NULL;
+    }
+    panel->Window = window;
+    if (panel->Image && panel->Key == key) {
+        return false;
+    }
+    if (!panel->Image) {
+        ALLEGRO_BITMAP *image = WindowImage(window);
+        panel->Image = al_create_bitmap(al_get_bitmap_width(image), al_get_bitmap_height(image));
+        if (!panel->Image) {
+            return true;
+        }
+    }
+    panel->Key = key;
+    FlushDrawList();
+
+    // Keep the alpha of the window, so the panel draws the
+    // same way the window would have.
+    al_store_state(&PanelState, ALLEGRO_STATE_TARGET_BITMAP|ALLEGRO_STATE_BLENDER);
+    al_set_target_bitmap(panel->Image);
+    al_set_separate_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA, ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_INVERSE_ALPHA);
+    al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+    DrawAt(0, 0);
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Finishes drawing a panel and shows it.
+ * @param panel: The panel.
+ * @param drawn: What BeginPanel returned.
+ **************************************************************/
+static void EndPanel(const PANEL *panel, bool drawn) {
+    if (!panel->Image) {
+        return;
+    }
+    if (drawn) {
+        FlushDrawList();
+        al_restore_state(&PanelState);
+    }
+    ListBitmap(panel->Image, 0, 0, 0);
+}
+
+/**********************************************************//**
+ * @brief Frees the images of some panels. They're drawn again
+ * the next time they're shown.
+ * @param panels: The panels.
+ * @param n: Number of panels.
+ **************************************************************/
+static void FreePanels(PANEL *panels, int n) {
+    for (int i = 0; i < n; i++) {
+        if (panels[i].Image) {
+            al_destroy_bitmap(panels[i].Image);
+        }
+        panels[i].Image = NULL;
+        panels[i].Owner = NULL;
+    }
+}
+
+/**********************************************************//**
+ * @brief Frees the images of every panel.
+ **************************************************************/
+void DestroyPanels(void) {
+    FreePanels(Panels, N_PANEL);
+    FreePanels(PanelPool, PANEL_POOL_SIZE);
 }
 
 /**********************************************************//**
@@ -221,10 +420,19 @@ static inline void DrawBar(float percent, int x, int y) {
  * @param choice: MENU choices of 4 or less characters each.
  **************************************************************/
 void DrawChoice(const MENU *choice) {
-    al_draw_bitmap(WindowImage(MENU_CHOICE), 0, 0, 0);
+    PANEL *panel = MenuPanel(choice);
+    uint32_t key = HASH_START;
     for (int i=0; i<2; i++) {
-        DrawText(choice->Option[choice->Control.Scroll+i], 4, 4+13*i);
+        key = HashString(key, choice->Option[choice->Control.Scroll+i]);
+    }
+    bool drawn = BeginPanel(panel, MENU_CHOICE, key);
+    if (drawn) {
+        ListBitmap(WindowImage(MENU_CHOICE), 0, 0, 0);
+        for (int i=0; i<2; i++) {
+            DrawText(choice->Option[choice->Control.Scroll+i], 4, 4+13*i);
+        }
     }
+    EndPanel(panel, drawn);
     DrawSelector(2, 2+13*choice->Control.Index, 34, 12);
 }
 
@@ -233,8 +441,13 @@ void DrawChoice(const MENU *choice) {
  * @param text: Text to put in the alert.
  **************************************************************/
 void DrawAlert(const char *text) {
-    al_draw_bitmap(WindowImage(ALERT), 0, 0, 0);
-    DrawTextBox(text, 4, 17, 120);
+    PANEL *panel = &Panels[PANEL_ALERT];
+    bool drawn = BeginPanel(panel, ALERT, HashString(HASH_START, text));
+    if (drawn) {
+        ListBitmap(WindowImage(ALERT), 0, 0, 0);
+        DrawTextBox(text, 4, 17, 120);
+    }
+    EndPanel(panel, drawn);
 }
 
 /**********************************************************//**
@@ -242,8 +455,13 @@ void DrawAlert(const char *text) {
  * @param text: Text to put in the warning.
  **************************************************************/
 void DrawWarning(const char *text) {
-    al_draw_bitmap(WindowImage(WARNING), 0, 0, 0);
-    DrawTextBox(text, 4, 17, 120);
+    PANEL *panel = &Panels[PANEL_WARNING];
+    bool drawn = BeginPanel(panel, WARNING, HashString(HASH_START, text));
+    if (drawn) {
+        ListBitmap(WindowImage(WARNING), 0, 0, 0);
+        DrawTextBox(text, 4, 17, 120);
+    }
+    EndPanel(panel, drawn);
 }
 
 /**********************************************************//**
@@ -251,14 +469,22 @@ void DrawWarning(const char *text) {
  * @param options: MENU items to draw.
  **************************************************************/
 void DrawOption(const MENU *options) {
-    al_draw_bitmap(WindowImage(MENU_OPTION), 0, 0, 0);
-    for (int i=0; i<6; i++) {
-        int index = options->Control.Scroll+i;
-        if (index > options->Control.IndexMax) {
-            break;
+    PANEL *panel = MenuPanel(options);
+    const CONTROL *control = &options->Control;
+    int count = control->IndexMax+control->ScrollMax+1-control->Scroll;
+    count = (count<6)? count: 6;
+    uint32_t key = HashBytes(HASH_START, &count, sizeof(count));
+    for (int i=0; i<count; i++) {
+        key = HashString(key, options->Option[options->Control.Scroll+i]);
+    }
+    bool drawn = BeginPanel(panel, MENU_OPTION, key);
+    if (drawn) {
+        ListBitmap(WindowImage(MENU_OPTION), 0, 0, 0);
+        for (int i=0; i<count; i++) {
+            DrawText(options->Option[options->Control.Scroll+i], 4, 4+13*i);
         }
-        DrawText(options->Option[index], 4, 4+13*i);
     }
+    EndPanel(panel, drawn);
     DrawSelector(2, 2+13*options->Control.Index, 96, 12);
 }
 
@@ -269,11 +495,21 @@ void DrawOption(const MENU *options) {
  * @param second: Items to put in the second column.
  **************************************************************/
 void DrawColumn(const MENU *first, const MENU *second) {
-    al_draw_bitmap(WindowImage(MENU_COLUMN), 0, 0, 0);
+    PANEL *panel = MenuPanel(first);
+    uint32_t key = HASH_START;
     for (int i=0; i<8; i++) {
-        DrawText(first->Option[first->Control.Scroll+i], 4, 4+13*i);
-        DrawText(second->Option[first->Control.Scroll+i], 101, 4+13*i);
+        key = HashString(key, first->Option[first->Control.Scroll+i]);
+        key = HashString(key, second->Option[first->Control.Scroll+i]);
     }
+    bool drawn = BeginPanel(panel, MENU_COLUMN, key);
+    if (drawn) {
+        ListBitmap(WindowImage(MENU_COLUMN), 0, 0, 0);
+        for (int i=0; i<8; i++) {
+            DrawText(first->Option[first->Control.Scroll+i], 4, 4+13*i);
+            DrawText(second->Option[first->Control.Scroll+i], 101, 4+13*i);
+        }
+    }
+    EndPanel(panel, drawn);
     DrawSelector(2, 2+13*first->Control.Index, 138, 12);
 }
 
@@ -324,7 +560,15 @@ void UpdateControl(CONTROL *control) {
  * @param spectra: Spectra to display stats for.
  **************************************************************/
 void DrawSpectraDisplay(const SPECTRA *spectra) {
-    al_draw_bitmap(WindowImage(SPECTRA_DISPLAY), 0, 0, 0);
+    PANEL *panel = &Panels[PANEL_SPECTRA];
+    uint32_t key = HashBytes(HASH_START, spectra, sizeof(SPECTRA));
+    key = HashBytes(key, &Player->Costume, sizeof(Player->Costume));
+    bool drawn = BeginPanel(panel, SPECTRA_DISPLAY, key);
+    if (!drawn) {
+        EndPanel(panel, drawn);
+        return;
+    }
+    ListBitmap(WindowImage(SPECTRA_DISPLAY), 0, 0, 0);
     const SPECIES *species = SpeciesOfSpectra(spectra);
     
     // Spectra title bar
@@ -332,12 +576,12 @@ void DrawSpectraDisplay(const SPECTRA *spectra) {
     DrawTitleF(198, 4, "Lv.%d", spectra->Level);
     
     // Icons
-    al_draw_bitmap(TypeImage(species->Type[0]), 4, 15, 0);
+    ListBitmap(TypeImage(species->Type[0]), 4, 15, 0);
     if (species->Type[1]) {
-        al_draw_bitmap(TypeImage(species->Type[1]), 44, 15, 0);
+        ListBitmap(TypeImage(species->Type[1]), 44, 15, 0);
     }
     if (spectra->Ailment) {
-        al_draw_bitmap(AilmentImage(spectra->Ailment), 109, 19, 0);
+        ListBitmap(AilmentImage(spectra->Ailment), 109, 19, 0);
     }
     
     // Bars
@@ -357,7 +601,7 @@ void DrawSpectraDisplay(const SPECTRA *spectra) {
     for (i = 0; i < spectra->MovesetSize; i++) {
         const TECHNIQUE *technique = TechniqueByID(spectra->Moveset[i]);
         DrawText(technique->Name, 4, 150+13*i);
-        al_draw_bitmap(TypeImage(technique->Type), 103, 148+13*i, 0);
+        ListBitmap(TypeImage(technique->Type), 103, 148+13*i, 0);
         DrawNumber(190, 150+13*i, technique->Power);
         DrawNumber(240, 150+13*i, technique->Cost);
         
@@ -378,7 +622,8 @@ void DrawSpectraDisplay(const SPECTRA *spectra) {
     int height = al_get_bitmap_height(sprite);
     int xOffset = (125-width)/2;
     int yOffset = (123-height)/2;
-    al_draw_bitmap(sprite, 109+xOffset, 19+yOffset, ALLEGRO_FLIP_HORIZONTAL);
+    ListBitmap(sprite, 109+xOffset, 19+yOffset, ALLEGRO_FLIP_HORIZONTAL);
+    EndPanel(panel, drawn);
 }
 
 /**********************************************************//**
@@ -386,7 +631,7 @@ void DrawSpectraDisplay(const SPECTRA *spectra) {
  * @param spectra: SPECTRA to show.
  **************************************************************/
 void DrawHudUser(const SPECTRA *spectra) {
-    al_draw_bitmap(WindowImage(HUD_USER), 0, 0, 0);
+    ListBitmap(WindowImage(HUD_USER), 0, 0, 0);
     const SPECIES *species = SpeciesOfSpectra(spectra);
     
     DrawText(species->Name, 4, 4);
@@ -395,7 +640,7 @@ void DrawHudUser(const SPECTRA *spectra) {
     DrawBar((float)spectra->Power/spectra->MaxPower, 116, 15);
     
     if (spectra->Ailment) {
-        al_draw_bitmap(AilmentImage(spectra->Ailment), 54, 13, 0);
+        ListBitmap(AilmentImage(spectra->Ailment), 54, 13, 0);
     }
     
     DrawTextF(116, 4, "%d/%d", spectra->Health, spectra->MaxHealth);
@@ -407,7 +652,7 @@ void DrawHudUser(const SPECTRA *spectra) {
  * @param spectra: SPECTRA to show.
  **************************************************************/
 void DrawHudEnemy(const SPECTRA *spectra) {
-    al_draw_bitmap(WindowImage(HUD_ENEMY), 0, 0, 0);
+    ListBitmap(WindowImage(HUD_ENEMY), 0, 0, 0);
     const SPECIES *species = SpeciesOfSpectra(spectra);
     
     DrawText(species->Name, 105, 4);
@@ -416,7 +661,7 @@ void DrawHudEnemy(const SPECTRA *spectra) {
     DrawBar((float)spectra->Power/spectra->MaxPower, 19, 15);
     
     if (spectra->Ailment) {
-        al_draw_bitmap(AilmentImage(spectra->Ailment), 155, 13, 0);
+        ListBitmap(AilmentImage(spectra->Ailment), 155, 13, 0);
     }
 }
 
@@ -425,14 +670,19 @@ void DrawHudEnemy(const SPECTRA *spectra) {
  * @param id: ID of a TECHNIQUE.
  **************************************************************/
 void DrawTechniqueDisplay(TECHNIQUE_ID id) {
-    al_draw_bitmap(WindowImage(TECHNIQUE_DISPLAY), 0, 0, 0);
-    const TECHNIQUE *technique = TechniqueByID(id);
+    PANEL *panel = &Panels[PANEL_TECHNIQUE];
+    bool drawn = BeginPanel(panel, TECHNIQUE_DISPLAY, HashBytes(HASH_START, &id, sizeof(id)));
+    if (drawn) {
+        ListBitmap(WindowImage(TECHNIQUE_DISPLAY), 0, 0, 0);
+        const TECHNIQUE *technique = TechniqueByID(id);
     
-    DrawTitle(technique->Name, 4, 4);
-    DrawNumber(105, 17, technique->Power);
-    DrawNumber(171, 17, technique->Cost);
-    DrawTextBox(technique->Description, 4, 30, 165);
-    al_draw_bitmap(TypeImage(technique->Type), 2, 15, 0);
+        DrawTitle(technique->Name, 4, 4);
+        DrawNumber(105, 17, technique->Power);
+        DrawNumber(171, 17, technique->Cost);
+        DrawTextBox(technique->Description, 4, 30, 165);
+        ListBitmap(TypeImage(technique->Type), 2, 15, 0);
+    }
+    EndPanel(panel, drawn);
 }
 
 /**********************************************************//**
@@ -440,12 +690,17 @@ void DrawTechniqueDisplay(TECHNIQUE_ID id) {
  * @param id: ID of an ITEM.
  **************************************************************/
 void DrawItemDisplay(ITEM_ID id) {
-    al_draw_bitmap(WindowImage(ITEM_DISPLAY), 0, 0, 0);
-    const ITEM *item = ItemByID(id);
+    PANEL *panel = &Panels[PANEL_ITEM];
+    bool drawn = BeginPanel(panel, ITEM_DISPLAY, HashBytes(HASH_START, &id, sizeof(id)));
+    if (drawn) {
+        ListBitmap(WindowImage(ITEM_DISPLAY), 0, 0, 0);
+        const ITEM *item = ItemByID(id);
     
-    DrawTitle(item->Name, 4, 4);
-    DrawTextF(39, 17, "$%d.00", item->Price);
-    DrawTextBox(item->Description, 4, 30, 165);
+        DrawTitle(item->Name, 4, 4);
+        DrawTextF(39, 17, "$%d.00", item->Price);
+        DrawTextBox(item->Description, 4, 30, 165);
+    }
+    EndPanel(panel, drawn);
 }
 
 /**********************************************************//**
@@ -463,8 +718,21 @@ static inline void DrawWaitingIcon(int x, int y) {
  * @brief Draw the current output.
  **************************************************************/
 void DrawOutput(void) {
-    al_draw_bitmap(WindowImage(OUTPUT), 4, 328, 0);
-    DrawTextBox(GetOutput(), 8, 332, 464);
+    ListBitmap(WindowImage(OUTPUT), 4, 328, 0);
+    static TEXT_LAYOUT Layout;
+    static int Serial = -1;
+    int length;
+    int typed;
+    const char *text = GetOutput(&length, &typed);
+    if (text) {
+        // Wrap each message once, and type it out along the
+        // lines it will end up on.
+        if (Serial != OutputSerial()) {
+            LayoutText(&Layout, Font(FONT_WINDOW), text, length, 464);
+            Serial = OutputSerial();
+        }
+        DrawTextLayout(&Layout, text, typed, al_map_rgb(20, 20, 20), 8, 332-3, 13);
+    }
     if (OutputWaiting()) {
         DrawWaitingIcon(468, 345);
     }
@@ -475,51 +743,78 @@ void DrawOutput(void) {
  * @param text: Text to put in the popup.
  **************************************************************/
 void DrawPopupBar(const char *text) {
-    al_draw_bitmap(WindowImage(POPUP_BAR), 0, 0, 0);
-    DrawText(text, 4, 4);
+    PANEL *panel = &Panels[PANEL_POPUP];
+    bool drawn = BeginPanel(panel, POPUP_BAR, HashString(HASH_START, text));
+    if (drawn) {
+        ListBitmap(WindowImage(POPUP_BAR), 0, 0, 0);
+        DrawText(text, 4, 4);
+    }
+    EndPanel(panel, drawn);
+}
+
+/**********************************************************//**
+ * @brief Draws the player display, only redrawing it when the
+ * clock ticks or something changes.
+ * @param panel: Panel to draw it in.
+ * @param info: What to show.
+ **************************************************************/
+static void DrawPlayerPanel(PANEL *panel, const PLAYER_PANEL *info) {
+    bool drawn = BeginPanel(panel, PLAYER_DISPLAY, HashBytes(HASH_START, info, sizeof(PLAYER_PANEL)));
+    if (!drawn) {
+        EndPanel(panel, drawn);
+        return;
+    }
+    ListBitmap(WindowImage(PLAYER_DISPLAY), 0, 0, 0);
+    DrawText("Amy", 45, 4);
+    DrawTextBox(Location(info->Location)->Name, 45, 17, 94);
+    DrawNumber(141, 46, info->nSpectra);
+    DrawNumber(141, 59, info->nItems);
+    
+    // Time formatting
+    int time = info->Time;
+    const char *format = (!info->Ticking || time%2)? "%d:%02d": "%d %02d";
+    DrawTextRightF(141, 72, format, time/3600, time/60%60);
+    
+    // Money
+    DrawTextRightF(141, 85, "$%.2f", (double)info->Money);
+    
+    // Sprite pane
+    ALLEGRO_BITMAP *sprite = CostumeImage(info->Costume);
+    int width = al_get_bitmap_width(sprite);
+    int height = al_get_bitmap_height(sprite);
+    int xOffset = (32-width)/2;
+    int yOffset = (85-height)/2;
+    ListBitmap(sprite, 6+xOffset, 6+yOffset, 0);
+    EndPanel(panel, drawn);
 }
 
 /**********************************************************//**
  * @brief Draw the player's information on the screen.
  **************************************************************/
 void DrawPlayerDisplay(void) {
-    al_draw_bitmap(WindowImage(PLAYER_DISPLAY), 0, 0, 0);
-    DrawText("Amy", 45, 4);
-    DrawTextBox(Location(Player->Location)->Name, 45, 17, 94);
+    // Zeroed, since the padding is hashed too.
+    PLAYER_PANEL info;
+    memset(&info, 0, sizeof(info));
+    info.Costume = Player->Costume;
+    info.Location = Player->Location;
+    info.Time = Player->PlayTime + UnaccountedPlayTime();
+    info.Money = Player->Money;
+    info.Ticking = true;
     
     // Spectra count
-    int spectraCount = 0;
     for (int i = 0; i < PARTY_SIZE; i++) {
         if (Player->Spectra[i].Species) {
-            spectraCount++;
+            info.nSpectra++;
         }
     }
-    DrawNumber(141, 46, spectraCount);
     
     // Item count
-    int itemCount = 0;
     for (int i = 0; i < INVENTORY_SIZE; i++) {
         if (Player->Inventory[i]) {
-            itemCount++;
+            info.nItems++;
         }
     }
-    DrawNumber(141, 59, itemCount);
-    
-    // Time formatting
-    int time = Player->PlayTime + UnaccountedPlayTime();
-    const char *format = time%2? "%d:%02d": "%d %02d";
-    DrawTextRightF(141, 72, format, time/3600, time/60%60);
-    
-    // Money
-    DrawTextRightF(141, 85, "$%.2f", (double)Player->Money);
-    
-    // Sprite pane
-    ALLEGRO_BITMAP *sprite = CostumeImage(Player->Costume);
-    int width = al_get_bitmap_width(sprite);
-    int height = al_get_bitmap_height(sprite);
-    int xOffset = (32-width)/2;
-    int yOffset = (85-height)/2;
-    al_draw_bitmap(sprite, 6+xOffset, 6+yOffset, 0);
+    DrawPlayerPanel(&Panels[PANEL_PLAYER], &info);
 }
 
 /**********************************************************//**
@@ -573,20 +868,25 @@ static inline int PartyY(int index) {
  * @brief Draws the party menu on the screen.
  **************************************************************/
 void DrawParty(void) {
-    al_draw_bitmap(WindowImage(SPECTRA_LIST), 0, 0, 0);
-    for (int i=0; i<PARTY_SIZE && Player->Spectra[i].Species; i++) {
-        // Contend with vertical divider
-        int y = PartyY(i);
-        
-        // Display spectra information
-        const SPECTRA *spectra = &Player->Spectra[i];
-        DrawText(SpeciesOfSpectra(spectra)->Name, 4, y);
-        DrawNumber(130, y, spectra->Level);
-        DrawBar((float)spectra->Health/spectra->MaxHealth, 133, y);
-        DrawBar((float)spectra->Power/spectra->MaxPower, 219, y);
-        DrawTextF(133, y, "%d/%d", spectra->Health, spectra->MaxHealth);
-        DrawTextF(219, y, "%d/%d", spectra->Power, spectra->MaxPower);
+    PANEL *panel = &Panels[PANEL_PARTY];
+    bool drawn = BeginPanel(panel, SPECTRA_LIST, HashBytes(HASH_START, Player->Spectra, sizeof(Player->Spectra)));
+    if (drawn) {
+        ListBitmap(WindowImage(SPECTRA_LIST), 0, 0, 0);
+        for (int i=0; i<PARTY_SIZE && Player->Spectra[i].Species; i++) {
+            // Contend with vertical divider
+            int y = PartyY(i);
+            
+            // Display spectra information
+            const SPECTRA *spectra = &Player->Spectra[i];
+            DrawText(SpeciesOfSpectra(spectra)->Name, 4, y);
+            DrawNumber(130, y, spectra->Level);
+            DrawBar((float)spectra->Health/spectra->MaxHealth, 133, y);
+            DrawBar((float)spectra->Power/spectra->MaxPower, 219, y);
+            DrawTextF(133, y, "%d/%d", spectra->Health, spectra->MaxHealth);
+            DrawTextF(219, y, "%d/%d", spectra->Power, spectra->MaxPower);
+        }
     }
+    EndPanel(panel, drawn);
     DrawSelector(2, PartyY(SpectraControl.Index)-2, 104, 12);
 }
 
@@ -594,21 +894,26 @@ void DrawParty(void) {
  * @brief Draws the items menu on the screen.
  **************************************************************/
 void DrawItems(void) {
-    al_draw_bitmap(WindowImage(ITEM_LIST), 0, 0, 0);
+    PANEL *panel = &Panels[PANEL_ITEMS];
+    bool drawn = BeginPanel(panel, ITEM_LIST, HashBytes(HASH_START, Player->Inventory, sizeof(Player->Inventory)));
     int x, y;
-    for (int i=0; i<INVENTORY_SIZE && Player->Inventory[i]; i++) {
-        // Contend with columns
-        x = 4 + 105*(i/8);
-        y = 17 + 13*(i%8);
-        
-        // Get item information
-        const ITEM *item = ItemByID(Player->Inventory[i]);
-        if (item->Flags & MENU_ONLY) {
-            DrawText(item->Name, x, y);
-        } else {
-            DrawTextLowlight(item->Name, x, y);
+    if (drawn) {
+        ListBitmap(WindowImage(ITEM_LIST), 0, 0, 0);
+        for (int i=0; i<INVENTORY_SIZE && Player->Inventory[i]; i++) {
+            // Contend with columns
+            x = 4 + 105*(i/8);
+            y = 17 + 13*(i%8);
+            
+            // Get item information
+            const ITEM *item = ItemByID(Player->Inventory[i]);
+            if (item->Flags & MENU_ONLY) {
+                DrawText(item->Name, x, y);
+            } else {
+                DrawTextLowlight(item->Name, x, y);
+            }
         }
     }
+    EndPanel(panel, drawn);
     
     // Draw selector
     x = 2 + 105*(ItemControl.Index/8);
@@ -616,6 +921,35 @@ void DrawItems(void) {
     DrawSelector(x, y, 104, 12);
 }
 
+/**********************************************************//**
+ * @brief Draws part of the storage box as a list. Only the
+ * rows on screen are looked at, so the box can be any size.
+ * @param view: The part of the box to list.
+ * @param control: Control scrolling through the view.
+ **************************************************************/
+void DrawStorage(const STORAGE_VIEW *view, const CONTROL *control) {
+    PANEL *panel = MenuPanel(view);
+    const SPECTRA *rows[STORAGE_ROWS];
+    uint32_t key = HASH_START;
+    for (int i=0; i<STORAGE_ROWS; i++) {
+        rows[i] = StoredSpectra(StorageViewEntry(view, control->Scroll+i));
+        int row[2] = {rows[i]? rows[i]->Species: 0, rows[i]? rows[i]->Level: 0};
+        key = HashBytes(key, row, sizeof(row));
+    }
+    bool drawn = BeginPanel(panel, MENU_COLUMN, key);
+    if (drawn) {
+        ListBitmap(WindowImage(MENU_COLUMN), 0, 0, 0);
+        for (int i=0; i<STORAGE_ROWS && rows[i]; i++) {
+            DrawText(SpeciesOfSpectra(rows[i])->Name, 4, 4+13*i);
+            DrawTextF(101, 4+13*i, "Lv.%d", rows[i]->Level);
+        }
+    }
+    EndPanel(panel, drawn);
+    if (view->Count) {
+        DrawSelector(2, 2+13*control->Index, 138, 12);
+    }
+}
+
 /**********************************************************//**
  * @brief Initializes the scrollable region for a menu.
  * @param menu: Menu to initialize.
@@ -651,4 +985,79 @@ void InitializeMenuScroll(MENU *menu, WINDOW_ID type) {
     menu->Control.Jump = max;
 }
 
+/**********************************************************//**
+ * @brief Draws the list of save slots. Slots are only read
+ * once they're on screen, and show as "..." until then.
+ * @param control: Control scrolling through the slots.
+ **************************************************************/
+void DrawSaveSlots(const CONTROL *control) {
+    PANEL *panel = MenuPanel(control);
+    SLOT_STATE state[STORAGE_ROWS];
+    const SAVE_SUMMARY *rows[STORAGE_ROWS];
+    uint32_t key = HASH_START;
+    for (int i=0; i<STORAGE_ROWS; i++) {
+        int slot = control->Scroll+i;
+        state[i] = SaveSlotState(slot);
+        rows[i] = SaveSlotSummary(slot);
+        int row[3] = {state[i], rows[i]? rows[i]->Location: 0, rows[i]? rows[i]->PlayTime: 0};
+        key = HashBytes(key, row, sizeof(row));
+    }
+    bool drawn = BeginPanel(panel, MENU_COLUMN, key);
+    if (drawn) {
+        ListBitmap(WindowImage(MENU_COLUMN), 0, 0, 0);
+        for (int i=0; i<STORAGE_ROWS && control->Scroll+i<SAVE_SLOTS; i++) {
+            int y = 4+13*i;
+            switch (state[i]) {
+            case SLOT_READY:
+                DrawText(Location(rows[i]->Location)->Name, 4, y);
+                DrawTextF(101, y, "%d:%02d", rows[i]->PlayTime/3600, rows[i]->PlayTime/60%60);
+                break;
+            case SLOT_EMPTY:
+                DrawTextLowlight("Empty", 4, y);
+                break;
+            case SLOT_OLD:
+                DrawText("Old save", 4, y);
+                break;
+            case SLOT_DAMAGED:
+                DrawTextLowlight("Damaged", 4, y);
+                break;
+            default:
+                DrawTextLowlight("...", 4, y);
+                break;
+            }
+        }
+    }
+    EndPanel(panel, drawn);
+    DrawSelector(2, 2+13*control->Index, 138, 12);
+}
+
+/**********************************************************//**
+ * @brief Draws the summary of a save slot, with its picture
+ * underneath. Nothing is drawn until the summary is read.
+ * @param slot: The save slot.
+ **************************************************************/
+void DrawSaveSlot(int slot) {
+    const SAVE_SUMMARY *summary = SaveSlotSummary(slot);
+    if (!summary) {
+        return;
+    }
+    PLAYER_PANEL info;
+    memset(&info, 0, sizeof(info));
+    info.Costume = summary->Costume;
+    info.Location = summary->Location;
+    info.nItems = summary->nItems;
+    info.Time = summary->PlayTime;
+    info.Money = summary->Money;
+    for (int i = 0; i < PARTY_SIZE; i++) {
+        if (summary->Party[i]) {
+            info.nSpectra++;
+        }
+    }
+    DrawPlayerPanel(&Panels[PANEL_SLOT], &info);
+    ALLEGRO_BITMAP *thumbnail = SaveSlotThumbnail(slot);
+    if (thumbnail) {
+        ListBitmap(thumbnail, 0, 101, 0);
+    }
+}
+
 /**************************************************************/
@@ -0,0 +1,20 @@
+/**********************************************************//**
+ * @file message.c
+ * @brief Implements message template lookups.
+ * @author Rena Shinomiya
+ * @date June 10, 2018
+ **************************************************************/
+
+#include "message.h"            // MESSAGE_ID
+#include "message.i"            // MESSAGE_DATA
+
+/**********************************************************//**
+ * @brief Gets the template for a MESSAGE_ID.
+ * @param id: Message ID to look up.
+ * @return The printf-style template.
+ **************************************************************/
+const char *MessageTemplate(MESSAGE_ID id) {
+    return MESSAGE_DATA[id];
+}
+
+/**************************************************************/
@@ -5,8 +5,10 @@
  * @date April 16, 2018
  **************************************************************/
 
-#include <string.h>             // strncpy, strlen
+#include <stdlib.h>             // malloc, realloc, free
+#include <string.h>             // memcpy, memmove, strlen, strchr
 #include <stdio.h>              // snprintf
+#include <stdarg.h>             // va_list, va_arg
 
 #include "output.h"             // MESSAGE_SIZE
 #include "game.h"               // KEY
@@ -18,15 +20,65 @@
 
 #define FAST_FORWARD_WAIT 0.5f
 
+/// @brief Bytes of text the arena starts with.
+#define ARENA_SIZE 4096
+
+/**********************************************************//**
+ * @union MESSAGE_ARGUMENT
+ * @brief One argument to a message template.
+ **************************************************************/
+typedef union {
+    int Integer;                ///< For %d and %c.
+    double Real;                ///< For %f.
+    const char *Text;           ///< For %s; must outlive the message.
+} MESSAGE_ARGUMENT;
+
+/**********************************************************//**
+ * @struct OUTPUT
+ * @brief One queued message. Plain text is kept in the Arena;
+ * templates are formatted into Shown when they reach the
+ * front of the queue.
+ **************************************************************/
+typedef struct {
+    MESSAGE_ID Message;                             ///< Template, or 0 for plain text.
+    MESSAGE_ARGUMENT Arguments[MESSAGE_ARGUMENTS];  ///< Arguments to the template.
+    int Offset;                                     ///< Start of plain text in the Arena.
+    int Length;                                     ///< Length of the text, or -1 if not formatted yet.
+} OUTPUT;
+
 /**************************************************************/
-/// @brief Queue for output messages.
-static char Log[LOG_SIZE][MESSAGE_SIZE+1] = {{'\0'}};
+/// @brief Queue of output messages, as a ring that doubles
+/// in size when it fills up.
+static OUTPUT *Log = NULL;
+
+/// @brief Number of messages Log can hold.
+static int LogCapacity = 0;
 
 /// @brief Pointer to current output message.
 static int Head = 0;
 
-/// @brief Pointer to one past the end of the queue.
-static int Tail = 0;
+/// @brief Number of messages queued.
+static int nLog = 0;
+
+/// @brief Text of the plain messages, one after another in
+/// the order they were queued, each ending in a null.
+static char *Arena = NULL;
+
+/// @brief Bytes the Arena can hold.
+static int ArenaSize = 0;
+
+/// @brief Start of the oldest text still queued.
+static int ArenaStart = 0;
+
+/// @brief End of the newest text.
+static int ArenaEnd = 0;
+
+/// @brief Text of the template at the front of the queue.
+static char Shown[MESSAGE_SIZE+1];
+
+/// @brief Counts the messages taken off the queue, so each
+/// message at the front has its own number.
+static int Serial = 0;
 
 /// @brief The character position that's been typed to within
 /// the message at the Head of the Log.
@@ -35,40 +87,274 @@ static int CurrentCharacter = 0;
 /// @brief True if the system is waiting for the user.
 static bool WaitingForUser = false;
 
+/// @brief Set on threads whose output should be discarded.
+static __thread bool Muted = false;
+
+/**********************************************************//**
+ * @brief Discards output made by the current thread. Worker
+ * threads that play out battles use this so their messages
+ * don't end up in the game's log.
+ * @param mute: True to discard output, false to show it.
+ **************************************************************/
+void MuteOutput(bool mute) {
+    Muted = mute;
+}
+
+/**********************************************************//**
+ * @brief Adds a message to the back of the queue, growing the
+ * queue if it's full.
+ * @return The new message, or NULL if there's no memory.
+ **************************************************************/
+static OUTPUT *PushOutput(void) {
+    if (nLog == LogCapacity) {
+        int capacity = LogCapacity? 2*LogCapacity: LOG_SIZE;
+        OUTPUT *log = (OUTPUT *)malloc(sizeof(OUTPUT)*capacity);
+        if (!log) {
+            eprintf("Out of memory for output.\n");
+            return NULL;
+        }
+        for (int i=0; i<nLog; i++) {
+            log[i] = Log[(Head+i)%LogCapacity];
+        }
+        free(Log);
+        Log = log;
+        LogCapacity = capacity;
+        Head = 0;
+    }
+    return &Log[(Head+nLog++)%LogCapacity];
+}
+
+/**********************************************************//**
+ * @brief Makes room at the end of the Arena. The queued text
+ * slides down to the start first, and the Arena only grows if
+ * that isn't enough.
+ * @param size: Bytes needed.
+ * @return True if there's room.
+ **************************************************************/
+static bool ReserveArena(int size) {
+    if (ArenaEnd+size <= ArenaSize) {
+        return true;
+    }
+    if (ArenaStart) {
+        memmove(Arena, Arena+ArenaStart, ArenaEnd-ArenaStart);
+        for (int i=0; i<nLog; i++) {
+            OUTPUT *output = &Log[(Head+i)%LogCapacity];
+            if (!output->Message) {
+                output->Offset -= ArenaStart;
+            }
+        }
+        ArenaEnd -= ArenaStart;
+        ArenaStart = 0;
+        if (ArenaEnd+size <= ArenaSize) {
+            return true;
+        }
+    }
+    int capacity = ArenaSize? ArenaSize: ARENA_SIZE;
+    while (capacity < ArenaEnd+size) {
+        capacity *= 2;
+    }
+    char *arena = (char *)realloc(Arena, capacity);
+    if (!arena) {
+        eprintf("Out of memory for output.\n");
+        return false;
+    }
+    Arena = arena;
+    ArenaSize = capacity;
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Enqueues part of a string as a new message.
+ * @param text: The message.
+ * @param length: Length of the message.
+ **************************************************************/
+static void PushText(const char *text, int length) {
+    if (!ReserveArena(length+1)) {
+        return;
+    }
+    OUTPUT *output = PushOutput();
+    if (!output) {
+        return;
+    }
+    output->Message = 0;
+    output->Offset = ArenaEnd;
+    output->Length = length;
+    memcpy(Arena+ArenaEnd, text, length);
+    Arena[ArenaEnd+length] = '\0';
+    ArenaEnd += length+1;
+}
+
 /**********************************************************//**
  * @brief Enqueues a new output message.
  * @param text: The message.
  **************************************************************/
 void Output(const char *text) {
-    int length = strlen(text);
-    strncpy(Log[Tail], text, (length<MESSAGE_SIZE)? length: MESSAGE_SIZE);
-    Log[Tail][length] = '\0';
-    Tail = (Tail+1)%LOG_SIZE;
-    if (Head == Tail) {
-        eprintf("Output queue overflow.");
+    if (Muted) {
+        return;
     }
+    PushText(text, strlen(text));
 }
 
+/**********************************************************//**
+ * @brief Enqueues a message for each line of some text, where
+ * the lines are separated by carriage returns.
+ * @param text: The lines.
+ **************************************************************/
 void OutputSplitByCR(const char *text) {
-    char page[MESSAGE_SIZE+1];
-    char *p = page;
-    for (const char *t=text; *t; t++) {
-        if (*t == '\r') {
-            *p = '\0';
-            Output(page);
-            p = page;
-        } else {
-            *p = *t;
-            if (p-page < (ptrdiff_t)MESSAGE_SIZE) {
-                p++;
-            } else {
-                eprintf("Buffer overflow.");
-            }
+    if (Muted) {
+        return;
+    }
+    while (*text) {
+        const char *end = strchr(text, '\r');
+        if (!end) {
+            PushText(text, strlen(text));
+            break;
         }
+        PushText(text, end-text);
+        text = end+1;
     }
-    if (p != page) {
-        *p = '\0';
-        Output(page);
+}
+
+/**********************************************************//**
+ * @brief Finds the next conversion in a message template.
+ * @param format: Where to start looking.
+ * @return Pointer to the conversion's letter, or NULL if
+ * there are no more.
+ **************************************************************/
+static const char *NextConversion(const char *format) {
+    while ((format = strchr(format, '%'))) {
+        format++;
+        if (*format == '%') {
+            format++;
+            continue;
+        }
+        while (*format && !strchr("cdfs", *format)) {
+            format++;
+        }
+        return *format? format: NULL;
+    }
+    return NULL;
+}
+
+/**********************************************************//**
+ * @brief Enqueues a message from a template. The arguments
+ * are saved and the text isn't formatted until the message
+ * is shown, so muted threads do no string work at all.
+ * @param message: The template.
+ * @param ...: Arguments to the template. Strings must still
+ * exist when the message is shown.
+ **************************************************************/
+void OutputMessage(MESSAGE_ID message, ...) {
+    if (Muted) {
+        return;
+    }
+    OUTPUT *output = PushOutput();
+    if (!output) {
+        return;
+    }
+    output->Message = message;
+    output->Length = -1;
+    va_list args;
+    va_start(args, message);
+    const char *format = MessageTemplate(message);
+    for (int i=0; (format = NextConversion(format)) && i<MESSAGE_ARGUMENTS; i++) {
+        switch (*format) {
+        case 's':
+            output->Arguments[i].Text = va_arg(args, const char *);
+            break;
+        case 'f':
+            output->Arguments[i].Real = va_arg(args, double);
+            break;
+        default:
+            output->Arguments[i].Integer = va_arg(args, int);
+            break;
+        }
+    }
+    va_end(args);
+}
+
+/**********************************************************//**
+ * @brief Gets the text of the message at the front of the
+ * queue. A template is formatted into Shown the first time
+ * this is called for it; after that, and for plain text, this
+ * just returns a pointer.
+ * @param length: Set to the length of the text.
+ * @return The message text.
+ **************************************************************/
+static const char *CurrentOutput(int *length) {
+    OUTPUT *output = &Log[Head];
+    if (!output->Message) {
+        *length = output->Length;
+        return Arena+output->Offset;
+    } else if (output->Length >= 0) {
+        *length = output->Length;
+        return Shown;
+    }
+    const char *format = MessageTemplate(output->Message);
+    int n = 0;
+    int argument = 0;
+    while (*format && n < MESSAGE_SIZE) {
+        if (*format != '%') {
+            Shown[n++] = *format++;
+            continue;
+        }
+
+        // Pull out one conversion, such as %s or %.2f
+        const char *end = format+1;
+        while (*end && !strchr("%cdfs", *end)) {
+            end++;
+        }
+        char spec[16];
+        int size = end+1-format;
+        if (!*end || size >= (int)sizeof(spec) || (*end != '%' && argument >= MESSAGE_ARGUMENTS)) {
+            eprintf("Bad message template %d.\n", output->Message);
+            break;
+        }
+        memcpy(spec, format, size);
+        spec[size] = '\0';
+        format = end+1;
+
+        // Format it in place
+        char *text = &Shown[n];
+        int room = MESSAGE_SIZE+1-n;
+        int written;
+        switch (*end) {
+        case '%':
+            written = snprintf(text, room, "%%");
+            break;
+        case 's':
+            written = snprintf(text, room, spec, output->Arguments[argument++].Text);
+            break;
+        case 'f':
+            written = snprintf(text, room, spec, output->Arguments[argument++].Real);
+            break;
+        default:
+            written = snprintf(text, room, spec, output->Arguments[argument++].Integer);
+            break;
+        }
+        n += (written<room)? written: room-1;
+    }
+    Shown[n] = '\0';
+    output->Length = n;
+    *length = n;
+    return Shown;
+}
+
+/**********************************************************//**
+ * @brief Removes the message at the front of the queue. Its
+ * text in the Arena is free to reuse.
+ **************************************************************/
+static void PopOutput(void) {
+    const OUTPUT *output = &Log[Head];
+    if (!output->Message) {
+        ArenaStart = output->Offset+output->Length+1;
+    }
+    Head = (Head+1)%LogCapacity;
+    nLog--;
+    Serial++;
+    if (!nLog) {
+        ArenaStart = 0;
+        ArenaEnd = 0;
     }
 }
 
@@ -79,10 +365,11 @@ void OutputSplitByCR(const char *text) {
 void UpdateOutput(void) {
     static float Progress = 0.0f;
     static float FastForwardTime = 0.0f;
-    int max = strlen(Log[Head]);
-    if (Head == Tail) {
+    if (!nLog) {
         return;
     }
+    int max;
+    CurrentOutput(&max);
     
     if (KeyUp(KEY_CONFIRM)) {
         FastForwardTime = 0.0f;
@@ -94,7 +381,7 @@ void UpdateOutput(void) {
         bool again = FastForwardTime && al_get_time()>FastForwardTime;
         if (KeyJustUp(KEY_CONFIRM) || again) {
             WaitingForUser = false;
-            Head = (Head+1) % LOG_SIZE;
+            PopOutput();
             Progress = 0.0;
             CurrentCharacter = 0;
             if (again) {
@@ -117,18 +404,32 @@ void UpdateOutput(void) {
 }
 
 /**********************************************************//**
- * @brief Gets the amount of the current output that's been
- * typed.
- * @return Pointer to the output string.
+ * @brief Gets the current output and how much of it has been
+ * typed. Nothing is copied; the text stays where it's queued,
+ * and may move once new messages are queued.
+ * @param length: Set to the length of the whole message.
+ * @param typed: Set to the number of characters typed.
+ * @return Pointer to the message, or NULL if there's no
+ * output.
  **************************************************************/
-const char *GetOutput(void) {
-    static char display[MESSAGE_SIZE+1];
-    if (Head == Tail) {
+const char *GetOutput(int *length, int *typed) {
+    if (!nLog) {
+        *length = 0;
+        *typed = 0;
         return NULL;
     }
-    strncpy(display, Log[Head], CurrentCharacter);
-    display[CurrentCharacter] = '\0';
-    return display;
+    const char *text = CurrentOutput(length);
+    *typed = (CurrentCharacter<*length)? CurrentCharacter: *length;
+    return text;
+}
+
+/**********************************************************//**
+ * @brief Gets a number that changes whenever a different
+ * message comes to the front of the queue.
+ * @return The number.
+ **************************************************************/
+int OutputSerial(void) {
+    return Serial;
 }
 
 /**********************************************************//**
@@ -136,7 +437,7 @@ const char *GetOutput(void) {
  * @return True if there's no more output.
  **************************************************************/
 bool OutputDone(void) {
-    return Head == Tail && !WaitingForUser;
+    return !nLog && !WaitingForUser;
 }
 
 /**********************************************************//**
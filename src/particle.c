@@ -0,0 +1,287 @@
+/**********************************************************//**
+ * @file particle.c
+ * @brief Particle effects shown when techniques are used in
+ * battle. Particles are kept one array per field, packed at
+ * the front of the pool, so updating them is a few straight
+ * loops the compiler can vectorize. Every sprite is cut from
+ * one small atlas, so they all draw in one call.
+ * @author Rena Shinomiya
+ * @date June 10, 2018
+ **************************************************************/
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_primitives.h>
+
+#include <stdbool.h>            // bool
+#include <math.h>               // sqrt, cos, sin, fabs
+
+#include "particle.h"           // PARTICLE_MAX
+#include "random.h"             // RandomState, uniform
+#include "debug.h"              // eprintf
+
+/**************************************************************/
+/// @brief Width and height of one sprite in the atlas.
+#define PARTICLE_SIZE 8
+
+/**********************************************************//**
+ * @enum PARTICLE_SPRITE
+ * @brief Shapes in the particle atlas, left to right.
+ **************************************************************/
+typedef enum {
+    SPRITE_DOT,                 ///< Soft round blob.
+    SPRITE_SPARK,               ///< Small diamond.
+    SPRITE_FLAKE,               ///< Six-pointed flake.
+    SPRITE_RING,                ///< Hollow circle.
+} PARTICLE_SPRITE;
+
+/// The number of unique PARTICLE_SPRITE members.
+#define N_PARTICLE_SPRITE 4
+
+/**********************************************************//**
+ * @struct PARTICLE_STYLE
+ * @brief How the particles of one type look and move.
+ **************************************************************/
+typedef struct {
+    PARTICLE_SPRITE Sprite;     ///< Shape of each particle.
+    float Color[3];             ///< Red, green and blue tint.
+    int Count;                  ///< Particles in one effect.
+    float Spread;               ///< Distance particles start from the center.
+    float Speed;                ///< Fastest starting speed in pixels per second.
+    float Rise;                 ///< Upward speed added to every particle.
+    float Gravity;              ///< Downward acceleration.
+    float Life;                 ///< Longest life in seconds.
+    float Size;                 ///< Width of a new particle in pixels.
+} PARTICLE_STYLE;
+
+/**************************************************************/
+/// @brief The effect of each type of technique.
+static const PARTICLE_STYLE Styles[N_TYPE] = {
+    [BASIC] = {SPRITE_DOT,   {1.00, 1.00, 1.00}, 24, 10,  90,   0,    0, 0.35, 6},
+    [FIRE]  = {SPRITE_DOT,   {1.00, 0.45, 0.10}, 60, 16,  40, 110,  -60, 0.70, 8},
+    [WATER] = {SPRITE_DOT,   {0.25, 0.55, 1.00}, 48, 12, 120,  90,  420, 0.70, 5},
+    [ICE]   = {SPRITE_FLAKE, {0.75, 0.95, 1.00}, 36, 24,  30,   0,   40, 1.00, 7},
+    [WIND]  = {SPRITE_SPARK, {0.70, 1.00, 0.70}, 40, 20, 220,   0,    0, 0.45, 5},
+    [EARTH] = {SPRITE_DOT,   {0.60, 0.42, 0.22}, 40, 14, 100, 160,  600, 0.80, 6},
+    [METAL] = {SPRITE_SPARK, {0.85, 0.85, 0.90}, 50,  6, 260,  60,  500, 0.40, 4},
+    [LIGHT] = {SPRITE_RING,  {1.00, 0.95, 0.50}, 20,  8,  70,   0,    0, 0.60, 8},
+    [DARK]  = {SPRITE_DOT,   {0.45, 0.20, 0.60}, 48, 30,  20,   0,  -30, 0.90, 7},
+};
+
+/// @brief Every sprite side by side, drawn in white so the
+/// vertex colors can tint them.
+static ALLEGRO_BITMAP *Atlas = NULL;
+
+/// @brief Number of live particles; they fill the front of
+/// each array.
+static int nParticles = 0;
+
+/// @brief Position of each particle.
+static float X[PARTICLE_MAX], Y[PARTICLE_MAX];
+
+/// @brief Velocity of each particle.
+static float VX[PARTICLE_MAX], VY[PARTICLE_MAX];
+
+/// @brief Downward acceleration of each particle.
+static float Gravity[PARTICLE_MAX];
+
+/// @brief Seconds each particle has lived.
+static float Age[PARTICLE_MAX];
+
+/// @brief Seconds each particle lives for.
+static float Life[PARTICLE_MAX];
+
+/// @brief Type of technique each particle came from.
+static unsigned char Type[PARTICLE_MAX];
+
+/// @brief Two triangles for each particle, rebuilt each frame.
+static ALLEGRO_VERTEX Vertices[6*PARTICLE_MAX];
+
+/// @brief Random number state for new particles, kept apart
+/// from the battle's. Zero until the first effect seeds it.
+static uint64_t ParticleRandom = 0;
+
+/**********************************************************//**
+ * @brief Works out how opaque a sprite is at a pixel.
+ * @param sprite: The sprite.
+ * @param x: X-distance from the center of the sprite.
+ * @param y: Y-distance from the center of the sprite.
+ * @return Opacity from 0 to 1.
+ **************************************************************/
+static float SpriteAlpha(PARTICLE_SPRITE sprite, float x, float y) {
+    float radius = PARTICLE_SIZE/2.0;
+    float distance = sqrt(x*x + y*y);
+    float alpha = 0.0;
+    switch (sprite) {
+    case SPRITE_DOT:
+        alpha = 1.0 - distance/radius;
+        break;
+    case SPRITE_SPARK:
+        alpha = 1.0 - (fabs(x)+fabs(y))/radius;
+        break;
+    case SPRITE_FLAKE:
+        if (distance < radius && (fabs(x) < 0.6 || fabs(fabs(x)-fabs(y)*0.58) < 0.6)) {
+            alpha = 1.0;
+        }
+        break;
+    case SPRITE_RING:
+        alpha = 1.0 - fabs(distance-radius+1.2)/0.9;
+        break;
+    }
+    return (alpha < 0.0)? 0.0: (alpha > 1.0)? 1.0: alpha;
+}
+
+/**********************************************************//**
+ * @brief Creates the particle atlas. Call this once the
+ * display exists.
+ * @return True on success.
+ **************************************************************/
+bool InitializeParticles(void) {
+    DestroyParticles();
+    Atlas = al_create_bitmap(PARTICLE_SIZE*N_PARTICLE_SPRITE, PARTICLE_SIZE);
+    if (!Atlas) {
+        eprintf("Failed to create the particle atlas.\n");
+        return false;
+    }
+    ALLEGRO_LOCKED_REGION *region = al_lock_bitmap(Atlas, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_WRITEONLY);
+    if (!region) {
+        eprintf("Failed to draw the particle atlas.\n");
+        DestroyParticles();
+        return false;
+    }
+    float center = (PARTICLE_SIZE-1)/2.0;
+    for (int y = 0; y < PARTICLE_SIZE; y++) {
+        unsigned char *out = (unsigned char *)region->data+y*region->pitch;
+        for (int x = 0; x < PARTICLE_SIZE*N_PARTICLE_SPRITE; x++) {
+            PARTICLE_SPRITE sprite = x/PARTICLE_SIZE;
+            float alpha = SpriteAlpha(sprite, x%PARTICLE_SIZE-center, y-center);
+            out[x*4+0] = 255;
+            out[x*4+1] = 255;
+            out[x*4+2] = 255;
+            out[x*4+3] = (unsigned char)(alpha*255.0+0.5);
+        }
+    }
+    al_unlock_bitmap(Atlas);
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Removes every particle and frees the atlas.
+ **************************************************************/
+void DestroyParticles(void) {
+    if (Atlas) {
+        al_destroy_bitmap(Atlas);
+        Atlas = NULL;
+    }
+    nParticles = 0;
+}
+
+/**********************************************************//**
+ * @brief Bursts particles out of a point. If the pool fills
+ * up, the effect is cut short rather than growing the pool.
+ * @param type: Type of the technique.
+ * @param x: X-position of the center.
+ * @param y: Y-position of the center.
+ **************************************************************/
+void StartParticleEffect(TYPE_ID type, float x, float y) {
+    if (type <= 0 || type >= N_TYPE) {
+        type = BASIC;
+    }
+    const PARTICLE_STYLE *style = &Styles[type];
+
+    // Effects start in the middle of turns, so they draw from
+    // their own numbers to keep the battle's replayable.
+    uint64_t saved = RandomState;
+    RandomState = ParticleRandom;
+    for (int n = 0; n < style->Count && nParticles < PARTICLE_MAX; n++) {
+        int i = nParticles++;
+        double angle = uniform(0.0, 2.0*M_PI);
+        double offset = uniform(0.0, style->Spread);
+        double speed = uniform(0.25, 1.0)*style->Speed;
+        X[i] = x + cos(angle)*offset;
+        Y[i] = y + sin(angle)*offset;
+        VX[i] = cos(angle)*speed;
+        VY[i] = sin(angle)*speed - style->Rise;
+        Gravity[i] = style->Gravity;
+        Age[i] = 0.0;
+        Life[i] = uniform(0.6, 1.0)*style->Life;
+        Type[i] = type;
+    }
+    ParticleRandom = RandomState;
+    RandomState = saved;
+}
+
+/**********************************************************//**
+ * @brief Removes every particle.
+ **************************************************************/
+void ClearParticles(void) {
+    nParticles = 0;
+}
+
+/**********************************************************//**
+ * @brief Moves every particle forward in time and removes
+ * the ones that have faded out.
+ * @param time: Seconds since the last update.
+ **************************************************************/
+void UpdateParticles(float time) {
+    int n = nParticles;
+    for (int i = 0; i < n; i++) {
+        VY[i] += Gravity[i]*time;
+    }
+    for (int i = 0; i < n; i++) {
+        X[i] += VX[i]*time;
+        Y[i] += VY[i]*time;
+        Age[i] += time;
+    }
+
+    // Slide the survivors down over the dead.
+    int live = 0;
+    for (int i = 0; i < n; i++) {
+        if (Age[i] >= Life[i]) {
+            continue;
+        }
+        if (live != i) {
+            X[live] = X[i];
+            Y[live] = Y[i];
+            VX[live] = VX[i];
+            VY[live] = VY[i];
+            Gravity[live] = Gravity[i];
+            Age[live] = Age[i];
+            Life[live] = Life[i];
+            Type[live] = Type[i];
+        }
+        live++;
+    }
+    nParticles = live;
+}
+
+/**********************************************************//**
+ * @brief Draws every particle in one call. Particles shrink
+ * and fade out over their lives.
+ **************************************************************/
+void DrawParticles(void) {
+    if (!Atlas || !nParticles) {
+        return;
+    }
+    for (int i = 0; i < nParticles; i++) {
+        const PARTICLE_STYLE *style = &Styles[Type[i]];
+        float fade = 1.0 - Age[i]/Life[i];
+        float half = style->Size*(0.5+0.5*fade)/2.0;
+        float left = X[i]-half;
+        float right = X[i]+half;
+        float top = Y[i]-half;
+        float bottom = Y[i]+half;
+        float u0 = style->Sprite*PARTICLE_SIZE;
+        float u1 = u0+PARTICLE_SIZE;
+        ALLEGRO_COLOR color = al_map_rgba_f(style->Color[0], style->Color[1], style->Color[2], fade);
+        ALLEGRO_VERTEX *v = &Vertices[6*i];
+        v[0] = (ALLEGRO_VERTEX){left,  top,    0, u0, 0,             color};
+        v[1] = (ALLEGRO_VERTEX){right, top,    0, u1, 0,             color};
+        v[2] = (ALLEGRO_VERTEX){left,  bottom, 0, u0, PARTICLE_SIZE, color};
+        v[3] = (ALLEGRO_VERTEX){right, top,    0, u1, 0,             color};
+        v[4] = (ALLEGRO_VERTEX){right, bottom, 0, u1, PARTICLE_SIZE, color};
+        v[5] = (ALLEGRO_VERTEX){left,  bottom, 0, u0, PARTICLE_SIZE, color};
+    }
+    al_draw_prim(Vertices, NULL, Atlas, 0, 6*nParticles, ALLEGRO_PRIM_TRIANGLE_LIST);
+}
+
+/**************************************************************/
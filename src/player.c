@@ -7,19 +7,20 @@
 
 #include <stdbool.h>            // bool
 #include <stdio.h>              // FILE
-#include <stdlib.h>             // memcpy
+#include <stdlib.h>             // memcpy, free
 
-#include <allegro5/allegro.h>
+#include <allegro5/allegro.h>   // ALLEGRO_THREAD, ALLEGRO_MUTEX
 
 #include "player.h"             // PLAYER
 #include "assets.h"             // SAVE_FILE
 #include "species.h"            // CreateSpectra
 #include "location.h"           // Warp
+#include "storage.h"            // StoreSpectra
+#include "save_file.h"          // WriteSaveFile, ReadSaveFile
+#include "journal.h"            // Journal
+#include "save_slot.h"          // SaveSlotPath, Thumbnail
 
 /**************************************************************/
-/// @brief Defines the path to the save file.
-#define SAVE_FILE "spectrum.save"
-
 /// @brief Define the path to the backup save file.
 #define BACKUP_SAVE_FILE "backup.save"
 
@@ -37,6 +38,32 @@ PLAYER *const Player = &PlayerData;
 /// when Save is chosen from the main menu).
 static double StartTime;
 
+/// @brief Save slot the game was loaded from or last saved to,
+/// or -1 for a new game that hasn't been saved.
+static int Slot = -1;
+
+/**********************************************************//**
+ * @struct SAVE_JOB
+ * @brief A save being written on another thread. The save
+ * thread only reads Data, and only sets Done and Success
+ * while holding Lock.
+ **************************************************************/
+typedef struct {
+    SAVE_DATA Data;             ///< Copy of everything being saved.
+    bool Started;               ///< Set until FinishSaveGame is called.
+    bool Done;                  ///< Set once the file is written.
+    bool Success;               ///< Whether the file was written.
+    ALLEGRO_THREAD *Thread;     ///< The save thread, or NULL.
+    ALLEGRO_MUTEX *Lock;        ///< Guards Done and Success.
+    unsigned long Checksum;     ///< Checksum of Data.
+    int Slot;                   ///< Slot being saved to.
+    bool HasThumbnail;          ///< Set if there's a picture to save.
+    SAVE_THUMBNAIL Thumbnail;   ///< Picture of the game.
+} SAVE_JOB;
+
+/// @brief The save being written, if any.
+static SAVE_JOB SaveJob;
+
 /**********************************************************//**
  * @brief Give the player a new item.
  * @param id: Item to obtain.
@@ -46,6 +73,7 @@ bool GetItem(ITEM_ID id) {
     for (int i=0; i<INVENTORY_SIZE; i++) {
         if (!PlayerData.Inventory[i]) {
             PlayerData.Inventory[i] = id;
+            Journal(JOURNAL_GET_ITEM, id);
             return true;
         }
     }
@@ -87,6 +115,7 @@ bool HasItem(ITEM_ID id) {
  * @param id: Item to use.
  **************************************************************/
 void DropItem(ITEM_ID id) {
+    Journal(JOURNAL_DROP_ITEM, id);
     for (int i=0; i<INVENTORY_SIZE && PlayerData.Inventory[i]; i++) {
         ITEM_ID current = PlayerData.Inventory[i];
         if (current == id) {
@@ -100,19 +129,52 @@ void DropItem(ITEM_ID id) {
 }
 
 /**********************************************************//**
- * @brief Attempts to add a spectra to the player's party.
+ * @brief Determine if the player's party is full.
+ * @return True if the party is full.
+ **************************************************************/
+bool PartyFull(void) {
+    for (int i=0; i<PARTY_SIZE; i++) {
+        if (!PlayerData.Spectra[i].Species) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Attempts to add a spectra to the player's party. If
+ * the party is full, the spectra goes into storage.
  * @param spectra: Spectra to capture.
- * @return True if the spectra was added.
+ * @return True if the spectra was kept.
  **************************************************************/
 bool GetSpectra(const SPECTRA *spectra) {
     // Try to find a slot for the spectra
-    for (int i=0; i<PARTY_SIZE; i++) {
+    bool kept = false;
+    for (int i=0; i<PARTY_SIZE && !kept; i++) {
         if (!PlayerData.Spectra[i].Species) {
             memcpy(&PlayerData.Spectra[i], spectra, sizeof(SPECTRA));
-            return true;
+            kept = true;
         }
     }
-    return false;
+    if (!kept) {
+        kept = StoreSpectra(spectra);
+    }
+    if (kept) {
+        JournalSpectra(JOURNAL_GET_SPECTRA, spectra);
+    }
+    return kept;
+}
+
+/**********************************************************//**
+ * @brief Takes a spectra out of the party, moving the ones
+ * after it up.
+ * @param index: Index of the spectra in the party.
+ **************************************************************/
+static void RemoveFromParty(int index) {
+    for (int i=index; i<PARTY_SIZE-1; i++) {
+        PlayerData.Spectra[i] = PlayerData.Spectra[i+1];
+    }
+    PlayerData.Spectra[PARTY_SIZE-1].Species = 0;
 }
 
 void ReleaseSpectra(int index) {
@@ -120,12 +182,45 @@ void ReleaseSpectra(int index) {
     if (PlayerData.Spectra[index].Species == AMY) {
         return;
     }
-    
-    // Rotate spectra list down
-    for (int i=index; i<PARTY_SIZE; i++) {
-        PlayerData.Spectra[i] = PlayerData.Spectra[i+1];
+    RemoveFromParty(index);
+    Journal(JOURNAL_RELEASE_SPECTRA, index);
+}
+
+/**********************************************************//**
+ * @brief Moves a spectra from the party into storage.
+ * @param index: Index of the spectra in the party.
+ * @return True if the spectra was stored.
+ **************************************************************/
+bool DepositSpectra(int index) {
+    // The player character stays in the party
+    const SPECTRA *spectra = &PlayerData.Spectra[index];
+    if (!spectra->Species || spectra->Species == AMY) {
+        return false;
     }
-    PlayerData.Spectra[PARTY_SIZE-1].Species = 0;
+    if (!StoreSpectra(spectra)) {
+        return false;
+    }
+    RemoveFromParty(index);
+    Journal(JOURNAL_DEPOSIT_SPECTRA, index);
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Moves a spectra from storage into the party.
+ * @param entry: Entry of the spectra in storage.
+ * @return True if there was room in the party.
+ **************************************************************/
+bool WithdrawSpectra(int entry) {
+    for (int i=0; i<PARTY_SIZE; i++) {
+        if (!PlayerData.Spectra[i].Species) {
+            if (!TakeStoredSpectra(entry, &PlayerData.Spectra[i])) {
+                return false;
+            }
+            JournalSpectra(JOURNAL_WITHDRAW_SPECTRA, &PlayerData.Spectra[i]);
+            return true;
+        }
+    }
+    return false;
 }
 
 void RecoverParty(void) {
@@ -166,6 +261,11 @@ void NewGame(void) {
         Player->Spectra[i].Species = 0;
     }
     CreateSpectra(&Player->Spectra[0], AMY, 5);
+    ClearStorage();
+
+    // Nothing is journaled until the new game is saved.
+    StopJournal();
+    Slot = -1;
     
     // Reset locations
     Warp(YOUR_HOUSE, 2, 3, DOWN);
@@ -189,47 +289,231 @@ int UnaccountedPlayTime(void) {
 }
 
 /**********************************************************//**
- * @brief Loads a save file from disk. Currently data are
- * stored in SAVE_FILE and no other location is possible.
+ * @brief Loads a save file from an older version, which was
+ * just the raw PLAYER data followed by the storage box.
+ * @param saveFile: The save file.
+ * @return True if the player's data were read.
+ **************************************************************/
+static bool LoadRawGame(FILE *saveFile) {
+    int nRead = fread(&PlayerData, sizeof(PLAYER), 1, saveFile);
+    if (nRead == 1) {
+        // Lost storage is bad, but not worth losing the
+        // rest of the save over.
+        LoadStorage(saveFile);
+    }
+    return nRead == 1;
+}
+
+/**********************************************************//**
+ * @brief Loads the save file in a save slot from disk. Saves
+ * in the raw format of older versions still load, and are
+ * rewritten in the new format the next time the game is
+ * saved.
+ * @param slot: The save slot.
+ * @param recover: Set when starting up, to play back anything
+ * journaled after the save before a crash. Otherwise the
+ * journal starts over from the save.
  * @return True if the load succeeded.
  **************************************************************/
-bool LoadGame(void) {
-    FILE *saveFile = fopen(SAVE_FILE, "rb");
-    if (saveFile) {
-        int nRead = fread(&PlayerData, sizeof(PLAYER), 1, saveFile);
-        fclose(saveFile);
-        if (nRead == 1) {
-            InitializeLocation();
-            SetMode(MODE_MAP);
+bool LoadGame(int slot, bool recover) {
+    FinishSaveGame();
+    const char *path = SaveSlotPath(slot);
+    bool loaded = false;
+    if (IsSaveFile(path)) {
+        SAVE_DATA data;
+        if (ReadSaveFile(path, &data)) {
+            PlayerData = data.Player;
+            RestoreStorage(data.Storage, data.nStorage);
+            free(data.Storage);
+            loaded = true;
+        }
+    } else {
+        FILE *saveFile = fopen(path, "rb");
+        if (saveFile) {
+            loaded = LoadRawGame(saveFile);
+            fclose(saveFile);
+        }
+    }
+    if (loaded) {
+        Slot = slot;
+        StartPlayTime();
+
+        // Play back anything journaled after the save.
+        SAVE_DATA current;
+        current.Player = PlayerData;
+        current.Storage = CopyStorage(&current.nStorage);
+        if (recover) {
+            RecoverJournal(SaveDataChecksum(&current), slot);
+        } else {
+            ResetJournal(SaveDataChecksum(&current), slot);
+        }
+        free(current.Storage);
+        InitializeLocation();
+        SetMode(MODE_MAP);
 #ifdef DEBUG
-            FILE *copyFile = fopen(BACKUP_SAVE_FILE, "wb");
-            fwrite(&PlayerData, sizeof(PLAYER), 1, copyFile);
-            fflush(copyFile);
-            fclose(copyFile);
+        SAVE_DATA backup;
+        backup.Player = PlayerData;
+        backup.Storage = CopyStorage(&backup.nStorage);
+        WriteSaveFile(BACKUP_SAVE_FILE, &backup, NULL, false);
+        free(backup.Storage);
 #endif // DEBUG
-            return true;
-        }
     }
-    return false;
+    return loaded;
 }
 
 /**********************************************************//**
- * @brief Saves the player's data to the SAVE_FILE. Currently
- * this is the only possible location to save to.
- * @return True if the save succeeded.
+ * @brief Gets the save slot the game was loaded from or last
+ * saved to.
+ * @return The save slot, or -1 if the game hasn't been saved.
  **************************************************************/
-bool SaveGame(void) {
+int CurrentSaveSlot(void) {
+    return Slot;
+}
+
+/**********************************************************//**
+ * @brief Writes the save file for the save that was started.
+ * @return True on success.
+ **************************************************************/
+static bool WriteSaveJob(void) {
+    const SAVE_THUMBNAIL *thumbnail = SaveJob.HasThumbnail? &SaveJob.Thumbnail: NULL;
+    return WriteSaveFile(SaveSlotPath(SaveJob.Slot), &SaveJob.Data, thumbnail, true);
+}
+
+/**********************************************************//**
+ * @brief Writes the save that was started. This runs on the
+ * save thread, and only touches SaveJob.
+ * @param thread: The thread.
+ * @param argument: Unused.
+ * @return NULL.
+ **************************************************************/
+static void *WriteSave(ALLEGRO_THREAD *thread, void *argument) {
+    (void)thread;
+    (void)argument;
+    bool success = WriteSaveJob();
+    al_lock_mutex(SaveJob.Lock);
+    SaveJob.Success = success;
+    SaveJob.Done = true;
+    al_unlock_mutex(SaveJob.Lock);
+    return NULL;
+}
+
+/**********************************************************//**
+ * @brief Starts saving the player's data to a save slot.
+ * The data are copied now, and written to disk on another
+ * thread, so the game can go on while it's saved. Use
+ * SaveGameDone to find out when it's finished. The picture
+ * from the last CaptureThumbnail is saved with it.
+ * @param slot: The save slot.
+ **************************************************************/
+void StartSaveGame(int slot) {
+    FinishSaveGame();
+    Slot = slot;
+
+    // Nothing else may have the file open while it's replaced.
+    ForgetSaveSlot(slot);
+
     // Update time stamping
     Player->PlayTime += UnaccountedPlayTime();
     StartPlayTime();
-    FILE *saveFile = fopen(SAVE_FILE, "wb");
-    if (saveFile) {
-        int nWrite = fwrite(&PlayerData, sizeof(PLAYER), 1, saveFile);
-        fflush(saveFile);
-        fclose(saveFile);
-        return nWrite == 1;
+
+    // Copy everything the save thread needs.
+    SaveJob.Data.Player = PlayerData;
+    SaveJob.Data.Storage = CopyStorage(&SaveJob.Data.nStorage);
+    SaveJob.Checksum = SaveDataChecksum(&SaveJob.Data);
+    SaveJob.Slot = slot;
+    const SAVE_THUMBNAIL *thumbnail = Thumbnail();
+    SaveJob.HasThumbnail = thumbnail != NULL;
+    if (thumbnail) {
+        SaveJob.Thumbnail = *thumbnail;
+    }
+    BeginJournal(SaveJob.Checksum, slot);
+    SaveJob.Done = false;
+    SaveJob.Success = false;
+    SaveJob.Started = true;
+    if (!SaveJob.Lock) {
+        SaveJob.Lock = al_create_mutex();
+    }
+    if (SaveJob.Lock) {
+        SaveJob.Thread = al_create_thread(WriteSave, NULL);
+    }
+    if (SaveJob.Thread) {
+        al_start_thread(SaveJob.Thread);
+    } else {
+        // Without a thread, just save now.
+        SaveJob.Success = WriteSaveJob();
+        SaveJob.Done = true;
+    }
+}
+
+/**********************************************************//**
+ * @brief Checks if the save started by StartSaveGame has
+ * been written. This never waits for the disk.
+ * @param success: Where to put whether the save succeeded,
+ * once it's done.
+ * @return True if the save is done.
+ **************************************************************/
+bool SaveGameDone(bool *success) {
+    if (!SaveJob.Started) {
+        return true;
+    }
+    bool done = SaveJob.Done;
+    if (SaveJob.Thread) {
+        al_lock_mutex(SaveJob.Lock);
+        done = SaveJob.Done;
+        al_unlock_mutex(SaveJob.Lock);
+    }
+    if (done) {
+        *success = FinishSaveGame();
+    }
+    return done;
+}
+
+/**********************************************************//**
+ * @brief Waits for the save started by StartSaveGame, if
+ * there is one, to be written.
+ * @return True if the save succeeded.
+ **************************************************************/
+bool FinishSaveGame(void) {
+    if (!SaveJob.Started) {
+        return SaveJob.Success;
+    }
+    if (SaveJob.Thread) {
+        al_join_thread(SaveJob.Thread, NULL);
+        al_destroy_thread(SaveJob.Thread);
+        SaveJob.Thread = NULL;
+    }
+    free(SaveJob.Data.Storage);
+    SaveJob.Data.Storage = NULL;
+    SaveJob.Started = false;
+    ForgetSaveSlot(SaveJob.Slot);
+    if (SaveJob.Success) {
+        // The journal up to here is in the save now.
+        CompactJournal(SaveJob.Checksum);
+    }
+    return SaveJob.Success;
+}
+
+/**********************************************************//**
+ * @brief Saves the player's data to a save slot, waiting
+ * for it to be written.
+ * @param slot: The save slot.
+ * @return True if the save succeeded.
+ **************************************************************/
+bool SaveGame(int slot) {
+    StartSaveGame(slot);
+    return FinishSaveGame();
+}
+
+/**********************************************************//**
+ * @brief Waits for any save to finish and frees the save
+ * thread's resources.
+ **************************************************************/
+void DestroySaveGame(void) {
+    FinishSaveGame();
+    if (SaveJob.Lock) {
+        al_destroy_mutex(SaveJob.Lock);
+        SaveJob.Lock = NULL;
     }
-    return false;
 }
 
 /**************************************************************/
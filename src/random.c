@@ -0,0 +1,56 @@
+/**********************************************************//**
+ * @file random.c
+ * @brief Seeds the per-thread random number generators.
+ * @author Rena Shinomiya
+ * @date June 4, 2018
+ **************************************************************/
+
+#include <stdint.h>             // uint64_t, uintptr_t
+#include <time.h>               // time
+
+#include "random.h"             // RandomState
+
+/**************************************************************/
+__thread uint64_t RandomState = 0;
+
+/// @brief Counts lazily seeded threads, so threads started in
+/// the same second still get different streams.
+static volatile uint64_t SeedCounter = 0;
+
+/**********************************************************//**
+ * @brief Scrambles a seed so nearby seeds give unrelated
+ * streams (splitmix64 finalizer).
+ * @param x: The seed.
+ * @return The scrambled seed.
+ **************************************************************/
+static uint64_t ScrambleSeed(uint64_t x) {
+    x += UINT64_C(0x9E3779B97F4A7C15);
+    x = (x ^ (x >> 30))*UINT64_C(0xBF58476D1CE4E5B9);
+    x = (x ^ (x >> 27))*UINT64_C(0x94D049BB133111EB);
+    return x ^ (x >> 31);
+}
+
+/**********************************************************//**
+ * @brief Seeds the random number generator of the current
+ * thread. The same seed always gives the same numbers.
+ * @param seed: Any number.
+ **************************************************************/
+void SeedRandom(uint64_t seed) {
+    RandomState = ScrambleSeed(seed);
+    if (!RandomState) {
+        // Xorshift can't leave the zero state.
+        RandomState = 1;
+    }
+}
+
+/**********************************************************//**
+ * @brief Seeds the current thread's generator from the time
+ * and a per-thread counter. This is done automatically the
+ * first time a thread asks for a random number.
+ **************************************************************/
+void SeedRandomLazily(void) {
+    uint64_t count = __sync_fetch_and_add(&SeedCounter, 1);
+    SeedRandom((uint64_t)time(NULL) ^ (count << 32) ^ (uint64_t)(uintptr_t)&RandomState);
+}
+
+/**************************************************************/
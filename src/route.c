@@ -0,0 +1,523 @@
+/**********************************************************//**
+ * @file route.c
+ * @brief Plans walking routes between locations. Every warp
+ * in the game is collected into a small graph once at load
+ * time, with the walking distance between the warps on each
+ * map precomputed from the map sensors. A route query only
+ * floods the map the player is standing on, and then
+ * searches the small warp graph.
+ * @author Rena Shinomiya
+ * @date May 30, 2018
+ **************************************************************/
+
+#include <stdlib.h>             // malloc, realloc, free
+#include <stdbool.h>            // bool
+#include <limits.h>             // INT_MAX
+
+#include "route.h"              // ROUTE
+#include "sensor.h"             // SENSOR, LoadSensor
+#include "event.h"              // EVENT, Events
+#include "debug.h"              // eprintf
+
+/**********************************************************//**
+ * @struct ROUTE_NODE
+ * @brief One node of the warp graph. A node is either a warp
+ * tile, or the tile a warp leads to.
+ **************************************************************/
+typedef struct {
+    MAP_ID Map;                 ///< Map the node is on.
+    COORDINATE Tile;            ///< Tile position of the node.
+    int Arrival;                ///< For warps, the node the warp leads to. Otherwise -1.
+} ROUTE_NODE;
+
+/**********************************************************//**
+ * @struct ROUTE_GOAL
+ * @brief Walking distance from a node to a LOCATION.
+ **************************************************************/
+typedef struct {
+    int Cost;                   ///< Steps to reach the location.
+    COORDINATE Tile;            ///< First tile reached inside the location.
+} ROUTE_GOAL;
+
+/**************************************************************/
+/// @brief Cost used for unreachable nodes.
+#define UNREACHABLE INT_MAX
+
+/// @brief Cost of stepping through a warp.
+#define WARP_COST 1
+
+/**************************************************************/
+/// @brief Sensors for every map, kept for planning.
+static SENSOR Sensors[N_MAP];
+
+/// @brief All nodes in the warp graph.
+static ROUTE_NODE *Nodes = NULL;
+
+/// @brief Number of nodes in the warp graph.
+static int NodeCount = 0;
+
+/// @brief Walking cost from each arrival node to each warp
+/// node on the same map, indexed [from*NodeCount+to].
+static int *Cost = NULL;
+
+/// @brief Walking cost from each arrival node into each
+/// location, indexed [location*NodeCount+from].
+static ROUTE_GOAL *Goals = NULL;
+
+/**************************************************************/
+/// @brief Scratch distance buffer used while planning.
+static int *Distance = NULL;
+
+/// @brief Distance field toward the current leg's target.
+static int *Field = NULL;
+
+/// @brief Queue used by Flood.
+static int *Queue = NULL;
+
+/// @brief Map the distance field was computed on.
+static MAP_ID FieldMap = 0;
+
+/// @brief Target tile of the distance field.
+static COORDINATE FieldTarget;
+
+/// @brief Dijkstra state, one entry per node.
+static int *Best = NULL;
+static int *Previous = NULL;
+static bool *Done = NULL;
+
+/**********************************************************//**
+ * @brief Gets the map a warp to a LOCATION arrives on.
+ * @param id: The warp's destination LOCATION.
+ * @return The destination map.
+ **************************************************************/
+static inline MAP_ID WarpMap(LOCATION_ID id) {
+    return (id == OVERWORLD)? MAP_OVERWORLD: Location(id)->Map;
+}
+
+/**********************************************************//**
+ * @brief Applies any redirects to an event ID.
+ * @param events: The map's EVENT array.
+ * @param id: The event ID.
+ * @return Pointer to a non-redirect event.
+ **************************************************************/
+static inline const EVENT *ResolveEvent(const EVENT *events, int id) {
+    const EVENT *event = &events[id];
+    while (event->Type == EVENT_REDIRECT) {
+        event = &events[event->Union.Redirect];
+    }
+    return event;
+}
+
+/**********************************************************//**
+ * @brief Checks if the tile can be walked on.
+ * @param sensor: The map's sensor.
+ * @param x: Tile X-coordinate.
+ * @param y: Tile Y-coordinate.
+ * @return True if the tile is passable.
+ **************************************************************/
+static inline bool Passable(const SENSOR *sensor, int x, int y) {
+    return SensorInBounds(sensor, x, y) && !SensorTile(sensor, x, y)->Flags;
+}
+
+/**********************************************************//**
+ * @brief Adds a node to the warp graph. Arrival nodes at the
+ * same position are shared.
+ * @param map: The node's map.
+ * @param tile: The node's tile.
+ * @param arrival: Node the warp leads to, or -1.
+ * @return Index of the node, or -1 on failure.
+ **************************************************************/
+static int AddNode(MAP_ID map, COORDINATE tile, int arrival) {
+    if (arrival < 0) {
+        for (int i = 0; i < NodeCount; i++) {
+            const ROUTE_NODE *node = &Nodes[i];
+            if (node->Arrival < 0 && node->Map == map && node->Tile.X == tile.X && node->Tile.Y == tile.Y) {
+                return i;
+            }
+        }
+    }
+    ROUTE_NODE *nodes = (ROUTE_NODE *)realloc(Nodes, sizeof(ROUTE_NODE)*(NodeCount+1));
+    if (!nodes) {
+        eprintf("Out of memory for route nodes.\n");
+        return -1;
+    }
+    Nodes = nodes;
+    Nodes[NodeCount] = (ROUTE_NODE){map, tile, arrival};
+    return NodeCount++;
+}
+
+/**********************************************************//**
+ * @brief Computes the walking distance from a seed tile to
+ * every tile on a map. The seed itself doesn't need to be
+ * passable, so warp tiles can be used as seeds.
+ * @param sensor: The map's sensor.
+ * @param distance: Output distances, one per tile.
+ * @param seed: The starting tile.
+ **************************************************************/
+static void Flood(const SENSOR *sensor, int *distance, COORDINATE seed) {
+    static const int DX[] = {0, -1, 0, 1};
+    static const int DY[] = {1, 0, -1, 0};
+    int size = sensor->Width*sensor->Height;
+    for (int i = 0; i < size; i++) {
+        distance[i] = UNREACHABLE;
+    }
+    if (!SensorInBounds(sensor, seed.X, seed.Y)) {
+        return;
+    }
+    int head = 0;
+    int tail = 0;
+    Queue[tail++] = seed.Y*sensor->Width+seed.X;
+    distance[Queue[0]] = 0;
+    while (head < tail) {
+        int index = Queue[head++];
+        int x = index%sensor->Width;
+        int y = index/sensor->Width;
+        for (int i = 0; i < 4; i++) {
+            int nx = x+DX[i];
+            int ny = y+DY[i];
+            int next = ny*sensor->Width+nx;
+            if (Passable(sensor, nx, ny) && distance[next] == UNREACHABLE) {
+                distance[next] = distance[index]+1;
+                Queue[tail++] = next;
+            }
+        }
+    }
+}
+
+/**********************************************************//**
+ * @brief Gets the walking distance to a warp tile after a
+ * Flood. Warps are reached by walking into them from any
+ * passable neighbor.
+ * @param sensor: The map's sensor.
+ * @param distance: Distances computed by Flood.
+ * @param warp: The warp tile.
+ * @return Steps to the warp, or UNREACHABLE.
+ **************************************************************/
+static int WarpDistance(const SENSOR *sensor, const int *distance, COORDINATE warp) {
+    static const int DX[] = {0, -1, 0, 1};
+    static const int DY[] = {1, 0, -1, 0};
+    int best = UNREACHABLE;
+    for (int i = 0; i < 4; i++) {
+        int x = warp.X+DX[i];
+        int y = warp.Y+DY[i];
+        if (Passable(sensor, x, y)) {
+            int cost = distance[y*sensor->Width+x];
+            if (cost != UNREACHABLE && cost+1 < best) {
+                best = cost+1;
+            }
+        }
+    }
+    return best;
+}
+
+/**********************************************************//**
+ * @brief Gets the walking distance into a LOCATION's bounding
+ * box after a Flood.
+ * @param sensor: The map's sensor.
+ * @param distance: Distances computed by Flood.
+ * @param bounds: World coordinate bounds of the location.
+ * @param tile: Set to the closest tile inside the bounds.
+ * @return Steps into the bounds, or UNREACHABLE.
+ **************************************************************/
+static int RegionDistance(const SENSOR *sensor, const int *distance, const COORDINATE *bounds, COORDINATE *tile) {
+    int best = UNREACHABLE;
+    for (int y = bounds[0].Y/16; y < (bounds[1].Y+15)/16; y++) {
+        for (int x = bounds[0].X/16; x < (bounds[1].X+15)/16; x++) {
+            if (SensorInBounds(sensor, x, y) && distance[y*sensor->Width+x] < best) {
+                best = distance[y*sensor->Width+x];
+                *tile = (COORDINATE){x, y};
+            }
+        }
+    }
+    return best;
+}
+
+/**********************************************************//**
+ * @brief Builds the warp graph from every map's sensor and
+ * events, and precomputes walking costs within each map.
+ * @return True on success.
+ **************************************************************/
+bool InitializeRoutes(void) {
+    DestroyRoutes();
+
+    // Collect every warp and the tile it arrives on.
+    int largest = 0;
+    for (MAP_ID map = MAP_OVERWORLD; map < N_MAP; map++) {
+        if (!LoadSensor(&Sensors[map], map)) {
+            continue;
+        }
+        const SENSOR *sensor = &Sensors[map];
+        if (sensor->Width*sensor->Height > largest) {
+            largest = sensor->Width*sensor->Height;
+        }
+        const EVENT *events = Events(map);
+        if (!events) {
+            continue;
+        }
+        for (int y = 0; y < sensor->Height; y++) {
+            for (int x = 0; x < sensor->Width; x++) {
+                int id = SensorTile(sensor, x, y)->EventID;
+                if (!id) {
+                    continue;
+                }
+                const EVENT *event = ResolveEvent(events, id);
+                if (event->Type != EVENT_WARP) {
+                    continue;
+                }
+                const WARP *warp = &event->Union.Warp;
+                int arrival = AddNode(WarpMap(warp->Location), warp->Destination, -1);
+                if (arrival < 0 || AddNode(map, (COORDINATE){x, y}, arrival) < 0) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    // Planning buffers
+    Distance = (int *)malloc(sizeof(int)*largest);
+    Field = (int *)malloc(sizeof(int)*largest);
+    Queue = (int *)malloc(sizeof(int)*largest);
+    Cost = (int *)malloc(sizeof(int)*NodeCount*NodeCount);
+    Goals = (ROUTE_GOAL *)malloc(sizeof(ROUTE_GOAL)*N_LOCATION*NodeCount);
+    Best = (int *)malloc(sizeof(int)*NodeCount);
+    Previous = (int *)malloc(sizeof(int)*NodeCount);
+    Done = (bool *)malloc(sizeof(bool)*NodeCount);
+    if (!Distance || !Field || !Queue || !Cost || !Goals || !Best || !Previous || !Done) {
+        eprintf("Out of memory for route planning.\n");
+        DestroyRoutes();
+        return false;
+    }
+    for (int i = 0; i < NodeCount*NodeCount; i++) {
+        Cost[i] = UNREACHABLE;
+    }
+    for (int i = 0; i < N_LOCATION*NodeCount; i++) {
+        Goals[i].Cost = UNREACHABLE;
+    }
+
+    // Walk from each arrival to every warp and location on
+    // the same map.
+    for (int from = 0; from < NodeCount; from++) {
+        const ROUTE_NODE *node = &Nodes[from];
+        const SENSOR *sensor = &Sensors[node->Map];
+        if (node->Arrival >= 0 || !sensor->Sensor) {
+            continue;
+        }
+        if (!Passable(sensor, node->Tile.X, node->Tile.Y)) {
+            eprintf("Warp arrives on a blocked tile: map %d at %d,%d\n", node->Map, node->Tile.X, node->Tile.Y);
+        }
+        Flood(sensor, Distance, node->Tile);
+        for (int to = 0; to < NodeCount; to++) {
+            if (Nodes[to].Arrival >= 0 && Nodes[to].Map == node->Map) {
+                Cost[from*NodeCount+to] = WarpDistance(sensor, Distance, Nodes[to].Tile);
+            }
+        }
+        for (LOCATION_ID id = 1; id < N_LOCATION; id++) {
+            const LOCATION *location = Location(id);
+            ROUTE_GOAL *goal = &Goals[id*NodeCount+from];
+            if (location->Map != node->Map) {
+                continue;
+            } else if (node->Map == MAP_OVERWORLD) {
+                goal->Cost = RegionDistance(sensor, Distance, location->Bounds, &goal->Tile);
+            } else {
+                goal->Cost = 0;
+                goal->Tile = node->Tile;
+            }
+        }
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Releases all route planning data.
+ **************************************************************/
+void DestroyRoutes(void) {
+    for (MAP_ID map = 0; map < N_MAP; map++) {
+        DestroySensor(&Sensors[map]);
+    }
+    free(Nodes);
+    free(Cost);
+    free(Goals);
+    free(Distance);
+    free(Field);
+    free(Queue);
+    free(Best);
+    free(Previous);
+    free(Done);
+    Nodes = NULL;
+    Cost = NULL;
+    Goals = NULL;
+    Distance = NULL;
+    Field = NULL;
+    Queue = NULL;
+    Best = NULL;
+    Previous = NULL;
+    Done = NULL;
+    NodeCount = 0;
+    FieldMap = 0;
+}
+
+/**********************************************************//**
+ * @brief Relaxes the cost of reaching a node.
+ * @param to: Node being reached.
+ * @param from: Node it's reached from.
+ * @param cost: Total cost of reaching it this way.
+ **************************************************************/
+static inline void Relax(int to, int from, int cost) {
+    if (cost < Best[to]) {
+        Best[to] = cost;
+        Previous[to] = from;
+    }
+}
+
+/**********************************************************//**
+ * @brief Plans the shortest walking route to a LOCATION.
+ * @param route: The ROUTE to fill in.
+ * @param map: Map the route starts on.
+ * @param start: Tile the route starts on.
+ * @param destination: The LOCATION to reach.
+ * @return True if a route exists.
+ **************************************************************/
+bool FindRoute(ROUTE *route, MAP_ID map, COORDINATE start, LOCATION_ID destination) {
+    route->Destination = destination;
+    route->Cost = 0;
+    route->Length = 0;
+    route->Current = 0;
+    if (!Nodes || destination <= 0 || destination >= N_LOCATION || map <= 0 || map >= N_MAP) {
+        return false;
+    }
+    const LOCATION *goal = Location(destination);
+    const SENSOR *sensor = &Sensors[map];
+    if (!goal->Map || !sensor->Sensor || !SensorInBounds(sensor, start.X, start.Y)) {
+        return false;
+    }
+
+    // Walk from the start to the warps on this map. The goal
+    // may also be on this map already.
+    Flood(sensor, Distance, start);
+    int goalCost = UNREACHABLE;
+    int goalFrom = -1;
+    COORDINATE goalTile = start;
+    if (goal->Map == map) {
+        if (map == MAP_OVERWORLD) {
+            goalCost = RegionDistance(sensor, Distance, goal->Bounds, &goalTile);
+        } else {
+            goalCost = 0;
+        }
+    }
+    for (int i = 0; i < NodeCount; i++) {
+        Best[i] = UNREACHABLE;
+        Previous[i] = -1;
+        Done[i] = false;
+        if (Nodes[i].Arrival >= 0 && Nodes[i].Map == map) {
+            Best[i] = WarpDistance(sensor, Distance, Nodes[i].Tile);
+        }
+    }
+
+    // Dijkstra over the warp graph - it's small enough that
+    // a linear scan for the next node is fine.
+    while (true) {
+        int node = -1;
+        for (int i = 0; i < NodeCount; i++) {
+            if (!Done[i] && Best[i] < goalCost && (node < 0 || Best[i] < Best[node])) {
+                node = i;
+            }
+        }
+        if (node < 0) {
+            break;
+        }
+        Done[node] = true;
+        int cost = Best[node];
+        if (Nodes[node].Arrival >= 0) {
+            Relax(Nodes[node].Arrival, node, cost+WARP_COST);
+            continue;
+        }
+        for (int to = 0; to < NodeCount; to++) {
+            int step = Cost[node*NodeCount+to];
+            if (step != UNREACHABLE) {
+                Relax(to, node, cost+step);
+            }
+        }
+        const ROUTE_GOAL *reach = &Goals[destination*NodeCount+node];
+        if (reach->Cost != UNREACHABLE && cost+reach->Cost < goalCost) {
+            goalCost = cost+reach->Cost;
+            goalFrom = node;
+            goalTile = reach->Tile;
+        }
+    }
+    if (goalCost == UNREACHABLE) {
+        return false;
+    }
+
+    // Count the warps taken, then write out the legs.
+    int legs = 1;
+    for (int node = goalFrom; node >= 0; node = Previous[node]) {
+        legs += (Nodes[node].Arrival >= 0);
+    }
+    if (legs > ROUTE_MAX) {
+        eprintf("Route to %d is too long.\n", destination);
+        return false;
+    }
+    route->Cost = goalCost;
+    route->Length = legs;
+    route->Leg[legs-1] = (ROUTE_LEG){goal->Map, goalTile, false};
+    for (int node = goalFrom, leg = legs-2; node >= 0; node = Previous[node]) {
+        if (Nodes[node].Arrival >= 0) {
+            route->Leg[leg--] = (ROUTE_LEG){Nodes[node].Map, Nodes[node].Tile, true};
+        }
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Gets the next tile to walk to along a route. The
+ * route advances to a later leg when the map changes.
+ * @param route: The ROUTE being walked.
+ * @param map: The current map.
+ * @param tile: The current tile.
+ * @param next: Set to the next tile to walk to. This may be
+ * the warp tile at the end of the leg.
+ * @return False if the route is finished, or if the current
+ * position isn't on the route.
+ **************************************************************/
+bool RouteStep(ROUTE *route, MAP_ID map, COORDINATE tile, COORDINATE *next) {
+    static const int DX[] = {0, -1, 0, 1};
+    static const int DY[] = {1, 0, -1, 0};
+    while (route->Current < route->Length && route->Leg[route->Current].Map != map) {
+        route->Current++;
+    }
+    if (route->Current >= route->Length) {
+        return false;
+    }
+
+    // Distance field toward the end of this leg, reused for
+    // every step on the same leg.
+    const ROUTE_LEG *leg = &route->Leg[route->Current];
+    const SENSOR *sensor = &Sensors[map];
+    if (FieldMap != map || FieldTarget.X != leg->Target.X || FieldTarget.Y != leg->Target.Y) {
+        Flood(sensor, Field, leg->Target);
+        FieldMap = map;
+        FieldTarget = leg->Target;
+    }
+    if (!SensorInBounds(sensor, tile.X, tile.Y)) {
+        return false;
+    }
+
+    // Step downhill
+    int best = Field[tile.Y*sensor->Width+tile.X];
+    if (best == 0 || best == UNREACHABLE) {
+        return false;
+    }
+    bool found = false;
+    for (int i = 0; i < 4; i++) {
+        int x = tile.X+DX[i];
+        int y = tile.Y+DY[i];
+        if (SensorInBounds(sensor, x, y) && Field[y*sensor->Width+x] < best) {
+            best = Field[y*sensor->Width+x];
+            *next = (COORDINATE){x, y};
+            found = true;
+        }
+    }
+    return found;
+}
+
+/**************************************************************/
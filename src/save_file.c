@@ -0,0 +1,656 @@
+/**********************************************************//**
+ * @file save_file.c
+ * @brief Reads and writes save files. A save file is a short
+ * header followed by the payload, which may be compressed:
+ *
+ *     char[4] Magic        SAVE_MAGIC
+ *     u16     Version      SAVE_VERSION
+ *     u16     Flags        SAVE_COMPRESSED
+ *     u32     Size         Size of the payload
+ *     u32     StoredSize   Bytes of payload in the file
+ *     u32     Checksum     CRC-32 of the payload
+ *
+ * From version 2, a summary of SAVE_SUMMARY_SIZE bytes comes
+ * between the header and the payload, ending in a CRC-32 of
+ * its own. It's always the same size, so listing save slots
+ * only reads the start of each file.
+ *
+ * Files are written next to the old save and renamed over it,
+ * so a crash while saving leaves the old save alone.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#include <stdio.h>              // FILE, fopen, rename
+#include <stdlib.h>             // malloc, realloc, free
+#include <string.h>             // memcmp, memcpy
+#include <time.h>               // time
+
+#include <zlib.h>               // compress2, uncompress, crc32
+
+#ifdef _WIN32
+#include <windows.h>            // MoveFileEx
+#endif
+
+#include "save_file.h"          // SAVE_DATA
+#include "debug.h"              // eprintf
+
+/**************************************************************/
+/// @brief Bytes in the header.
+#define SAVE_HEADER_SIZE 20
+
+/// @brief Set in the header if the payload is compressed.
+#define SAVE_COMPRESSED 0x0001
+
+/// @brief Bytes in the summary, including its checksum.
+#define SAVE_SUMMARY_SIZE (17+3*PARTY_SIZE+sizeof(SAVE_THUMBNAIL)+4)
+
+/// @brief Set in the summary if it has a picture.
+#define SUMMARY_THUMBNAIL 0x01
+
+/// @brief Most stored spectra a save file can claim to have.
+/// This only guards against damaged files.
+#define SAVE_STORAGE_MAX (1<<20)
+
+/// @brief Most bytes a save file's payload can claim to have,
+/// which is more than the player and the most stored spectra
+/// take up packed.
+#define SAVE_PAYLOAD_MAX (sizeof(PLAYER)+SAVE_STORAGE_MAX*sizeof(SPECTRA))
+
+/**********************************************************//**
+ * @struct SAVE_BUFFER
+ * @brief Bytes being written or read. Writing past the end
+ * grows the buffer; reading past the end sets Failed.
+ **************************************************************/
+typedef struct {
+    unsigned char *Data;        ///< The bytes.
+    int Size;                   ///< Bytes written, or bytes to read.
+    int Capacity;               ///< Bytes there's room for.
+    int Offset;                 ///< Next byte to read.
+    bool Failed;                ///< Set if a read or write failed.
+} SAVE_BUFFER;
+
+/**********************************************************//**
+ * @brief Adds bytes to a buffer.
+ * @param buffer: The buffer.
+ * @param data: Bytes to add.
+ * @param size: Number of bytes.
+ **************************************************************/
+static void PutBytes(SAVE_BUFFER *buffer, const void *data, int size) {
+    if (buffer->Failed) {
+        return;
+    }
+    if (buffer->Size+size > buffer->Capacity) {
+        int capacity = buffer->Capacity? buffer->Capacity: 1024;
+        while (capacity < buffer->Size+size) {
+            capacity *= 2;
+        }
+        unsigned char *bytes = (unsigned char *)realloc(buffer->Data, capacity);
+        if (!bytes) {
+            buffer->Failed = true;
+            return;
+        }
+        buffer->Data = bytes;
+        buffer->Capacity = capacity;
+    }
+    memcpy(&buffer->Data[buffer->Size], data, size);
+    buffer->Size += size;
+}
+
+/**********************************************************//**
+ * @brief Adds an unsigned integer to a buffer, least
+ * significant byte first.
+ * @param buffer: The buffer.
+ * @param value: The integer.
+ * @param size: Number of bytes to use.
+ **************************************************************/
+static void PutUnsigned(SAVE_BUFFER *buffer, unsigned long value, int size) {
+    unsigned char bytes[4];
+    for (int i = 0; i < size; i++) {
+        bytes[i] = (value >> (8*i)) & 0xFF;
+    }
+    PutBytes(buffer, bytes, size);
+}
+
+/**********************************************************//**
+ * @brief Takes bytes out of a buffer.
+ * @param buffer: The buffer.
+ * @param size: Number of bytes.
+ * @return The bytes, or NULL if there aren't enough.
+ **************************************************************/
+static const unsigned char *GetBytes(SAVE_BUFFER *buffer, int size) {
+    if (buffer->Failed || buffer->Offset+size > buffer->Size) {
+        buffer->Failed = true;
+        return NULL;
+    }
+    const unsigned char *bytes = &buffer->Data[buffer->Offset];
+    buffer->Offset += size;
+    return bytes;
+}
+
+/**********************************************************//**
+ * @brief Takes an unsigned integer out of a buffer.
+ * @param buffer: The buffer.
+ * @param size: Number of bytes it uses.
+ * @return The integer, or 0 if there aren't enough bytes.
+ **************************************************************/
+static unsigned long GetUnsigned(SAVE_BUFFER *buffer, int size) {
+    const unsigned char *bytes = GetBytes(buffer, size);
+    unsigned long value = 0;
+    for (int i = 0; bytes && i < size; i++) {
+        value |= (unsigned long)bytes[i] << (8*i);
+    }
+    return value;
+}
+
+/**********************************************************//**
+ * @brief Takes a signed 32-bit integer out of a buffer.
+ * @param buffer: The buffer.
+ * @return The integer.
+ **************************************************************/
+static int GetInteger(SAVE_BUFFER *buffer) {
+    unsigned long value = GetUnsigned(buffer, 4);
+    return (value & 0x80000000ul)? -(int)(0xFFFFFFFFul-value)-1: (int)value;
+}
+
+/**********************************************************//**
+ * @brief Adds a spectra to a buffer. Empty slots are just
+ * their species.
+ * @param buffer: The buffer.
+ * @param spectra: The spectra.
+ **************************************************************/
+static void PackSpectra(SAVE_BUFFER *buffer, const SPECTRA *spectra) {
+    PutUnsigned(buffer, spectra->Species, 2);
+    if (!spectra->Species) {
+        return;
+    }
+    PutUnsigned(buffer, spectra->MaxHealth, 4);
+    PutUnsigned(buffer, spectra->MaxPower, 4);
+    PutUnsigned(buffer, spectra->Attack, 4);
+    PutUnsigned(buffer, spectra->Defend, 4);
+    PutUnsigned(buffer, spectra->Evade, 4);
+    PutUnsigned(buffer, spectra->Luck, 4);
+    PutUnsigned(buffer, spectra->MovesetSize, 1);
+    for (int i = 0; i < MOVESET_SIZE; i++) {
+        PutUnsigned(buffer, spectra->Moveset[i], 2);
+    }
+    PutUnsigned(buffer, spectra->Health, 4);
+    PutUnsigned(buffer, spectra->Power, 4);
+    PutUnsigned(buffer, spectra->Ailment, 1);
+    PutUnsigned(buffer, spectra->Level, 1);
+    PutUnsigned(buffer, spectra->Experience, 4);
+}
+
+/**********************************************************//**
+ * @brief Takes a spectra out of a buffer.
+ * @param buffer: The buffer.
+ * @param spectra: Where to put the spectra.
+ **************************************************************/
+static void UnpackSpectra(SAVE_BUFFER *buffer, SPECTRA *spectra) {
+    memset(spectra, 0, sizeof(SPECTRA));
+    spectra->Species = GetUnsigned(buffer, 2);
+    if (!spectra->Species) {
+        return;
+    }
+    spectra->MaxHealth = GetInteger(buffer);
+    spectra->MaxPower = GetInteger(buffer);
+    spectra->Attack = GetInteger(buffer);
+    spectra->Defend = GetInteger(buffer);
+    spectra->Evade = GetInteger(buffer);
+    spectra->Luck = GetInteger(buffer);
+    spectra->MovesetSize = GetUnsigned(buffer, 1);
+    for (int i = 0; i < MOVESET_SIZE; i++) {
+        spectra->Moveset[i] = GetUnsigned(buffer, 2);
+    }
+    spectra->Health = GetInteger(buffer);
+    spectra->Power = GetInteger(buffer);
+    spectra->Ailment = GetUnsigned(buffer, 1);
+    spectra->Level = GetUnsigned(buffer, 1);
+    spectra->Experience = GetInteger(buffer);
+    if (spectra->Species >= N_SPECIES || spectra->MovesetSize > MOVESET_SIZE
+    || spectra->Level < 1 || spectra->Level > LEVEL_MAX) {
+        buffer->Failed = true;
+    }
+}
+
+/**********************************************************//**
+ * @brief Writes the payload of a save file.
+ * @param buffer: Buffer to write to.
+ * @param data: What to save.
+ **************************************************************/
+static void PackSaveData(SAVE_BUFFER *buffer, const SAVE_DATA *data) {
+    const PLAYER *player = &data->Player;
+    PutUnsigned(buffer, player->Costume, 4);
+    PutUnsigned(buffer, player->Money, 4);
+    PutUnsigned(buffer, player->PlayTime, 4);
+    for (int i = 0; i < INVENTORY_SIZE; i++) {
+        PutUnsigned(buffer, player->Inventory[i], 2);
+    }
+    for (int i = 0; i < PARTY_SIZE; i++) {
+        PackSpectra(buffer, &player->Spectra[i]);
+    }
+    PutUnsigned(buffer, player->Location, 2);
+    PutUnsigned(buffer, player->Position.X, 4);
+    PutUnsigned(buffer, player->Position.Y, 4);
+    PutUnsigned(buffer, player->Direction, 1);
+
+    // Switches are only ever on or off.
+    unsigned char switches[N_SWITCH/8] = {0};
+    for (int i = 0; i < N_SWITCH; i++) {
+        if (player->Switch[i]) {
+            switches[i/8] |= 1 << (i%8);
+        }
+    }
+    PutBytes(buffer, switches, sizeof(switches));
+    PutUnsigned(buffer, player->LastHospital, 2);
+
+    // Storage, oldest first
+    PutUnsigned(buffer, data->nStorage, 4);
+    for (int i = 0; i < data->nStorage; i++) {
+        PackSpectra(buffer, &data->Storage[i]);
+    }
+}
+
+/**********************************************************//**
+ * @brief Reads the payload of a save file.
+ * @param buffer: Buffer to read from.
+ * @param data: Where to put what was saved. The storage is
+ * allocated, and should be freed by the caller.
+ * @return True if the payload made sense.
+ **************************************************************/
+static bool UnpackSaveData(SAVE_BUFFER *buffer, SAVE_DATA *data) {
+    PLAYER *player = &data->Player;
+    memset(player, 0, sizeof(PLAYER));
+    player->Costume = GetInteger(buffer);
+    player->Money = GetInteger(buffer);
+    player->PlayTime = GetInteger(buffer);
+    for (int i = 0; i < INVENTORY_SIZE; i++) {
+        player->Inventory[i] = GetUnsigned(buffer, 2);
+    }
+    for (int i = 0; i < PARTY_SIZE; i++) {
+        UnpackSpectra(buffer, &player->Spectra[i]);
+    }
+    player->Location = GetUnsigned(buffer, 2);
+    player->Position.X = GetInteger(buffer);
+    player->Position.Y = GetInteger(buffer);
+    player->Direction = GetUnsigned(buffer, 1);
+    const unsigned char *switches = GetBytes(buffer, N_SWITCH/8);
+    for (int i = 0; switches && i < N_SWITCH; i++) {
+        player->Switch[i] = (switches[i/8] >> (i%8)) & 1;
+    }
+    player->LastHospital = GetUnsigned(buffer, 2);
+
+    // Storage
+    data->Storage = NULL;
+    data->nStorage = 0;
+    unsigned long nStorage = GetUnsigned(buffer, 4);
+    if (buffer->Failed || nStorage > SAVE_STORAGE_MAX) {
+        return false;
+    }
+    if (nStorage) {
+        data->Storage = (SPECTRA *)malloc(nStorage*sizeof(SPECTRA));
+        if (!data->Storage) {
+            eprintf("Failed to allocate %lu stored spectra.\n", nStorage);
+            return false;
+        }
+    }
+    data->nStorage = nStorage;
+    for (unsigned long i = 0; i < nStorage; i++) {
+        UnpackSpectra(buffer, &data->Storage[i]);
+        if (!data->Storage[i].Species) {
+            buffer->Failed = true;
+        }
+    }
+    if (buffer->Failed || buffer->Offset != buffer->Size) {
+        free(data->Storage);
+        data->Storage = NULL;
+        data->nStorage = 0;
+        return false;
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Fills in the parts of a summary that come from the
+ * player's data.
+ * @param summary: The summary.
+ * @param player: The player's data.
+ **************************************************************/
+static void Summarize(SAVE_SUMMARY *summary, const PLAYER *player) {
+    summary->Costume = player->Costume;
+    summary->Location = player->Location;
+    summary->PlayTime = player->PlayTime;
+    summary->Money = player->Money;
+    summary->nItems = 0;
+    for (int i = 0; i < INVENTORY_SIZE; i++) {
+        if (player->Inventory[i]) {
+            summary->nItems++;
+        }
+    }
+    for (int i = 0; i < PARTY_SIZE; i++) {
+        summary->Party[i] = player->Spectra[i].Species;
+        summary->Level[i] = player->Spectra[i].Species? player->Spectra[i].Level: 0;
+    }
+}
+
+/**********************************************************//**
+ * @brief Writes the summary of a save file.
+ * @param buffer: Buffer to write to.
+ * @param summary: The summary.
+ **************************************************************/
+static void PackSummary(SAVE_BUFFER *buffer, const SAVE_SUMMARY *summary) {
+    int start = buffer->Size;
+    PutUnsigned(buffer, summary->Costume, 1);
+    PutUnsigned(buffer, summary->Location, 2);
+    PutUnsigned(buffer, summary->PlayTime, 4);
+    PutUnsigned(buffer, summary->Money, 4);
+    PutUnsigned(buffer, summary->SavedAt, 4);
+    PutUnsigned(buffer, summary->nItems, 1);
+    for (int i = 0; i < PARTY_SIZE; i++) {
+        PutUnsigned(buffer, summary->Party[i], 2);
+        PutUnsigned(buffer, summary->Level[i], 1);
+    }
+    PutUnsigned(buffer, summary->HasThumbnail? SUMMARY_THUMBNAIL: 0, 1);
+    PutBytes(buffer, &summary->Thumbnail, sizeof(SAVE_THUMBNAIL));
+    if (!buffer->Failed) {
+        PutUnsigned(buffer, crc32(0L, &buffer->Data[start], buffer->Size-start), 4);
+    }
+}
+
+/**********************************************************//**
+ * @brief Reads the summary of a save file.
+ * @param buffer: Buffer to read from.
+ * @param summary: Where to put the summary.
+ * @return True if the summary made sense.
+ **************************************************************/
+static bool UnpackSummary(SAVE_BUFFER *buffer, SAVE_SUMMARY *summary) {
+    const unsigned char *start = &buffer->Data[buffer->Offset];
+    summary->Costume = GetUnsigned(buffer, 1);
+    summary->Location = GetUnsigned(buffer, 2);
+    summary->PlayTime = GetInteger(buffer);
+    summary->Money = GetInteger(buffer);
+    summary->SavedAt = GetUnsigned(buffer, 4);
+    summary->nItems = GetUnsigned(buffer, 1);
+    for (int i = 0; i < PARTY_SIZE; i++) {
+        summary->Party[i] = GetUnsigned(buffer, 2);
+        summary->Level[i] = GetUnsigned(buffer, 1);
+    }
+    summary->HasThumbnail = GetUnsigned(buffer, 1) & SUMMARY_THUMBNAIL;
+    const unsigned char *pixels = GetBytes(buffer, sizeof(SAVE_THUMBNAIL));
+    if (pixels) {
+        memcpy(&summary->Thumbnail, pixels, sizeof(SAVE_THUMBNAIL));
+    }
+    unsigned long size = buffer->Failed? 0: &buffer->Data[buffer->Offset]-start;
+    unsigned long checksum = GetUnsigned(buffer, 4);
+    if (buffer->Failed || crc32(0L, start, size) != checksum) {
+        return false;
+    }
+    for (int i = 0; i < PARTY_SIZE; i++) {
+        if (summary->Party[i] >= N_SPECIES) {
+            return false;
+        }
+    }
+    return summary->Costume < N_COSTUME && summary->Location < N_LOCATION
+        && summary->nItems <= INVENTORY_SIZE;
+}
+
+/**********************************************************//**
+ * @brief Puts a new file in place of an old one, in one step
+ * where the system allows it.
+ * @param from: Path of the new file.
+ * @param to: Path of the old file.
+ * @return True on success.
+ **************************************************************/
+bool MoveOverFile(const char *from, const char *to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING|MOVEFILE_WRITE_THROUGH);
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+/**********************************************************//**
+ * @brief Works out the checksum a save file of the data would
+ * have. Equal data always have the same checksum.
+ * @param data: The data.
+ * @return The checksum.
+ **************************************************************/
+unsigned long SaveDataChecksum(const SAVE_DATA *data) {
+    SAVE_BUFFER payload = {0};
+    PackSaveData(&payload, data);
+    unsigned long checksum = payload.Failed? 0: crc32(0L, payload.Data, payload.Size);
+    free(payload.Data);
+    return checksum;
+}
+
+/**********************************************************//**
+ * @brief Checks if a file is in the save file format, rather
+ * than the raw PLAYER data that older versions saved.
+ * @param path: Path of the file.
+ * @return True if the file starts with SAVE_MAGIC.
+ **************************************************************/
+bool IsSaveFile(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    char magic[4];
+    bool match = fread(magic, sizeof(magic), 1, file) == 1 && !memcmp(magic, SAVE_MAGIC, 4);
+    fclose(file);
+    return match;
+}
+
+/**********************************************************//**
+ * @brief Writes a save file. The file is written under a
+ * temporary name first, then renamed over the old file. This
+ * doesn't touch any game state, so it's safe to call from
+ * another thread.
+ * @param path: Path of the save file.
+ * @param data: What to save.
+ * @param thumbnail: Picture for the summary, or NULL.
+ * @param compress: Whether to compress the payload. It's
+ * still stored plainly if compressing doesn't help.
+ * @return True on success.
+ **************************************************************/
+bool WriteSaveFile(const char *path, const SAVE_DATA *data, const SAVE_THUMBNAIL *thumbnail, bool compress) {
+    SAVE_BUFFER payload = {0};
+    PackSaveData(&payload, data);
+    if (payload.Failed) {
+        eprintf("Failed to lay out the save file.\n");
+        free(payload.Data);
+        return false;
+    }
+    unsigned long checksum = crc32(0L, payload.Data, payload.Size);
+
+    // Compress if it helps
+    unsigned char *stored = payload.Data;
+    unsigned long storedSize = payload.Size;
+    unsigned char *packed = NULL;
+    unsigned flags = 0;
+    if (compress) {
+        uLongf packedSize = compressBound(payload.Size);
+        packed = (unsigned char *)malloc(packedSize);
+        if (packed && compress2(packed, &packedSize, payload.Data, payload.Size, Z_DEFAULT_COMPRESSION) == Z_OK
+        && packedSize < (uLongf)payload.Size) {
+            stored = packed;
+            storedSize = packedSize;
+            flags |= SAVE_COMPRESSED;
+        }
+    }
+
+    // Header
+    SAVE_BUFFER header = {0};
+    PutBytes(&header, SAVE_MAGIC, 4);
+    PutUnsigned(&header, SAVE_VERSION, 2);
+    PutUnsigned(&header, flags, 2);
+    PutUnsigned(&header, payload.Size, 4);
+    PutUnsigned(&header, storedSize, 4);
+    PutUnsigned(&header, checksum, 4);
+
+    // Summary, which is never compressed so it can be read
+    // on its own.
+    SAVE_SUMMARY *summary = (SAVE_SUMMARY *)calloc(1, sizeof(SAVE_SUMMARY));
+    if (summary) {
+        Summarize(summary, &data->Player);
+        summary->SavedAt = time(NULL);
+        if (thumbnail) {
+            summary->HasThumbnail = true;
+            summary->Thumbnail = *thumbnail;
+        }
+        PackSummary(&header, summary);
+        free(summary);
+    } else {
+        header.Failed = true;
+    }
+
+    // Write everything next to the old save, then swap it in.
+    char temporary[FILENAME_MAX];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    bool success = false;
+    FILE *file = fopen(temporary, "wb");
+    if (file) {
+        success = !header.Failed
+            && fwrite(header.Data, header.Size, 1, file) == 1
+            && fwrite(stored, storedSize, 1, file) == 1;
+        success = (fflush(file) == 0) && success;
+        success = (fclose(file) == 0) && success;
+        if (success) {
+            success = MoveOverFile(temporary, path);
+        }
+        if (!success) {
+            remove(temporary);
+        }
+    }
+    if (!success) {
+        eprintf("Failed to write the save file %s.\n", path);
+    }
+    free(header.Data);
+    free(packed);
+    free(payload.Data);
+    return success;
+}
+
+/**********************************************************//**
+ * @brief Reads a save file, checking its version and
+ * checksum. Nothing is changed in data unless this succeeds.
+ * @param path: Path of the save file.
+ * @param data: Where to put what was saved. The storage is
+ * allocated, and should be freed by the caller.
+ * @return True on success.
+ **************************************************************/
+bool ReadSaveFile(const char *path, SAVE_DATA *data) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+
+    // Header
+    unsigned char bytes[SAVE_HEADER_SIZE];
+    SAVE_BUFFER header = {bytes, SAVE_HEADER_SIZE, SAVE_HEADER_SIZE, 0, false};
+    if (fread(bytes, sizeof(bytes), 1, file) != 1 || memcmp(bytes, SAVE_MAGIC, 4)) {
+        fclose(file);
+        return false;
+    }
+    GetBytes(&header, 4);
+    unsigned version = GetUnsigned(&header, 2);
+    unsigned flags = GetUnsigned(&header, 2);
+    unsigned long size = GetUnsigned(&header, 4);
+    unsigned long storedSize = GetUnsigned(&header, 4);
+    unsigned long checksum = GetUnsigned(&header, 4);
+    if (version > SAVE_VERSION) {
+        eprintf("The save file is from a newer version (%u).\n", version);
+        fclose(file);
+        return false;
+    }
+    if (version >= 2 && fseek(file, SAVE_SUMMARY_SIZE, SEEK_CUR)) {
+        fclose(file);
+        return false;
+    }
+
+    // Don't trust the sizes until they fit the file.
+    long start = ftell(file);
+    long end = (start >= 0 && !fseek(file, 0, SEEK_END))? ftell(file): -1;
+    if (start < 0 || end < start || fseek(file, start, SEEK_SET)
+    || storedSize > (unsigned long)(end-start) || size > SAVE_PAYLOAD_MAX) {
+        eprintf("The save file's sizes are damaged.\n");
+        fclose(file);
+        return false;
+    }
+
+    // Payload
+    unsigned char *stored = (unsigned char *)malloc(storedSize? storedSize: 1);
+    unsigned char *raw = (flags & SAVE_COMPRESSED)? (unsigned char *)malloc(size? size: 1): stored;
+    bool success = stored && raw && fread(stored, storedSize, 1, file) == 1;
+    fclose(file);
+    if (success && (flags & SAVE_COMPRESSED)) {
+        uLongf rawSize = size;
+        success = uncompress(raw, &rawSize, stored, storedSize) == Z_OK && rawSize == size;
+    } else if (success) {
+        success = storedSize == size;
+    }
+    if (success && crc32(0L, raw, size) != checksum) {
+        eprintf("The save file's checksum doesn't match.\n");
+        success = false;
+    }
+
+    // Only touch the caller's data once everything checks out.
+    if (success) {
+        SAVE_BUFFER payload = {raw, size, size, 0, false};
+        SAVE_DATA loaded;
+        success = UnpackSaveData(&payload, &loaded);
+        if (success) {
+            *data = loaded;
+        } else {
+            eprintf("The save file is damaged.\n");
+        }
+    }
+    if (raw != stored) {
+        free(raw);
+    }
+    free(stored);
+    return success;
+}
+
+/**********************************************************//**
+ * @brief Reads the summary of a save file, without reading
+ * the rest of it. Files from version 1 have no summary, so
+ * they're read whole to make one, without a picture.
+ * @param path: Path of the save file.
+ * @param summary: Where to put the summary.
+ * @return True on success.
+ **************************************************************/
+bool ReadSaveSummary(const char *path, SAVE_SUMMARY *summary) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    unsigned char *bytes = (unsigned char *)malloc(SAVE_HEADER_SIZE+SAVE_SUMMARY_SIZE);
+    if (!bytes) {
+        fclose(file);
+        return false;
+    }
+    int size = fread(bytes, 1, SAVE_HEADER_SIZE+SAVE_SUMMARY_SIZE, file);
+    fclose(file);
+    SAVE_BUFFER buffer = {bytes, size, size, 0, false};
+    const unsigned char *magic = GetBytes(&buffer, 4);
+    unsigned version = GetUnsigned(&buffer, 2);
+    bool success = false;
+    if (!magic || memcmp(magic, SAVE_MAGIC, 4) || version > SAVE_VERSION) {
+        success = false;
+    } else if (version >= 2) {
+        GetBytes(&buffer, SAVE_HEADER_SIZE-6);
+        success = UnpackSummary(&buffer, summary);
+    } else {
+        SAVE_DATA data;
+        success = ReadSaveFile(path, &data);
+        if (success) {
+            memset(summary, 0, sizeof(SAVE_SUMMARY));
+            Summarize(summary, &data.Player);
+            free(data.Storage);
+        }
+    }
+    free(bytes);
+    return success;
+}
+
+/**************************************************************/
@@ -0,0 +1,318 @@
+/**********************************************************//**
+ * @file save_slot.c
+ * @brief Lists the save slots. Each slot's summary is read on
+ * a thread of its own the first time the slot is asked about,
+ * so slots on screen are read side by side while the game
+ * goes on drawing. The pictures are only turned into bitmaps
+ * once they're drawn.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#include <stdio.h>              // FILE, fopen
+
+#include <allegro5/allegro.h>   // ALLEGRO_THREAD, ALLEGRO_MUTEX
+
+#include "save_slot.h"          // SLOT_STATE
+#include "game.h"               // Screenshot
+#include "debug.h"              // eprintf
+
+/**********************************************************//**
+ * @struct SAVE_SLOT
+ * @brief What's known about one save slot.
+ **************************************************************/
+typedef struct {
+    SLOT_STATE State;           ///< Guarded by Lock while Thread runs.
+    SAVE_SUMMARY Summary;       ///< The summary, once it's read.
+    ALLEGRO_BITMAP *Image;      ///< The summary's picture, or NULL.
+    ALLEGRO_THREAD *Thread;     ///< Thread reading the summary, or NULL.
+} SAVE_SLOT;
+
+/**************************************************************/
+/// @brief Path of the save file in each slot. The first slot
+/// keeps the name saves had before there were slots.
+static const char *const SlotPath[SAVE_SLOTS] = {
+    "spectrum.save",
+    "spectrum2.save",
+    "spectrum3.save",
+    "spectrum4.save",
+    "spectrum5.save",
+    "spectrum6.save",
+    "spectrum7.save",
+    "spectrum8.save",
+};
+
+/// @brief Every save slot.
+static SAVE_SLOT Slots[SAVE_SLOTS];
+
+/// @brief Guards the state of slots being read.
+static ALLEGRO_MUTEX *Lock = NULL;
+
+/// @brief Picture of the game for the next save.
+static SAVE_THUMBNAIL Captured;
+
+/// @brief Set if Captured has a picture in it.
+static bool HasCapture = false;
+
+/**********************************************************//**
+ * @brief Gets the path of the save file in a slot.
+ * @param slot: The slot.
+ * @return The path.
+ **************************************************************/
+const char *SaveSlotPath(int slot) {
+    return SlotPath[(slot >= 0 && slot < SAVE_SLOTS)? slot: 0];
+}
+
+/**********************************************************//**
+ * @brief Reads what's in a slot. This doesn't touch any other
+ * slot, so it's safe to call from another thread.
+ * @param slot: The slot.
+ * @param summary: Where to put the summary.
+ * @return The slot's state.
+ **************************************************************/
+static SLOT_STATE ReadSlot(int slot, SAVE_SUMMARY *summary) {
+    const char *path = SlotPath[slot];
+    if (ReadSaveSummary(path, summary)) {
+        return SLOT_READY;
+    }
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return SLOT_EMPTY;
+    }
+    fclose(file);
+    return IsSaveFile(path)? SLOT_DAMAGED: SLOT_OLD;
+}
+
+/**********************************************************//**
+ * @brief Reads the summary of a slot on its own thread.
+ * @param thread: The thread.
+ * @param argument: The SAVE_SLOT.
+ * @return NULL.
+ **************************************************************/
+static void *ReadSlotThread(ALLEGRO_THREAD *thread, void *argument) {
+    (void)thread;
+    SAVE_SLOT *slot = (SAVE_SLOT *)argument;
+    SLOT_STATE state = ReadSlot(slot-Slots, &slot->Summary);
+    al_lock_mutex(Lock);
+    slot->State = state;
+    al_unlock_mutex(Lock);
+    return NULL;
+}
+
+/**********************************************************//**
+ * @brief Starts reading the summary of a slot.
+ * @param slot: The slot.
+ **************************************************************/
+static void StartReading(int slot) {
+    SAVE_SLOT *saveSlot = &Slots[slot];
+    if (!Lock) {
+        Lock = al_create_mutex();
+    }
+    saveSlot->State = SLOT_READING;
+    if (Lock) {
+        saveSlot->Thread = al_create_thread(ReadSlotThread, saveSlot);
+    }
+    if (saveSlot->Thread) {
+        al_start_thread(saveSlot->Thread);
+    } else {
+        // Without a thread, just read it now.
+        saveSlot->State = ReadSlot(slot, &saveSlot->Summary);
+    }
+}
+
+/**********************************************************//**
+ * @brief Waits for the summary of a slot to be read, if it's
+ * being read.
+ * @param saveSlot: The slot.
+ **************************************************************/
+static void FinishReading(SAVE_SLOT *saveSlot) {
+    if (saveSlot->Thread) {
+        al_join_thread(saveSlot->Thread, NULL);
+        al_destroy_thread(saveSlot->Thread);
+        saveSlot->Thread = NULL;
+    }
+}
+
+/**********************************************************//**
+ * @brief Finds out what's in a save slot. The first time a
+ * slot is asked about, its summary starts being read, and
+ * the slot is SLOT_READING until it's done. This never waits
+ * for the disk.
+ * @param slot: The slot.
+ * @return The slot's state.
+ **************************************************************/
+SLOT_STATE SaveSlotState(int slot) {
+    if (slot < 0 || slot >= SAVE_SLOTS) {
+        return SLOT_EMPTY;
+    }
+    SAVE_SLOT *saveSlot = &Slots[slot];
+    if (!saveSlot->Thread && saveSlot->State == SLOT_UNREAD) {
+        StartReading(slot);
+    }
+    if (saveSlot->Thread) {
+        al_lock_mutex(Lock);
+        SLOT_STATE state = saveSlot->State;
+        al_unlock_mutex(Lock);
+        if (state != SLOT_READING) {
+            FinishReading(saveSlot);
+        }
+        return state;
+    }
+    return saveSlot->State;
+}
+
+/**********************************************************//**
+ * @brief Gets the summary of a save slot.
+ * @param slot: The slot.
+ * @return The summary, or NULL if it hasn't been read or
+ * there isn't one.
+ **************************************************************/
+const SAVE_SUMMARY *SaveSlotSummary(int slot) {
+    if (SaveSlotState(slot) != SLOT_READY) {
+        return NULL;
+    }
+    return &Slots[slot].Summary;
+}
+
+/**********************************************************//**
+ * @brief Gets the picture in the summary of a save slot. The
+ * bitmap is made the first time it's asked for.
+ * @param slot: The slot.
+ * @return The picture, or NULL if there isn't one.
+ **************************************************************/
+ALLEGRO_BITMAP *SaveSlotThumbnail(int slot) {
+    const SAVE_SUMMARY *summary = SaveSlotSummary(slot);
+    if (!summary || !summary->HasThumbnail) {
+        return NULL;
+    }
+    SAVE_SLOT *saveSlot = &Slots[slot];
+    if (saveSlot->Image) {
+        return saveSlot->Image;
+    }
+    ALLEGRO_BITMAP *image = al_create_bitmap(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT);
+    if (!image) {
+        return NULL;
+    }
+    if (al_lock_bitmap(image, ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_WRITEONLY)) {
+        ALLEGRO_STATE state;
+        al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP);
+        al_set_target_bitmap(image);
+        for (int y = 0; y < THUMBNAIL_HEIGHT; y++) {
+            for (int x = 0; x < THUMBNAIL_WIDTH; x++) {
+                const unsigned char *pixel = summary->Thumbnail.Pixels[y][x];
+                al_put_pixel(x, y, al_map_rgb(pixel[0], pixel[1], pixel[2]));
+            }
+        }
+        al_restore_state(&state);
+        al_unlock_bitmap(image);
+    }
+    saveSlot->Image = image;
+    return image;
+}
+
+/**********************************************************//**
+ * @brief Forgets what's in a save slot, so it's read again.
+ * Call this once the slot is saved to.
+ * @param slot: The slot.
+ **************************************************************/
+void ForgetSaveSlot(int slot) {
+    if (slot < 0 || slot >= SAVE_SLOTS) {
+        return;
+    }
+    SAVE_SLOT *saveSlot = &Slots[slot];
+    FinishReading(saveSlot);
+    if (saveSlot->Image) {
+        al_destroy_bitmap(saveSlot->Image);
+        saveSlot->Image = NULL;
+    }
+    saveSlot->State = SLOT_UNREAD;
+}
+
+/**********************************************************//**
+ * @brief Finds the slot saved to most recently. Every slot is
+ * read at once, and this waits until they're done.
+ * @return The slot, or 0 if nothing has been saved.
+ **************************************************************/
+int LatestSaveSlot(void) {
+    for (int i = 0; i < SAVE_SLOTS; i++) {
+        SaveSlotState(i);
+    }
+    int latest = -1;
+    int old = -1;
+    for (int i = 0; i < SAVE_SLOTS; i++) {
+        FinishReading(&Slots[i]);
+        if (Slots[i].State == SLOT_READY) {
+            if (latest < 0 || Slots[i].Summary.SavedAt > Slots[latest].Summary.SavedAt) {
+                latest = i;
+            }
+        } else if (Slots[i].State == SLOT_OLD && old < 0) {
+            old = i;
+        }
+    }
+    if (latest >= 0) {
+        return latest;
+    }
+    return (old >= 0)? old: 0;
+}
+
+/**********************************************************//**
+ * @brief Waits for any slots being read and frees their
+ * pictures.
+ **************************************************************/
+void DestroySaveSlots(void) {
+    for (int i = 0; i < SAVE_SLOTS; i++) {
+        ForgetSaveSlot(i);
+    }
+    if (Lock) {
+        al_destroy_mutex(Lock);
+        Lock = NULL;
+    }
+}
+
+/**********************************************************//**
+ * @brief Takes a picture of the last frame for the next save.
+ * Call this while the frame is just the game, before anything
+ * like a menu is drawn over it.
+ **************************************************************/
+void CaptureThumbnail(void) {
+    HasCapture = false;
+    ALLEGRO_BITMAP *screen = Screenshot();
+    if (!screen) {
+        return;
+    }
+    ALLEGRO_BITMAP *image = al_create_bitmap(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT);
+    if (image) {
+        ALLEGRO_STATE state;
+        al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP|ALLEGRO_STATE_BLENDER);
+        al_set_target_bitmap(image);
+        al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
+        al_draw_scaled_bitmap(screen, 0, 0, al_get_bitmap_width(screen), al_get_bitmap_height(screen),
+            0, 0, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, 0);
+        al_restore_state(&state);
+        if (al_lock_bitmap(image, ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READONLY)) {
+            for (int y = 0; y < THUMBNAIL_HEIGHT; y++) {
+                for (int x = 0; x < THUMBNAIL_WIDTH; x++) {
+                    unsigned char *pixel = Captured.Pixels[y][x];
+                    al_unmap_rgb(al_get_pixel(image, x, y), &pixel[0], &pixel[1], &pixel[2]);
+                }
+            }
+            al_unlock_bitmap(image);
+            HasCapture = true;
+        }
+        al_destroy_bitmap(image);
+    }
+    al_destroy_bitmap(screen);
+    if (!HasCapture) {
+        eprintf("Failed to take a picture for the save.\n");
+    }
+}
+
+/**********************************************************//**
+ * @brief Gets the picture taken for the next save.
+ * @return The picture, or NULL if there isn't one.
+ **************************************************************/
+const SAVE_THUMBNAIL *Thumbnail(void) {
+    return HasCapture? &Captured: NULL;
+}
+
+/**************************************************************/
@@ -0,0 +1,118 @@
+/**********************************************************//**
+ * @file sensor.c
+ * @brief Decodes map sensor images into tile information.
+ * @author Rena Shinomiya
+ * @date April 15, 2018
+ **************************************************************/
+
+#include <allegro5/allegro.h>
+
+#include <stdlib.h>             // malloc, free
+#include <stdbool.h>            // bool
+
+#include "sensor.h"             // SENSOR, TILE
+#include "assets.h"             // SensorImage
+#include "debug.h"              // eprintf
+
+/**********************************************************//**
+ * @brief Decodes one sensor pixel into tile flags.
+ * @param color: The pixel color.
+ * @param valid: Set to false if the color is unrecognized.
+ * @return The TILE_FLAGS for the pixel.
+ **************************************************************/
+static TILE_FLAGS SensorFlags(ALLEGRO_COLOR color, bool *valid) {
+    unsigned char r, g, b;
+    al_unmap_rgb(color, &r, &g, &b);
+    *valid = true;
+    if (r==239 && g==239 && b==239) {
+        return 0;
+    } else if (r==132 && g==183 && b==244) {
+        return TILE_SOLID;
+    } else if (r==24 && g==119 && b==235) {
+        return TILE_WATER;
+    } else if (r==0 && g==0 && b==0) {
+        // Warp
+        return TILE_EVENT;
+    } else if (r==128 && g==128 && b==128) {
+        // Sign
+        return TILE_EVENT;
+    } else if (r==255 && g==135 && b==139) {
+        // Gift
+        return TILE_EVENT;
+    } else if (r==0 && g==255 && b==0) {
+        // Person
+        return TILE_EVENT;
+    }
+    *valid = false;
+    return 0;
+}
+
+/**********************************************************//**
+ * @brief Decodes the sensor image for a map. Event tiles are
+ * numbered from 1 in row-major order, matching the indices
+ * of the map's EVENT array. The alpha channel holds the
+ * encounter zone: fully opaque pixels are zone 0, and each
+ * step of transparency is the next zone.
+ * @param sensor: The SENSOR to fill in. Any tiles it already
+ * holds are released.
+ * @param id: The map identity.
+ * @return True on success.
+ **************************************************************/
+bool LoadSensor(SENSOR *sensor, MAP_ID id) {
+    DestroySensor(sensor);
+
+    // Load the sensor image
+    ALLEGRO_BITMAP *sensorImage = SensorImage(id);
+    if (!sensorImage) {
+        eprintf("No sensor for map %d\n", id);
+        return false;
+    }
+    al_lock_bitmap(sensorImage, al_get_bitmap_format(sensorImage), ALLEGRO_LOCK_READONLY);
+    sensor->Height = al_get_bitmap_height(sensorImage);
+    sensor->Width = al_get_bitmap_width(sensorImage);
+    sensor->Sensor = (TILE *)malloc(sizeof(TILE)*sensor->Height*sensor->Width);
+    if (!sensor->Sensor) {
+        eprintf("Failed to load sensor for map %d\n", id);
+        al_unlock_bitmap(sensorImage);
+        return false;
+    }
+
+    // Load the tile information
+    int eventID = 1;
+    for (int y = 0; y < sensor->Height; y++) {
+        for (int x = 0; x < sensor->Width; x++) {
+            bool valid;
+            unsigned char r, g, b, a;
+            ALLEGRO_COLOR color = al_get_pixel(sensorImage, x, y);
+            al_unmap_rgba(color, &r, &g, &b, &a);
+            TILE *tile = SensorTile(sensor, x, y);
+            tile->Flags = SensorFlags(color, &valid);
+            tile->EventID = 0;
+            tile->RuntimeID = 0;
+            tile->Zone = 255-a;
+            if (!valid) {
+                eprintf("Invalid color in sensor %d at %d,%d\n", id, x, y);
+            }
+            if (tile->Flags == TILE_EVENT) {
+                tile->EventID = eventID++;
+            }
+        }
+    }
+    al_unlock_bitmap(sensorImage);
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Releases the tiles held by a sensor.
+ * @param sensor: The SENSOR to clear.
+ **************************************************************/
+void DestroySensor(SENSOR *sensor) {
+    if (sensor->Sensor) {
+        free(sensor->Sensor);
+    }
+    sensor->Sensor = NULL;
+    sensor->Width = 0;
+    sensor->Height = 0;
+}
+
+/**************************************************************/
@@ -0,0 +1,479 @@
+/**********************************************************//**
+ * @file snapshot.c
+ * @brief Keeps a history of the game in memory. Each record
+ * holds only the runs of bytes in a GAME_SNAPSHOT that differ
+ * from its keyframe, which is the last record stored whole
+ * (that is, compared against zeroes). Records share one ring
+ * of SNAPSHOT_MEMORY bytes, and the oldest keyframe and the
+ * records that depend on it are dropped together to make
+ * room, so the memory used never grows.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#include <stdlib.h>             // malloc, free
+#include <string.h>             // memcpy, memset
+
+#include <allegro5/allegro.h>   // al_get_time
+
+#include "snapshot.h"           // GAME_SNAPSHOT
+#include "storage.h"            // StorageChanges
+#include "journal.h"            // JournalPlayer
+#include "debug.h"              // eprintf
+
+/**************************************************************/
+/// @brief Unchanged bytes that can sit inside a run. Shorter
+/// gaps cost less to copy than to start a new run over.
+#define SNAPSHOT_GAP 8
+
+/// @brief Seconds after taking or restoring a snapshot that
+/// rewinding goes to the one before it.
+#define SNAPSHOT_GRACE 1.0
+
+/**********************************************************//**
+ * @struct SNAPSHOT_RUN
+ * @brief Header of a run of changed bytes in a record. The
+ * bytes follow the header.
+ **************************************************************/
+typedef struct {
+    int Skip;                   ///< Unchanged bytes before the run.
+    int Length;                 ///< Bytes in the run.
+} SNAPSHOT_RUN;
+
+/**********************************************************//**
+ * @struct SNAPSHOT_RECORD
+ * @brief Where a snapshot is kept in the History.
+ **************************************************************/
+typedef struct {
+    int Offset;                 ///< Position of its runs in History.
+    int Size;                   ///< Bytes of runs.
+    int Keyframe;               ///< Number of its keyframe; its own if it is one.
+    double Time;                ///< When it was taken or last restored.
+} SNAPSHOT_RECORD;
+
+/**************************************************************/
+/// @brief Memory the records' runs are kept in.
+static unsigned char *History = NULL;
+
+/// @brief Position in History after the newest record.
+static int HistoryEnd = 0;
+
+/// @brief Every record kept. Records are numbered in the
+/// order they're taken, and record n is kept at n%SNAPSHOT_MAX.
+static SNAPSHOT_RECORD Records[SNAPSHOT_MAX];
+
+/// @brief Number of the oldest record kept.
+static int FirstRecord = 0;
+
+/// @brief Number of the next record taken.
+static int NextRecord = 0;
+
+/// @brief The keyframe most recently worked out.
+static GAME_SNAPSHOT Keyframe;
+
+/// @brief Number of the record in Keyframe, or -1.
+static int KeyframeRecord = -1;
+
+/// @brief What keyframes are compared against.
+static const GAME_SNAPSHOT Blank;
+
+/// @brief The snapshot being taken or restored.
+static GAME_SNAPSHOT Current;
+
+/// @brief Runs being worked out for a new record.
+static unsigned char *Scratch = NULL;
+
+/// @brief The quicksave.
+static GAME_SNAPSHOT QuickSnapshot;
+
+/// @brief Set once there's a quicksave.
+static bool HaveQuickSave = false;
+
+/// @brief Time the last snapshot was taken or restored.
+static double LastSnapshotTime = 0.0;
+
+/**********************************************************//**
+ * @brief Gets a record by its number.
+ * @param n: Number of the record.
+ * @return The record.
+ **************************************************************/
+static inline SNAPSHOT_RECORD *Record(int n) {
+    return &Records[n%SNAPSHOT_MAX];
+}
+
+/**********************************************************//**
+ * @brief Works out the runs of bytes that differ between two
+ * snapshots. Runs can hold short gaps of unchanged bytes.
+ * @param snapshot: The snapshot to record.
+ * @param base: The snapshot it's compared against.
+ * @param runs: Where to put the runs.
+ * @return Number of bytes of runs.
+ **************************************************************/
+static int Compare(const GAME_SNAPSHOT *snapshot, const GAME_SNAPSHOT *base, unsigned char *runs) {
+    const unsigned char *now = (const unsigned char *)snapshot;
+    const unsigned char *then = (const unsigned char *)base;
+    const int n = sizeof(GAME_SNAPSHOT);
+    int size = 0;
+    int last = 0;
+    int i = 0;
+    while (i < n) {
+        if (now[i] == then[i]) {
+            i++;
+            continue;
+        }
+
+        // Run on until SNAPSHOT_GAP bytes in a row are the same.
+        int end = i+1;
+        for (int j = end, same = 0; j < n && same < SNAPSHOT_GAP; j++) {
+            if (now[j] == then[j]) {
+                same++;
+            } else {
+                same = 0;
+                end = j+1;
+            }
+        }
+        SNAPSHOT_RUN run = {i-last, end-i};
+        memcpy(&runs[size], &run, sizeof(run));
+        size += sizeof(run);
+        memcpy(&runs[size], &now[i], run.Length);
+        size += run.Length;
+        last = end;
+        i = end;
+    }
+    return size;
+}
+
+/**********************************************************//**
+ * @brief Writes runs of bytes over a snapshot.
+ * @param runs: The runs.
+ * @param size: Number of bytes of runs.
+ * @param snapshot: The snapshot to change.
+ **************************************************************/
+static void Apply(const unsigned char *runs, int size, GAME_SNAPSHOT *snapshot) {
+    unsigned char *bytes = (unsigned char *)snapshot;
+    int at = 0;
+    int offset = 0;
+    while (offset < size) {
+        SNAPSHOT_RUN run;
+        memcpy(&run, &runs[offset], sizeof(run));
+        offset += sizeof(run);
+        at += run.Skip;
+        memcpy(&bytes[at], &runs[offset], run.Length);
+        offset += run.Length;
+        at += run.Length;
+    }
+}
+
+/**********************************************************//**
+ * @brief Works out a keyframe into Keyframe, unless it's
+ * already there.
+ * @param n: Number of the keyframe's record.
+ * @return The keyframe.
+ **************************************************************/
+static const GAME_SNAPSHOT *LoadKeyframe(int n) {
+    if (KeyframeRecord != n) {
+        const SNAPSHOT_RECORD *record = Record(n);
+        Keyframe = Blank;
+        Apply(&History[record->Offset], record->Size, &Keyframe);
+        KeyframeRecord = n;
+    }
+    return &Keyframe;
+}
+
+/**********************************************************//**
+ * @brief Works out a record into a snapshot.
+ * @param n: Number of the record.
+ * @param snapshot: Where to put the snapshot.
+ **************************************************************/
+static void LoadRecord(int n, GAME_SNAPSHOT *snapshot) {
+    const SNAPSHOT_RECORD *record = Record(n);
+    *snapshot = *LoadKeyframe(record->Keyframe);
+    if (record->Keyframe != n) {
+        Apply(&History[record->Offset], record->Size, snapshot);
+    }
+}
+
+/**********************************************************//**
+ * @brief Drops the oldest keyframe and every record that
+ * depends on it.
+ **************************************************************/
+static void DropOldest(void) {
+    do {
+        if (KeyframeRecord == FirstRecord) {
+            KeyframeRecord = -1;
+        }
+        FirstRecord++;
+    } while (FirstRecord < NextRecord && Record(FirstRecord)->Keyframe != FirstRecord);
+    if (FirstRecord == NextRecord) {
+        HistoryEnd = 0;
+    }
+}
+
+/**********************************************************//**
+ * @brief Drops the newest record.
+ **************************************************************/
+static void DropNewest(void) {
+    NextRecord--;
+    HistoryEnd = Record(NextRecord)->Offset;
+    if (KeyframeRecord == NextRecord) {
+        KeyframeRecord = -1;
+    }
+}
+
+/**********************************************************//**
+ * @brief Makes room for a record in the History, dropping
+ * the oldest records until it fits. Records are kept in one
+ * piece, so when there isn't room before the end of the
+ * History, the record goes at the start.
+ * @param size: Bytes needed.
+ * @return Position of the room in History, or -1.
+ **************************************************************/
+static int Reserve(int size) {
+    if (size > SNAPSHOT_MEMORY) {
+        return -1;
+    }
+    while (FirstRecord < NextRecord) {
+        int oldest = Record(FirstRecord)->Offset;
+        if (HistoryEnd+size <= SNAPSHOT_MEMORY) {
+            // Records ahead of the end are in the way.
+            if (oldest < HistoryEnd || oldest >= HistoryEnd+size) {
+                return HistoryEnd;
+            }
+        } else if (oldest < HistoryEnd && oldest >= size) {
+            // Records past the end will be skipped, and the
+            // ones at the start are out of the way.
+            return 0;
+        }
+        DropOldest();
+    }
+    return (HistoryEnd+size <= SNAPSHOT_MEMORY)? HistoryEnd: 0;
+}
+
+/**********************************************************//**
+ * @brief Adds a snapshot to the history, as changes to the
+ * newest keyframe or as a new keyframe.
+ * @param snapshot: The snapshot.
+ * @return True if it was kept.
+ **************************************************************/
+static bool Keep(const GAME_SNAPSHOT *snapshot) {
+    if (!History) {
+        History = (unsigned char *)malloc(SNAPSHOT_MEMORY);
+        Scratch = (unsigned char *)malloc(2*sizeof(GAME_SNAPSHOT)+sizeof(SNAPSHOT_RUN));
+        if (!History || !Scratch) {
+            eprintf("Failed to allocate snapshot memory.\n");
+            DestroySnapshots();
+            return false;
+        }
+    }
+
+    // Start a new keyframe every so often, or when too much
+    // has changed for the old one to help.
+    int keyframe = -1;
+    if (FirstRecord < NextRecord) {
+        keyframe = Record(NextRecord-1)->Keyframe;
+    }
+    if (keyframe >= 0 && NextRecord-keyframe >= SNAPSHOT_KEYFRAME) {
+        keyframe = -1;
+    }
+    int size = Compare(snapshot, (keyframe >= 0)? LoadKeyframe(keyframe): &Blank, Scratch);
+    if (keyframe >= 0 && size > (int)sizeof(GAME_SNAPSHOT)/2) {
+        keyframe = -1;
+        size = Compare(snapshot, &Blank, Scratch);
+    }
+
+    // Make room, which may drop the keyframe too.
+    if (NextRecord-FirstRecord >= SNAPSHOT_MAX) {
+        DropOldest();
+    }
+    int offset = Reserve(size);
+    if (keyframe >= 0 && keyframe < FirstRecord) {
+        keyframe = -1;
+        size = Compare(snapshot, &Blank, Scratch);
+        offset = Reserve(size);
+    }
+    if (offset < 0) {
+        eprintf("Snapshot of %d bytes doesn't fit.\n", size);
+        return false;
+    }
+    memcpy(&History[offset], Scratch, size);
+    SNAPSHOT_RECORD *record = Record(NextRecord);
+    record->Offset = offset;
+    record->Size = size;
+    record->Keyframe = (keyframe >= 0)? keyframe: NextRecord;
+    record->Time = al_get_time();
+    HistoryEnd = offset+size;
+    NextRecord++;
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Checks if a snapshot can be taken or restored now.
+ * @return True if the game is waiting on the player.
+ **************************************************************/
+bool SnapshotReady(void) {
+    switch (GetMode()) {
+    case MODE_BATTLE:
+        return BattleSnapshotReady();
+    case MODE_MAP:
+        return MapSnapshotReady();
+    default:
+        return false;
+    }
+}
+
+/**********************************************************//**
+ * @brief Takes a snapshot of the game as it is.
+ * @param snapshot: Where to put the snapshot.
+ **************************************************************/
+static void Capture(GAME_SNAPSHOT *snapshot) {
+    // Unused parts stay zero so they never look changed.
+    memset(snapshot, 0, sizeof(GAME_SNAPSHOT));
+    snapshot->Mode = GetMode();
+    snapshot->Player = *Player;
+    snapshot->Storage = StorageChanges();
+    SnapshotMap(&snapshot->Map);
+    if (snapshot->Mode == MODE_BATTLE) {
+        SnapshotBattle(&snapshot->Battle);
+    }
+}
+
+/**********************************************************//**
+ * @brief Checks if a snapshot can still be restored. The
+ * storage box isn't in snapshots, so one taken before the box
+ * changed would bring back spectra that are still stored, or
+ * lose ones stored since.
+ * @param snapshot: The snapshot.
+ * @return True if the storage box hasn't changed since.
+ **************************************************************/
+static bool CanRestore(const GAME_SNAPSHOT *snapshot) {
+    return snapshot->Storage == StorageChanges();
+}
+
+/**********************************************************//**
+ * @brief Puts the game back the way it was in a snapshot.
+ * @param snapshot: The snapshot.
+ **************************************************************/
+static void Restore(const GAME_SNAPSHOT *snapshot) {
+    MODE_ID mode = GetMode();
+    *Player = snapshot->Player;
+    RestoreMapSnapshot(&snapshot->Map);
+    if (snapshot->Mode == MODE_BATTLE) {
+        RestoreBattleSnapshot(&snapshot->Battle);
+    } else if (mode == MODE_BATTLE) {
+        AbandonBattle();
+    }
+    SetMode(snapshot->Mode);
+    LastSnapshotTime = al_get_time();
+    JournalPlayer();
+}
+
+/**********************************************************//**
+ * @brief Adds a snapshot of the game to the history.
+ * @return True if the snapshot was taken.
+ **************************************************************/
+bool TakeSnapshot(void) {
+    if (!SnapshotReady()) {
+        return false;
+    }
+    Capture(&Current);
+    LastSnapshotTime = al_get_time();
+    return Keep(&Current);
+}
+
+/**********************************************************//**
+ * @brief Saves the game in memory, replacing the last
+ * quicksave.
+ * @return True if the game was saved.
+ **************************************************************/
+bool QuickSave(void) {
+    if (!SnapshotReady()) {
+        return false;
+    }
+    Capture(&QuickSnapshot);
+    HaveQuickSave = true;
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Puts the game back to the last quicksave.
+ * @return True if there was a quicksave to load.
+ **************************************************************/
+bool QuickLoad(void) {
+    if (!HaveQuickSave || !SnapshotReady() || !CanRestore(&QuickSnapshot)) {
+        return false;
+    }
+    Restore(&QuickSnapshot);
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Puts the game back to the newest snapshot. If that
+ * was only just taken or restored, the snapshot is dropped
+ * and the game goes back to the one before, so rewinding
+ * again goes further back. Playing on from a rewind replaces
+ * the snapshots after it. Rewinding stops at the last change
+ * to the storage box.
+ * @return True if there was a snapshot to go back to.
+ **************************************************************/
+bool Rewind(void) {
+    if (FirstRecord == NextRecord || !SnapshotReady()) {
+        return false;
+    }
+    int n = NextRecord-1;
+    if (NextRecord-FirstRecord > 1 && al_get_time()-Record(n)->Time < SNAPSHOT_GRACE) {
+        n--;
+    }
+    LoadRecord(n, &Current);
+    if (!CanRestore(&Current)) {
+        return false;
+    }
+    if (n < NextRecord-1) {
+        DropNewest();
+    }
+    Restore(&Current);
+    Record(NextRecord-1)->Time = LastSnapshotTime;
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Takes a snapshot every SNAPSHOT_INTERVAL seconds,
+ * and handles the quicksave and rewind keys in debug builds.
+ **************************************************************/
+void UpdateSnapshots(void) {
+    if (!SnapshotReady()) {
+        return;
+    }
+#ifdef DEBUG
+    if (KeyJustUp(KEY_QUICKSAVE)) {
+        QuickSave();
+        return;
+    } else if (KeyJustUp(KEY_QUICKLOAD)) {
+        QuickLoad();
+        return;
+    } else if (KeyJustDown(KEY_REWIND)) {
+        // Held down, this repeats.
+        Rewind();
+        return;
+    }
+#endif
+    if (al_get_time()-LastSnapshotTime >= SNAPSHOT_INTERVAL) {
+        TakeSnapshot();
+    }
+}
+
+/**********************************************************//**
+ * @brief Forgets every snapshot and frees their memory.
+ **************************************************************/
+void DestroySnapshots(void) {
+    free(History);
+    History = NULL;
+    free(Scratch);
+    Scratch = NULL;
+    HistoryEnd = 0;
+    FirstRecord = 0;
+    NextRecord = 0;
+    KeyframeRecord = -1;
+    HaveQuickSave = false;
+}
+
+/**************************************************************/
@@ -0,0 +1,402 @@
+/**********************************************************//**
+ * @file storage.c
+ * @brief Keeps the spectra that don't fit in the party. The
+ * spectra are packed at the front of one array, and an index
+ * for each STORAGE_ORDER lists their positions in sorted
+ * order. The indexes are kept sorted as spectra come and go,
+ * so any sort is already done and any filter on the sort key
+ * is just two binary searches.
+ * @author Rena Shinomiya
+ * @date June 12, 2018
+ **************************************************************/
+
+#include <stdlib.h>             // malloc, realloc, free
+#include <string.h>             // memmove
+#include <limits.h>             // INT_MIN, INT_MAX
+
+#include "storage.h"            // STORAGE_VIEW
+#include "debug.h"              // eprintf
+
+/**********************************************************//**
+ * @struct STORED_SPECTRA
+ * @brief One spectra in the box, with its sort keys.
+ **************************************************************/
+typedef struct {
+    SPECTRA Spectra;                ///< The spectra.
+    int Captured;                   ///< When it was stored; unique.
+    int Key[N_STORAGE_ORDER];       ///< Its key in each index.
+} STORED_SPECTRA;
+
+/**************************************************************/
+/// @brief Every stored spectra, in no particular order.
+static STORED_SPECTRA *Box = NULL;
+
+/// @brief Number of spectra in the box.
+static int nStored = 0;
+
+/// @brief Number of spectra there's room for.
+static int StorageCapacity = 0;
+
+/// @brief Positions in the Box, sorted by each order's key,
+/// then by when they were stored.
+static int *Index[N_STORAGE_ORDER];
+
+/// @brief Number given to the next spectra stored.
+static int NextCapture = 0;
+
+/// @brief Number of times the box has changed.
+static int Changes = 0;
+
+/**********************************************************//**
+ * @brief Works out the key of a stored spectra in one order.
+ * @param order: The order.
+ * @param stored: The stored spectra.
+ * @return The key; smaller keys sort first.
+ **************************************************************/
+static int KeyOf(STORAGE_ORDER order, const STORED_SPECTRA *stored) {
+    const SPECIES *species = SpeciesOfSpectra(&stored->Spectra);
+    switch (order) {
+    case STORAGE_BY_SPECIES:
+        return stored->Spectra.Species;
+    case STORAGE_BY_LEVEL:
+        return -stored->Spectra.Level;
+    case STORAGE_BY_TYPE:
+        return species->Type[0]*N_TYPE + species->Type[1];
+    case STORAGE_BY_CAPTURE:
+    default:
+        return stored->Captured;
+    }
+}
+
+/**********************************************************//**
+ * @brief Finds where a key goes in an index.
+ * @param order: The index to search.
+ * @param key: Key to find.
+ * @param captured: When the spectra was stored, to tell
+ * apart spectra with the same key.
+ * @return Position of the first entry that isn't before it.
+ **************************************************************/
+static int LowerBound(STORAGE_ORDER order, int key, int captured) {
+    const int *index = Index[order];
+    int low = 0;
+    int high = nStored;
+    while (low < high) {
+        int middle = low + (high-low)/2;
+        const STORED_SPECTRA *stored = &Box[index[middle]];
+        if (stored->Key[order] < key
+        || (stored->Key[order] == key && stored->Captured < captured)) {
+            low = middle+1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**********************************************************//**
+ * @brief Makes room in the box for one more spectra.
+ * @return True if there's room.
+ **************************************************************/
+static bool ReserveStorage(void) {
+    if (nStored < StorageCapacity) {
+        return true;
+    }
+    int capacity = StorageCapacity? 2*StorageCapacity: STORAGE_SIZE;
+    STORED_SPECTRA *box = (STORED_SPECTRA *)realloc(Box, capacity*sizeof(STORED_SPECTRA));
+    if (!box) {
+        eprintf("Failed to grow storage to %d spectra.\n", capacity);
+        return false;
+    }
+    Box = box;
+    for (int order = 0; order < N_STORAGE_ORDER; order++) {
+        int *index = (int *)realloc(Index[order], capacity*sizeof(int));
+        if (!index) {
+            eprintf("Failed to grow storage index %d to %d spectra.\n", order, capacity);
+            return false;
+        }
+        Index[order] = index;
+    }
+    StorageCapacity = capacity;
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Adds a spectra to the box and every index.
+ * @param spectra: The spectra.
+ * @param captured: When it was stored.
+ * @return True if it was stored.
+ **************************************************************/
+static bool AddStored(const SPECTRA *spectra, int captured) {
+    if (!ReserveStorage()) {
+        return false;
+    }
+    int entry = nStored;
+    STORED_SPECTRA *stored = &Box[entry];
+    stored->Spectra = *spectra;
+    stored->Captured = captured;
+    for (int order = 0; order < N_STORAGE_ORDER; order++) {
+        stored->Key[order] = KeyOf(order, stored);
+    }
+    for (int order = 0; order < N_STORAGE_ORDER; order++) {
+        int *index = Index[order];
+        int at = LowerBound(order, stored->Key[order], captured);
+        memmove(&index[at+1], &index[at], (nStored-at)*sizeof(int));
+        index[at] = entry;
+    }
+    nStored++;
+    Changes++;
+    if (captured >= NextCapture) {
+        NextCapture = captured+1;
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Puts a spectra in the box.
+ * @param spectra: The spectra to store.
+ * @return True if it was stored.
+ **************************************************************/
+bool StoreSpectra(const SPECTRA *spectra) {
+    return AddStored(spectra, NextCapture);
+}
+
+/**********************************************************//**
+ * @brief Takes a spectra out of the box. The last spectra in
+ * the box moves into its place, so entries from before this
+ * call, and views of the box, have to be looked up again.
+ * @param entry: Entry of the spectra, from StorageViewEntry.
+ * @param spectra: Where to put the spectra, or NULL.
+ * @return True if the spectra was in the box.
+ **************************************************************/
+bool TakeStoredSpectra(int entry, SPECTRA *spectra) {
+    if (entry < 0 || entry >= nStored) {
+        return false;
+    }
+    const STORED_SPECTRA *stored = &Box[entry];
+    if (spectra) {
+        *spectra = stored->Spectra;
+    }
+    for (int order = 0; order < N_STORAGE_ORDER; order++) {
+        int *index = Index[order];
+        int at = LowerBound(order, stored->Key[order], stored->Captured);
+        memmove(&index[at], &index[at+1], (nStored-at-1)*sizeof(int));
+    }
+    nStored--;
+
+    // Fill the hole with the last spectra.
+    int last = nStored;
+    if (entry != last) {
+        const STORED_SPECTRA *moved = &Box[last];
+        for (int order = 0; order < N_STORAGE_ORDER; order++) {
+            int at = LowerBound(order, moved->Key[order], moved->Captured);
+            Index[order][at] = entry;
+        }
+        Box[entry] = Box[last];
+    }
+    Changes++;
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Gets a spectra in the box.
+ * @param entry: Entry of the spectra, from StorageViewEntry.
+ * @return The spectra, or NULL if there's no such entry.
+ **************************************************************/
+const SPECTRA *StoredSpectra(int entry) {
+    if (entry < 0 || entry >= nStored) {
+        return NULL;
+    }
+    return &Box[entry].Spectra;
+}
+
+/**********************************************************//**
+ * @brief Gets the number of spectra in the box.
+ * @return The number of spectra.
+ **************************************************************/
+int StorageSize(void) {
+    return nStored;
+}
+
+/**********************************************************//**
+ * @brief Empties the box, keeping its memory.
+ **************************************************************/
+void ClearStorage(void) {
+    nStored = 0;
+    NextCapture = 0;
+    Changes++;
+}
+
+/**********************************************************//**
+ * @brief Counts changes to the box, so anything that keeps a
+ * copy of the player can tell if the box has changed since.
+ * @return The number of times the box has changed.
+ **************************************************************/
+int StorageChanges(void) {
+    return Changes;
+}
+
+/**********************************************************//**
+ * @brief Empties the box and frees its memory.
+ **************************************************************/
+void DestroyStorage(void) {
+    free(Box);
+    Box = NULL;
+    for (int order = 0; order < N_STORAGE_ORDER; order++) {
+        free(Index[order]);
+        Index[order] = NULL;
+    }
+    StorageCapacity = 0;
+    ClearStorage();
+}
+
+/**********************************************************//**
+ * @brief Sets up a view of a range of keys in one order.
+ * @param view: The view.
+ * @param order: Order of the view.
+ * @param low: Smallest key shown.
+ * @param high: Largest key shown.
+ **************************************************************/
+static void ViewStorageKeys(STORAGE_VIEW *view, STORAGE_ORDER order, int low, int high) {
+    view->Order = order;
+    view->Low = low;
+    view->High = high;
+    RefreshStorageView(view);
+}
+
+/**********************************************************//**
+ * @brief Views the whole box in one order.
+ * @param view: The view.
+ * @param order: Order of the view.
+ **************************************************************/
+void ViewStorage(STORAGE_VIEW *view, STORAGE_ORDER order) {
+    ViewStorageKeys(view, order, INT_MIN, INT_MAX);
+}
+
+/**********************************************************//**
+ * @brief Views the spectra of one species, oldest first.
+ * @param view: The view.
+ * @param species: The species.
+ **************************************************************/
+void ViewStorageSpecies(STORAGE_VIEW *view, SPECIES_ID species) {
+    ViewStorageKeys(view, STORAGE_BY_SPECIES, species, species);
+}
+
+/**********************************************************//**
+ * @brief Views the spectra whose first type is the given type.
+ * @param view: The view.
+ * @param type: The type.
+ **************************************************************/
+void ViewStorageType(STORAGE_VIEW *view, TYPE_ID type) {
+    ViewStorageKeys(view, STORAGE_BY_TYPE, type*N_TYPE, type*N_TYPE+N_TYPE-1);
+}
+
+/**********************************************************//**
+ * @brief Views the spectra in a range of levels, highest
+ * level first.
+ * @param view: The view.
+ * @param low: Lowest level shown.
+ * @param high: Highest level shown.
+ **************************************************************/
+void ViewStorageLevels(STORAGE_VIEW *view, int low, int high) {
+    ViewStorageKeys(view, STORAGE_BY_LEVEL, -high, -low);
+}
+
+/**********************************************************//**
+ * @brief Finds the entries of a view again after the box has
+ * changed.
+ * @param view: The view.
+ **************************************************************/
+void RefreshStorageView(STORAGE_VIEW *view) {
+    // Capture numbers are never negative or INT_MAX, so these
+    // land on either side of every entry with a key in range.
+    int first = LowerBound(view->Order, view->Low, INT_MIN);
+    int last = LowerBound(view->Order, view->High, INT_MAX);
+    view->First = first;
+    view->Count = last-first;
+}
+
+/**********************************************************//**
+ * @brief Gets the entry of a spectra in a view.
+ * @param view: The view.
+ * @param index: Position in the view.
+ * @return The entry, or -1 if the view isn't that long.
+ **************************************************************/
+int StorageViewEntry(const STORAGE_VIEW *view, int index) {
+    if (index < 0 || index >= view->Count) {
+        return -1;
+    }
+    return Index[view->Order][view->First+index];
+}
+
+/**********************************************************//**
+ * @brief Copies the box, oldest first, so it can be saved
+ * while the game goes on.
+ * @param count: Where to put the number of spectra copied.
+ * @return The copies, which should be freed by the caller.
+ * This is NULL if the box is empty or there isn't memory.
+ **************************************************************/
+SPECTRA *CopyStorage(int *count) {
+    *count = 0;
+    if (!nStored) {
+        return NULL;
+    }
+    SPECTRA *copy = (SPECTRA *)malloc(nStored*sizeof(SPECTRA));
+    if (!copy) {
+        eprintf("Failed to copy %d stored spectra.\n", nStored);
+        return NULL;
+    }
+    const int *index = Index[STORAGE_BY_CAPTURE];
+    for (int i = 0; i < nStored; i++) {
+        copy[i] = Box[index[i]].Spectra;
+    }
+    *count = nStored;
+    return copy;
+}
+
+/**********************************************************//**
+ * @brief Replaces the box with spectra from CopyStorage.
+ * @param spectra: The spectra, oldest first.
+ * @param count: Number of spectra.
+ * @return True if every spectra was stored.
+ **************************************************************/
+bool RestoreStorage(const SPECTRA *spectra, int count) {
+    ClearStorage();
+    for (int i = 0; i < count; i++) {
+        if (!AddStored(&spectra[i], i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Reads the box from an old save file that was just
+ * raw data. Saves from before there was storage just have an
+ * empty box.
+ * @param file: The save file.
+ * @return True on success.
+ **************************************************************/
+bool LoadStorage(FILE *file) {
+    ClearStorage();
+    int header[2];
+    if (fread(header, sizeof(header), 1, file) != 1) {
+        return feof(file);
+    }
+    for (int i = 0; i < header[0]; i++) {
+        SPECTRA spectra;
+        int captured;
+        if (fread(&spectra, sizeof(SPECTRA), 1, file) != 1
+        || fread(&captured, sizeof(int), 1, file) != 1
+        || !AddStored(&spectra, captured)) {
+            eprintf("Storage in the save file is cut short.\n");
+            ClearStorage();
+            return false;
+        }
+    }
+    if (header[1] > NextCapture) {
+        NextCapture = header[1];
+    }
+    return true;
+}
+
+/**************************************************************/
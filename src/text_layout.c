@@ -0,0 +1,183 @@
+/**********************************************************//**
+ * @file text_layout.c
+ * @brief Wraps text into lines once, so text boxes can be
+ * drawn every frame without measuring the text again. Lines
+ * break the same way al_draw_multiline_text breaks them.
+ * @author Rena Shinomiya
+ * @date June 11, 2018
+ **************************************************************/
+
+#include <string.h>             // strlen
+#include <stdint.h>             // uint32_t
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+
+#include "text_layout.h"        // TEXT_LAYOUT
+#include "draw_list.h"          // ListText
+
+/**************************************************************/
+/// @brief Number of layouts CachedTextLayout remembers.
+#define LAYOUT_CACHE_SIZE 16
+
+/**************************************************************/
+/// @brief Layouts of recently drawn text boxes.
+static TEXT_LAYOUT Cache[LAYOUT_CACHE_SIZE];
+
+/// @brief Next cache entry to replace.
+static int NextCache = 0;
+
+/**********************************************************//**
+ * @brief Hashes some text (FNV-1a).
+ * @param text: The text.
+ * @param length: Length of the text.
+ * @return The hash.
+ **************************************************************/
+static uint32_t HashText(const char *text, int length) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)text[i])*16777619u;
+    }
+    return hash;
+}
+
+/**********************************************************//**
+ * @brief Measures part of a string.
+ * @param font: Font to measure in.
+ * @param text: Start of the part.
+ * @param length: Length of the part.
+ * @return Width in pixels.
+ **************************************************************/
+static int TextWidth(const ALLEGRO_FONT *font, const char *text, int length) {
+    ALLEGRO_USTR_INFO info;
+    return al_get_ustr_width(font, al_ref_buffer(&info, text, length));
+}
+
+/**********************************************************//**
+ * @brief Adds a line to a layout, if there's room.
+ * @param layout: The layout.
+ * @param start: Offset of the line.
+ * @param end: Offset just past the line.
+ **************************************************************/
+static void AddLine(TEXT_LAYOUT *layout, int start, int end) {
+    if (layout->nLines < TEXT_LINES_MAX) {
+        TEXT_LINE *line = &layout->Lines[layout->nLines++];
+        line->Start = start;
+        line->Length = end-start;
+    }
+}
+
+/**********************************************************//**
+ * @brief Wraps text to a width. Newlines always break the
+ * line; otherwise words are added to each line while they
+ * fit, and a word too long for any line gets one to itself.
+ * @param layout: Layout to fill in.
+ * @param font: Font to measure in.
+ * @param text: The text.
+ * @param length: Length of the text.
+ * @param width: Width in pixels to wrap to.
+ **************************************************************/
+void LayoutText(TEXT_LAYOUT *layout, const ALLEGRO_FONT *font, const char *text, int length, int width) {
+    layout->Font = font;
+    layout->Width = width;
+    layout->Length = length;
+    layout->Hash = HashText(text, length);
+    layout->nLines = 0;
+    int paragraph = 0;
+    while (paragraph <= length) {
+        // Each newline starts a new paragraph.
+        int end = paragraph;
+        while (end < length && text[end] != '\n') {
+            end++;
+        }
+
+        // Fill lines with as many words as fit.
+        int start = paragraph;
+        int lineEnd = -1;
+        int i = paragraph;
+        while (i < end) {
+            while (i < end && (text[i] == ' ' || text[i] == '\t')) {
+                i++;
+            }
+            if (i == end) {
+                break;
+            }
+            if (lineEnd < 0) {
+                start = i;
+            }
+            int word = i;
+            while (i < end && text[i] != ' ' && text[i] != '\t') {
+                i++;
+            }
+            if (lineEnd >= 0 && TextWidth(font, text+start, i-start) > width) {
+                AddLine(layout, start, lineEnd);
+                start = word;
+            }
+            lineEnd = i;
+        }
+        AddLine(layout, start, (lineEnd < 0)? start: lineEnd);
+        paragraph = end+1;
+    }
+}
+
+/**********************************************************//**
+ * @brief Gets the layout of a string, wrapping it only if it
+ * hasn't been drawn recently at this width.
+ * @param font: Font to measure in.
+ * @param text: The text.
+ * @param width: Width in pixels to wrap to.
+ * @return The layout.
+ **************************************************************/
+const TEXT_LAYOUT *CachedTextLayout(const ALLEGRO_FONT *font, const char *text, int width) {
+    int length = strlen(text);
+    uint32_t hash = HashText(text, length);
+    for (int i = 0; i < LAYOUT_CACHE_SIZE; i++) {
+        const TEXT_LAYOUT *layout = &Cache[i];
+        if (layout->Font == font && layout->Width == width
+        && layout->Length == length && layout->Hash == hash) {
+            return layout;
+        }
+    }
+    TEXT_LAYOUT *layout = &Cache[NextCache];
+    NextCache = (NextCache+1)%LAYOUT_CACHE_SIZE;
+    LayoutText(layout, font, text, length, width);
+    return layout;
+}
+
+/**********************************************************//**
+ * @brief Draws wrapped text. Only the first few characters
+ * can be shown, and they're on the same lines they'd be on
+ * if the whole text was shown. The lines go on the draw list.
+ * @param layout: Layout of the text.
+ * @param text: The text the layout was made from.
+ * @param reveal: Number of characters to show, or -1 for all.
+ * @param color: Color of the text.
+ * @param x: Left of the text.
+ * @param y: Top of the first line.
+ * @param lineHeight: Distance between lines in pixels.
+ **************************************************************/
+void DrawTextLayout(const TEXT_LAYOUT *layout, const char *text, int reveal, ALLEGRO_COLOR color, int x, int y, int lineHeight) {
+    if (reveal < 0) {
+        reveal = layout->Length;
+    }
+    for (int i = 0; i < layout->nLines; i++) {
+        const TEXT_LINE *line = &layout->Lines[i];
+        if (line->Start >= reveal) {
+            break;
+        }
+        int length = reveal-line->Start;
+        if (length > line->Length) {
+            length = line->Length;
+        }
+        ListText(
+            layout->Font,
+            color,
+            x,
+            y+i*lineHeight,
+            ALLEGRO_ALIGN_LEFT|ALLEGRO_ALIGN_INTEGER,
+            text+line->Start,
+            length);
+    }
+}
+
+/**************************************************************/
@@ -0,0 +1,303 @@
+/**********************************************************//**
+ * @file world_map.c
+ * @brief Zoomable overview of the whole overworld. The map
+ * image is reduced into a pyramid once at load, so every zoom
+ * level draws only its visible region at 1:1 scale.
+ * @author Rena Shinomiya
+ * @date June 3, 2018
+ **************************************************************/
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+#include <allegro5/allegro_primitives.h>
+
+#include <stdbool.h>            // bool
+#include <string.h>             // strcmp
+
+#include "world_map.h"          // WORLD_MAP_LEVELS
+#include "location.h"           // LOCATION, MAP_OVERWORLD
+#include "player.h"             // Player
+#include "assets.h"             // MapImage, Font
+#include "menu.h"               // DrawAt
+#include "draw_list.h"          // FlushDrawList
+#include "game.h"               // KeyDown, DISPLAY_WIDTH
+#include "debug.h"              // eprintf
+
+/**************************************************************/
+/// @brief Panning speed in screen pixels per second.
+#define PAN_SPEED 240
+
+/// @brief Zoom level shown when the world map opens.
+#define DEFAULT_LEVEL 2
+
+/**********************************************************//**
+ * @struct WORLD_LABEL
+ * @brief A location name on the world map. Overworld
+ * locations that share a name share one label, centered on
+ * all their bounds together.
+ **************************************************************/
+typedef struct {
+    const char *Name;           ///< Location name.
+    int Left;                   ///< Left edge in world pixels.
+    int Top;                    ///< Top edge in world pixels.
+    int Right;                  ///< Right edge in world pixels.
+    int Bottom;                 ///< Bottom edge in world pixels.
+} WORLD_LABEL;
+
+/**************************************************************/
+/// @brief The map pyramid. Level 0 is the overworld image
+/// itself, and each level after is half the size of the last.
+static ALLEGRO_BITMAP *Level[WORLD_MAP_LEVELS];
+
+/// @brief Number of levels in the pyramid.
+static int nLevels = 0;
+
+/// @brief Location names shown on the map.
+static WORLD_LABEL Labels[N_LOCATION];
+
+/// @brief Number of labels.
+static int nLabels = 0;
+
+/// @brief World X-coordinate at the center of the screen.
+static float ViewX;
+
+/// @brief World Y-coordinate at the center of the screen.
+static float ViewY;
+
+/// @brief Pyramid level being viewed.
+static int ViewLevel;
+
+/// @brief Whether the world map is being viewed.
+static bool Open = false;
+
+/**********************************************************//**
+ * @brief Makes an image half the size of another, where each
+ * pixel is the average of the 2*2 pixels it covers.
+ * @param source: The image to reduce.
+ * @return The reduced image, or NULL on failure.
+ **************************************************************/
+static ALLEGRO_BITMAP *HalveImage(ALLEGRO_BITMAP *source) {
+    int width = al_get_bitmap_width(source);
+    int height = al_get_bitmap_height(source);
+    ALLEGRO_BITMAP *half = al_create_bitmap((width+1)/2, (height+1)/2);
+    if (!half) {
+        return NULL;
+    }
+    ALLEGRO_LOCKED_REGION *from = al_lock_bitmap(source, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_READONLY);
+    ALLEGRO_LOCKED_REGION *to = al_lock_bitmap(half, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_WRITEONLY);
+    if (!from || !to) {
+        if (from) {
+            al_unlock_bitmap(source);
+        }
+        if (to) {
+            al_unlock_bitmap(half);
+        }
+        al_destroy_bitmap(half);
+        return NULL;
+    }
+    for (int y = 0; y < (height+1)/2; y++) {
+        // Odd sizes repeat the last row or column.
+        const unsigned char *row0 = (const unsigned char *)from->data+(2*y)*from->pitch;
+        const unsigned char *row1 = (2*y+1 < height)? row0+from->pitch: row0;
+        unsigned char *out = (unsigned char *)to->data+y*to->pitch;
+        for (int x = 0; x < (width+1)/2; x++) {
+            int x0 = 2*x*4;
+            int x1 = (2*x+1 < width)? x0+4: x0;
+            for (int c = 0; c < 4; c++) {
+                out[x*4+c] = (row0[x0+c]+row0[x1+c]+row1[x0+c]+row1[x1+c]+2)/4;
+            }
+        }
+    }
+    al_unlock_bitmap(half);
+    al_unlock_bitmap(source);
+    return half;
+}
+
+/**********************************************************//**
+ * @brief Collects the names of the overworld locations.
+ **************************************************************/
+static void InitializeLabels(void) {
+    nLabels = 0;
+    for (LOCATION_ID id = 1; id < N_LOCATION; id++) {
+        const LOCATION *location = Location(id);
+        if (location->Map != MAP_OVERWORLD || !location->Name) {
+            continue;
+        }
+        const COORDINATE *bounds = location->Bounds;
+        int i = 0;
+        while (i < nLabels && strcmp(Labels[i].Name, location->Name)) {
+            i++;
+        }
+        if (i == nLabels) {
+            Labels[nLabels++] = (WORLD_LABEL){location->Name, bounds[0].X, bounds[0].Y, bounds[1].X, bounds[1].Y};
+            continue;
+        }
+        // Grow the existing label to cover this location too.
+        WORLD_LABEL *label = &Labels[i];
+        label->Left = (bounds[0].X < label->Left)? bounds[0].X: label->Left;
+        label->Top = (bounds[0].Y < label->Top)? bounds[0].Y: label->Top;
+        label->Right = (bounds[1].X > label->Right)? bounds[1].X: label->Right;
+        label->Bottom = (bounds[1].Y > label->Bottom)? bounds[1].Y: label->Bottom;
+    }
+}
+
+/**********************************************************//**
+ * @brief Builds the world map pyramid from the overworld
+ * image. Levels are added until the whole map fits on the
+ * screen.
+ * @return True on success.
+ **************************************************************/
+bool InitializeWorldMap(void) {
+    DestroyWorldMap();
+    InitializeLabels();
+    Level[0] = MapImage(MAP_OVERWORLD);
+    if (!Level[0]) {
+        eprintf("No overworld image for the world map.\n");
+        return false;
+    }
+    nLevels = 1;
+    while (nLevels < WORLD_MAP_LEVELS) {
+        ALLEGRO_BITMAP *last = Level[nLevels-1];
+        if (al_get_bitmap_width(last) <= DISPLAY_WIDTH && al_get_bitmap_height(last) <= DISPLAY_HEIGHT) {
+            break;
+        }
+        Level[nLevels] = HalveImage(last);
+        if (!Level[nLevels]) {
+            eprintf("Failed to build world map level %d.\n", nLevels);
+            return false;
+        }
+        nLevels++;
+    }
+    return true;
+}
+
+/**********************************************************//**
+ * @brief Releases the world map pyramid. Level 0 belongs to
+ * the assets.
+ **************************************************************/
+void DestroyWorldMap(void) {
+    for (int i = 1; i < nLevels; i++) {
+        al_destroy_bitmap(Level[i]);
+    }
+    for (int i = 0; i < WORLD_MAP_LEVELS; i++) {
+        Level[i] = NULL;
+    }
+    nLevels = 0;
+}
+
+/**********************************************************//**
+ * @brief Checks if the player is somewhere on the overworld.
+ * @return True if the player marker can be shown.
+ **************************************************************/
+static inline bool PlayerOnOverworld(void) {
+    return Location(Player->Location)->Map == MAP_OVERWORLD;
+}
+
+/**********************************************************//**
+ * @brief Opens the world map, centered on the player if they
+ * are on the overworld.
+ **************************************************************/
+void OpenWorldMap(void) {
+    Open = nLevels > 0;
+    ViewLevel = (DEFAULT_LEVEL < nLevels)? DEFAULT_LEVEL: nLevels-1;
+    if (Open && PlayerOnOverworld()) {
+        ViewX = Player->Position.X;
+        ViewY = Player->Position.Y;
+    } else if (Open) {
+        ViewX = al_get_bitmap_width(Level[0])/2;
+        ViewY = al_get_bitmap_height(Level[0])/2;
+    }
+}
+
+/**********************************************************//**
+ * @brief Pans and zooms the world map.
+ **************************************************************/
+void UpdateWorldMap(void) {
+    if (!Open) {
+        return;
+    }
+    if (KeyJustUp(KEY_DENY)) {
+        Open = false;
+        return;
+    }
+    if (KeyJustUp(KEY_CONFIRM) && ViewLevel > 0) {
+        ViewLevel--;
+    } else if (KeyJustUp(KEY_MENU) && ViewLevel < nLevels-1) {
+        ViewLevel++;
+    }
+
+    // Pan at the same screen speed on every level.
+    float step = PAN_SPEED*LastFrameTime()*(1 << ViewLevel);
+    ViewX += (KeyDown(KEY_RIGHT)-KeyDown(KEY_LEFT))*step;
+    ViewY += (KeyDown(KEY_DOWN)-KeyDown(KEY_UP))*step;
+    float width = al_get_bitmap_width(Level[0]);
+    float height = al_get_bitmap_height(Level[0]);
+    ViewX = (ViewX < 0)? 0: (ViewX > width)? width: ViewX;
+    ViewY = (ViewY < 0)? 0: (ViewY > height)? height: ViewY;
+}
+
+/**********************************************************//**
+ * @brief Draws the visible part of the world map, with the
+ * location names and the player's position.
+ **************************************************************/
+void DrawWorldMap(void) {
+    if (!Open) {
+        return;
+    }
+
+    // The map covers the menus under it.
+    FlushDrawList();
+    DrawAt(0, 0);
+    al_draw_filled_rectangle(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, al_map_rgb(0, 0, 0));
+
+    // Only the region on screen is drawn from this level.
+    ALLEGRO_BITMAP *image = Level[ViewLevel];
+    int scale = 1 << ViewLevel;
+    int left = (int)ViewX/scale-DISPLAY_WIDTH/2;
+    int top = (int)ViewY/scale-DISPLAY_HEIGHT/2;
+    int x0 = (left < 0)? 0: left;
+    int y0 = (top < 0)? 0: top;
+    int x1 = left+DISPLAY_WIDTH;
+    int y1 = top+DISPLAY_HEIGHT;
+    x1 = (x1 > al_get_bitmap_width(image))? al_get_bitmap_width(image): x1;
+    y1 = (y1 > al_get_bitmap_height(image))? al_get_bitmap_height(image): y1;
+    if (x0 < x1 && y0 < y1) {
+        al_draw_bitmap_region(image, x0, y0, x1-x0, y1-y0, x0-left, y0-top, 0);
+    }
+
+    // Location names
+    ALLEGRO_FONT *font = Font(FONT_WINDOW);
+    int lineHeight = al_get_font_line_height(font);
+    al_hold_bitmap_drawing(true);
+    for (int i = 0; i < nLabels; i++) {
+        const WORLD_LABEL *label = &Labels[i];
+        int x = (label->Left+label->Right)/2/scale-left;
+        int y = (label->Top+label->Bottom)/2/scale-top;
+        int halfWidth = al_get_text_width(font, label->Name)/2+1;
+        if (x+halfWidth < 0 || x-halfWidth > DISPLAY_WIDTH || y+lineHeight < 0 || y-lineHeight > DISPLAY_HEIGHT) {
+            continue;
+        }
+        al_draw_text(font, al_map_rgb(0, 0, 0), x+1, y+1-lineHeight/2, ALLEGRO_ALIGN_CENTRE, label->Name);
+        al_draw_text(font, al_map_rgb(255, 255, 255), x, y-lineHeight/2, ALLEGRO_ALIGN_CENTRE, label->Name);
+    }
+    al_hold_bitmap_drawing(false);
+
+    // Player marker
+    if (PlayerOnOverworld()) {
+        float x = (float)Player->Position.X/scale-left;
+        float y = (float)Player->Position.Y/scale-top;
+        al_draw_filled_circle(x, y, 4, al_map_rgb(255, 255, 255));
+        al_draw_filled_circle(x, y, 3, al_map_rgb(255, 64, 64));
+    }
+}
+
+/**********************************************************//**
+ * @brief Checks if the world map was closed and processing
+ * should return to whatever opened it.
+ * @return True if the world map is closed.
+ **************************************************************/
+bool WorldMapClosed(void) {
+    return !Open;
+}
+
+/**************************************************************/
@@ -0,0 +1,462 @@
+/**********************************************************//**
+ * @file balance.c
+ * @brief Offline balance report. For every attacking species,
+ * defending species, damaging technique and level bracket,
+ * works out the expected damage per use, the hits needed to
+ * knock the defender out, and who moves first, using the
+ * game's own battle rules. Attackers are split across every
+ * core.
+ * @author Rena Shinomiya
+ * @date June 8, 2018
+ *
+ * Usage: spectrum-balance [options]
+ *
+ * Both sides are the same level, with no boosts or ailments.
+ * Every level in a bracket is evaluated and the results are
+ * averaged over the bracket.
+ *
+ * Options:
+ *   -j THREADS   Number of threads (default: one per core).
+ *   -w WIDTH     Levels per bracket (default 10).
+ *   -a           Report every technique, not just the best
+ *                one for each matchup.
+ *   -o FILE      Write the CSV report to FILE instead of
+ *                standard output.
+ *   -m FILE      Also save a heatmap image of the bracket
+ *                holding level -L; rows are attackers and
+ *                columns are defenders.
+ *   -L LEVEL     Level for the heatmap (default 50).
+ **************************************************************/
+
+#include <stdio.h>              // printf, fprintf
+#include <stdlib.h>             // strtol, calloc, free
+#include <stdbool.h>            // bool
+#include <math.h>               // ceilf
+#include <pthread.h>            // pthread_create, pthread_join
+#include <time.h>               // clock_gettime
+
+#ifdef _WIN32
+#include <windows.h>            // GetSystemInfo
+#else
+#include <unistd.h>             // sysconf
+#endif
+
+#include <allegro5/allegro.h>               // al_init, ALLEGRO_BITMAP
+#include <allegro5/allegro_image.h>         // al_init_image_addon
+
+#include "species.h"            // CreateSpectra, N_SPECIES
+#include "technique.h"          // TechniqueByID, N_TECHNIQUES
+#include "battler.h"            // InitializeBattler
+#include "battle_rules.h"       // HitRate, Priority
+#include "damage.h"             // DAMAGE_BATCH
+
+/**************************************************************/
+/// @brief Maximum number of threads.
+#define THREAD_MAX 256
+
+/// @brief Size of each heatmap cell in pixels.
+#define HEATMAP_CELL 8
+
+/**********************************************************//**
+ * @struct MATCHUP
+ * @brief One attacker using one technique on one defender,
+ * summed over the levels in a bracket.
+ **************************************************************/
+typedef struct {
+    float Damage;               ///< Expected damage per use.
+    float Hits;                 ///< Hits needed to knock out the defender.
+} MATCHUP;
+
+/**********************************************************//**
+ * @struct BALANCE_THREAD
+ * @brief Work given to one thread: every attacker from First
+ * up to, but not including, Last.
+ **************************************************************/
+typedef struct {
+    pthread_t Thread;           ///< The thread.
+    int First;                  ///< First attacker.
+    int Last;                   ///< One past the last attacker.
+} BALANCE_THREAD;
+
+/**************************************************************/
+/// @brief Levels per bracket.
+static int Width = 10;
+
+/// @brief Number of brackets.
+static int nBrackets;
+
+/// @brief Every species at every level, ready to battle.
+/// Level n is stored at index n-1.
+static BATTLER Battlers[N_SPECIES][LEVEL_MAX];
+
+/// @brief Species that exist.
+static SPECIES_ID Species[N_SPECIES];
+
+/// @brief Number of species that exist.
+static int nSpecies;
+
+/// @brief Techniques that deal damage.
+static TECHNIQUE_ID Techniques[N_TECHNIQUES];
+
+/// @brief Number of techniques that deal damage.
+static int nTechniques;
+
+/// @brief Results for [attacker][defender][technique][bracket],
+/// indexed by position in Species and Techniques.
+static MATCHUP *Matchups;
+
+/// @brief Chance the attacker moves first for
+/// [attacker][defender][bracket].
+static float *First;
+
+/**********************************************************//**
+ * @brief Gets the results for a matchup.
+ * @param a: Attacker's position in Species.
+ * @param d: Defender's position in Species.
+ * @param t: Position in Techniques.
+ * @param b: Level bracket.
+ * @return The matchup.
+ **************************************************************/
+static inline MATCHUP *Matchup(int a, int d, int t, int b) {
+    return &Matchups[((a*nSpecies+d)*nTechniques+t)*nBrackets+b];
+}
+
+/**********************************************************//**
+ * @brief Gets the chance an attacker moves first.
+ * @param a: Attacker's position in Species.
+ * @param d: Defender's position in Species.
+ * @param b: Level bracket.
+ * @return Pointer to the chance.
+ **************************************************************/
+static inline float *MovesFirst(int a, int d, int b) {
+    return &First[(a*nSpecies+d)*nBrackets+b];
+}
+
+/**********************************************************//**
+ * @brief Battle messages aren't shown by the report.
+ * @param text: Ignored.
+ **************************************************************/
+void Output(const char *text) {
+    (void)text;
+}
+
+/**********************************************************//**
+ * @brief Battle messages aren't shown by the report.
+ * @param text: Ignored.
+ **************************************************************/
+void OutputSplitByCR(const char *text) {
+    (void)text;
+}
+
+/**********************************************************//**
+ * @brief Lists the species and damaging techniques, and sets
+ * up a battler for every species at every level.
+ **************************************************************/
+static void LoadBattlers(void) {
+    for (int id = 1; id < N_SPECIES; id++) {
+        if (!SpeciesByID(id)->Name[0]) {
+            continue;
+        }
+        Species[nSpecies++] = id;
+        for (int level = 1; level <= LEVEL_MAX; level++) {
+            SPECTRA spectra;
+            CreateSpectra(&spectra, id, level);
+            InitializeBattler(&Battlers[id][level-1], &spectra);
+        }
+    }
+    for (int id = 1; id < N_TECHNIQUES; id++) {
+        const TECHNIQUE *technique = TechniqueByID(id);
+        if (technique->Name[0] && technique->Power && technique->Effect != EFFECT_SPECIAL) {
+            Techniques[nTechniques++] = id;
+        }
+    }
+}
+
+/**********************************************************//**
+ * @brief Thread entry point; fills in every matchup for a
+ * share of the attackers.
+ * @param argument: The BALANCE_THREAD.
+ * @return NULL.
+ **************************************************************/
+static void *BalanceThread(void *argument) {
+    const BALANCE_THREAD *thread = (const BALANCE_THREAD *)argument;
+    DAMAGE_BATCH batch;
+    for (int a = thread->First; a < thread->Last; a++) {
+        for (int d = 0; d < nSpecies; d++) {
+            for (int level = 1; level <= LEVEL_MAX; level++) {
+                const BATTLER *user = &Battlers[Species[a]][level-1];
+                const BATTLER *target = &Battlers[Species[d]][level-1];
+                int b = (level-1)/Width;
+
+                // Ties go either way, so count them as half.
+                int userPriority = Priority(user);
+                int targetPriority = Priority(target);
+                *MovesFirst(a, d, b) += (userPriority > targetPriority)? 1.0: (userPriority == targetPriority)? 0.5: 0.0;
+
+                // Expected damage counts misses and critical hits.
+                float health = BattlerMaxHealth(target);
+                float hit = HitRate(user, target, false, TechniqueByID(DEFAULT_ATTACK));
+                hit = (hit > 1.0)? 1.0: hit;
+                float critical = 1.0 + CriticalHitRate(user, target);
+                // Techniques go through in batches until they're all done.
+                for (int first = 0; first < nTechniques; first += batch.Count) {
+                    batch.Count = 0;
+                    for (int t = first; t < nTechniques; t++) {
+                        if (!AddDamageBatch(&batch, user, target, TechniqueByID(Techniques[t]))) {
+                            break;
+                        }
+                    }
+                    ComputeDamageBatch(&batch);
+                    for (int i = 0; i < batch.Count; i++) {
+                        int damage = batch.Damage[i];
+                        MATCHUP *matchup = Matchup(a, d, first+i, b);
+                        matchup->Damage += hit*damage*critical;
+                        matchup->Hits += ceilf(health/damage);
+                    }
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+/**********************************************************//**
+ * @brief Gets the number of levels in a bracket.
+ * @param b: The bracket.
+ * @return Number of levels.
+ **************************************************************/
+static int BracketSize(int b) {
+    int last = (b+1)*Width;
+    return ((last > LEVEL_MAX)? LEVEL_MAX: last) - b*Width;
+}
+
+/**********************************************************//**
+ * @brief Finds the technique doing the most damage in a
+ * matchup.
+ * @param a: Attacker's position in Species.
+ * @param d: Defender's position in Species.
+ * @param b: Level bracket.
+ * @return Position of the technique in Techniques.
+ **************************************************************/
+static int BestTechnique(int a, int d, int b) {
+    int best = 0;
+    for (int t = 1; t < nTechniques; t++) {
+        if (Matchup(a, d, t, b)->Damage > Matchup(a, d, best, b)->Damage) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+/**********************************************************//**
+ * @brief Writes one row of the report.
+ * @param file: The CSV file.
+ * @param a: Attacker's position in Species.
+ * @param d: Defender's position in Species.
+ * @param t: Position in Techniques.
+ * @param b: Level bracket.
+ **************************************************************/
+static void ReportMatchup(FILE *file, int a, int d, int t, int b) {
+    int levels = BracketSize(b);
+    const MATCHUP *matchup = Matchup(a, d, t, b);
+    fprintf(file, "%s,%s,%d-%d,%s,%.2f,%.2f,%.2f\n",
+        SpeciesByID(Species[a])->Name,
+        SpeciesByID(Species[d])->Name,
+        b*Width+1, b*Width+levels,
+        TechniqueByID(Techniques[t])->Name,
+        matchup->Damage/levels,
+        matchup->Hits/levels,
+        *MovesFirst(a, d, b)/levels
+    );
+}
+
+/**********************************************************//**
+ * @brief Writes the report as CSV.
+ * @param file: The CSV file.
+ * @param all: Set to report every technique.
+ **************************************************************/
+static void Report(FILE *file, bool all) {
+    fprintf(file, "attacker,defender,levels,technique,damage,hits_to_ko,moves_first\n");
+    for (int a = 0; a < nSpecies; a++) {
+        for (int d = 0; d < nSpecies; d++) {
+            for (int b = 0; b < nBrackets; b++) {
+                if (all) {
+                    for (int t = 0; t < nTechniques; t++) {
+                        ReportMatchup(file, a, d, t, b);
+                    }
+                } else {
+                    ReportMatchup(file, a, d, BestTechnique(a, d, b), b);
+                }
+            }
+        }
+    }
+}
+
+/**********************************************************//**
+ * @brief Saves a heatmap of how much of the defender's health
+ * the attacker's best technique takes per use. Blue cells
+ * barely scratch; red cells knock out in one use.
+ * @param filename: Image file to write; the extension picks
+ * the format.
+ * @param level: A level in the bracket to show.
+ * @return True if the image was saved.
+ **************************************************************/
+static bool SaveHeatmap(const char *filename, int level) {
+    if (!al_init() || !al_init_image_addon()) {
+        fprintf(stderr, "Can't start Allegro\n");
+        return false;
+    }
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP);
+    int size = nSpecies*HEATMAP_CELL;
+    ALLEGRO_BITMAP *heatmap = al_create_bitmap(size, size);
+    if (!heatmap) {
+        fprintf(stderr, "Can't create a %dx%d heatmap\n", size, size);
+        return false;
+    }
+    int b = (level-1)/Width;
+    int levels = BracketSize(b);
+    al_set_target_bitmap(heatmap);
+    for (int a = 0; a < nSpecies; a++) {
+        for (int d = 0; d < nSpecies; d++) {
+            const MATCHUP *matchup = Matchup(a, d, BestTechnique(a, d, b), b);
+            const BATTLER *target = &Battlers[Species[d]][b*Width+levels/2];
+            float fraction = matchup->Damage/levels/BattlerMaxHealth(target);
+            fraction = (fraction > 1.0)? 1.0: fraction;
+            ALLEGRO_COLOR color = al_map_rgb_f(fraction, 0.2, 1.0-fraction);
+            for (int y = 0; y < HEATMAP_CELL; y++) {
+                for (int x = 0; x < HEATMAP_CELL; x++) {
+                    al_put_pixel(d*HEATMAP_CELL+x, a*HEATMAP_CELL+y, color);
+                }
+            }
+        }
+    }
+    bool saved = al_save_bitmap(filename, heatmap);
+    al_destroy_bitmap(heatmap);
+    if (!saved) {
+        fprintf(stderr, "Can't write heatmap %s\n", filename);
+    }
+    return saved;
+}
+
+/**********************************************************//**
+ * @brief Gets the number of processors.
+ * @return Number of cores to use.
+ **************************************************************/
+static int ProcessorCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0)? count: 1;
+#endif
+}
+
+/**********************************************************//**
+ * @brief Prints how to use the report.
+ **************************************************************/
+static void Usage(void) {
+    fprintf(stderr, "Usage: spectrum-balance [-j threads] [-w width] [-a] [-o report] [-m heatmap] [-L level]\n");
+}
+
+/**********************************************************//**
+ * @brief Runs the report.
+ * @param argc: Number of arguments.
+ * @param argv: Arguments.
+ * @return Exit status.
+ **************************************************************/
+int main(int argc, char **argv) {
+    int threads = ProcessorCount();
+    bool all = false;
+    const char *reportFilename = NULL;
+    const char *heatmapFilename = NULL;
+    int heatmapLevel = 50;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-' || !argv[i][1] || argv[i][2]) {
+            Usage();
+            return EXIT_FAILURE;
+        } else if (argv[i][1] == 'a') {
+            all = true;
+            continue;
+        } else if (i+1 == argc) {
+            Usage();
+            return EXIT_FAILURE;
+        }
+        switch (argv[i][1]) {
+        case 'j':
+            threads = strtol(argv[++i], NULL, 10);
+            break;
+        case 'w':
+            Width = strtol(argv[++i], NULL, 10);
+            break;
+        case 'o':
+            reportFilename = argv[++i];
+            break;
+        case 'm':
+            heatmapFilename = argv[++i];
+            break;
+        case 'L':
+            heatmapLevel = strtol(argv[++i], NULL, 10);
+            break;
+        default:
+            Usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (Width < 1 || Width > LEVEL_MAX || heatmapLevel < 1 || heatmapLevel > LEVEL_MAX) {
+        Usage();
+        return EXIT_FAILURE;
+    }
+    threads = (threads < 1)? 1: (threads > THREAD_MAX)? THREAD_MAX: threads;
+
+    // Set up the tables
+    InitializeDamageTables();
+    LoadBattlers();
+    nBrackets = (LEVEL_MAX+Width-1)/Width;
+    Matchups = (MATCHUP *)calloc((size_t)nSpecies*nSpecies*nTechniques*nBrackets, sizeof(MATCHUP));
+    First = (float *)calloc((size_t)nSpecies*nSpecies*nBrackets, sizeof(float));
+    if (!Matchups || !First) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    threads = (threads > nSpecies)? nSpecies: threads;
+
+    // Split the attackers between the threads
+    static BALANCE_THREAD thread[THREAD_MAX];
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < threads; i++) {
+        thread[i].First = nSpecies*i/threads;
+        thread[i].Last = nSpecies*(i+1)/threads;
+        if (pthread_create(&thread[i].Thread, NULL, BalanceThread, &thread[i])) {
+            fprintf(stderr, "Failed to start thread %d\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(thread[i].Thread, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec-start.tv_sec)+(end.tv_nsec-start.tv_nsec)/1e9;
+    long evaluations = (long)nSpecies*nSpecies*nTechniques*LEVEL_MAX;
+    fprintf(stderr, "Evaluated %ld matchups in %.2fs on %d threads (%.0f/s)\n",
+        evaluations, seconds, threads, evaluations/seconds);
+
+    // Write the results
+    FILE *file = reportFilename? fopen(reportFilename, "w"): stdout;
+    if (!file) {
+        fprintf(stderr, "Can't write report %s\n", reportFilename);
+        return EXIT_FAILURE;
+    }
+    Report(file, all);
+    if (file != stdout) {
+        fclose(file);
+    }
+    bool ok = !heatmapFilename || SaveHeatmap(heatmapFilename, heatmapLevel);
+    free(Matchups);
+    free(First);
+    return ok? EXIT_SUCCESS: EXIT_FAILURE;
+}
+
+/**************************************************************/
@@ -0,0 +1,512 @@
+/**********************************************************//**
+ * @file battlesim.c
+ * @brief Headless battle simulator. Runs complete battles
+ * between two teams with the game's battle rules, spread
+ * across every core, and reports how they turned out.
+ * @author Rena Shinomiya
+ * @date June 4, 2018
+ *
+ * Usage: spectrum-battlesim [options] TEAM TEAM
+ *
+ * Each TEAM is a comma-separated list of up to 32
+ * species:level pairs, such as "Amy:30,Karda:28". Species
+ * can be given by name or by number. The teams don't need to
+ * be the same size. Both teams choose
+ * techniques and targets the way wild spectra do.
+ *
+ * Options:
+ *   -n BATTLES   Number of battles to run (default 100000).
+ *   -j THREADS   Number of threads (default: one per core).
+ *   -s SEED      Seed for reproducible runs.
+ *   -r ROUNDS    Rounds before a battle is a draw (default 200).
+ *   -o LOG       Save a log of the first battle to LOG.
+ *   -l LOG       Replay a battle log, check that it comes out
+ *                the same, and print it as CSV. No TEAMs are
+ *                needed.
+ **************************************************************/
+
+#include <stdio.h>              // printf, fprintf
+#include <stdlib.h>             // strtol, malloc, free
+#include <stdint.h>             // uint64_t
+#include <string.h>             // memset, strchr
+#include <strings.h>            // strncasecmp
+#include <stdbool.h>            // bool
+#include <pthread.h>            // pthread_create, pthread_join
+#include <time.h>               // clock_gettime
+
+#ifdef _WIN32
+#include <windows.h>            // GetSystemInfo
+#else
+#include <unistd.h>             // sysconf
+#endif
+
+#include "battle.h"             // TEAM_MAX
+#include "battle_engine.h"      // BATTLE_CONTEXT, RunRound
+#include "battle_log.h"         // BATTLE_LOG, ExportBattleLog
+#include "species.h"            // CreateSpectra
+#include "random.h"             // SeedRandom
+#include "output.h"             // OutputMessage
+#include "damage.h"             // InitializeDamageTables
+
+/**************************************************************/
+/// @brief Largest damage counted individually in the damage
+/// histogram. Larger hits share the last bucket.
+#define DAMAGE_MAX 1000
+
+/// @brief Maximum number of threads.
+#define THREAD_MAX 256
+
+/**********************************************************//**
+ * @enum SIM_RESULT
+ * @brief How one simulated battle ended.
+ **************************************************************/
+typedef enum {
+    SIM_FIRST,                  ///< The first team won.
+    SIM_SECOND,                 ///< The second team won.
+    SIM_DRAW,                   ///< Nobody won before the round limit.
+    N_SIM_RESULT,
+} SIM_RESULT;
+
+/**********************************************************//**
+ * @struct SIM_STATS
+ * @brief Totals collected by one thread.
+ **************************************************************/
+typedef struct {
+    long Battles;                   ///< Battles simulated.
+    long Result[N_SIM_RESULT];      ///< Battles ending each way.
+    long *Rounds;                   ///< Histogram of rounds per battle.
+    long Damage[DAMAGE_MAX+1];      ///< Histogram of damage per hit.
+    long Hits;                      ///< Hits that landed.
+    long Misses;                    ///< Hits that were avoided.
+    long Criticals;                 ///< Critical hits.
+    long Blocked;                   ///< Turns lost to ailments.
+    double TeamDamage[2];           ///< Damage dealt by each team.
+} SIM_STATS;
+
+/**********************************************************//**
+ * @struct SIM_THREAD
+ * @brief Work given to one thread.
+ **************************************************************/
+typedef struct {
+    pthread_t Thread;               ///< The thread.
+    int Index;                      ///< Thread number.
+    long Battles;                   ///< Battles to run.
+    SIM_STATS Stats;                ///< Results.
+} SIM_THREAD;
+
+/**************************************************************/
+/// @brief Species and levels for both teams.
+static SPECTRA Teams[2][TEAM_MAX];
+
+/// @brief Number of spectra on each team.
+static int TeamSize[2];
+
+/// @brief Rounds before calling a draw.
+static int MaxRounds = 200;
+
+/// @brief Seed given on the command line.
+static uint64_t Seed = 0;
+
+/// @brief Set if a seed was given.
+static bool Seeded = false;
+
+/// @brief Log of the first battle, if one was asked for.
+static BATTLE_LOG FirstLog;
+
+/// @brief Where to save FirstLog, or NULL.
+static const char *LogFilename = NULL;
+
+/**********************************************************//**
+ * @brief Battle messages aren't shown by the simulator.
+ * @param text: Ignored.
+ **************************************************************/
+void Output(const char *text) {
+    (void)text;
+}
+
+/**********************************************************//**
+ * @brief Battle messages aren't shown by the simulator.
+ * @param text: Ignored.
+ **************************************************************/
+void OutputSplitByCR(const char *text) {
+    (void)text;
+}
+
+/**********************************************************//**
+ * @brief Battle messages aren't shown by the simulator.
+ * @param message: Ignored.
+ **************************************************************/
+void OutputMessage(MESSAGE_ID message, ...) {
+    (void)message;
+}
+
+/**********************************************************//**
+ * @brief Adds hits, misses and blocked turns to the totals.
+ * @param data: The thread's SIM_STATS.
+ * @param notice: What happened.
+ **************************************************************/
+static void SimNotify(void *data, const BATTLE_NOTICE *notice) {
+    SIM_STATS *stats = (SIM_STATS *)data;
+    switch (notice->Type) {
+    case NOTICE_BLOCKED:
+        stats->Blocked++;
+        break;
+    case NOTICE_MISS:
+        stats->Misses++;
+        break;
+    case NOTICE_HIT:
+        stats->Hits++;
+        stats->Criticals += notice->Critical;
+        stats->Damage[(notice->Damage < DAMAGE_MAX)? notice->Damage: DAMAGE_MAX]++;
+        stats->TeamDamage[notice->User>=TeamSize[0]] += notice->Damage;
+        break;
+    }
+}
+
+/**********************************************************//**
+ * @brief Runs one battle to the end. The first team plays
+ * the player's side.
+ * @param battle: Scratch space for the battle.
+ * @param start: The battle before the first round.
+ * @param stats: Totals to add to.
+ * @param log: Log to record the battle in, or NULL.
+ **************************************************************/
+static void SimBattle(BATTLE_CONTEXT *battle, const BATTLE_CONTEXT *start, SIM_STATS *stats, BATTLE_LOG *log) {
+    CopyBattleContext(battle, start);
+    SeedBattleContext(battle, RandomNext());
+    if (log) {
+        StartBattleLog(battle, log);
+    }
+    int round = 0;
+    while (round < MaxRounds && battle->State == BATTLE_STATE_ACTIVE) {
+        round++;
+        BeginRound(battle);
+        for (int id=0; id<battle->nBattlers; id++) {
+            ChooseRandomTurn(battle, id);
+        }
+        RunRound(battle);
+    }
+
+    SIM_RESULT result;
+    switch (battle->State) {
+    case BATTLE_STATE_WIN:
+        result = SIM_FIRST;
+        break;
+    case BATTLE_STATE_LOSE:
+        result = SIM_SECOND;
+        break;
+    default:
+        result = SIM_DRAW;
+        break;
+    }
+    stats->Battles++;
+    stats->Result[result]++;
+    stats->Rounds[round]++;
+}
+
+/**********************************************************//**
+ * @brief Thread entry point; runs a share of the battles.
+ * @param argument: The SIM_THREAD.
+ * @return NULL.
+ **************************************************************/
+static void *SimThread(void *argument) {
+    SIM_THREAD *thread = (SIM_THREAD *)argument;
+    if (Seeded) {
+        SeedRandom(Seed+thread->Index);
+    }
+    BATTLE_CONTEXT start;
+    InitializeBattleContext(&start, Teams[0], TeamSize[0], Teams[1], TeamSize[1]);
+    start.Quiet = true;
+    start.Notify = SimNotify;
+    start.NotifyData = &thread->Stats;
+    BATTLE_CONTEXT battle;
+    for (long i = 0; i < thread->Battles; i++) {
+        bool first = LogFilename && thread->Index==0 && i==0;
+        SimBattle(&battle, &start, &thread->Stats, first? &FirstLog: NULL);
+    }
+    return NULL;
+}
+
+/**********************************************************//**
+ * @brief Finds a species by name or number.
+ * @param name: The name, which doesn't need to end in a null.
+ * @param length: Length of the name.
+ * @return The species, or 0 if there is none.
+ **************************************************************/
+static SPECIES_ID FindSpecies(const char *name, int length) {
+    char *end;
+    long number = strtol(name, &end, 10);
+    if (end == name+length && 0 < number && number < N_SPECIES) {
+        return (SPECIES_ID)number;
+    }
+    for (int id = 1; id < N_SPECIES; id++) {
+        const char *species = SpeciesByID(id)->Name;
+        if ((int)strlen(species) == length && !strncasecmp(species, name, length)) {
+            return (SPECIES_ID)id;
+        }
+    }
+    return 0;
+}
+
+/**********************************************************//**
+ * @brief Reads a team from the command line.
+ * @param team: The team to fill in.
+ * @param text: The team, as "species:level,...".
+ * @return Number of spectra on the team, or 0 if the team
+ * isn't valid.
+ **************************************************************/
+static int ParseTeam(SPECTRA *team, const char *text) {
+    int count = 0;
+    while (*text) {
+        const char *colon = strchr(text, ':');
+        if (!colon || count == TEAM_MAX) {
+            return 0;
+        }
+        SPECIES_ID species = FindSpecies(text, colon-text);
+        char *end;
+        long level = strtol(colon+1, &end, 10);
+        if (!species || level < 1 || level > LEVEL_MAX || (*end && *end != ',')) {
+            return 0;
+        }
+        CreateSpectra(&team[count++], species, level);
+        text = *end? end+1: end;
+    }
+    return count;
+}
+
+/**********************************************************//**
+ * @brief Gets the number of processors.
+ * @return Number of cores to use.
+ **************************************************************/
+static int ProcessorCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0)? count: 1;
+#endif
+}
+
+/**********************************************************//**
+ * @brief Gets a percentile from a histogram.
+ * @param histogram: Count of each value.
+ * @param size: Number of values.
+ * @param total: Sum of the histogram.
+ * @param fraction: Percentile, from 0 to 1.
+ * @return The smallest value at or past the percentile.
+ **************************************************************/
+static int Percentile(const long *histogram, int size, long total, double fraction) {
+    long goal = (long)(fraction*total);
+    long count = 0;
+    for (int i = 0; i < size; i++) {
+        count += histogram[i];
+        if (count > goal) {
+            return i;
+        }
+    }
+    return size-1;
+}
+
+/**********************************************************//**
+ * @brief Writes the totals of every thread.
+ * @param stats: The combined totals.
+ * @param seconds: Time taken.
+ * @param threads: Threads used.
+ **************************************************************/
+static void Report(const SIM_STATS *stats, double seconds, int threads) {
+    long n = stats->Battles;
+    printf("Battles:     %ld in %.2fs on %d threads (%.0f/s)\n", n, seconds, threads, n/seconds);
+    printf("First wins:  %6.2f%%\n", 100.0*stats->Result[SIM_FIRST]/n);
+    printf("Second wins: %6.2f%%\n", 100.0*stats->Result[SIM_SECOND]/n);
+    printf("Draws:       %6.2f%%\n", 100.0*stats->Result[SIM_DRAW]/n);
+
+    // Rounds
+    double rounds = 0.0;
+    for (int i = 0; i <= MaxRounds; i++) {
+        rounds += (double)i*stats->Rounds[i];
+    }
+    printf("Rounds:      mean %.2f, median %d, 90%% %d, 99%% %d\n",
+        rounds/n,
+        Percentile(stats->Rounds, MaxRounds+1, n, 0.5),
+        Percentile(stats->Rounds, MaxRounds+1, n, 0.9),
+        Percentile(stats->Rounds, MaxRounds+1, n, 0.99)
+    );
+
+    // Damage
+    long hits = stats->Hits;
+    long attempts = stats->Hits+stats->Misses;
+    double damage = 0.0;
+    for (int i = 0; i <= DAMAGE_MAX; i++) {
+        damage += (double)i*stats->Damage[i];
+    }
+    if (hits) {
+        printf("Damage/hit:  mean %.2f, median %d, 90%% %d, 99%% %d\n",
+            damage/hits,
+            Percentile(stats->Damage, DAMAGE_MAX+1, hits, 0.5),
+            Percentile(stats->Damage, DAMAGE_MAX+1, hits, 0.9),
+            Percentile(stats->Damage, DAMAGE_MAX+1, hits, 0.99)
+        );
+        printf("Criticals:   %6.2f%% of damaging hits\n", 100.0*stats->Criticals/hits);
+    }
+    if (attempts) {
+        printf("Misses:      %6.2f%% of attempts\n", 100.0*stats->Misses/attempts);
+    }
+    printf("Damage/battle: first %.1f, second %.1f\n", stats->TeamDamage[0]/n, stats->TeamDamage[1]/n);
+    printf("Turns lost to ailments: %.3f per battle\n", (double)stats->Blocked/n);
+}
+
+/**********************************************************//**
+ * @brief Replays a battle log, checks that the engine still
+ * plays it out the same way, and prints it as CSV.
+ * @param filename: The log file.
+ * @return Exit status.
+ **************************************************************/
+static int ReplayLog(const char *filename) {
+    static BATTLE_LOG log;
+    static BATTLE_LOG check;
+    if (!LoadBattleLog(&log, filename)) {
+        fprintf(stderr, "Can't read battle log %s\n", filename);
+        return EXIT_FAILURE;
+    }
+
+    // Replay it into a second log
+    BATTLE_CONTEXT battle;
+    BATTLE_REPLAY replay;
+    StartReplay(&replay, &log, &battle);
+    battle.Quiet = true;
+    StartBattleLog(&battle, &check);
+    FastForwardReplay(&replay, &battle);
+    ExportBattleLog(&log, stdout);
+
+    // Compare the two
+    for (int i = 0; i < log.nEvents; i++) {
+        if (i >= check.nEvents || memcmp(&log.Events[i], &check.Events[i], sizeof(BATTLE_EVENT))) {
+            fprintf(stderr, "Replay differs from the log at event %d\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+    if (check.nEvents != log.nEvents) {
+        fprintf(stderr, "Replay has %d events but the log has %d\n", check.nEvents, log.nEvents);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**********************************************************//**
+ * @brief Prints how to use the simulator.
+ **************************************************************/
+static void Usage(void) {
+    fprintf(stderr, "Usage: spectrum-battlesim [-n battles] [-j threads] [-s seed] [-r rounds] [-o log] TEAM TEAM\n");
+    fprintf(stderr, "       spectrum-battlesim -l log\n");
+    fprintf(stderr, "TEAM is species:level[,species:level...], e.g. Amy:30,Karda:28\n");
+}
+
+/**********************************************************//**
+ * @brief Runs the simulator.
+ * @param argc: Number of arguments.
+ * @param argv: Arguments.
+ * @return Exit status.
+ **************************************************************/
+int main(int argc, char **argv) {
+    long battles = 100000;
+    int threads = ProcessorCount();
+    int team = 0;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] == '-' && argv[i][1] && !argv[i][2] && i+1 < argc) {
+            switch (argv[i][1]) {
+            case 'n':
+                battles = strtol(argv[++i], NULL, 10);
+                break;
+            case 'j':
+                threads = strtol(argv[++i], NULL, 10);
+                break;
+            case 's':
+                Seed = strtoull(argv[++i], NULL, 10);
+                Seeded = true;
+                break;
+            case 'r':
+                MaxRounds = strtol(argv[++i], NULL, 10);
+                break;
+            case 'o':
+                LogFilename = argv[++i];
+                break;
+            case 'l':
+                InitializeDamageTables();
+                return ReplayLog(argv[++i]);
+            default:
+                Usage();
+                return EXIT_FAILURE;
+            }
+        } else if (team < 2 && (TeamSize[team] = ParseTeam(Teams[team], argv[i]))) {
+            team++;
+        } else {
+            fprintf(stderr, "Bad argument: %s\n", argv[i]);
+            Usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (team < 2 || battles < 1 || MaxRounds < 1) {
+        Usage();
+        return EXIT_FAILURE;
+    }
+    threads = (threads < 1)? 1: (threads > THREAD_MAX)? THREAD_MAX: threads;
+    InitializeDamageTables();
+
+    // Split the battles between the threads
+    static SIM_THREAD thread[THREAD_MAX];
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < threads; i++) {
+        memset(&thread[i].Stats, 0, sizeof(SIM_STATS));
+        thread[i].Index = i;
+        thread[i].Battles = battles/threads + (i < battles%threads);
+        thread[i].Stats.Rounds = (long *)calloc(MaxRounds+1, sizeof(long));
+        if (!thread[i].Stats.Rounds || pthread_create(&thread[i].Thread, NULL, SimThread, &thread[i])) {
+            fprintf(stderr, "Failed to start thread %d\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Combine the results
+    SIM_STATS total;
+    memset(&total, 0, sizeof(total));
+    total.Rounds = (long *)calloc(MaxRounds+1, sizeof(long));
+    if (!total.Rounds) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(thread[i].Thread, NULL);
+        const SIM_STATS *stats = &thread[i].Stats;
+        total.Battles += stats->Battles;
+        for (int r = 0; r < N_SIM_RESULT; r++) {
+            total.Result[r] += stats->Result[r];
+        }
+        for (int r = 0; r <= MaxRounds; r++) {
+            total.Rounds[r] += stats->Rounds[r];
+        }
+        for (int d = 0; d <= DAMAGE_MAX; d++) {
+            total.Damage[d] += stats->Damage[d];
+        }
+        total.Hits += stats->Hits;
+        total.Misses += stats->Misses;
+        total.Criticals += stats->Criticals;
+        total.Blocked += stats->Blocked;
+        total.TeamDamage[0] += stats->TeamDamage[0];
+        total.TeamDamage[1] += stats->TeamDamage[1];
+        free(stats->Rounds);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec-start.tv_sec)+(end.tv_nsec-start.tv_nsec)/1e9;
+    Report(&total, seconds, threads);
+    free(total.Rounds);
+    if (LogFilename && !SaveBattleLog(&FirstLog, LogFilename)) {
+        fprintf(stderr, "Can't write battle log %s\n", LogFilename);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**************************************************************/